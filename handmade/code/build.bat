@@ -11,21 +11,39 @@ pushd %BuildDir%
 
 :: Set compiler arguments
 set Files=..\handmade\code\win32_handmade.cpp
-set Libs=user32.lib gdi32.lib
+set GameFiles=..\handmade\code\handmade.cpp
+set BenchFiles=..\handmade\code\handmade_bench.cpp
+set PackerFiles=..\handmade\code\handmade_packer.cpp
+set Libs=user32.lib gdi32.lib advapi32.lib winmm.lib ole32.lib
 set ObjDir=.\obj\
 
 :: Set compiler flags:
 :: -DHANDMADE_WIN32 for performance metrics
+:: -DHANDMADE_SLOW=1 enables Asserts
+:: -DDEBUG=1 keeps debug_Message, which the window procedure reports its messages through
 :: -Zi enable debugging info
 :: -FC use full path in diagnostics
 :: -Fo path to store Object files
-set CompilerFlags=-DHANDMADE_WIN32=1 -Zi -FC -Fo%ObjDir%
+set CompilerFlags=-DHANDMADE_WIN32=1 -DHANDMADE_SLOW=1 -DDEBUG=1 -Zi -FC -Fo%ObjDir%
 
 :: Create Object directory if it doesn't exist
 if not exist %ObjDir% mkdir %ObjDir%
 
+:: Game DLL first, the platform won't reload while lock.tmp exists
+:: PDB gets a random name because the debugger keeps the loaded one locked
+del handmade_*.pdb > NUL 2> NUL
+echo WAITING FOR PDB > lock.tmp
+cl %CompilerFlags% %GameFiles% -LD /link -incremental:no -PDB:handmade_%random%.pdb
+del lock.tmp
+
 :: Run Visual Studio compiler
 cl %CompilerFlags% %Files% %Libs%
 
+:: Kernel micro-benchmarks, standalone so they build without either platform layer
+cl %CompilerFlags% %BenchFiles%
+
+:: Asset packer, bakes .bmp and .wav files into handmade.hha for the game to map
+cl %CompilerFlags% %PackerFiles%
+
 :: Jump out of build directory
 popd
\ No newline at end of file
@@ -0,0 +1,36 @@
+#!/bin/sh
+
+# Set build directory relative to this script
+BuildDir="$(cd "$(dirname "$0")" && pwd)/../../build"
+
+# Create path if it doesn't exist
+mkdir -p "$BuildDir"
+
+# Move to build directory
+cd "$BuildDir" || exit 1
+
+# Set compiler arguments
+Files=../handmade/code/linux_handmade.cpp
+GameFiles=../handmade/code/handmade.cpp
+BenchFiles=../handmade/code/handmade_bench.cpp
+PackerFiles=../handmade/code/handmade_packer.cpp
+Libs="-lm -lpthread -ldl"
+
+# Set compiler flags:
+# -DHANDMADE_LINUX for the headless platform layer
+# -g enable debugging info
+# -O2 optimise, the Linux build exists to time the game code
+# -Wall -Wextra keep the tree warning free, -Wno-unused-function because every unity build pulls in helpers it never calls
+CompilerFlags="-DHANDMADE_LINUX=1 -g -O2 -Wall -Wextra -Wno-unused-function"
+
+# Game library first, written under a temporary name and renamed so a running platform never loads a partial file
+g++ $CompilerFlags -shared -fPIC $GameFiles -o libhandmade.so.tmp -lm && mv libhandmade.so.tmp libhandmade.so
+
+# Run GCC
+g++ $CompilerFlags $Files -o linux_handmade $Libs
+
+# Kernel micro-benchmarks, standalone so they build without either platform layer
+g++ $CompilerFlags $BenchFiles -o handmade_bench -lm
+
+# Asset packer, bakes .bmp and .wav files into handmade.hha for the game to map
+g++ $CompilerFlags $PackerFiles -o handmade_packer -lm
@@ -1,72 +1,303 @@
 #include "handmade.h"
+#include "handmade_memory.h"
+#include "handmade_render.cpp"
+#include "handmade_sound.cpp"
+#include "handmade_resample.cpp"
+#include "handmade_asset.cpp"
 
-internal void sound_OutputSound(HANDMADE_SOUND_BUFFER *SoundBuffer, int ToneHz)
+//What the platform's buffer last showed, so a frame redraws only what differs
+//Transient because it describes pixels, which a replay rewinding permanent storage leaves alone
+struct HANDMADE_SCREEN
 {
-    local float32 tSine;
-    int16 Amplitude = 3000;
-    int WavePeriod = SoundBuffer->SampleRate / ToneHz;
+    bool32 IsValid;
+    void *BitmapMemory;
+    int BitmapWidth;
+    int BitmapHeight;
+    int Pitch;
+    HANDMADE_PIXEL_FORMAT Format;
+    int XOffset;
+    int YOffset;
+    HANDMADE_RECT PlayerRect;
+    RENDER_BITMAP *PlayerBitmap;
+    void *PlayerMemory;
+};
 
-    int16 *SampleOut = SoundBuffer->Samples;
+//Lives at the start of permanent storage, every other allocation comes from the arenas behind it
+struct HANDMADE_STATE
+{
+    int XOffset;
+    int YOffset;
+    int ToneHz;
+    float32 PlayerX;
+    float32 PlayerY;
+
+    SOUND_WAVETABLES *Wavetables;
+    SOUND_MIXER Mixer;
+    SOUND_SAMPLES Blip;
+    int16 *BlipSamples;
+    SOUND_VOICE *MusicVoice;
+
+    MEMORY_ARENA PermanentArena;
+    MEMORY_ARENA TransientArena;
+
+    //Cache and its budget live in transient storage, a replay snapshot of permanent storage never rewinds them under a running load
+    ASSET_CACHE *AssetCache;
+    void *AssetBudget;
+
+    //Points into the pack mapping, so it is transient too and refreshed from the pack before every mix
+    SOUND_STREAM *Music;
 
-    for(int SampleIndex = 0; SampleIndex < SoundBuffer->SampleCount; ++SampleIndex)
+    HANDMADE_SCREEN *Screen;
+};
+
+#define HANDMADE_BLIP_SAMPLE_COUNT 4800
+#define HANDMADE_ASSET_BUDGET Megabytes(64)
+
+//Library global rather than game state, it points into the platform's mapping which a replay snapshot knows nothing about
+global ASSET_PACK GlobalAssetPack;
+
+//Reopened whenever the platform hands over a different mapping, including after a reload zeroes the global
+internal ASSET_PACK *handmade_GetAssetPack(HANDMADE_PLATFORM *Platform)
+{
+    if(GlobalAssetPack.Base != Platform->AssetPackMemory)
     {
-        float32 SineValue = sinf(tSine);
-        int16 SampleValue = (int16) (SineValue * Amplitude);
-        
-        *SampleOut++ = SampleValue;
-        *SampleOut++ = SampleValue;
+        bool32 Opened = asset_OpenPack(&GlobalAssetPack, Platform->AssetPackMemory, Platform->AssetPackSize);
+        if(Platform->AssetPackMemory && !Opened)
+        {
+            debug_LogWarning("Asset pack of %llu bytes is not valid, drawing without it", Platform->AssetPackSize);
+        }
 
-        tSine += 2.0f * Pi32 * 1.0 / (float32) WavePeriod;
+        GlobalAssetPack.Base = (uint8 *) Platform->AssetPackMemory;
     }
+
+    return &GlobalAssetPack;
 }
 
-internal void render_Gradient(HANDMADE_OFFSCREEN_BUFFER *Buffer, int XOffset, int YOffset)
-{    
-    uint8 *Row = (uint8 *) Buffer->BitmapMemory; 
+//Both entry points start here, whichever the platform calls first sets memory up
+internal HANDMADE_STATE *handmade_GetState(HANDMADE_PLATFORM *Platform, HANDMADE_MEMORY *Memory)
+{
+    Assert(sizeof(HANDMADE_STATE) <= Memory->PermanentStorageSize);
+    HANDMADE_STATE *State = (HANDMADE_STATE *) Memory->PermanentStorage;
+
+    if(!Memory->IsInitialised)
+    {
+        memory_InitArena(&State->PermanentArena, (size_t) (Memory->PermanentStorageSize - sizeof(HANDMADE_STATE)), (uint8 *) Memory->PermanentStorage + sizeof(HANDMADE_STATE));
+        memory_InitArena(&State->TransientArena, (size_t) Memory->TransientStorageSize, Memory->TransientStorage);
+
+        State->ToneHz = 256;
+        State->PlayerX = 100.0f;
+        State->PlayerY = 100.0f;
+        State->Wavetables = memory_PushStruct(&State->PermanentArena, SOUND_WAVETABLES);
+        State->BlipSamples = memory_PushArray(&State->PermanentArena, HANDMADE_BLIP_SAMPLE_COUNT, int16);
+
+        State->AssetCache = memory_PushStruct(&State->TransientArena, ASSET_CACHE);
+        State->AssetBudget = memory_PushSize_(&State->TransientArena, HANDMADE_ASSET_BUDGET, ASSET_CACHE_BLOCK_HEADER);
+        State->Music = memory_PushStruct(&State->TransientArena, SOUND_STREAM);
+        *State->Music = {};
+        State->Screen = memory_PushStruct(&State->TransientArena, HANDMADE_SCREEN);
+        *State->Screen = {};
 
-    //Animation loops
-    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+        Memory->IsInitialised = true;
+    }
+
+    //Kernel pointers are library globals, a fresh load has them all at zero
+    if(Memory->ExecutableReloaded)
     {
-        uint32 *Pixel = (uint32 *) Row;
+        render_SelectKernels(Platform->SimdLevel);
+        sound_SelectKernels(Platform->SimdLevel);
+        resample_SelectKernels(Platform->SimdLevel);
+
+        //Slots hold the library's own pointers, the platform finished every load before unloading the old copy
+        asset_InitCache(State->AssetCache, State->AssetBudget, HANDMADE_ASSET_BUDGET);
 
-        for(int X = 0; X < Buffer->BitmapWidth; ++X)
+        //New code may draw differently
+        State->Screen->IsValid = false;
+
+        Memory->ExecutableReloaded = false;
+    }
+
+    return State;
+}
+
+//Share of the frame's input window the button spent down, walked back from where it ended through the listed events
+//Buttons with unlisted events past HANDMADE_INPUT_MAX_EVENTS come out approximate, a window of no length is all or nothing
+internal float32 handmade_GetHeldFraction(HANDMADE_INPUT_USER *Input, int ControllerIndex, int ButtonIndex)
+{
+    HANDMADE_INPUT_CONTROLLER_BUTTON_STATE *Button = &Input->Controllers[ControllerIndex].Buttons[ButtonIndex];
+
+    if(Input->FrameSeconds <= 0.0f)
+    {
+        return Button->EndedDown ? 1.0f : 0.0f;
+    }
+
+    //An odd number of transitions means it started the frame the other way
+    bool32 IsDown = (Button->EndedDown != 0) != ((Button->HalfTransitionCount & 1) != 0);
+    float32 HeldSeconds = 0.0f;
+    float32 LastTime = 0.0f;
+
+    for(int EventIndex = 0; EventIndex < Input->EventCount; ++EventIndex)
+    {
+        HANDMADE_INPUT_EVENT *Event = &Input->Events[EventIndex];
+
+        if((Event->ControllerIndex == ControllerIndex) && (Event->ButtonIndex == ButtonIndex))
         {
-            //Pixels in memory = 0x xxBBGGRR (Little Endian)
-            uint8 Blue = (X + XOffset);
-            uint8 Green = (Y + YOffset);
+            if(IsDown)
+            {
+                HeldSeconds += Event->Time - LastTime;
+            }
 
-            //Pixel increments by 1 * sizeof(uint32) = 4 bytes
-            //xx BB GG RR -> xx RR GG BB from Little Endian
-            *Pixel++ = ((Green << 8) | Blue); //Shift and Or RGB values together
+            LastTime = Event->Time;
+            IsDown = Event->IsDown;
         }
+    }
 
-        //Pitch moves from one row to the next (in bytes)
-        Row += Buffer->Pitch;
+    if(IsDown)
+    {
+        HeldSeconds += Input->FrameSeconds - LastTime;
     }
+
+    return HeldSeconds / Input->FrameSeconds;
 }
 
-internal void handmade_GameUpdate_Render(HANDMADE_INPUT_USER *Input, HANDMADE_OFFSCREEN_BUFFER *Buffer, HANDMADE_SOUND_BUFFER *SoundBuffer)
+HANDMADE_EXPORT HANDMADE_GAME_UPDATE_RENDER(handmade_GameUpdate_Render)
 {
-    local int XOffset = 0;
-    local int YOffset = 0;
-    local int ToneHz = 256;
+    GlobalDebugTable = Platform->DebugTable;
+    GlobalDebugLog = Platform->DebugLog;
+    TIMED_FUNCTION();
+
+    HANDMADE_STATE *State = handmade_GetState(Platform, Memory);
+
+    ASSET_PACK *AssetPack = handmade_GetAssetPack(Platform);
+    asset_BeginFrame(State->AssetCache, Platform, AssetPack);
+
+    //Keyboard and every pad drive the same player
+    for(int ControllerIndex = 0; ControllerIndex < HANDMADE_INPUT_MAX_CONTROLLERS; ++ControllerIndex)
+    {
+        HANDMADE_INPUT_CONTROLLER *Controller = &Input->Controllers[ControllerIndex];
+
+        if(Controller->Down.EndedDown)
+        {
+            State->XOffset += 1;
+        }
+
+        //Moves for as much of the frame as the button was held, so a tap shorter than a frame still moves a little
+        State->PlayerX -= handmade_GetHeldFraction(Input, ControllerIndex, HANDMADE_INPUT_BUTTON_LEFT);
+        State->PlayerY -= handmade_GetHeldFraction(Input, ControllerIndex, HANDMADE_INPUT_BUTTON_UP);
+    }
+
+    //Blip on every press, even several in one frame, panned by which shoulder that controller holds. The mixer is set up by the first sound call
+    for(int EventIndex = 0; EventIndex < Input->EventCount; ++EventIndex)
+    {
+        HANDMADE_INPUT_EVENT *Event = &Input->Events[EventIndex];
+
+        if(State->Mixer.SampleRate && Event->IsDown && (Event->ButtonIndex == HANDMADE_INPUT_BUTTON_RIGHT))
+        {
+            HANDMADE_INPUT_CONTROLLER *Controller = &Input->Controllers[Event->ControllerIndex];
+            float32 Pan = Controller->LeftShoulder.EndedDown ? 0.2f : (Controller->RightShoulder.EndedDown ? 0.8f : 0.5f);
+            sound_PlaySound(&State->Mixer, &State->Blip, 1.0f - Pan, Pan, false);
+        }
+    }
+
+    //Player art streams in from the pack, a placeholder rectangle stands in until it is resident
+    RENDER_BITMAP *PlayerBitmap = asset_GetBitmapStreamed(State->AssetCache, Platform, asset_FindAsset(AssetPack, "player", ASSET_TYPE_BITMAP));
+    void *PlayerMemory = PlayerBitmap ? PlayerBitmap->Memory : 0;
+    HANDMADE_RECT PlayerRect = PlayerBitmap ? render_GetBitmapBounds(PlayerBitmap, State->PlayerX, State->PlayerY) :
+                               render_GetRectangleBounds(State->PlayerX, State->PlayerY, State->PlayerX + 10.0f, State->PlayerY + 10.0f);
 
-    HANDMADE_INPUT_CONTROLLER *Input0 = &Input->Controllers[0];
+    //Anything that moves the background repaints everything, otherwise only where the player was and now is
+    HANDMADE_SCREEN *Screen = State->Screen;
+    HANDMADE_DIRTY_RECTS LocalDirty;
+    HANDMADE_DIRTY_RECTS *Dirty = Platform->DirtyRects ? Platform->DirtyRects : &LocalDirty;
+    render_ClearDirtyRects(Dirty);
 
-    if(Input0->IsAnalog)
+    if(!Platform->DirtyRects || !Screen->IsValid || (Screen->BitmapMemory != Buffer->BitmapMemory) || (Screen->BitmapWidth != Buffer->BitmapWidth) ||
+       (Screen->BitmapHeight != Buffer->BitmapHeight) || (Screen->Pitch != Buffer->Pitch) || (Screen->Format != Buffer->Format) ||
+       (Screen->XOffset != State->XOffset) || (Screen->YOffset != State->YOffset))
+    {
+        render_AddDirtyRect(Dirty, Buffer, render_GetBufferRect(Buffer));
+    }
+    else if(!render_RectsEqual(Screen->PlayerRect, PlayerRect) || (Screen->PlayerBitmap != PlayerBitmap) || (Screen->PlayerMemory != PlayerMemory))
     {
+        render_AddDirtyRect(Dirty, Buffer, Screen->PlayerRect);
+        render_AddDirtyRect(Dirty, Buffer, PlayerRect);
+    }
+
+    render_CoalesceDirtyRects(Dirty);
 
+    if(Platform->JobQueue)
+    {
+        render_GradientTiled(Platform, &State->TransientArena, Buffer, State->XOffset, State->YOffset, Dirty);
     }
     else
     {
+        for(int RectIndex = 0; RectIndex < Dirty->RectCount; ++RectIndex)
+        {
+            HANDMADE_RECT Rect = Dirty->Rects[RectIndex];
+            HANDMADE_OFFSCREEN_BUFFER Part = render_GetSubBuffer(Buffer, Rect);
+            render_Gradient(&Part, State->XOffset + Rect.MinX, State->YOffset + Rect.MinY);
+        }
+    }
+
+    //Rectangles are disjoint, so clipping to each in turn blends every player pixel exactly once
+    for(int RectIndex = 0; RectIndex < Dirty->RectCount; ++RectIndex)
+    {
+        HANDMADE_RECT Rect = Dirty->Rects[RectIndex];
 
+        if(PlayerBitmap)
+        {
+            render_DrawBitmapClipped(Buffer, PlayerBitmap, State->PlayerX, State->PlayerY, Rect);
+        }
+        else
+        {
+            render_DrawRectangleClipped(Buffer, State->PlayerX, State->PlayerY, State->PlayerX + 10.0f, State->PlayerY + 10.0f, 0xFFFFFFFF, Rect);
+        }
     }
 
-    if(Input0->Down.EndedDown)
+    Screen->IsValid = true;
+    Screen->BitmapMemory = Buffer->BitmapMemory;
+    Screen->BitmapWidth = Buffer->BitmapWidth;
+    Screen->BitmapHeight = Buffer->BitmapHeight;
+    Screen->Pitch = Buffer->Pitch;
+    Screen->Format = Buffer->Format;
+    Screen->XOffset = State->XOffset;
+    Screen->YOffset = State->YOffset;
+    Screen->PlayerRect = PlayerRect;
+    Screen->PlayerBitmap = PlayerBitmap;
+    Screen->PlayerMemory = PlayerMemory;
+
+    asset_EndFrame(State->AssetCache, Platform);
+
+    memory_CheckArena(&State->TransientArena);
+}
+
+HANDMADE_EXPORT HANDMADE_GAME_GET_SOUND_SAMPLES(handmade_GetSoundSamples)
+{
+    GlobalDebugTable = Platform->DebugTable;
+    GlobalDebugLog = Platform->DebugLog;
+    TIMED_FUNCTION();
+
+    HANDMADE_STATE *State = handmade_GetState(Platform, Memory);
+    SOUND_MIXER *Mixer = &State->Mixer;
+
+    //Music loops straight out of the pack, starting it reads nothing
+    ASSET_PACK *AssetPack = handmade_GetAssetPack(Platform);
+    asset_GetStream(AssetPack, asset_FindAsset(AssetPack, "music", ASSET_TYPE_STREAM), State->Music);
+
+    //Blip is regenerated in place for the new rate, voices still playing it are dropped with the old mixer
+    if(Mixer->SampleRate != SoundBuffer->SampleRate)
     {
-        XOffset += 1;
+        sound_InitMixer(Mixer, State->Wavetables, SoundBuffer->SampleRate);
+        sound_GenerateTone(Mixer, &State->Blip, State->BlipSamples, HANDMADE_BLIP_SAMPLE_COUNT, SOUND_WAVE_SQUARE, 880.0f, 4000.0f);
+        Mixer->Oscillators.OscillatorCount = 1;
+        State->MusicVoice = 0;
     }
 
-    sound_OutputSound(SoundBuffer, ToneHz);
-    render_Gradient(Buffer, XOffset, YOffset);
-}
\ No newline at end of file
+    if(!State->MusicVoice && (State->Music->SampleCount > 0))
+    {
+        State->MusicVoice = sound_PlayStream(Mixer, State->Music, 0.5f, 0.5f, true);
+    }
+
+    sound_SetOscillator(&Mixer->Oscillators, &Mixer->Oscillators.Oscillators[0], SOUND_WAVE_SINE, (float32) State->ToneHz, 3000.0f);
+    sound_ReadAhead(Mixer, Platform);
+    sound_OutputSound(Mixer, SoundBuffer);
+}
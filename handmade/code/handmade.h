@@ -1,7 +1,62 @@
 #if !defined(HANDMADE_H)
 
+//Shared by the platform layers and the game library, everything either side needs to talk to the other
+#include <stdint.h>
+#include <math.h>
+
+//Static can have three different meanings:
+#define global static //Global access to variable
+#define internal static //Variable local to source file only
+#define local static //Variable persists after stepping out of scope (this should be avoided when possible)
+
+#define Pi32 3.14159265359f
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+
+typedef int32 bool32;
+
+typedef float float32;
+typedef double float64;
+
 #define ArrayCount(Array) (sizeof(Array) / sizeof((Array[0])))
 
+#define Kilobytes(Value) ((Value) * 1024LL)
+#define Megabytes(Value) (Kilobytes(Value) * 1024LL)
+#define Gigabytes(Value) (Megabytes(Value) * 1024LL)
+#define Terabytes(Value) (Gigabytes(Value) * 1024LL)
+
+//HANDMADE_SLOW 1 enables checks that cost time, writing to address 0 stops in the debugger
+#if HANDMADE_SLOW
+#define Assert(Expression) if(!(Expression)) {*(volatile int *) 0 = 0;}
+#else
+#define Assert(Expression)
+#endif
+
+#include "handmade_intrinsics.h"
+#include "handmade_debug.h"
+
+//Layout of backbuffer pixels, the renderer has kernels for each and the platform converts to what the display takes when presenting
+//Zero is the display's own format so buffers that never set one keep working
+enum HANDMADE_PIXEL_FORMAT
+{
+    HANDMADE_PIXEL_FORMAT_BGRX8888, //0xXXRRGGBB
+    HANDMADE_PIXEL_FORMAT_RGB565, //Half the bytes to fill and present
+    HANDMADE_PIXEL_FORMAT_INDEXED8, //Index into a fixed 3-3-2 palette, red in the top bits
+
+    HANDMADE_PIXEL_FORMAT_COUNT
+};
+
+global const char * const PixelFormatNames[HANDMADE_PIXEL_FORMAT_COUNT] = {"bgrx8888", "rgb565", "indexed8"};
+global const int PixelFormatBytes[HANDMADE_PIXEL_FORMAT_COUNT] = {4, 2, 1};
+
 //Create struct instead of global variables, means multiple buffers can be made
 struct HANDMADE_OFFSCREEN_BUFFER
 {
@@ -9,6 +64,27 @@ struct HANDMADE_OFFSCREEN_BUFFER
     int BitmapWidth;
     int BitmapHeight;
     int Pitch;
+    HANDMADE_PIXEL_FORMAT Format;
+};
+
+//Pixel rectangle, Min inclusive and Max exclusive
+struct HANDMADE_RECT
+{
+    int MinX;
+    int MinY;
+    int MaxX;
+    int MaxY;
+};
+
+#define HANDMADE_MAX_DIRTY_RECTS 64
+
+//Parts of the backbuffer the game changed this frame, disjoint and clipped to the buffer
+//Pixels outside them are exactly what the platform was last given, so only these need presenting
+struct HANDMADE_DIRTY_RECTS
+{
+    int RectCount;
+    HANDMADE_RECT Rects[HANDMADE_MAX_DIRTY_RECTS];
+    uint64 DirtyPixelCount;
 };
 
 struct HANDMADE_SOUND_BUFFER
@@ -20,10 +96,23 @@ struct HANDMADE_SOUND_BUFFER
 
 struct HANDMADE_INPUT_CONTROLLER_BUTTON_STATE
 {
-    int HalfTransitionCount;
+    int HalfTransitionCount; //Every press and release this frame, a tap between two frames counts 2
     bool32 EndedDown;
 };
 
+//Index into HANDMADE_INPUT_CONTROLLER::Buttons, and what input events name a button by
+enum HANDMADE_INPUT_BUTTON
+{
+    HANDMADE_INPUT_BUTTON_UP,
+    HANDMADE_INPUT_BUTTON_DOWN,
+    HANDMADE_INPUT_BUTTON_LEFT,
+    HANDMADE_INPUT_BUTTON_RIGHT,
+    HANDMADE_INPUT_BUTTON_LEFT_SHOULDER,
+    HANDMADE_INPUT_BUTTON_RIGHT_SHOULDER,
+
+    HANDMADE_INPUT_BUTTON_COUNT
+};
+
 struct HANDMADE_INPUT_CONTROLLER
 {
     bool32 IsAnalog;
@@ -42,7 +131,7 @@ struct HANDMADE_INPUT_CONTROLLER
 
     union
     {
-        HANDMADE_INPUT_CONTROLLER_BUTTON_STATE Buttons[5];
+        HANDMADE_INPUT_CONTROLLER_BUTTON_STATE Buttons[HANDMADE_INPUT_BUTTON_COUNT];
 
         struct
         {
@@ -56,19 +145,127 @@ struct HANDMADE_INPUT_CONTROLLER
     };
 };
 
+//Keyboard first, then one per gamepad
+#define HANDMADE_INPUT_KEYBOARD 0
+#define HANDMADE_INPUT_MAX_CONTROLLERS 5
+#define HANDMADE_INPUT_MAX_EVENTS 64
+
+//One button transition, Time is seconds into the frame's input window so the game can tell early presses from late ones
+struct HANDMADE_INPUT_EVENT
+{
+    float32 Time;
+    uint8 ControllerIndex;
+    uint8 ButtonIndex;
+    uint8 IsDown;
+    uint8 Pad;
+};
+
+//Button states are where each button ended the frame, Events is every transition that got it there in time order
+//Events past HANDMADE_INPUT_MAX_EVENTS still count in the button states, they just aren't listed
 struct HANDMADE_INPUT_USER
 {
-    HANDMADE_INPUT_CONTROLLER Controllers[4];
+    HANDMADE_INPUT_CONTROLLER Controllers[HANDMADE_INPUT_MAX_CONTROLLERS];
+
+    float32 FrameSeconds; //Length of the input window, from the previous frame's gather to this one's
+    int32 EventCount;
+    HANDMADE_INPUT_EVENT Events[HANDMADE_INPUT_MAX_EVENTS];
+};
+
+//Work queue is owned by the platform, the game only sees the handle and pushes entries through function pointers
+struct HANDMADE_WORK_QUEUE;
+
+#define PLATFORM_WORK_QUEUE_CALLBACK(name) void name(HANDMADE_WORK_QUEUE *Queue, void *Data)
+typedef PLATFORM_WORK_QUEUE_CALLBACK(platform_work_queue_callback);
+
+//Callable from the main thread or from inside a running job, Data must stay valid until CompleteAllWork returns
+#define PLATFORM_ADD_WORK_ENTRY(name) void name(HANDMADE_WORK_QUEUE *Queue, platform_work_queue_callback *Callback, void *Data)
+typedef PLATFORM_ADD_WORK_ENTRY(platform_add_work_entry);
+
+//Blocks until every entry pushed so far has finished, the calling thread helps out while it waits
+#define PLATFORM_COMPLETE_ALL_WORK(name) void name(HANDMADE_WORK_QUEUE *Queue)
+typedef PLATFORM_COMPLETE_ALL_WORK(platform_complete_all_work);
+
+//Streaming asset cache counters, written by the game and read by the platform for its reports
+struct HANDMADE_ASSET_STATS
+{
+    uint64 Hits; //Asked for and resident
+    uint64 Misses; //Asked for and not resident yet, whether or not a load was already running
+    uint64 Loads; //Loads started
+    uint64 Evictions;
+    uint64 BudgetFailures; //Loads that couldn't start because everything left was in use this frame or in flight
+    uint64 BytesInFlight;
+    uint64 BytesResident;
+    uint64 BudgetSize;
+};
+
+//Services the platform hands to the game every frame
+struct HANDMADE_PLATFORM
+{
+    HANDMADE_WORK_QUEUE *JobQueue;
+    platform_add_work_entry *AddWorkEntry;
+    platform_complete_all_work *CompleteAllWork;
+
+    //Backbuffer is split into tiles of this size, one job per tile
+    int RenderTileWidth;
+    int RenderTileHeight;
+
+    //Kernels the game selects after every load, AUTO picks the widest the CPU supports
+    SIMD_LEVEL SimdLevel;
+
+    //Profiler tables the platform collates each frame, 0 turns TIMED_BLOCK into a branch
+    DEBUG_TABLE *DebugTable;
+
+    //Per thread log rings the platform's writer thread drains, 0 drops every record
+    DEBUG_LOG *DebugLog;
+
+    //Asset pack mapped read only for the whole run (handmade_asset.h), 0 when there is none
+    void *AssetPackMemory;
+    uint64 AssetPackSize;
+
+    //Background queue for work that spans frames, nothing on the frame path waits on it. 0 runs that work inline
+    //The platform completes it before unloading the game library, whose code the queued entries point at
+    //Push from the update thread only, its workers aren't threads of JobQueue
+    HANDMADE_WORK_QUEUE *BackgroundQueue;
+
+    //Filled by the game each frame when set
+    HANDMADE_ASSET_STATS *AssetStats;
+
+    //Filled by the game each frame when set. 0 tells the game the platform presents the whole buffer, so it redraws all of it
+    HANDMADE_DIRTY_RECTS *DirtyRects;
+};
+
+//One block reserved by the platform at startup, the game never allocates anywhere else
+//Permanent storage is everything that must survive between frames, transient can be rebuilt at any time
+struct HANDMADE_MEMORY
+{
+    bool32 IsInitialised;
+
+    uint64 PermanentStorageSize;
+    void *PermanentStorage; //Platform must clear this to zero
+
+    uint64 TransientStorageSize;
+    void *TransientStorage;
+
+    //Set by the platform whenever the game library was (re)loaded, globals inside the library start over at zero
+    bool32 ExecutableReloaded;
 };
 
-//Prototypes
+//Entry points exported by the game library, the platform loads them by name
+//Nothing in game memory may point into the library itself (code, globals or string constants), it moves on reload
 
-internal void sound_OutputSound(HANDMADE_SOUND_BUFFER *SoundBuffer, int ToneHz);
+//5 inputs: platform services / game memory / timing / keyboard input / bitmap buffer
+#define HANDMADE_GAME_UPDATE_RENDER(name) void name(HANDMADE_PLATFORM *Platform, HANDMADE_MEMORY *Memory, HANDMADE_INPUT_USER *Input, HANDMADE_OFFSCREEN_BUFFER *Buffer)
+typedef HANDMADE_GAME_UPDATE_RENDER(handmade_game_update_render);
 
-internal void render_Gradient(HANDMADE_OFFSCREEN_BUFFER *Buffer, int XOffset, int YOffset);
+//Fills SoundBuffer->SampleCount frames, called after the update for the same frame
+#define HANDMADE_GAME_GET_SOUND_SAMPLES(name) void name(HANDMADE_PLATFORM *Platform, HANDMADE_MEMORY *Memory, HANDMADE_SOUND_BUFFER *SoundBuffer)
+typedef HANDMADE_GAME_GET_SOUND_SAMPLES(handmade_game_get_sound_samples);
 
-//4 inputs: timing / keyboard input / bitmap buffer / sound buffer 
-internal void handmade_GameUpdate_Render(HANDMADE_INPUT_USER *Input, HANDMADE_OFFSCREEN_BUFFER *Buffer, HANDMADE_SOUND_BUFFER *SoundBuffer);
+#if defined(_MSC_VER)
+#define HANDMADE_EXPORT extern "C" __declspec(dllexport)
+#else
+#define HANDMADE_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
 
 #define HANDMADE_H
 #endif
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include "handmade_asset.h"
+
+//Streaming residency cache over a mapped pack
+//The game asks for an asset by index every frame it wants it and gets 0 until the copy has landed
+//Least recently used assets are evicted to make room, never one already used this frame or still being loaded
+//Pointers handed out stay valid until the asset is evicted, so anything held across frames (a playing voice) must ask again each frame
+
+internal void asset_InitCache(ASSET_CACHE *Cache, void *Budget, size_t BudgetSize)
+{
+    Cache->Pack = {};
+    Cache->FrameIndex = 0;
+    Cache->Budget = (uint8 *) Budget;
+    Cache->BudgetSize = BudgetSize;
+    Cache->SlotCount = 0;
+    Cache->LRUHead = -1;
+    Cache->LRUTail = -1;
+    Cache->Stats = {};
+    Cache->Stats.BudgetSize = BudgetSize;
+}
+
+//Nothing may be in flight, every slot goes back to unloaded and the budget to one free block
+internal void asset_ResetCache(ASSET_CACHE *Cache, ASSET_PACK *Pack)
+{
+    Cache->Pack = *Pack;
+    Cache->SlotCount = (Pack->AssetCount < ASSET_CACHE_MAX_SLOTS) ? (int) Pack->AssetCount : ASSET_CACHE_MAX_SLOTS;
+    Cache->LRUHead = -1;
+    Cache->LRUTail = -1;
+    Cache->Stats.BytesResident = 0;
+    Cache->Stats.BytesInFlight = 0;
+
+    ASSET_BLOCK *Sentinel = &Cache->Sentinel;
+    Sentinel->Prev = Sentinel;
+    Sentinel->Next = Sentinel;
+    Sentinel->Size = 0;
+    Sentinel->Used = true;
+
+    if(Cache->BudgetSize > ASSET_CACHE_BLOCK_HEADER)
+    {
+        ASSET_BLOCK *Block = (ASSET_BLOCK *) Cache->Budget;
+        Block->Prev = Sentinel;
+        Block->Next = Sentinel;
+        Block->Size = Cache->BudgetSize - ASSET_CACHE_BLOCK_HEADER;
+        Block->Used = false;
+
+        Sentinel->Next = Block;
+        Sentinel->Prev = Block;
+    }
+
+    for(int SlotIndex = 0; SlotIndex < Cache->SlotCount; ++SlotIndex)
+    {
+        ASSET_SLOT *Slot = &Cache->Slots[SlotIndex];
+        *Slot = {};
+        Slot->LRUPrev = -1;
+        Slot->LRUNext = -1;
+        Slot->Cache = Cache;
+    }
+}
+
+//First fit, the remainder is split off when it can hold a useful payload
+internal ASSET_BLOCK *asset_AllocateBlock(ASSET_CACHE *Cache, uint64 Size)
+{
+    size_t AlignedSize = (size_t) ((Size + ASSET_CACHE_BLOCK_HEADER - 1) & ~((uint64) ASSET_CACHE_BLOCK_HEADER - 1));
+
+    for(ASSET_BLOCK *Block = Cache->Sentinel.Next; Block != &Cache->Sentinel; Block = Block->Next)
+    {
+        if(Block->Used || (Block->Size < AlignedSize))
+        {
+            continue;
+        }
+
+        if(Block->Size >= AlignedSize + (2 * ASSET_CACHE_BLOCK_HEADER))
+        {
+            ASSET_BLOCK *Remainder = (ASSET_BLOCK *) ((uint8 *) Block + ASSET_CACHE_BLOCK_HEADER + AlignedSize);
+            Remainder->Size = Block->Size - AlignedSize - ASSET_CACHE_BLOCK_HEADER;
+            Remainder->Used = false;
+            Remainder->Prev = Block;
+            Remainder->Next = Block->Next;
+            Remainder->Next->Prev = Remainder;
+            Block->Next = Remainder;
+            Block->Size = AlignedSize;
+        }
+
+        Block->Used = true;
+        return Block;
+    }
+
+    return 0;
+}
+
+//Merging only with free neighbours in the list, which are also neighbours in memory
+internal void asset_MergeWithNext(ASSET_CACHE *Cache, ASSET_BLOCK *Block)
+{
+    ASSET_BLOCK *Next = Block->Next;
+
+    if((Next != &Cache->Sentinel) && !Block->Used && !Next->Used)
+    {
+        Block->Size += ASSET_CACHE_BLOCK_HEADER + Next->Size;
+        Block->Next = Next->Next;
+        Block->Next->Prev = Block;
+    }
+}
+
+internal void asset_FreeBlock(ASSET_CACHE *Cache, ASSET_BLOCK *Block)
+{
+    Block->Used = false;
+    asset_MergeWithNext(Cache, Block);
+
+    if(Block->Prev != &Cache->Sentinel)
+    {
+        asset_MergeWithNext(Cache, Block->Prev);
+    }
+}
+
+internal void asset_UnlinkLRU(ASSET_CACHE *Cache, ASSET_SLOT *Slot)
+{
+    if(Slot->LRUPrev >= 0)
+    {
+        Cache->Slots[Slot->LRUPrev].LRUNext = Slot->LRUNext;
+    }
+    else
+    {
+        Cache->LRUHead = Slot->LRUNext;
+    }
+
+    if(Slot->LRUNext >= 0)
+    {
+        Cache->Slots[Slot->LRUNext].LRUPrev = Slot->LRUPrev;
+    }
+    else
+    {
+        Cache->LRUTail = Slot->LRUPrev;
+    }
+
+    Slot->InLRU = false;
+    Slot->LRUPrev = -1;
+    Slot->LRUNext = -1;
+}
+
+internal void asset_PushLRUHead(ASSET_CACHE *Cache, int SlotIndex)
+{
+    ASSET_SLOT *Slot = &Cache->Slots[SlotIndex];
+    Slot->InLRU = true;
+    Slot->LRUPrev = -1;
+    Slot->LRUNext = Cache->LRUHead;
+
+    if(Cache->LRUHead >= 0)
+    {
+        Cache->Slots[Cache->LRUHead].LRUPrev = SlotIndex;
+    }
+    else
+    {
+        Cache->LRUTail = SlotIndex;
+    }
+
+    Cache->LRUHead = SlotIndex;
+}
+
+//False when the least recently used asset was used this frame, evicting it would only thrash
+internal bool32 asset_EvictLeastRecent(ASSET_CACHE *Cache)
+{
+    if(Cache->LRUTail < 0)
+    {
+        return false;
+    }
+
+    ASSET_SLOT *Slot = &Cache->Slots[Cache->LRUTail];
+
+    if(Slot->LastUseFrame == Cache->FrameIndex)
+    {
+        return false;
+    }
+
+    asset_UnlinkLRU(Cache, Slot);
+    asset_FreeBlock(Cache, Slot->Block);
+
+    Cache->Stats.BytesResident -= Slot->Size;
+    ++Cache->Stats.Evictions;
+
+    Slot->Block = 0;
+    Slot->State = ASSET_SLOT_UNLOADED;
+
+    return true;
+}
+
+//Runs on a background worker, the copy is what pages the payload in from the file
+internal PLATFORM_WORK_QUEUE_CALLBACK(asset_LoadWork)
+{
+    (void) Queue;
+    ASSET_SLOT *Slot = (ASSET_SLOT *) Data;
+    TIMED_FUNCTION();
+
+    uint64 *Source = (uint64 *) Slot->Source;
+    uint64 *Dest = (uint64 *) ((uint8 *) Slot->Block + ASSET_CACHE_BLOCK_HEADER);
+
+    uint64 WordCount = Slot->Size / sizeof(uint64);
+    for(uint64 WordIndex = 0; WordIndex < WordCount; ++WordIndex)
+    {
+        Dest[WordIndex] = Source[WordIndex];
+    }
+
+    //Packer pads every payload so this is normally empty, OpenPack doesn't insist on it
+    for(uint64 ByteIndex = WordCount * sizeof(uint64); ByteIndex < Slot->Size; ++ByteIndex)
+    {
+        ((uint8 *) Dest)[ByteIndex] = ((uint8 *) Source)[ByteIndex];
+    }
+
+    atomic_AddUInt64(&Slot->Cache->Stats.BytesInFlight, (uint64) 0 - Slot->Size);
+
+    //Copy has to be visible before the owner can see the state change
+    CompletePreviousWritesBeforeFutureWrites;
+    Slot->State = ASSET_SLOT_LOADED;
+}
+
+//Call at the start of every frame, before any getter. A different pack waits out in flight loads and starts the cache over
+internal void asset_BeginFrame(ASSET_CACHE *Cache, HANDMADE_PLATFORM *Platform, ASSET_PACK *Pack)
+{
+    if((Cache->Pack.Base != Pack->Base) || (Cache->Pack.Entries != Pack->Entries) || (Cache->Pack.AssetCount != Pack->AssetCount))
+    {
+        if(Platform->BackgroundQueue)
+        {
+            Platform->CompleteAllWork(Platform->BackgroundQueue);
+        }
+
+        asset_ResetCache(Cache, Pack);
+    }
+
+    ++Cache->FrameIndex;
+}
+
+internal void asset_EndFrame(ASSET_CACHE *Cache, HANDMADE_PLATFORM *Platform)
+{
+    if(Platform->AssetStats)
+    {
+        *Platform->AssetStats = Cache->Stats;
+    }
+}
+
+//0 until the asset is resident, the first miss queues its load
+internal ASSET_SLOT *asset_GetSlot(ASSET_CACHE *Cache, HANDMADE_PLATFORM *Platform, int AssetIndex, ASSET_TYPE Type)
+{
+    if((AssetIndex < 0) || (AssetIndex >= Cache->SlotCount) || (Cache->Pack.Entries[AssetIndex].Type != (uint32) Type))
+    {
+        return 0;
+    }
+
+    ASSET_SLOT *Slot = &Cache->Slots[AssetIndex];
+
+    if(Slot->State == ASSET_SLOT_UNLOADED)
+    {
+        ASSET_PACK_ENTRY *Entry = &Cache->Pack.Entries[AssetIndex];
+
+        ASSET_BLOCK *Block = asset_AllocateBlock(Cache, Entry->DataSize);
+        while(!Block && asset_EvictLeastRecent(Cache))
+        {
+            Block = asset_AllocateBlock(Cache, Entry->DataSize);
+        }
+
+        ++Cache->Stats.Misses;
+
+        if(!Block)
+        {
+            ++Cache->Stats.BudgetFailures;
+            return 0;
+        }
+
+        uint8 *Dest = (uint8 *) Block + ASSET_CACHE_BLOCK_HEADER;
+
+        Slot->Type = Type;
+        Slot->Block = Block;
+        Slot->Source = Cache->Pack.Base + Entry->DataOffset;
+        Slot->Size = Entry->DataSize;
+        Slot->LastUseFrame = Cache->FrameIndex;
+
+        if(Type == ASSET_TYPE_BITMAP)
+        {
+            asset_GetBitmap(&Cache->Pack, AssetIndex, &Slot->Bitmap);
+            Slot->Bitmap.Memory = Dest;
+        }
+        else
+        {
+            asset_GetSound(&Cache->Pack, AssetIndex, &Slot->Sound);
+            Slot->Sound.Samples[0] = (int16 *) Dest;
+            Slot->Sound.Samples[1] = (int16 *) (Dest + ((Slot->Sound.ChannelCount > 1) ? Entry->Sound.ChannelStride : 0));
+        }
+
+        Cache->Stats.BytesResident += Slot->Size;
+        atomic_AddUInt64(&Cache->Stats.BytesInFlight, Slot->Size);
+        ++Cache->Stats.Loads;
+
+        Slot->State = ASSET_SLOT_QUEUED;
+
+        if(Platform->BackgroundQueue)
+        {
+            Platform->AddWorkEntry(Platform->BackgroundQueue, asset_LoadWork, Slot);
+            return 0;
+        }
+
+        //No background threads, load now and hand it straight back
+        asset_LoadWork(0, Slot);
+        asset_PushLRUHead(Cache, AssetIndex);
+        return Slot;
+    }
+
+    Slot->LastUseFrame = Cache->FrameIndex;
+
+    if(Slot->State != ASSET_SLOT_LOADED)
+    {
+        ++Cache->Stats.Misses;
+        return 0;
+    }
+
+    CompletePreviousReadsBeforeFutureReads;
+
+    //Joins the LRU list the first time it is seen loaded, until then it can't be evicted
+    if(!Slot->InLRU)
+    {
+        asset_PushLRUHead(Cache, AssetIndex);
+    }
+    else if(Cache->LRUHead != AssetIndex)
+    {
+        asset_UnlinkLRU(Cache, Slot);
+        asset_PushLRUHead(Cache, AssetIndex);
+    }
+
+    ++Cache->Stats.Hits;
+    return Slot;
+}
+
+internal RENDER_BITMAP *asset_GetBitmapStreamed(ASSET_CACHE *Cache, HANDMADE_PLATFORM *Platform, int AssetIndex)
+{
+    ASSET_SLOT *Slot = asset_GetSlot(Cache, Platform, AssetIndex, ASSET_TYPE_BITMAP);
+    return Slot ? &Slot->Bitmap : 0;
+}
+
+internal SOUND_SAMPLES *asset_GetSoundStreamed(ASSET_CACHE *Cache, HANDMADE_PLATFORM *Platform, int AssetIndex)
+{
+    ASSET_SLOT *Slot = asset_GetSlot(Cache, Platform, AssetIndex, ASSET_TYPE_SOUND);
+    return Slot ? &Slot->Sound : 0;
+}
@@ -0,0 +1,335 @@
+#if !defined(HANDMADE_ASSET_H)
+
+//Pack file baked by handmade_packer: header, one entry per asset, then payloads on 64 byte boundaries
+//The platform maps the file read only and the game uses payloads where they lie, nothing is parsed or copied
+//Opening reads the header and entry table only, a payload's pages come in the first time something touches it
+//
+//Payloads are already in the formats the kernels consume:
+//bitmaps are premultiplied 0xAARRGGBB, top row first, like RENDER_BITMAP
+//sounds are planar int16, one channel after the other, like SOUND_SAMPLES
+//streams are long sounds left interleaved in the WAV's own int16 or float32 samples, like SOUND_STREAM
+
+#define ASSET_PACK_MAGIC_VALUE (((uint32) 'h' << 0) | ((uint32) 'h' << 8) | ((uint32) 'a' << 16) | ((uint32) 'p' << 24))
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGNMENT 64 //Cache line, and enough for any aligned SIMD load
+#define ASSET_MAX_NAME 32
+
+enum ASSET_TYPE
+{
+    ASSET_TYPE_NONE,
+    ASSET_TYPE_BITMAP,
+    ASSET_TYPE_SOUND,
+    ASSET_TYPE_STREAM,
+};
+
+struct ASSET_PACK_HEADER
+{
+    uint32 MagicValue;
+    uint32 Version;
+    uint32 AssetCount;
+    uint32 Reserved;
+    uint64 EntriesOffset; //From the start of the file, like every offset in the pack
+    uint64 FileSize;
+};
+
+struct ASSET_PACK_BITMAP
+{
+    uint32 Width;
+    uint32 Height;
+    uint32 Pitch;
+};
+
+struct ASSET_PACK_SOUND
+{
+    uint32 ChannelCount;
+    uint32 SampleCount;
+    uint32 SampleRate;
+    uint32 ChannelStride; //Bytes from one channel's samples to the next, keeps every channel aligned
+};
+
+struct ASSET_PACK_STREAM
+{
+    uint32 ChannelCount;
+    uint32 SampleCount; //Frames
+    uint32 SampleRate;
+    uint32 Format; //SOUND_SAMPLE_FORMAT
+};
+
+//Tag table entry, looked up by name
+struct ASSET_PACK_ENTRY
+{
+    char Name[ASSET_MAX_NAME]; //Zero padded, always terminated
+    uint32 NameHash;
+    uint32 Type;
+    uint64 DataOffset;
+    uint64 DataSize;
+
+    union
+    {
+        ASSET_PACK_BITMAP Bitmap;
+        ASSET_PACK_SOUND Sound;
+        ASSET_PACK_STREAM Stream;
+    };
+};
+
+//View of a mapped pack, pointers go into the mapping so it is never stored in game memory
+struct ASSET_PACK
+{
+    uint8 *Base;
+    uint64 Size;
+    uint32 AssetCount;
+    ASSET_PACK_ENTRY *Entries;
+};
+
+//FNV-1a, the packer stores it so lookups compare names only on a hash match
+internal uint32 asset_HashName(const char *Name)
+{
+    uint32 Hash = 2166136261u;
+
+    for(const char *Character = Name; *Character; ++Character)
+    {
+        Hash ^= (uint8) *Character;
+        Hash *= 16777619u;
+    }
+
+    return Hash;
+}
+
+internal bool32 asset_NamesMatch(const char *PackName, const char *Name)
+{
+    for(int Index = 0; Index < ASSET_MAX_NAME; ++Index)
+    {
+        if(PackName[Index] != Name[Index])
+        {
+            return false;
+        }
+
+        if(!Name[Index])
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//Checks the header and that every entry's payload lies inside the file, so the getters below can trust them
+internal bool32 asset_OpenPack(ASSET_PACK *Pack, void *Memory, uint64 Size)
+{
+    *Pack = {};
+
+    if(!Memory || (Size < sizeof(ASSET_PACK_HEADER)))
+    {
+        return false;
+    }
+
+    ASSET_PACK_HEADER *Header = (ASSET_PACK_HEADER *) Memory;
+
+    if((Header->MagicValue != ASSET_PACK_MAGIC_VALUE) || (Header->Version != ASSET_PACK_VERSION) || (Header->FileSize != Size))
+    {
+        return false;
+    }
+
+    if((Header->EntriesOffset > Size) || (((Size - Header->EntriesOffset) / sizeof(ASSET_PACK_ENTRY)) < Header->AssetCount) ||
+       (Header->EntriesOffset % sizeof(uint64)))
+    {
+        return false;
+    }
+
+    ASSET_PACK_ENTRY *Entries = (ASSET_PACK_ENTRY *) ((uint8 *) Memory + Header->EntriesOffset);
+
+    for(uint32 AssetIndex = 0; AssetIndex < Header->AssetCount; ++AssetIndex)
+    {
+        ASSET_PACK_ENTRY *Entry = &Entries[AssetIndex];
+
+        if((Entry->DataOffset % ASSET_PACK_ALIGNMENT) || (Entry->DataOffset > Size) || (Entry->DataSize > (Size - Entry->DataOffset)) ||
+           Entry->Name[ASSET_MAX_NAME - 1])
+        {
+            return false;
+        }
+
+        uint64 NeededSize = 0;
+
+        if(Entry->Type == ASSET_TYPE_BITMAP)
+        {
+            ASSET_PACK_BITMAP *Bitmap = &Entry->Bitmap;
+            if(Bitmap->Pitch < (uint64) Bitmap->Width * 4)
+            {
+                return false;
+            }
+            NeededSize = (uint64) Bitmap->Pitch * Bitmap->Height;
+        }
+        else if(Entry->Type == ASSET_TYPE_SOUND)
+        {
+            ASSET_PACK_SOUND *Sound = &Entry->Sound;
+            if((Sound->ChannelCount < 1) || (Sound->ChannelCount > 2) || (Sound->ChannelStride < (uint64) Sound->SampleCount * sizeof(int16)) ||
+               (Sound->ChannelStride % ASSET_PACK_ALIGNMENT))
+            {
+                return false;
+            }
+            NeededSize = (uint64) Sound->ChannelStride * Sound->ChannelCount;
+        }
+        else if(Entry->Type == ASSET_TYPE_STREAM)
+        {
+            ASSET_PACK_STREAM *Stream = &Entry->Stream;
+            if((Stream->ChannelCount < 1) || (Stream->ChannelCount > 2) || (Stream->SampleCount > 0x7FFFFFFF) ||
+               ((Stream->Format != SOUND_SAMPLE_FORMAT_INT16) && (Stream->Format != SOUND_SAMPLE_FORMAT_FLOAT32)))
+            {
+                return false;
+            }
+            NeededSize = (uint64) Stream->SampleCount * Stream->ChannelCount * ((Stream->Format == SOUND_SAMPLE_FORMAT_INT16) ? sizeof(int16) : sizeof(float32));
+        }
+
+        if(NeededSize > Entry->DataSize)
+        {
+            return false;
+        }
+    }
+
+    Pack->Base = (uint8 *) Memory;
+    Pack->Size = Size;
+    Pack->AssetCount = Header->AssetCount;
+    Pack->Entries = Entries;
+
+    return true;
+}
+
+//Returns -1 if the pack has no asset of that name and type
+internal int asset_FindAsset(ASSET_PACK *Pack, const char *Name, ASSET_TYPE Type)
+{
+    uint32 Hash = asset_HashName(Name);
+
+    for(uint32 AssetIndex = 0; AssetIndex < Pack->AssetCount; ++AssetIndex)
+    {
+        ASSET_PACK_ENTRY *Entry = &Pack->Entries[AssetIndex];
+
+        if((Entry->NameHash == Hash) && (Entry->Type == (uint32) Type) && asset_NamesMatch(Entry->Name, Name))
+        {
+            return (int) AssetIndex;
+        }
+    }
+
+    return -1;
+}
+
+//Points Bitmap straight at the mapped payload, read only
+internal bool32 asset_GetBitmap(ASSET_PACK *Pack, int AssetIndex, RENDER_BITMAP *Bitmap)
+{
+    if((AssetIndex < 0) || ((uint32) AssetIndex >= Pack->AssetCount) || (Pack->Entries[AssetIndex].Type != ASSET_TYPE_BITMAP))
+    {
+        return false;
+    }
+
+    ASSET_PACK_ENTRY *Entry = &Pack->Entries[AssetIndex];
+    Bitmap->Width = (int) Entry->Bitmap.Width;
+    Bitmap->Height = (int) Entry->Bitmap.Height;
+    Bitmap->Pitch = (int) Entry->Bitmap.Pitch;
+    Bitmap->Memory = Pack->Base + Entry->DataOffset;
+
+    return true;
+}
+
+//Same for sounds, at whatever rate they were baked
+internal bool32 asset_GetSound(ASSET_PACK *Pack, int AssetIndex, SOUND_SAMPLES *Sound)
+{
+    if((AssetIndex < 0) || ((uint32) AssetIndex >= Pack->AssetCount) || (Pack->Entries[AssetIndex].Type != ASSET_TYPE_SOUND))
+    {
+        return false;
+    }
+
+    ASSET_PACK_ENTRY *Entry = &Pack->Entries[AssetIndex];
+    Sound->ChannelCount = (int) Entry->Sound.ChannelCount;
+    Sound->SampleRate = (int) Entry->Sound.SampleRate;
+    Sound->SampleCount = (int) Entry->Sound.SampleCount;
+    Sound->Samples[0] = (int16 *) (Pack->Base + Entry->DataOffset);
+    Sound->Samples[1] = (int16 *) (Pack->Base + Entry->DataOffset + ((Sound->ChannelCount > 1) ? Entry->Sound.ChannelStride : 0));
+
+    return true;
+}
+
+//Points Stream at the mapped frames and leaves its read ahead state alone, so it can be refreshed every frame
+//A missing stream comes back empty, which a voice playing it treats as finished
+internal bool32 asset_GetStream(ASSET_PACK *Pack, int AssetIndex, SOUND_STREAM *Stream)
+{
+    if((AssetIndex < 0) || ((uint32) AssetIndex >= Pack->AssetCount) || (Pack->Entries[AssetIndex].Type != ASSET_TYPE_STREAM))
+    {
+        Stream->SampleCount = 0;
+        Stream->Frames = 0;
+        return false;
+    }
+
+    ASSET_PACK_ENTRY *Entry = &Pack->Entries[AssetIndex];
+    Stream->Format = (SOUND_SAMPLE_FORMAT) Entry->Stream.Format;
+    Stream->ChannelCount = (int) Entry->Stream.ChannelCount;
+    Stream->SampleRate = (int) Entry->Stream.SampleRate;
+    Stream->SampleCount = (int) Entry->Stream.SampleCount;
+    Stream->Frames = Pack->Base + Entry->DataOffset;
+
+    return true;
+}
+
+//Streaming cache (handmade_asset.cpp): asset IDs are pack indices, payloads are copied from the pack into a fixed
+//budget on the platform's background queue so page faults and copies never land on the frame thread
+//Only the thread that owns the cache calls into it, workers touch nothing but their own slot and BytesInFlight
+
+#define ASSET_CACHE_MAX_SLOTS 4096 //Pack entries past this are never cached
+#define ASSET_CACHE_BLOCK_HEADER 64 //Keeps every payload on a cache line like it was in the pack
+
+enum ASSET_SLOT_STATE
+{
+    ASSET_SLOT_UNLOADED,
+    ASSET_SLOT_QUEUED, //Owned by a worker until it flips the state to loaded
+    ASSET_SLOT_LOADED,
+};
+
+//Budget is carved into blocks in address order, free neighbours merge on release
+struct ASSET_BLOCK
+{
+    ASSET_BLOCK *Prev;
+    ASSET_BLOCK *Next;
+    size_t Size; //Payload bytes after the header
+    bool32 Used;
+};
+
+struct ASSET_CACHE;
+
+struct ASSET_SLOT
+{
+    uint32 volatile State;
+    ASSET_TYPE Type;
+
+    //Loaded slots join the LRU list, most recently used at the head, once the owner has seen them loaded
+    bool32 InLRU;
+    int LRUPrev;
+    int LRUNext;
+    uint64 LastUseFrame;
+
+    ASSET_BLOCK *Block;
+    ASSET_CACHE *Cache;
+    void *Source; //In the pack mapping
+    uint64 Size;
+
+    //What the getters hand out, already pointing at the copy in the budget
+    RENDER_BITMAP Bitmap;
+    SOUND_SAMPLES Sound;
+};
+
+struct ASSET_CACHE
+{
+    ASSET_PACK Pack;
+    uint64 FrameIndex;
+
+    uint8 *Budget;
+    size_t BudgetSize;
+    ASSET_BLOCK Sentinel; //Both ends of the block list
+
+    int SlotCount;
+    int LRUHead;
+    int LRUTail;
+    ASSET_SLOT Slots[ASSET_CACHE_MAX_SLOTS];
+
+    HANDMADE_ASSET_STATS Stats; //BytesInFlight is shared with the workers
+};
+
+#define HANDMADE_ASSET_H
+#endif
@@ -0,0 +1,525 @@
+#include "handmade_asset.h"
+
+//Build time side of the pack format: decodes source files into the runtime formats and writes the pack
+//Shared by handmade_packer and the load time benchmark, uses the C runtime freely since neither runs in the game
+
+//Sounds at least this long are packed as streams, shorter ones are decoded for the resident path
+#define BUILDER_STREAM_MIN_SECONDS 10
+
+//One decoded asset waiting to be written, Memory is malloc'd and owned here
+struct BUILDER_ASSET
+{
+    char Name[ASSET_MAX_NAME];
+    ASSET_TYPE Type;
+    RENDER_BITMAP Bitmap;
+    SOUND_SAMPLES Sound;
+    SOUND_STREAM Stream; //Frames is Memory, a copy of the WAV's data chunk
+    void *Memory;
+};
+
+//Where a WAV's samples are and how they are stored, nothing decoded
+struct BUILDER_WAV
+{
+    SOUND_SAMPLE_FORMAT Format;
+    int ChannelCount;
+    int SampleRate;
+    int SampleCount; //Frames
+    uint8 *Data;
+};
+
+internal uint16 builder_ReadUInt16(uint8 *At)
+{
+    return (uint16) (At[0] | (At[1] << 8));
+}
+
+internal uint32 builder_ReadUInt32(uint8 *At)
+{
+    return (uint32) At[0] | ((uint32) At[1] << 8) | ((uint32) At[2] << 16) | ((uint32) At[3] << 24);
+}
+
+internal uint64 builder_AlignUp(uint64 Value, uint64 Alignment)
+{
+    return (Value + Alignment - 1) & ~(Alignment - 1);
+}
+
+//Returns 0 on failure, free the result
+internal void *builder_ReadEntireFile(const char *Path, uint64 *Size)
+{
+    void *Result = 0;
+    *Size = 0;
+
+    FILE *File = fopen(Path, "rb");
+    if(!File)
+    {
+        return 0;
+    }
+
+    fseek(File, 0, SEEK_END);
+    long Length = ftell(File);
+    fseek(File, 0, SEEK_SET);
+
+    if(Length > 0)
+    {
+        Result = malloc((size_t) Length);
+        if(Result && (fread(Result, 1, (size_t) Length, File) == (size_t) Length))
+        {
+            *Size = (uint64) Length;
+        }
+        else
+        {
+            free(Result);
+            Result = 0;
+        }
+    }
+
+    fclose(File);
+    return Result;
+}
+
+//Shift and width of a channel mask, masks are assumed to be 8 bits wide
+internal uint32 builder_GetMaskShift(uint32 Mask)
+{
+    uint32 Shift = 0;
+
+    while(Mask && !(Mask & 1))
+    {
+        Mask >>= 1;
+        ++Shift;
+    }
+
+    return Shift;
+}
+
+//Uncompressed 24 or 32 bit BMP, either row order, BI_RGB or BI_BITFIELDS
+//Result is top row first and premultiplied. BI_RGB 32 bit files with every alpha at 0 are taken as opaque
+internal bool32 builder_DecodeBMP(void *Contents, uint64 Size, RENDER_BITMAP *Bitmap)
+{
+    uint8 *File = (uint8 *) Contents;
+
+    if((Size < 54) || (File[0] != 'B') || (File[1] != 'M'))
+    {
+        return false;
+    }
+
+    uint32 PixelOffset = builder_ReadUInt32(File + 10);
+    uint32 InfoSize = builder_ReadUInt32(File + 14);
+    int32 Width = (int32) builder_ReadUInt32(File + 18);
+    int32 Height = (int32) builder_ReadUInt32(File + 22);
+    uint16 BitsPerPixel = builder_ReadUInt16(File + 28);
+    uint32 Compression = builder_ReadUInt32(File + 30);
+
+    bool32 TopDown = (Height < 0);
+    if(TopDown)
+    {
+        Height = -Height;
+    }
+
+    if((Width <= 0) || (Height <= 0) || (Width > 32768) || (Height > 32768) || ((BitsPerPixel != 24) && (BitsPerPixel != 32)))
+    {
+        return false;
+    }
+
+    uint32 RedMask = 0x00FF0000;
+    uint32 GreenMask = 0x0000FF00;
+    uint32 BlueMask = 0x000000FF;
+    uint32 AlphaMask = (BitsPerPixel == 32) ? 0xFF000000 : 0;
+
+    if(Compression == 3)
+    {
+        if(Size < 66)
+        {
+            return false;
+        }
+
+        RedMask = builder_ReadUInt32(File + 54);
+        GreenMask = builder_ReadUInt32(File + 58);
+        BlueMask = builder_ReadUInt32(File + 62);
+        AlphaMask = ((InfoSize >= 56) && (Size >= 70)) ? builder_ReadUInt32(File + 66) : 0;
+    }
+    else if(Compression != 0)
+    {
+        return false;
+    }
+
+    uint64 SourcePitch = (((uint64) Width * BitsPerPixel + 31) / 32) * 4;
+    if((PixelOffset > Size) || ((Size - PixelOffset) < SourcePitch * (uint64) Height))
+    {
+        return false;
+    }
+
+    Bitmap->Width = Width;
+    Bitmap->Height = Height;
+    Bitmap->Pitch = Width * 4;
+    Bitmap->Memory = malloc((size_t) Bitmap->Pitch * Height);
+
+    if(!Bitmap->Memory)
+    {
+        return false;
+    }
+
+    uint32 RedShift = builder_GetMaskShift(RedMask);
+    uint32 GreenShift = builder_GetMaskShift(GreenMask);
+    uint32 BlueShift = builder_GetMaskShift(BlueMask);
+    uint32 AlphaShift = builder_GetMaskShift(AlphaMask);
+    uint32 AlphaSeen = 0;
+
+    for(int32 Y = 0; Y < Height; ++Y)
+    {
+        uint8 *Source = File + PixelOffset + (SourcePitch * (uint64) (TopDown ? Y : (Height - 1 - Y)));
+        uint32 *Dest = (uint32 *) ((uint8 *) Bitmap->Memory + (Y * Bitmap->Pitch));
+
+        for(int32 X = 0; X < Width; ++X)
+        {
+            uint32 Pixel = (BitsPerPixel == 32) ? builder_ReadUInt32(Source + (X * 4)) :
+                                                  (uint32) (Source[X * 3] | (Source[(X * 3) + 1] << 8) | (Source[(X * 3) + 2] << 16));
+
+            uint32 Alpha = AlphaMask ? ((Pixel & AlphaMask) >> AlphaShift) : 255;
+            AlphaSeen |= Alpha;
+
+            Dest[X] = (Alpha << 24) | (((Pixel & RedMask) >> RedShift) << 16) | (((Pixel & GreenMask) >> GreenShift) << 8) | ((Pixel & BlueMask) >> BlueShift);
+        }
+    }
+
+    if((Compression == 0) && AlphaMask && !AlphaSeen)
+    {
+        for(int32 PixelIndex = 0; PixelIndex < Width * Height; ++PixelIndex)
+        {
+            ((uint32 *) Bitmap->Memory)[PixelIndex] |= 0xFF000000;
+        }
+    }
+
+    render_PremultiplyBitmap(Bitmap);
+    return true;
+}
+
+//16 bit PCM or 32 bit float, mono or stereo
+internal bool32 builder_ParseWAV(void *Contents, uint64 Size, BUILDER_WAV *Wav)
+{
+    uint8 *File = (uint8 *) Contents;
+
+    if((Size < 12) || (memcmp(File, "RIFF", 4) != 0) || (memcmp(File + 8, "WAVE", 4) != 0))
+    {
+        return false;
+    }
+
+    uint32 ChannelCount = 0;
+    uint32 BitsPerSample = 0;
+    uint32 Format = 0;
+    uint32 SampleRate = 0;
+    uint8 *Data = 0;
+    uint32 DataSize = 0;
+
+    uint64 At = 12;
+    while(At + 8 <= Size)
+    {
+        uint8 *Chunk = File + At;
+        uint32 ChunkSize = builder_ReadUInt32(Chunk + 4);
+
+        if(ChunkSize > (Size - At - 8))
+        {
+            return false;
+        }
+
+        if((memcmp(Chunk, "fmt ", 4) == 0) && (ChunkSize >= 16))
+        {
+            Format = builder_ReadUInt16(Chunk + 8);
+            ChannelCount = builder_ReadUInt16(Chunk + 10);
+            SampleRate = builder_ReadUInt32(Chunk + 12);
+            BitsPerSample = builder_ReadUInt16(Chunk + 22);
+
+            //WAVE_FORMAT_EXTENSIBLE keeps the real format in the first two bytes of its SubFormat GUID
+            if((Format == 0xFFFE) && (ChunkSize >= 40))
+            {
+                Format = builder_ReadUInt16(Chunk + 8 + 24);
+            }
+        }
+        else if(memcmp(Chunk, "data", 4) == 0)
+        {
+            Data = Chunk + 8;
+            DataSize = ChunkSize;
+        }
+
+        //Chunks are padded to an even size
+        At += 8 + ChunkSize + (ChunkSize & 1);
+    }
+
+    //1 is WAVE_FORMAT_PCM, 3 WAVE_FORMAT_IEEE_FLOAT
+    bool32 IsInt16 = (Format == 1) && (BitsPerSample == 16);
+    bool32 IsFloat32 = (Format == 3) && (BitsPerSample == 32);
+
+    if(!Data || !(IsInt16 || IsFloat32) || (ChannelCount < 1) || (ChannelCount > 2) || (SampleRate == 0) || (SampleRate > 0x7FFFFFFF))
+    {
+        return false;
+    }
+
+    Wav->Format = IsInt16 ? SOUND_SAMPLE_FORMAT_INT16 : SOUND_SAMPLE_FORMAT_FLOAT32;
+    Wav->ChannelCount = (int) ChannelCount;
+    Wav->SampleRate = (int) SampleRate;
+    Wav->SampleCount = (int) (DataSize / (ChannelCount * (BitsPerSample / 8)));
+    Wav->Data = Data;
+
+    return true;
+}
+
+internal uint64 builder_GetStreamSize(SOUND_STREAM *Stream)
+{
+    return (uint64) Stream->SampleCount * Stream->ChannelCount * ((Stream->Format == SOUND_SAMPLE_FORMAT_INT16) ? sizeof(int16) : sizeof(float32));
+}
+
+//Deinterleaved into one buffer with each channel on an ASSET_PACK_ALIGNMENT boundary, float samples converted like sound_ReadStreamFrames does
+internal bool32 builder_DecodeWAV(BUILDER_WAV *Wav, SOUND_SAMPLES *Sound)
+{
+    uint32 ChannelCount = (uint32) Wav->ChannelCount;
+    uint32 SampleCount = (uint32) Wav->SampleCount;
+    uint64 ChannelStride = builder_AlignUp((uint64) SampleCount * sizeof(int16), ASSET_PACK_ALIGNMENT);
+
+    int16 *Samples = (int16 *) malloc((size_t) (ChannelStride * ChannelCount));
+    if(!Samples)
+    {
+        return false;
+    }
+
+    memset(Samples, 0, (size_t) (ChannelStride * ChannelCount));
+
+    Sound->ChannelCount = (int) ChannelCount;
+    Sound->SampleRate = Wav->SampleRate;
+    Sound->SampleCount = (int) SampleCount;
+    Sound->Samples[0] = Samples;
+    Sound->Samples[1] = (int16 *) ((uint8 *) Samples + ((ChannelCount > 1) ? ChannelStride : 0));
+
+    if(Wav->Format == SOUND_SAMPLE_FORMAT_INT16)
+    {
+        for(uint32 SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+        {
+            for(uint32 Channel = 0; Channel < ChannelCount; ++Channel)
+            {
+                Sound->Samples[Channel][SampleIndex] = (int16) builder_ReadUInt16(Wav->Data + (((SampleIndex * ChannelCount) + Channel) * sizeof(int16)));
+            }
+        }
+    }
+    else
+    {
+        for(uint32 SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+        {
+            for(uint32 Channel = 0; Channel < ChannelCount; ++Channel)
+            {
+                uint32 Bits = builder_ReadUInt32(Wav->Data + (((SampleIndex * ChannelCount) + Channel) * sizeof(float32)));
+                float32 Value;
+                memcpy(&Value, &Bits, sizeof(Value));
+
+                Value *= 32767.0f;
+                if(Value > 32767.0f)
+                {
+                    Value = 32767.0f;
+                }
+                else if(!(Value >= -32768.0f)) //NaN goes to the floor too
+                {
+                    Value = -32768.0f;
+                }
+
+                Sound->Samples[Channel][SampleIndex] = (int16) lrintf(Value);
+            }
+        }
+    }
+
+    return true;
+}
+
+//Copies the data chunk as it is, the game reads it interleaved from the mapped pack
+internal bool32 builder_CopyWAVStream(BUILDER_WAV *Wav, SOUND_STREAM *Stream)
+{
+    Stream->Format = Wav->Format;
+    Stream->ChannelCount = Wav->ChannelCount;
+    Stream->SampleRate = Wav->SampleRate;
+    Stream->SampleCount = Wav->SampleCount;
+
+    uint64 Size = builder_GetStreamSize(Stream);
+    Stream->Frames = malloc((size_t) (Size ? Size : 1));
+
+    if(!Stream->Frames)
+    {
+        return false;
+    }
+
+    memcpy(Stream->Frames, Wav->Data, (size_t) Size);
+    return true;
+}
+
+//Type comes from the extension, .bmp or .wav
+internal bool32 builder_LoadAsset(BUILDER_ASSET *Asset, const char *Name, const char *Path)
+{
+    *Asset = {};
+
+    if(strlen(Name) >= ASSET_MAX_NAME)
+    {
+        return false;
+    }
+
+    strcpy(Asset->Name, Name);
+
+    const char *Extension = strrchr(Path, '.');
+    if(!Extension)
+    {
+        return false;
+    }
+
+    uint64 Size;
+    void *Contents = builder_ReadEntireFile(Path, &Size);
+    if(!Contents)
+    {
+        return false;
+    }
+
+    bool32 Result = false;
+
+    if((strcmp(Extension, ".bmp") == 0) || (strcmp(Extension, ".BMP") == 0))
+    {
+        Asset->Type = ASSET_TYPE_BITMAP;
+        Result = builder_DecodeBMP(Contents, Size, &Asset->Bitmap);
+        Asset->Memory = Asset->Bitmap.Memory;
+    }
+    else if((strcmp(Extension, ".wav") == 0) || (strcmp(Extension, ".WAV") == 0))
+    {
+        BUILDER_WAV Wav;
+
+        if(builder_ParseWAV(Contents, Size, &Wav))
+        {
+            if(Wav.SampleCount >= (BUILDER_STREAM_MIN_SECONDS * Wav.SampleRate))
+            {
+                Asset->Type = ASSET_TYPE_STREAM;
+                Result = builder_CopyWAVStream(&Wav, &Asset->Stream);
+                Asset->Memory = Result ? Asset->Stream.Frames : 0;
+            }
+            else
+            {
+                Asset->Type = ASSET_TYPE_SOUND;
+                Result = builder_DecodeWAV(&Wav, &Asset->Sound);
+                Asset->Memory = Result ? Asset->Sound.Samples[0] : 0;
+            }
+        }
+    }
+
+    free(Contents);
+    return Result;
+}
+
+internal void builder_FreeAsset(BUILDER_ASSET *Asset)
+{
+    free(Asset->Memory);
+    Asset->Memory = 0;
+}
+
+internal bool32 builder_WritePadding(FILE *File, uint64 *At, uint64 Alignment)
+{
+    local uint8 Zeros[ASSET_PACK_ALIGNMENT];
+    uint64 Padding = builder_AlignUp(*At, Alignment) - *At;
+    *At += Padding;
+
+    return fwrite(Zeros, 1, (size_t) Padding, File) == (size_t) Padding;
+}
+
+//Header, entry table, then every payload in order on an ASSET_PACK_ALIGNMENT boundary
+internal bool32 builder_WritePack(const char *Path, BUILDER_ASSET *Assets, int AssetCount)
+{
+    ASSET_PACK_ENTRY *Entries = (ASSET_PACK_ENTRY *) calloc((size_t) (AssetCount ? AssetCount : 1), sizeof(ASSET_PACK_ENTRY));
+    if(!Entries)
+    {
+        return false;
+    }
+
+    ASSET_PACK_HEADER Header = {};
+    Header.MagicValue = ASSET_PACK_MAGIC_VALUE;
+    Header.Version = ASSET_PACK_VERSION;
+    Header.AssetCount = (uint32) AssetCount;
+    Header.EntriesOffset = sizeof(ASSET_PACK_HEADER);
+
+    uint64 At = builder_AlignUp(Header.EntriesOffset + ((uint64) AssetCount * sizeof(ASSET_PACK_ENTRY)), ASSET_PACK_ALIGNMENT);
+
+    for(int AssetIndex = 0; AssetIndex < AssetCount; ++AssetIndex)
+    {
+        BUILDER_ASSET *Asset = &Assets[AssetIndex];
+        ASSET_PACK_ENTRY *Entry = &Entries[AssetIndex];
+
+        strcpy(Entry->Name, Asset->Name);
+        Entry->NameHash = asset_HashName(Asset->Name);
+        Entry->Type = Asset->Type;
+        Entry->DataOffset = At;
+
+        if(Asset->Type == ASSET_TYPE_BITMAP)
+        {
+            Entry->Bitmap.Width = (uint32) Asset->Bitmap.Width;
+            Entry->Bitmap.Height = (uint32) Asset->Bitmap.Height;
+            Entry->Bitmap.Pitch = (uint32) Asset->Bitmap.Width * 4;
+            Entry->DataSize = (uint64) Entry->Bitmap.Pitch * Entry->Bitmap.Height;
+        }
+        else if(Asset->Type == ASSET_TYPE_STREAM)
+        {
+            Entry->Stream.ChannelCount = (uint32) Asset->Stream.ChannelCount;
+            Entry->Stream.SampleCount = (uint32) Asset->Stream.SampleCount;
+            Entry->Stream.SampleRate = (uint32) Asset->Stream.SampleRate;
+            Entry->Stream.Format = (uint32) Asset->Stream.Format;
+            Entry->DataSize = builder_GetStreamSize(&Asset->Stream);
+        }
+        else
+        {
+            Entry->Sound.ChannelCount = (uint32) Asset->Sound.ChannelCount;
+            Entry->Sound.SampleCount = (uint32) Asset->Sound.SampleCount;
+            Entry->Sound.SampleRate = (uint32) Asset->Sound.SampleRate;
+            Entry->Sound.ChannelStride = (uint32) builder_AlignUp((uint64) Asset->Sound.SampleCount * sizeof(int16), ASSET_PACK_ALIGNMENT);
+            Entry->DataSize = (uint64) Entry->Sound.ChannelStride * Entry->Sound.ChannelCount;
+        }
+
+        At = builder_AlignUp(At + Entry->DataSize, ASSET_PACK_ALIGNMENT);
+    }
+
+    Header.FileSize = At;
+
+    FILE *File = fopen(Path, "wb");
+    bool32 Result = (File != 0);
+
+    if(File)
+    {
+        At = 0;
+        Result = (fwrite(&Header, sizeof(Header), 1, File) == 1);
+        At += sizeof(Header);
+
+        if(AssetCount)
+        {
+            Result = Result && (fwrite(Entries, sizeof(ASSET_PACK_ENTRY), (size_t) AssetCount, File) == (size_t) AssetCount);
+            At += (uint64) AssetCount * sizeof(ASSET_PACK_ENTRY);
+        }
+
+        for(int AssetIndex = 0; Result && (AssetIndex < AssetCount); ++AssetIndex)
+        {
+            BUILDER_ASSET *Asset = &Assets[AssetIndex];
+            ASSET_PACK_ENTRY *Entry = &Entries[AssetIndex];
+
+            Result = builder_WritePadding(File, &At, ASSET_PACK_ALIGNMENT);
+
+            if(Asset->Type == ASSET_TYPE_BITMAP)
+            {
+                //Decoded bitmaps are already tightly packed, the pack pitch matches
+                Result = Result && (fwrite(Asset->Bitmap.Memory, 1, (size_t) Entry->DataSize, File) == (size_t) Entry->DataSize);
+            }
+            else if(Asset->Type == ASSET_TYPE_STREAM)
+            {
+                Result = Result && (fwrite(Asset->Stream.Frames, 1, (size_t) Entry->DataSize, File) == (size_t) Entry->DataSize);
+            }
+            else
+            {
+                for(int Channel = 0; Result && (Channel < Asset->Sound.ChannelCount); ++Channel)
+                {
+                    Result = (fwrite(Asset->Sound.Samples[Channel], 1, Entry->Sound.ChannelStride, File) == Entry->Sound.ChannelStride);
+                }
+            }
+
+            At += Entry->DataSize;
+        }
+
+        Result = Result && builder_WritePadding(File, &At, ASSET_PACK_ALIGNMENT);
+        Result = (fclose(File) == 0) && Result;
+    }
+
+    free(Entries);
+    return Result;
+}
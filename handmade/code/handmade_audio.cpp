@@ -0,0 +1,256 @@
+#include "handmade_audio.h"
+
+//A stereo int16 frame moves as one uint32
+internal void audio_CopyFrames(int16 *Dest, int16 *Source, int64 FrameCount)
+{
+    uint32 *DestFrame = (uint32 *) Dest;
+    uint32 *SourceFrame = (uint32 *) Source;
+
+    for(int64 FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+    {
+        *DestFrame++ = *SourceFrame++;
+    }
+}
+
+internal void audio_ClearFrames(int16 *Dest, int64 FrameCount)
+{
+    uint32 *DestFrame = (uint32 *) Dest;
+
+    for(int64 FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+    {
+        *DestFrame++ = 0;
+    }
+}
+
+//Smallest power of two holding MinFrames, for sizing the ring before allocating it
+internal int64 audio_GetRingCapacity(int64 MinFrames)
+{
+    int64 Capacity = 1;
+    while(Capacity < MinFrames)
+    {
+        Capacity <<= 1;
+    }
+
+    return Capacity;
+}
+
+internal size_t audio_GetRingMemorySize(int64 FrameCapacity)
+{
+    return (size_t) FrameCapacity * AUDIO_CHANNEL_COUNT * sizeof(int16);
+}
+
+//Memory must be audio_GetRingMemorySize(FrameCapacity) bytes, call before either thread touches the ring
+internal void audio_InitRingBuffer(AUDIO_RING_BUFFER *Ring, void *Memory, int64 FrameCapacity)
+{
+    Ring->Samples = (int16 *) Memory;
+    Ring->FrameCapacity = FrameCapacity;
+    Ring->FrameMask = FrameCapacity - 1;
+    Ring->WriteIndex = 0;
+    Ring->ReadIndex = 0;
+    Ring->UnderrunCount = 0;
+    Ring->UnderrunFrames = 0;
+    Ring->MinQueuedFrames = FrameCapacity;
+}
+
+//Safe from either thread, the answer is only a lower (producer) or upper (consumer) bound while the other side runs
+internal int64 audio_GetQueuedFrames(AUDIO_RING_BUFFER *Ring)
+{
+    int64 ReadIndex = atomic_LoadInt64(&Ring->ReadIndex);
+    int64 WriteIndex = atomic_LoadInt64(&Ring->WriteIndex);
+
+    return WriteIndex - ReadIndex;
+}
+
+//Frames the producer should write this frame to keep TargetQueuedFrames ahead of the device
+internal int64 audio_GetFramesToWrite(AUDIO_RING_BUFFER *Ring, int64 TargetQueuedFrames)
+{
+    if(TargetQueuedFrames > Ring->FrameCapacity)
+    {
+        TargetQueuedFrames = Ring->FrameCapacity;
+    }
+
+    int64 FramesToWrite = TargetQueuedFrames - audio_GetQueuedFrames(Ring);
+    if(FramesToWrite < 0)
+    {
+        FramesToWrite = 0;
+    }
+
+    return FramesToWrite;
+}
+
+//Producer side, returns the frames actually copied which is less than FrameCount only if the ring is full
+internal int64 audio_WriteFrames(AUDIO_RING_BUFFER *Ring, int16 *Source, int64 FrameCount)
+{
+    int64 WriteIndex = Ring->WriteIndex;
+    int64 ReadIndex = atomic_LoadInt64(&Ring->ReadIndex);
+
+    int64 FreeFrames = Ring->FrameCapacity - (WriteIndex - ReadIndex);
+    if(FrameCount > FreeFrames)
+    {
+        FrameCount = FreeFrames;
+    }
+
+    //At most two copies, up to the end of the ring then from the start
+    int64 Start = WriteIndex & Ring->FrameMask;
+    int64 FirstCount = Ring->FrameCapacity - Start;
+    if(FirstCount > FrameCount)
+    {
+        FirstCount = FrameCount;
+    }
+
+    audio_CopyFrames(Ring->Samples + (Start * AUDIO_CHANNEL_COUNT), Source, FirstCount);
+    audio_CopyFrames(Ring->Samples, Source + (FirstCount * AUDIO_CHANNEL_COUNT), FrameCount - FirstCount);
+
+    //Release, the consumer must see the samples before it sees the new index
+    atomic_StoreInt64(&Ring->WriteIndex, WriteIndex + FrameCount);
+
+    return FrameCount;
+}
+
+//Consumer side, always fills FrameCount frames. Whatever the ring can't supply is silence and counts as an underrun
+internal int64 audio_ReadFrames(AUDIO_RING_BUFFER *Ring, int16 *Dest, int64 FrameCount)
+{
+    int64 ReadIndex = Ring->ReadIndex;
+    int64 WriteIndex = atomic_LoadInt64(&Ring->WriteIndex);
+
+    int64 QueuedFrames = WriteIndex - ReadIndex;
+    if(QueuedFrames < Ring->MinQueuedFrames)
+    {
+        Ring->MinQueuedFrames = QueuedFrames;
+    }
+
+    int64 ReadCount = FrameCount;
+    if(ReadCount > QueuedFrames)
+    {
+        ReadCount = QueuedFrames;
+    }
+
+    int64 Start = ReadIndex & Ring->FrameMask;
+    int64 FirstCount = Ring->FrameCapacity - Start;
+    if(FirstCount > ReadCount)
+    {
+        FirstCount = ReadCount;
+    }
+
+    audio_CopyFrames(Dest, Ring->Samples + (Start * AUDIO_CHANNEL_COUNT), FirstCount);
+    audio_CopyFrames(Dest + (FirstCount * AUDIO_CHANNEL_COUNT), Ring->Samples, ReadCount - FirstCount);
+
+    if(ReadCount < FrameCount)
+    {
+        audio_ClearFrames(Dest + (ReadCount * AUDIO_CHANNEL_COUNT), FrameCount - ReadCount);
+
+        Ring->UnderrunCount = Ring->UnderrunCount + 1;
+        Ring->UnderrunFrames = Ring->UnderrunFrames + (FrameCount - ReadCount);
+    }
+
+    //Release, the producer may only reuse the frames once the copy above is done
+    atomic_StoreInt64(&Ring->ReadIndex, ReadIndex + ReadCount);
+
+    return ReadCount;
+}
+
+//InitialFrames is where the margin starts, a conservative guess the controller shrinks from rather than grows into
+//It starts shrinking straight away, to a floor that starts at 1 ms, is raised by every underrun and sinks back after a long calm
+internal void audio_InitLatencyController(AUDIO_LATENCY_CONTROLLER *Controller, int SampleRate, int64 InitialFrames, int64 MinFrames, int64 MaxFrames)
+{
+    *Controller = {};
+    Controller->SampleRate = SampleRate;
+    Controller->MinFrames = MinFrames;
+    Controller->MaxFrames = MaxFrames;
+    Controller->BaseMarginFrames = (float64) SampleRate / 1000.0;
+    Controller->MinMarginFrames = Controller->BaseMarginFrames;
+    Controller->MarginFrames = (float64) InitialFrames;
+    Controller->LastQueuedFrames = -1;
+    Controller->CalmSeconds = AUDIO_LATENCY_SETTLE_SECONDS;
+    Controller->TargetFrames = (InitialFrames < MinFrames) ? MinFrames : ((InitialFrames > MaxFrames) ? MaxFrames : InitialFrames);
+}
+
+//Producer side, once a frame before audio_GetFramesToWrite. FrameSeconds is the time since the previous call
+//Assumes the frame then writes up to the target it is given, which audio_GetFramesToWrite does unless the ring is full
+internal int64 audio_UpdateLatency(AUDIO_LATENCY_CONTROLLER *Controller, AUDIO_RING_BUFFER *Ring, float64 FrameSeconds)
+{
+    float64 SampleRate = (float64) Controller->SampleRate;
+    int64 QueuedFrames = audio_GetQueuedFrames(Ring);
+    int64 UnderrunCount = atomic_LoadInt64(&Ring->UnderrunCount);
+
+    Controller->WindowSeconds += FrameSeconds;
+    if(Controller->WindowSeconds > AUDIO_LATENCY_PEAK_WINDOW_SECONDS)
+    {
+        Controller->WindowSeconds = 0.0;
+        Controller->PeakFrameSeconds[1] = Controller->PeakFrameSeconds[0];
+        Controller->PeakBurstFrames[1] = Controller->PeakBurstFrames[0];
+        Controller->PeakFrameSeconds[0] = 0.0;
+        Controller->PeakBurstFrames[0] = 0.0;
+    }
+
+    if(FrameSeconds > Controller->PeakFrameSeconds[0])
+    {
+        Controller->PeakFrameSeconds[0] = FrameSeconds;
+    }
+
+    //The queue only drains between writes, so what left it is everything the device took since the last one
+    if(Controller->LastQueuedFrames >= 0)
+    {
+        float64 BurstFrames = (float64) (Controller->LastQueuedFrames - QueuedFrames) - (FrameSeconds * SampleRate);
+        if(BurstFrames > Controller->PeakBurstFrames[0])
+        {
+            Controller->PeakBurstFrames[0] = BurstFrames;
+        }
+    }
+
+    if(UnderrunCount != Controller->SeenUnderrunCount)
+    {
+        Controller->SeenUnderrunCount = UnderrunCount;
+        //The margin that just failed, plus a step, is the least it may shrink back to from now on
+        float64 StepFrames = SampleRate / 1000.0;
+        Controller->MinMarginFrames = Controller->MarginFrames + StepFrames;
+        Controller->MarginFrames = (Controller->MarginFrames * 2.0) + StepFrames;
+        Controller->CalmSeconds = 0.0;
+        ++Controller->WidenCount;
+    }
+    else
+    {
+        Controller->CalmSeconds += FrameSeconds;
+
+        //One hitch must not hold latency up for the rest of the session, but the floor trails the margin so repeats still find it raised
+        if(Controller->CalmSeconds > AUDIO_LATENCY_FLOOR_SETTLE_SECONDS)
+        {
+            float64 FloorExcess = Controller->MinMarginFrames - Controller->BaseMarginFrames;
+            Controller->MinMarginFrames = Controller->BaseMarginFrames + (FloorExcess * pow(0.5, FrameSeconds / AUDIO_LATENCY_FLOOR_HALF_LIFE));
+        }
+
+        if(Controller->CalmSeconds > AUDIO_LATENCY_SETTLE_SECONDS)
+        {
+            float64 Excess = Controller->MarginFrames - Controller->MinMarginFrames;
+            Controller->MarginFrames = Controller->MinMarginFrames + (Excess * pow(0.5, FrameSeconds / AUDIO_LATENCY_MARGIN_HALF_LIFE));
+        }
+    }
+
+    if(Controller->MarginFrames > (float64) Controller->MaxFrames)
+    {
+        Controller->MarginFrames = (float64) Controller->MaxFrames;
+    }
+
+    float64 PeakFrameSeconds = (Controller->PeakFrameSeconds[0] > Controller->PeakFrameSeconds[1]) ? Controller->PeakFrameSeconds[0] : Controller->PeakFrameSeconds[1];
+    float64 PeakBurstFrames = (Controller->PeakBurstFrames[0] > Controller->PeakBurstFrames[1]) ? Controller->PeakBurstFrames[0] : Controller->PeakBurstFrames[1];
+
+    int64 TargetFrames = (int64) ceil((PeakFrameSeconds * SampleRate) + PeakBurstFrames + Controller->MarginFrames);
+    if(TargetFrames < Controller->MinFrames)
+    {
+        TargetFrames = Controller->MinFrames;
+    }
+    if(TargetFrames > Controller->MaxFrames)
+    {
+        TargetFrames = Controller->MaxFrames;
+    }
+
+    Controller->TargetFrames = TargetFrames;
+    Controller->LastQueuedFrames = (QueuedFrames > TargetFrames) ? QueuedFrames : TargetFrames;
+
+    return TargetFrames;
+}
+
+internal float64 audio_GetLatencyMS(AUDIO_LATENCY_CONTROLLER *Controller)
+{
+    return (1000.0 * (float64) Controller->TargetFrames) / (float64) Controller->SampleRate;
+}
@@ -0,0 +1,62 @@
+#if !defined(HANDMADE_AUDIO_H)
+
+//Single producer/single consumer ring of interleaved stereo int16 frames
+//The game thread writes ahead of the device, a platform audio thread drains it at the device's pace
+//Indices count every frame ever written/read, so full and empty never look the same and wrap is a mask
+
+#define AUDIO_CHANNEL_COUNT 2
+
+//Each index lives on its own cache line, only its owning thread stores to it
+struct AUDIO_RING_BUFFER
+{
+    int16 *Samples;
+    int64 FrameCapacity; //Must be a power of two
+    int64 FrameMask;
+    uint8 PadHeader[40];
+
+    int64 volatile WriteIndex; //Producer only
+    uint8 PadWrite[56];
+
+    int64 volatile ReadIndex; //Consumer only
+    int64 volatile UnderrunCount; //Reads the ring couldn't fully satisfy
+    int64 volatile UnderrunFrames; //Silence played in their place
+    int64 volatile MinQueuedFrames; //Lowest fill the consumer has seen before a read
+    uint8 PadRead[32];
+};
+
+//Adaptive write-ahead for the producer, updated once a frame just before it tops the ring up
+//Everything is measured from the game side: how long frames really took, and how much the device took between two writes
+//beyond what that time accounts for, which is its cursor or period granularity plus how late its thread woke
+//Target = longest recent frame + largest recent device burst + a margin that doubles on every underrun and decays back
+//once there has been none for a while, so latency sits just above what the machine has recently needed
+//Peaks are maxima over the current and previous window, so a spike is held for at least one window and then dropped whole
+//rather than decaying under a hitch that keeps coming back every second or so
+#define AUDIO_LATENCY_PEAK_WINDOW_SECONDS 4.0
+#define AUDIO_LATENCY_SETTLE_SECONDS 8.0 //Underrun free time before the margin starts shrinking
+#define AUDIO_LATENCY_MARGIN_HALF_LIFE 2.0
+#define AUDIO_LATENCY_FLOOR_SETTLE_SECONDS 30.0 //Underrun free time before the floor an underrun raised starts coming back down
+#define AUDIO_LATENCY_FLOOR_HALF_LIFE 8.0
+
+struct AUDIO_LATENCY_CONTROLLER
+{
+    int SampleRate;
+    int64 MinFrames;
+    int64 MaxFrames; //No more than the ring holds
+
+    float64 WindowSeconds; //Into the current peak window
+    float64 PeakFrameSeconds[2]; //Longest gap between writes, current then previous window
+    float64 PeakBurstFrames[2]; //Most frames read beyond the gap's share, current then previous window
+    float64 MarginFrames;
+    float64 BaseMarginFrames; //1 ms, what the floor returns to
+    float64 MinMarginFrames; //Floor the margin decays to, raised by underruns and decaying back to BaseMarginFrames after a long calm
+    float64 CalmSeconds; //Since the last underrun
+
+    int64 LastQueuedFrames; //Ring fill right after the previous write, -1 before the first
+    int64 SeenUnderrunCount;
+    int64 WidenCount; //Underrun batches answered by doubling the margin
+
+    int64 TargetFrames;
+};
+
+#define HANDMADE_AUDIO_H
+#endif
@@ -0,0 +1,2007 @@
+#include "handmade.h"
+#include "handmade_memory.h"
+#include "handmade_audio.cpp"
+#include "handmade_render.cpp"
+#include "handmade_pixel.cpp"
+#include "handmade_scale.cpp"
+#include "handmade_sound.cpp"
+#include "handmade_resample.cpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#endif
+
+#include "handmade_asset.cpp"
+#include "handmade_asset_builder.cpp"
+#include "handmade_jobs.h"
+#include "handmade_capture.cpp"
+
+//Kernel micro-benchmarks, independent of either platform layer and the game library
+//Each case runs untimed warm-up repetitions, then times every repetition on its own so the spread can be reported
+//Output is one tab separated row per kernel, instruction set and size, appended to -o so runs from different commits line up
+
+#define BENCH_MAX_REPETITIONS 1000
+
+enum BENCH_FAMILY
+{
+    BENCH_FAMILY_RENDER, //render_Gradient, one full frame per repetition
+    BENCH_FAMILY_SOUND, //sound_OutputSound, one block per repetition, voices playing resident sounds then one streamed voice
+    BENCH_FAMILY_COPY, //Ring to region1/region2 copy done by win32_FillSoundBuffer, one block per repetition
+    BENCH_FAMILY_DRAW, //render_DrawRectangle and render_DrawBitmap at 1080p, checked against scalar first
+    BENCH_FAMILY_ASSET, //Loading a set of bitmaps and sounds from loose files against mapping them from a pack
+    BENCH_FAMILY_SCALE, //scale_Upscale from lower render resolutions to 1080p, one full frame per repetition, checked against scalar first
+    BENCH_FAMILY_CAPTURE, //capture_ConvertFrame BGRX to YUV 4:2:0, one full frame per repetition, checked against scalar first
+    BENCH_FAMILY_FORMAT, //Gradient, fills, blits and the present conversion per backbuffer format at 1080p, checked against scalar first
+    BENCH_FAMILY_RESAMPLE, //resample_Process per quality and pair of rates, one block of output per repetition, checked against scalar and a sine first
+
+    BENCH_FAMILY_COUNT
+};
+
+global const char *BenchFamilyNames[BENCH_FAMILY_COUNT] = {"render", "sound", "copy", "draw", "asset", "scale", "capture", "format", "resample"};
+
+struct BENCH_SETTINGS
+{
+    int WarmUpCount;
+    int RepetitionCount;
+    int SampleRate;
+    bool32 RunFamily[BENCH_FAMILY_COUNT];
+    char *Tag; //Copied into every row, usually the commit
+    char *OutputPath;
+};
+
+//Per repetition times of the case being run
+struct BENCH_TIMINGS
+{
+    int Count;
+    uint64 NS[BENCH_MAX_REPETITIONS];
+    uint64 Cycles[BENCH_MAX_REPETITIONS];
+};
+
+struct BENCH_RENDER_SIZE
+{
+    const char *Name;
+    int Width;
+    int Height;
+};
+
+global BENCH_RENDER_SIZE BenchRenderSizes[] = {{"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4k", 3840, 2160}};
+global int BenchBlockSizes[] = {64, 256, 800, 4800};
+
+#define BENCH_STREAM_SECONDS 60 //Streamed voice source, long enough that a block never sees the whole of it in cache
+
+#define BENCH_SPRITE_SIZE 64
+#define BENCH_SPRITE_COUNT 2048 //Blits per repetition
+#define BENCH_RECT_COUNT 2048 //Fills per repetition
+
+//Render resolutions a platform would upscale from, to a 1080p window
+struct BENCH_SCALE_CASE
+{
+    const char *Name;
+    SCALE_FILTER Filter;
+    int SourceWidth;
+    int SourceHeight;
+};
+
+global BENCH_SCALE_CASE BenchScaleCases[] =
+{
+    {"nearest_540p_x2", SCALE_FILTER_NEAREST, 960, 540},
+    {"nearest_360p_x3", SCALE_FILTER_NEAREST, 640, 360},
+    {"bilinear_360p", SCALE_FILTER_BILINEAR, 640, 360},
+    {"bilinear_540p", SCALE_FILTER_BILINEAR, 960, 540},
+    {"bilinear_720p", SCALE_FILTER_BILINEAR, 1280, 720},
+};
+
+#define BENCH_SCALE_DEST_WIDTH 1920
+#define BENCH_SCALE_DEST_HEIGHT 1080
+
+//Odd sizes only take part in the check, they exercise the scalar tails and the repeated last row and column
+global BENCH_RENDER_SIZE BenchCaptureCheckSizes[] = {{"odd", 1001, 777}, {"tiny", 3, 1}};
+
+enum BENCH_FORMAT_KERNEL
+{
+    BENCH_FORMAT_KERNEL_GRADIENT,
+    BENCH_FORMAT_KERNEL_RECT,
+    BENCH_FORMAT_KERNEL_BLIT,
+    BENCH_FORMAT_KERNEL_PRESENT, //pixel_ConvertRect of the whole frame to BGRX8888
+
+    BENCH_FORMAT_KERNEL_COUNT
+};
+
+global const char *BenchFormatKernelNames[BENCH_FORMAT_KERNEL_COUNT] = {"gradient", "rect64", "blit64", "present"};
+
+//Device rates a 48 kHz game meets, and assets at other rates coming the other way
+struct BENCH_RESAMPLE_CASE
+{
+    const char *Name;
+    int InputRate;
+    int OutputRate;
+};
+
+global BENCH_RESAMPLE_CASE BenchResampleCases[] =
+{
+    {"48k_44k1", 48000, 44100},
+    {"44k1_48k", 44100, 48000},
+    {"48k_96k", 48000, 96000},
+    {"96k_48k", 96000, 48000},
+    {"48k_47999", 48000, 47999}, //More positions than RESAMPLE_MAX_PHASES, so phases are rounded
+};
+
+//Least signal to error a resampled 997 Hz sine must keep at each quality, in dB
+//Rounding the input and output to int16 alone costs about 89 dB at this level, so high and best both sit near that floor
+global float64 BenchResampleMinimumSNR[RESAMPLE_QUALITY_COUNT] = {55.0, 75.0, 80.0, 80.0};
+
+#define BENCH_RESAMPLE_BLOCK 4800 //Output frames per repetition
+#define BENCH_RESAMPLE_SOURCE_FRAMES 96000 //Noise the timed runs read from, wrapping round
+
+#define BENCH_ASSET_BITMAP_COUNT 64
+#define BENCH_ASSET_BITMAP_SIZE 256
+#define BENCH_ASSET_SOUND_COUNT 16
+#define BENCH_ASSET_SOUND_SAMPLES 96000 //Two seconds of stereo at 48 kHz
+#define BENCH_ASSET_PACK_PATH "bench_assets.hha"
+#define BENCH_ASSET_STREAM_BUDGET Megabytes(4) //About a fifth of the pack, so cycling through it has to evict
+#define BENCH_ASSET_STREAM_WINDOW 4 //Assets asked for each frame
+
+//Sink for sums over asset memory, stops the reads being optimised away
+global volatile uint64 BenchTouchSum;
+
+internal uint64 bench_GetWallClock(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER Counter;
+    LARGE_INTEGER Frequency;
+    QueryPerformanceCounter(&Counter);
+    QueryPerformanceFrequency(&Frequency);
+    return (uint64) ((Counter.QuadPart * 1000000000.0) / (float64) Frequency.QuadPart);
+#else
+    timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return ((uint64) Time.tv_sec * 1000000000ull) + (uint64) Time.tv_nsec;
+#endif
+}
+
+internal int bench_CompareUInt64(const void *A, const void *B)
+{
+    uint64 ValueA = *(const uint64 *) A;
+    uint64 ValueB = *(const uint64 *) B;
+    return (ValueA < ValueB) ? -1 : ((ValueA > ValueB) ? 1 : 0);
+}
+
+internal void bench_PrintHeader(FILE *File)
+{
+    fprintf(File, "tag\tkernel\tlevel\tsize\tunits\treps\tmedian_ns\tmin_ns\tmean_ns\tstddev_pct\tcycles_per_unit\tgb_per_s\n");
+}
+
+//Median drives the per unit figures, min and the spread show how much the machine got in the way
+//UnitCount is pixels or sample frames per repetition, Bytes is what one repetition reads plus writes
+internal void bench_Report(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings, BENCH_FAMILY Family, SIMD_LEVEL Level, const char *SizeName, uint64 UnitCount, uint64 Bytes)
+{
+    float64 MeanNS = 0.0;
+    for(int Index = 0; Index < Timings->Count; ++Index)
+    {
+        MeanNS += (float64) Timings->NS[Index];
+    }
+    MeanNS /= (float64) Timings->Count;
+
+    float64 Variance = 0.0;
+    for(int Index = 0; Index < Timings->Count; ++Index)
+    {
+        float64 Difference = (float64) Timings->NS[Index] - MeanNS;
+        Variance += Difference * Difference;
+    }
+    Variance /= (float64) Timings->Count;
+
+    qsort(Timings->NS, Timings->Count, sizeof(uint64), bench_CompareUInt64);
+    qsort(Timings->Cycles, Timings->Count, sizeof(uint64), bench_CompareUInt64);
+
+    uint64 MedianNS = Timings->NS[Timings->Count / 2];
+    uint64 MedianCycles = Timings->Cycles[Timings->Count / 2];
+
+    float64 StdDevPercent = (MeanNS > 0.0) ? (100.0 * sqrt(Variance) / MeanNS) : 0.0;
+    float64 CyclesPerUnit = (float64) MedianCycles / (float64) UnitCount;
+    float64 GBPerSecond = (MedianNS > 0) ? ((float64) Bytes / (float64) MedianNS) : 0.0;
+
+    FILE *Files[2] = {stdout, Output};
+    for(int FileIndex = 0; FileIndex < (int) ArrayCount(Files); ++FileIndex)
+    {
+        if(Files[FileIndex])
+        {
+            fprintf(Files[FileIndex], "%s\t%s\t%s\t%s\t%llu\t%d\t%llu\t%llu\t%0.0f\t%0.2f\t%0.4f\t%0.3f\n",
+                    Settings->Tag, BenchFamilyNames[Family], SimdLevelNames[Level], SizeName, (unsigned long long) UnitCount, Timings->Count,
+                    (unsigned long long) MedianNS, (unsigned long long) Timings->NS[0], MeanNS, StdDevPercent, CyclesPerUnit, GBPerSecond);
+        }
+    }
+}
+
+internal void bench_RunRender(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    BENCH_RENDER_SIZE *Largest = &BenchRenderSizes[ArrayCount(BenchRenderSizes) - 1];
+    void *BitmapMemory = malloc((size_t) Largest->Width * Largest->Height * 4);
+
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+
+    for(int SizeIndex = 0; SizeIndex < (int) ArrayCount(BenchRenderSizes); ++SizeIndex)
+    {
+        BENCH_RENDER_SIZE *Size = &BenchRenderSizes[SizeIndex];
+
+        HANDMADE_OFFSCREEN_BUFFER Buffer = {};
+        Buffer.BitmapMemory = BitmapMemory;
+        Buffer.BitmapWidth = Size->Width;
+        Buffer.BitmapHeight = Size->Height;
+        Buffer.Pitch = Size->Width * 4;
+
+        for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+        {
+            render_SelectKernels((SIMD_LEVEL) Level);
+            Timings->Count = 0;
+
+            for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+            {
+                uint64 StartCounter = bench_GetWallClock();
+                uint64 StartCycleCount = __rdtsc();
+
+                render_Gradient(&Buffer, Repetition, Repetition * 2);
+
+                uint64 EndCycleCount = __rdtsc();
+                uint64 EndCounter = bench_GetWallClock();
+
+                if(Repetition >= 0)
+                {
+                    Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                    Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                    ++Timings->Count;
+                }
+            }
+
+            uint64 PixelCount = (uint64) Size->Width * Size->Height;
+            bench_Report(Settings, Output, Timings, BENCH_FAMILY_RENDER, (SIMD_LEVEL) Level, Size->Name, PixelCount, PixelCount * 4);
+        }
+    }
+
+    free(BitmapMemory);
+}
+
+//Rate converted streams are baked at, one the mixer has to convert from whatever -r asks for
+internal int bench_GetConvertRate(BENCH_SETTINGS *Settings)
+{
+    return (Settings->SampleRate == 44100) ? 48000 : 44100;
+}
+
+//A sound or stream at another rate must come out of the mixer as the same sine at the mixer's rate, to the converter's quality
+//Once it has played out its voice and converter must both be free again
+internal bool32 bench_CheckConvertedVoice(BENCH_SETTINGS *Settings, SOUND_MIXER *Mixer, SOUND_WAVETABLES *Wavetables, bool32 Resident)
+{
+    const char *Kind = Resident ? "sound" : "stream";
+    int StreamRate = bench_GetConvertRate(Settings);
+    int StreamSampleCount = StreamRate;
+    int DestFrames = Settings->SampleRate + (Settings->SampleRate / 4);
+
+    int16 *Frames = (int16 *) malloc((size_t) StreamSampleCount * 2 * sizeof(int16));
+    int16 *Planar = (int16 *) malloc((size_t) StreamSampleCount * 2 * sizeof(int16));
+    int16 *Dest = (int16 *) malloc((size_t) DestFrames * 2 * sizeof(int16));
+
+    float64 Pi = 3.14159265358979323846;
+    for(int Frame = 0; Frame < StreamSampleCount; ++Frame)
+    {
+        int16 Value = (int16) lrint(16000.0 * sin((2.0 * Pi * 997.0 * (float64) Frame) / (float64) StreamRate));
+        Frames[(Frame * 2)] = Value;
+        Frames[(Frame * 2) + 1] = (int16) -Value;
+        Planar[Frame] = Value;
+        Planar[StreamSampleCount + Frame] = (int16) -Value;
+    }
+
+    SOUND_STREAM Stream = {};
+    Stream.Format = SOUND_SAMPLE_FORMAT_INT16;
+    Stream.ChannelCount = 2;
+    Stream.SampleRate = StreamRate;
+    Stream.SampleCount = StreamSampleCount;
+    Stream.Frames = Frames;
+
+    SOUND_SAMPLES Sound = {};
+    Sound.ChannelCount = 2;
+    Sound.SampleRate = StreamRate;
+    Sound.SampleCount = StreamSampleCount;
+    Sound.Samples[0] = Planar;
+    Sound.Samples[1] = Planar + StreamSampleCount;
+
+    sound_InitMixer(Mixer, Wavetables, Settings->SampleRate);
+    SOUND_VOICE *Voice = Resident ? sound_PlaySound(Mixer, &Sound, 1.0f, 1.0f, false) : sound_PlayStream(Mixer, &Stream, 1.0f, 1.0f, false);
+    int TapCount = (Voice && Voice->Converter) ? Voice->Converter->Context.TapCount : 0;
+    bool32 Passed = true;
+
+    if(!Voice)
+    {
+        fprintf(stderr, "sound: a %d Hz %s won't start on a %d Hz mixer\n", StreamRate, Kind, Settings->SampleRate);
+        Passed = false;
+    }
+
+    //Uneven buffers so spans start part way through the converter's blocks
+    for(int Written = 0; Written < DestFrames;)
+    {
+        HANDMADE_SOUND_BUFFER SoundBuffer = {};
+        SoundBuffer.SampleRate = Settings->SampleRate;
+        SoundBuffer.SampleCount = ((Written / 7) % 900) + 100;
+        SoundBuffer.Samples = Dest + (Written * 2);
+
+        if(SoundBuffer.SampleCount > DestFrames - Written)
+        {
+            SoundBuffer.SampleCount = DestFrames - Written;
+        }
+
+        sound_OutputSound(Mixer, &SoundBuffer);
+        Written += SoundBuffer.SampleCount;
+    }
+
+    //The first and last outputs read the silence either side of the sine
+    int PlayedFrames = (int) (((int64) StreamSampleCount * Settings->SampleRate) / StreamRate);
+    float64 Signal = 0.0;
+    float64 Error = 0.0;
+    for(int Frame = TapCount; Frame < PlayedFrames - TapCount; ++Frame)
+    {
+        float64 Expected = 16000.0 * sin((2.0 * Pi * 997.0 * (float64) Frame) / (float64) Settings->SampleRate);
+        float64 Left = (float64) Dest[(Frame * 2)] - Expected;
+        float64 Right = (float64) Dest[(Frame * 2) + 1] + Expected;
+
+        Signal += 2.0 * Expected * Expected;
+        Error += (Left * Left) + (Right * Right);
+    }
+
+    float64 SNR = 10.0 * log10(Signal / ((Error > 0.0) ? Error : 1e-9));
+    if(Passed && (SNR < BenchResampleMinimumSNR[SOUND_CONVERTER_QUALITY]))
+    {
+        fprintf(stderr, "sound: a %d Hz %s mixed at %d Hz is only %0.1f dB above its error, needs %0.1f\n",
+                StreamRate, Kind, Settings->SampleRate, SNR, BenchResampleMinimumSNR[SOUND_CONVERTER_QUALITY]);
+        Passed = false;
+    }
+
+    int FreeConverterCount = 0;
+    for(SOUND_CONVERTER *Converter = Mixer->FirstFreeConverter; Converter; Converter = Converter->NextFree)
+    {
+        ++FreeConverterCount;
+    }
+
+    if((Mixer->VoiceCount != 0) || (FreeConverterCount != SOUND_MAX_CONVERTERS))
+    {
+        fprintf(stderr, "sound: a converted %s left %d voices playing and %d converters taken\n",
+                Kind, Mixer->VoiceCount, SOUND_MAX_CONVERTERS - FreeConverterCount);
+        Passed = false;
+    }
+
+    free(Dest);
+    free(Planar);
+    free(Frames);
+
+    return Passed;
+}
+
+//Same shape as the game's mix, one sine oscillator plus looping voices over stereo noise
+internal bool32 bench_RunSound(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    local SOUND_WAVETABLES Wavetables;
+    local SOUND_MIXER Mixer;
+    local SOUND_SAMPLES Sound;
+    local int16 SoundSamples[2][48000];
+    local int16 Samples[4800 * 2];
+
+    uint32 Random = 0x12345678;
+    for(int SampleIndex = 0; SampleIndex < (int) ArrayCount(SoundSamples[0]); ++SampleIndex)
+    {
+        for(int Channel = 0; Channel < 2; ++Channel)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+            SoundSamples[Channel][SampleIndex] = (int16) (Random >> 16);
+        }
+    }
+
+    Sound.ChannelCount = 2;
+    Sound.SampleRate = Settings->SampleRate;
+    Sound.SampleCount = ArrayCount(SoundSamples[0]);
+    Sound.Samples[0] = SoundSamples[0];
+    Sound.Samples[1] = SoundSamples[1];
+
+    int VoiceCount = 8;
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+
+    sound_SelectKernels(SIMD_LEVEL_AUTO);
+    if(!bench_CheckConvertedVoice(Settings, &Mixer, &Wavetables, true) || !bench_CheckConvertedVoice(Settings, &Mixer, &Wavetables, false))
+    {
+        return false;
+    }
+
+    for(int BlockIndex = 0; BlockIndex < (int) ArrayCount(BenchBlockSizes); ++BlockIndex)
+    {
+        int BlockSize = BenchBlockSizes[BlockIndex];
+        char SizeName[32];
+        snprintf(SizeName, sizeof(SizeName), "%d", BlockSize);
+
+        for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+        {
+            sound_SelectKernels((SIMD_LEVEL) Level);
+            sound_InitMixer(&Mixer, &Wavetables, Settings->SampleRate);
+
+            Mixer.Oscillators.OscillatorCount = 1;
+            sound_SetOscillator(&Mixer.Oscillators, &Mixer.Oscillators.Oscillators[0], SOUND_WAVE_SINE, 256.0f, 3000.0f);
+
+            for(int VoiceIndex = 0; VoiceIndex < VoiceCount; ++VoiceIndex)
+            {
+                SOUND_VOICE *Voice = sound_PlaySound(&Mixer, &Sound, 0.5f / (float32) VoiceCount, 0.5f / (float32) VoiceCount, true);
+                Voice->SamplesPlayed = (VoiceIndex * 997) % Sound.SampleCount;
+            }
+
+            Timings->Count = 0;
+
+            for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+            {
+                HANDMADE_SOUND_BUFFER SoundBuffer = {};
+                SoundBuffer.SampleRate = Settings->SampleRate;
+                SoundBuffer.SampleCount = BlockSize;
+                SoundBuffer.Samples = Samples;
+
+                uint64 StartCounter = bench_GetWallClock();
+                uint64 StartCycleCount = __rdtsc();
+
+                sound_OutputSound(&Mixer, &SoundBuffer);
+
+                uint64 EndCycleCount = __rdtsc();
+                uint64 EndCounter = bench_GetWallClock();
+
+                if(Repetition >= 0)
+                {
+                    Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                    Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                    ++Timings->Count;
+                }
+            }
+
+            bench_Report(Settings, Output, Timings, BENCH_FAMILY_SOUND, (SIMD_LEVEL) Level, SizeName, BlockSize, (uint64) BlockSize * AUDIO_CHANNEL_COUNT * sizeof(int16));
+        }
+    }
+
+    //One streamed voice and nothing else, its cost should follow the block size and not the length of the stream
+    //The last is int16 at another rate, through a converter
+    local const char *StreamNames[] = {"int16", "float32", "int16_convert"};
+    int StreamSampleCount = BENCH_STREAM_SECONDS * Settings->SampleRate;
+    void *StreamFrames = malloc((size_t) StreamSampleCount * 2 * sizeof(float32));
+
+    for(int Variant = 0; Variant < (int) ArrayCount(StreamNames); ++Variant)
+    {
+        int Format = (Variant == 1) ? SOUND_SAMPLE_FORMAT_FLOAT32 : SOUND_SAMPLE_FORMAT_INT16;
+
+        SOUND_STREAM Stream = {};
+        Stream.Format = (SOUND_SAMPLE_FORMAT) Format;
+        Stream.ChannelCount = 2;
+        Stream.SampleRate = (Variant == 2) ? bench_GetConvertRate(Settings) : Settings->SampleRate;
+        Stream.SampleCount = StreamSampleCount;
+        Stream.Frames = StreamFrames;
+
+        for(int SampleIndex = 0; SampleIndex < StreamSampleCount * 2; ++SampleIndex)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+
+            if(Format == SOUND_SAMPLE_FORMAT_INT16)
+            {
+                ((int16 *) StreamFrames)[SampleIndex] = (int16) (Random >> 16);
+            }
+            else
+            {
+                ((float32 *) StreamFrames)[SampleIndex] = (float32) (int32) Random / 2147483648.0f;
+            }
+        }
+
+        for(int BlockIndex = 0; BlockIndex < (int) ArrayCount(BenchBlockSizes); ++BlockIndex)
+        {
+            int BlockSize = BenchBlockSizes[BlockIndex];
+            char SizeName[32];
+            snprintf(SizeName, sizeof(SizeName), "%s_stream_%d", StreamNames[Variant], BlockSize);
+
+            for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+            {
+                sound_SelectKernels((SIMD_LEVEL) Level);
+                resample_SelectKernels((SIMD_LEVEL) Level);
+                sound_InitMixer(&Mixer, &Wavetables, Settings->SampleRate);
+                sound_PlayStream(&Mixer, &Stream, 0.5f, 0.5f, true);
+
+                Timings->Count = 0;
+
+                for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+                {
+                    HANDMADE_SOUND_BUFFER SoundBuffer = {};
+                    SoundBuffer.SampleRate = Settings->SampleRate;
+                    SoundBuffer.SampleCount = BlockSize;
+                    SoundBuffer.Samples = Samples;
+
+                    uint64 StartCounter = bench_GetWallClock();
+                    uint64 StartCycleCount = __rdtsc();
+
+                    sound_OutputSound(&Mixer, &SoundBuffer);
+
+                    uint64 EndCycleCount = __rdtsc();
+                    uint64 EndCounter = bench_GetWallClock();
+
+                    if(Repetition >= 0)
+                    {
+                        Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                        Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                        ++Timings->Count;
+                    }
+                }
+
+                uint64 FrameSize = (Format == SOUND_SAMPLE_FORMAT_INT16) ? (2 * sizeof(int16)) : (2 * sizeof(float32));
+                bench_Report(Settings, Output, Timings, BENCH_FAMILY_SOUND, (SIMD_LEVEL) Level, SizeName, BlockSize, (uint64) BlockSize * (FrameSize + (AUDIO_CHANNEL_COUNT * sizeof(int16))));
+            }
+        }
+    }
+
+    free(StreamFrames);
+    sound_SelectKernels(SIMD_LEVEL_AUTO);
+    resample_SelectKernels(SIMD_LEVEL_AUTO);
+
+    return true;
+}
+
+//Ring is filled untimed, then drained into two regions split the way a wrapped DirectSound lock would be
+internal void bench_RunCopy(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    local AUDIO_RING_BUFFER Ring;
+    local int16 Source[4800 * 2];
+    local int16 Region[4800 * 2];
+
+    int64 RingCapacity = audio_GetRingCapacity(ArrayCount(Source) / 2);
+    void *RingMemory = malloc((size_t) audio_GetRingMemorySize(RingCapacity));
+    audio_InitRingBuffer(&Ring, RingMemory, RingCapacity);
+
+    for(int SampleIndex = 0; SampleIndex < (int) ArrayCount(Source); ++SampleIndex)
+    {
+        Source[SampleIndex] = (int16) (SampleIndex * 31);
+    }
+
+    for(int BlockIndex = 0; BlockIndex < (int) ArrayCount(BenchBlockSizes); ++BlockIndex)
+    {
+        int BlockSize = BenchBlockSizes[BlockIndex];
+        int Region1Count = BlockSize - (BlockSize / 3);
+        int Region2Count = BlockSize - Region1Count;
+
+        char SizeName[32];
+        snprintf(SizeName, sizeof(SizeName), "%d", BlockSize);
+
+        Timings->Count = 0;
+
+        for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+        {
+            audio_WriteFrames(&Ring, Source, BlockSize);
+
+            uint64 StartCounter = bench_GetWallClock();
+            uint64 StartCycleCount = __rdtsc();
+
+            audio_ReadFrames(&Ring, Region, Region1Count);
+            audio_ReadFrames(&Ring, Region + (Region1Count * AUDIO_CHANNEL_COUNT), Region2Count);
+
+            uint64 EndCycleCount = __rdtsc();
+            uint64 EndCounter = bench_GetWallClock();
+
+            if(Repetition >= 0)
+            {
+                Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                ++Timings->Count;
+            }
+        }
+
+        //Copy has no kernel variants, level column says what the compiler was allowed to use
+        bench_Report(Settings, Output, Timings, BENCH_FAMILY_COPY, SIMD_LEVEL_AUTO, SizeName, BlockSize, (uint64) BlockSize * AUDIO_CHANNEL_COUNT * sizeof(int16) * 2);
+    }
+
+    free(RingMemory);
+}
+
+internal uint32 bench_NextRandom(uint32 *Random)
+{
+    *Random ^= *Random << 13;
+    *Random ^= *Random >> 17;
+    *Random ^= *Random << 5;
+    return *Random;
+}
+
+//Sub pixel positions with some sprites hanging off every edge, same sequence for every level
+internal void bench_GetSpritePosition(uint32 *Random, HANDMADE_OFFSCREEN_BUFFER *Buffer, float32 *X, float32 *Y)
+{
+    *X = (float32) ((int) (bench_NextRandom(Random) % (uint32) ((Buffer->BitmapWidth + BENCH_SPRITE_SIZE) * 16)) - (BENCH_SPRITE_SIZE * 16)) / 16.0f;
+    *Y = (float32) ((int) (bench_NextRandom(Random) % (uint32) ((Buffer->BitmapHeight + BENCH_SPRITE_SIZE) * 16)) - (BENCH_SPRITE_SIZE * 16)) / 16.0f;
+}
+
+internal void bench_DrawSprites(HANDMADE_OFFSCREEN_BUFFER *Buffer, RENDER_BITMAP *Sprite, uint32 Seed)
+{
+    uint32 Random = Seed;
+
+    for(int SpriteIndex = 0; SpriteIndex < BENCH_SPRITE_COUNT; ++SpriteIndex)
+    {
+        float32 X, Y;
+        bench_GetSpritePosition(&Random, Buffer, &X, &Y);
+        render_DrawBitmap(Buffer, Sprite, X, Y);
+    }
+}
+
+internal void bench_DrawRectangles(HANDMADE_OFFSCREEN_BUFFER *Buffer, uint32 Seed)
+{
+    uint32 Random = Seed;
+
+    for(int RectIndex = 0; RectIndex < BENCH_RECT_COUNT; ++RectIndex)
+    {
+        float32 X, Y;
+        bench_GetSpritePosition(&Random, Buffer, &X, &Y);
+        render_DrawRectangle(Buffer, X, Y, X + BENCH_SPRITE_SIZE, Y + BENCH_SPRITE_SIZE, bench_NextRandom(&Random));
+    }
+}
+
+//Soft edged disc in straight alpha with noisy colour, premultiplied the way loaded art would be
+internal RENDER_BITMAP bench_MakeSprite(uint32 *Texels, uint32 *Random)
+{
+    RENDER_BITMAP Sprite = {BENCH_SPRITE_SIZE, BENCH_SPRITE_SIZE, BENCH_SPRITE_SIZE * 4, Texels};
+
+    for(int Y = 0; Y < BENCH_SPRITE_SIZE; ++Y)
+    {
+        for(int X = 0; X < BENCH_SPRITE_SIZE; ++X)
+        {
+            float32 DX = ((float32) X + 0.5f) - (BENCH_SPRITE_SIZE / 2);
+            float32 DY = ((float32) Y + 0.5f) - (BENCH_SPRITE_SIZE / 2);
+            float32 Coverage = (BENCH_SPRITE_SIZE / 2) - sqrtf((DX * DX) + (DY * DY));
+            uint32 Alpha = (Coverage <= 0.0f) ? 0 : ((Coverage >= 4.0f) ? 255 : (uint32) (Coverage * 63.75f));
+
+            Texels[(Y * BENCH_SPRITE_SIZE) + X] = (Alpha << 24) | (bench_NextRandom(Random) & 0x00FFFFFF);
+        }
+    }
+
+    render_PremultiplyBitmap(&Sprite);
+
+    return Sprite;
+}
+
+//Every level must reproduce the scalar frame exactly before it is timed, fails the run otherwise
+internal bool32 bench_RunDraw(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    BENCH_RENDER_SIZE *Size = &BenchRenderSizes[1];
+    size_t FrameSize = (size_t) Size->Width * Size->Height * 4;
+
+    HANDMADE_OFFSCREEN_BUFFER Buffer = {};
+    Buffer.BitmapMemory = malloc(FrameSize);
+    Buffer.BitmapWidth = Size->Width;
+    Buffer.BitmapHeight = Size->Height;
+    Buffer.Pitch = Size->Width * 4;
+
+    void *Background = malloc(FrameSize);
+    void *Reference = malloc(FrameSize);
+
+    uint32 Random = 0x9E3779B9;
+    for(size_t PixelIndex = 0; PixelIndex < FrameSize / 4; ++PixelIndex)
+    {
+        ((uint32 *) Background)[PixelIndex] = bench_NextRandom(&Random);
+    }
+
+    local uint32 SpriteTexels[BENCH_SPRITE_SIZE * BENCH_SPRITE_SIZE];
+    RENDER_BITMAP Sprite = bench_MakeSprite(SpriteTexels, &Random);
+
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+    bool32 Passed = true;
+
+    render_SelectKernels(SIMD_LEVEL_SCALAR);
+    memcpy(Reference, Background, FrameSize);
+    Buffer.BitmapMemory = Reference;
+    bench_DrawRectangles(&Buffer, 1);
+    bench_DrawSprites(&Buffer, &Sprite, 2);
+
+    void *BitmapMemory = malloc(FrameSize);
+    Buffer.BitmapMemory = BitmapMemory;
+
+    for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+    {
+        render_SelectKernels((SIMD_LEVEL) Level);
+
+        memcpy(BitmapMemory, Background, FrameSize);
+        bench_DrawRectangles(&Buffer, 1);
+        bench_DrawSprites(&Buffer, &Sprite, 2);
+
+        if(memcmp(BitmapMemory, Reference, FrameSize) != 0)
+        {
+            fprintf(stderr, "draw: %s output differs from scalar\n", SimdLevelNames[Level]);
+            Passed = false;
+            continue;
+        }
+
+        for(int Kernel = 0; Kernel < 2; ++Kernel)
+        {
+            Timings->Count = 0;
+
+            for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+            {
+                uint64 StartCounter = bench_GetWallClock();
+                uint64 StartCycleCount = __rdtsc();
+
+                //xorshift never leaves a zero seed
+                uint32 Seed = 0x1234 + Repetition;
+
+                if(Kernel == 0)
+                {
+                    bench_DrawRectangles(&Buffer, Seed);
+                }
+                else
+                {
+                    bench_DrawSprites(&Buffer, &Sprite, Seed);
+                }
+
+                uint64 EndCycleCount = __rdtsc();
+                uint64 EndCounter = bench_GetWallClock();
+
+                if(Repetition >= 0)
+                {
+                    Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                    Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                    ++Timings->Count;
+                }
+            }
+
+            //Units are pixels touched before clipping, a fill writes each once and a blit reads four texels and the pixel then writes it
+            uint64 PixelCount = (uint64) BENCH_SPRITE_SIZE * BENCH_SPRITE_SIZE * ((Kernel == 0) ? BENCH_RECT_COUNT : BENCH_SPRITE_COUNT);
+            bench_Report(Settings, Output, Timings, BENCH_FAMILY_DRAW, (SIMD_LEVEL) Level, (Kernel == 0) ? "rect64" : "blit64", PixelCount, PixelCount * ((Kernel == 0) ? 4 : 24));
+        }
+    }
+
+    render_SelectKernels(SIMD_LEVEL_AUTO);
+
+    free(BitmapMemory);
+    free(Reference);
+    free(Background);
+
+    return Passed;
+}
+
+//Every level must reproduce the scalar frame exactly, and rescaling only a changed rectangle must give the same frame as rescaling everything
+internal bool32 bench_CheckScale(SCALE_CONTEXT *Context, HANDMADE_OFFSCREEN_BUFFER *Source, HANDMADE_OFFSCREEN_BUFFER *Dest, void *Reference, uint32 *Random)
+{
+    size_t DestSize = (size_t) Dest->Pitch * Dest->BitmapHeight;
+
+    scale_Upscale(Context, Source, Dest, 0);
+    if(memcmp(Dest->BitmapMemory, Reference, DestSize) != 0)
+    {
+        return false;
+    }
+
+    //Changed rectangle hangs off the bottom right corner, where bilinear clamps
+    HANDMADE_RECT Changed = {Source->BitmapWidth - 37, Source->BitmapHeight - 23, Source->BitmapWidth + 5, Source->BitmapHeight};
+    uint32 *Saved = (uint32 *) malloc((size_t) 37 * 23 * 4);
+
+    for(int Y = Changed.MinY; Y < Source->BitmapHeight; ++Y)
+    {
+        for(int X = Changed.MinX; X < Source->BitmapWidth; ++X)
+        {
+            uint32 *Pixel = (uint32 *) ((uint8 *) Source->BitmapMemory + (Y * Source->Pitch)) + X;
+            Saved[((Y - Changed.MinY) * 37) + (X - Changed.MinX)] = *Pixel;
+            *Pixel = bench_NextRandom(Random);
+        }
+    }
+
+    scale_Upscale(Context, Source, Dest, &Changed);
+    void *Partial = malloc(DestSize);
+    memcpy(Partial, Dest->BitmapMemory, DestSize);
+    scale_Upscale(Context, Source, Dest, 0);
+    bool32 Passed = (memcmp(Partial, Dest->BitmapMemory, DestSize) == 0);
+
+    for(int Y = Changed.MinY; Y < Source->BitmapHeight; ++Y)
+    {
+        for(int X = Changed.MinX; X < Source->BitmapWidth; ++X)
+        {
+            uint32 *Pixel = (uint32 *) ((uint8 *) Source->BitmapMemory + (Y * Source->Pitch)) + X;
+            *Pixel = Saved[((Y - Changed.MinY) * 37) + (X - Changed.MinX)];
+        }
+    }
+
+    free(Partial);
+    free(Saved);
+
+    return Passed;
+}
+
+internal bool32 bench_RunScale(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    HANDMADE_OFFSCREEN_BUFFER Dest = {};
+    Dest.BitmapWidth = BENCH_SCALE_DEST_WIDTH;
+    Dest.BitmapHeight = BENCH_SCALE_DEST_HEIGHT;
+    Dest.Pitch = BENCH_SCALE_DEST_WIDTH * 4;
+    Dest.BitmapMemory = malloc((size_t) Dest.Pitch * Dest.BitmapHeight);
+
+    void *Reference = malloc((size_t) Dest.Pitch * Dest.BitmapHeight);
+
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+    bool32 Passed = true;
+
+    for(int CaseIndex = 0; CaseIndex < (int) ArrayCount(BenchScaleCases); ++CaseIndex)
+    {
+        BENCH_SCALE_CASE *Case = &BenchScaleCases[CaseIndex];
+
+        //Noise so every channel of every tap is exercised, with the source one pixel narrower than its pitch
+        HANDMADE_OFFSCREEN_BUFFER Source = {};
+        Source.BitmapWidth = Case->SourceWidth;
+        Source.BitmapHeight = Case->SourceHeight;
+        Source.Pitch = (Case->SourceWidth + 1) * 4;
+        Source.BitmapMemory = malloc((size_t) Source.Pitch * Source.BitmapHeight);
+
+        uint32 Random = 0x2545F491;
+        for(int PixelIndex = 0; PixelIndex < (Source.Pitch / 4) * Source.BitmapHeight; ++PixelIndex)
+        {
+            ((uint32 *) Source.BitmapMemory)[PixelIndex] = bench_NextRandom(&Random);
+        }
+
+        SCALE_CONTEXT Context;
+        void *ContextMemory = malloc(scale_GetMemorySize(Source.BitmapWidth, Dest.BitmapWidth, Dest.BitmapHeight));
+        scale_InitContext(&Context, ContextMemory, Case->Filter, Source.BitmapWidth, Source.BitmapHeight, Dest.BitmapWidth, Dest.BitmapHeight);
+
+        scale_SelectKernels(SIMD_LEVEL_SCALAR);
+        scale_Upscale(&Context, &Source, &Dest, 0);
+        memcpy(Reference, Dest.BitmapMemory, (size_t) Dest.Pitch * Dest.BitmapHeight);
+
+        for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+        {
+            scale_SelectKernels((SIMD_LEVEL) Level);
+
+            if(!bench_CheckScale(&Context, &Source, &Dest, Reference, &Random))
+            {
+                fprintf(stderr, "scale: %s %s output differs from scalar or from a full rescale\n", Case->Name, SimdLevelNames[Level]);
+                Passed = false;
+                continue;
+            }
+
+            Timings->Count = 0;
+
+            for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+            {
+                uint64 StartCounter = bench_GetWallClock();
+                uint64 StartCycleCount = __rdtsc();
+
+                scale_Upscale(&Context, &Source, &Dest, 0);
+
+                uint64 EndCycleCount = __rdtsc();
+                uint64 EndCounter = bench_GetWallClock();
+
+                if(Repetition >= 0)
+                {
+                    Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                    Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                    ++Timings->Count;
+                }
+            }
+
+            //Units are output pixels, each source pixel is read and each output pixel written
+            uint64 PixelCount = (uint64) Dest.BitmapWidth * Dest.BitmapHeight;
+            uint64 SourceCount = (uint64) Source.BitmapWidth * Source.BitmapHeight;
+            bench_Report(Settings, Output, Timings, BENCH_FAMILY_SCALE, (SIMD_LEVEL) Level, Case->Name, PixelCount, (PixelCount + SourceCount) * 4);
+        }
+
+        free(ContextMemory);
+        free(Source.BitmapMemory);
+    }
+
+    scale_SelectKernels(SIMD_LEVEL_AUTO);
+
+    free(Reference);
+    free(Dest.BitmapMemory);
+
+    return Passed;
+}
+
+//Read only mapping of a whole file, Size is 0 on failure
+internal void *bench_MapFile(const char *Path, uint64 *Size)
+{
+    void *Result = 0;
+    *Size = 0;
+
+#if defined(_WIN32)
+    HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+    if(File != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER FileSize;
+        if(GetFileSizeEx(File, &FileSize) && (FileSize.QuadPart > 0))
+        {
+            HANDLE Mapping = CreateFileMappingA(File, 0, PAGE_READONLY, 0, 0, 0);
+            if(Mapping)
+            {
+                Result = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+                *Size = Result ? (uint64) FileSize.QuadPart : 0;
+                CloseHandle(Mapping);
+            }
+        }
+        CloseHandle(File);
+    }
+#else
+    int File = open(Path, O_RDONLY);
+    if(File >= 0)
+    {
+        struct stat FileStat;
+        if((fstat(File, &FileStat) == 0) && (FileStat.st_size > 0))
+        {
+            Result = mmap(0, (size_t) FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+            if(Result == MAP_FAILED)
+            {
+                Result = 0;
+            }
+            *Size = Result ? (uint64) FileStat.st_size : 0;
+        }
+        close(File);
+    }
+#endif
+
+    return Result;
+}
+
+internal void bench_UnmapFile(void *Memory, uint64 Size)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(Memory);
+#else
+    munmap(Memory, (size_t) Size);
+#endif
+}
+
+//Pages faulted into this process so far, 0 where the platform doesn't say
+internal uint64 bench_GetPageFaultCount(void)
+{
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage Usage;
+    getrusage(RUSAGE_SELF, &Usage);
+    return (uint64) Usage.ru_minflt + (uint64) Usage.ru_majflt;
+#endif
+}
+
+internal void bench_TouchMemory(void *Memory, uint64 Size)
+{
+    uint64 *At = (uint64 *) Memory;
+    uint64 Sum = 0;
+
+    for(uint64 Index = 0; Index < Size / sizeof(uint64); ++Index)
+    {
+        Sum += At[Index];
+    }
+
+    BenchTouchSum += Sum;
+}
+
+internal void bench_WriteUInt16(FILE *File, uint16 Value)
+{
+    fwrite(&Value, sizeof(Value), 1, File);
+}
+
+internal void bench_WriteUInt32(FILE *File, uint32 Value)
+{
+    fwrite(&Value, sizeof(Value), 1, File);
+}
+
+//32 bit BI_RGB, bottom row first, straight alpha: what an art tool would export
+internal bool32 bench_WriteBMP(const char *Path, int Width, int Height, uint32 *Random)
+{
+    FILE *File = fopen(Path, "wb");
+    if(!File)
+    {
+        return false;
+    }
+
+    uint32 PixelSize = (uint32) (Width * Height * 4);
+
+    fwrite("BM", 1, 2, File);
+    bench_WriteUInt32(File, 54 + PixelSize);
+    bench_WriteUInt32(File, 0);
+    bench_WriteUInt32(File, 54);
+    bench_WriteUInt32(File, 40);
+    bench_WriteUInt32(File, (uint32) Width);
+    bench_WriteUInt32(File, (uint32) Height);
+    bench_WriteUInt16(File, 1);
+    bench_WriteUInt16(File, 32);
+    bench_WriteUInt32(File, 0);
+    bench_WriteUInt32(File, PixelSize);
+    bench_WriteUInt32(File, 2835);
+    bench_WriteUInt32(File, 2835);
+    bench_WriteUInt32(File, 0);
+    bench_WriteUInt32(File, 0);
+
+    for(int PixelIndex = 0; PixelIndex < Width * Height; ++PixelIndex)
+    {
+        bench_WriteUInt32(File, bench_NextRandom(Random));
+    }
+
+    return fclose(File) == 0;
+}
+
+internal bool32 bench_WriteWAV(const char *Path, int SampleCount, int SampleRate, uint32 *Random)
+{
+    FILE *File = fopen(Path, "wb");
+    if(!File)
+    {
+        return false;
+    }
+
+    uint32 DataSize = (uint32) (SampleCount * 2 * sizeof(int16));
+
+    fwrite("RIFF", 1, 4, File);
+    bench_WriteUInt32(File, 36 + DataSize);
+    fwrite("WAVEfmt ", 1, 8, File);
+    bench_WriteUInt32(File, 16);
+    bench_WriteUInt16(File, 1);
+    bench_WriteUInt16(File, 2);
+    bench_WriteUInt32(File, (uint32) SampleRate);
+    bench_WriteUInt32(File, (uint32) SampleRate * 2 * sizeof(int16));
+    bench_WriteUInt16(File, 2 * sizeof(int16));
+    bench_WriteUInt16(File, 16);
+    fwrite("data", 1, 4, File);
+    bench_WriteUInt32(File, DataSize);
+
+    for(int SampleIndex = 0; SampleIndex < SampleCount * 2; ++SampleIndex)
+    {
+        bench_WriteUInt16(File, (uint16) bench_NextRandom(Random));
+    }
+
+    return fclose(File) == 0;
+}
+
+internal void bench_GetAssetSourcePath(char *Path, int PathSize, int AssetIndex)
+{
+    if(AssetIndex < BENCH_ASSET_BITMAP_COUNT)
+    {
+        snprintf(Path, PathSize, "bench_asset_%02d.bmp", AssetIndex);
+    }
+    else
+    {
+        snprintf(Path, PathSize, "bench_asset_%02d.wav", AssetIndex - BENCH_ASSET_BITMAP_COUNT);
+    }
+}
+
+enum BENCH_ASSET_CASE
+{
+    BENCH_ASSET_CASE_FREAD_DECODE, //Every loose file read and decoded into fresh memory, like a loader without a pack
+    BENCH_ASSET_CASE_MAP_OPEN, //Pack mapped and its tables checked, what startup costs
+    BENCH_ASSET_CASE_MAP_ONE, //Mapped, then one bitmap found and read end to end
+    BENCH_ASSET_CASE_MAP_ALL, //Mapped, then every payload read end to end
+    BENCH_ASSET_CASE_STREAM, //Mapped, then a window of assets walked through a streaming cache smaller than the pack, loads inline
+
+    BENCH_ASSET_CASE_COUNT
+};
+
+global const char *BenchAssetCaseNames[BENCH_ASSET_CASE_COUNT] = {"fread_decode", "map_open", "map_one", "map_all", "stream"};
+
+//One frame per asset, each asking for the next BENCH_ASSET_STREAM_WINDOW like a game panning across a level
+//Without a background queue every miss loads before the getter returns, so nothing comes back 0 unless the budget is full
+internal bool32 bench_StreamAssets(ASSET_CACHE *Cache, HANDMADE_PLATFORM *Platform, ASSET_PACK *Pack, BUILDER_ASSET *Assets)
+{
+    for(uint32 FrameIndex = 0; FrameIndex < Pack->AssetCount; ++FrameIndex)
+    {
+        asset_BeginFrame(Cache, Platform, Pack);
+
+        for(uint32 WindowIndex = 0; WindowIndex < BENCH_ASSET_STREAM_WINDOW; ++WindowIndex)
+        {
+            int AssetIndex = (int) ((FrameIndex + WindowIndex) % Pack->AssetCount);
+            ASSET_PACK_ENTRY *Entry = &Pack->Entries[AssetIndex];
+            void *Memory = 0;
+            uint64 Size = 0;
+
+            if(Entry->Type == ASSET_TYPE_BITMAP)
+            {
+                RENDER_BITMAP *Bitmap = asset_GetBitmapStreamed(Cache, Platform, AssetIndex);
+                Memory = Bitmap ? Bitmap->Memory : 0;
+                Size = (uint64) Entry->Bitmap.Pitch * Entry->Bitmap.Height;
+            }
+            else
+            {
+                SOUND_SAMPLES *Sound = asset_GetSoundStreamed(Cache, Platform, AssetIndex);
+                Memory = Sound ? Sound->Samples[0] : 0;
+                Size = (uint64) Entry->Sound.SampleCount * sizeof(int16);
+            }
+
+            if(!Memory)
+            {
+                return false;
+            }
+
+            //Assets is only passed by the check, the timed case reads the copies like a renderer would
+            if(Assets)
+            {
+                BUILDER_ASSET *Asset = &Assets[AssetIndex];
+                void *Expected = (Asset->Type == ASSET_TYPE_BITMAP) ? Asset->Bitmap.Memory : (void *) Asset->Sound.Samples[0];
+
+                if(memcmp(Memory, Expected, (size_t) Size) != 0)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                bench_TouchMemory(Memory, Size);
+            }
+        }
+
+        asset_EndFrame(Cache, Platform);
+    }
+
+    return true;
+}
+
+//Runs in the current directory, writes the sources and the pack there and deletes them afterwards
+//Files are fresh in the OS cache so both paths measure CPU and page mapping, not the disk
+internal bool32 bench_RunAsset(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    int AssetCount = BENCH_ASSET_BITMAP_COUNT + BENCH_ASSET_SOUND_COUNT;
+    BUILDER_ASSET *Assets = (BUILDER_ASSET *) calloc((size_t) AssetCount, sizeof(BUILDER_ASSET));
+    uint32 Random = 0x2545F491;
+    bool32 Passed = true;
+
+    char Path[64];
+    uint64 PayloadSize = 0;
+
+    for(int AssetIndex = 0; Passed && (AssetIndex < AssetCount); ++AssetIndex)
+    {
+        bench_GetAssetSourcePath(Path, sizeof(Path), AssetIndex);
+
+        if(AssetIndex < BENCH_ASSET_BITMAP_COUNT)
+        {
+            Passed = bench_WriteBMP(Path, BENCH_ASSET_BITMAP_SIZE, BENCH_ASSET_BITMAP_SIZE, &Random);
+        }
+        else
+        {
+            Passed = bench_WriteWAV(Path, BENCH_ASSET_SOUND_SAMPLES, Settings->SampleRate, &Random);
+        }
+
+        char Name[ASSET_MAX_NAME];
+        snprintf(Name, sizeof(Name), "asset%d", AssetIndex);
+        Passed = Passed && builder_LoadAsset(&Assets[AssetIndex], Name, Path);
+
+        if(Passed)
+        {
+            BUILDER_ASSET *Asset = &Assets[AssetIndex];
+            PayloadSize += (Asset->Type == ASSET_TYPE_BITMAP) ? ((uint64) Asset->Bitmap.Pitch * Asset->Bitmap.Height) :
+                                                               ((uint64) Asset->Sound.SampleCount * Asset->Sound.ChannelCount * sizeof(int16));
+        }
+    }
+
+    Passed = Passed && builder_WritePack(BENCH_ASSET_PACK_PATH, Assets, AssetCount);
+
+    ASSET_CACHE *Cache = (ASSET_CACHE *) malloc(sizeof(ASSET_CACHE));
+    void *Budget = malloc(BENCH_ASSET_STREAM_BUDGET);
+    HANDMADE_PLATFORM Platform = {};
+    HANDMADE_ASSET_STATS StreamStats = {};
+
+    //Round trip: what the pack hands back must be exactly what the builder decoded, directly and through the cache
+    if(Passed)
+    {
+        uint64 PackSize;
+        void *PackMemory = bench_MapFile(BENCH_ASSET_PACK_PATH, &PackSize);
+        ASSET_PACK Pack;
+        Passed = asset_OpenPack(&Pack, PackMemory, PackSize);
+
+        for(int AssetIndex = 0; Passed && (AssetIndex < AssetCount); ++AssetIndex)
+        {
+            BUILDER_ASSET *Asset = &Assets[AssetIndex];
+            int Index = asset_FindAsset(&Pack, Asset->Name, Asset->Type);
+
+            if(Asset->Type == ASSET_TYPE_BITMAP)
+            {
+                RENDER_BITMAP Bitmap;
+                Passed = asset_GetBitmap(&Pack, Index, &Bitmap) && (((uintptr_t) Bitmap.Memory % ASSET_PACK_ALIGNMENT) == 0) &&
+                         (memcmp(Bitmap.Memory, Asset->Bitmap.Memory, (size_t) Bitmap.Pitch * Bitmap.Height) == 0);
+            }
+            else
+            {
+                SOUND_SAMPLES Sound;
+                Passed = asset_GetSound(&Pack, Index, &Sound) && (Sound.SampleCount == Asset->Sound.SampleCount) && (Sound.SampleRate == Asset->Sound.SampleRate) &&
+                         (memcmp(Sound.Samples[0], Asset->Sound.Samples[0], Sound.SampleCount * sizeof(int16)) == 0) &&
+                         (memcmp(Sound.Samples[1], Asset->Sound.Samples[1], Sound.SampleCount * sizeof(int16)) == 0);
+            }
+        }
+
+        if(Passed)
+        {
+            Platform.AssetStats = &StreamStats;
+            asset_InitCache(Cache, Budget, BENCH_ASSET_STREAM_BUDGET);
+            Passed = bench_StreamAssets(Cache, &Platform, &Pack, Assets) && (StreamStats.Evictions > 0) && (StreamStats.BudgetFailures == 0);
+        }
+
+        if(PackMemory)
+        {
+            bench_UnmapFile(PackMemory, PackSize);
+        }
+    }
+
+    if(!Passed)
+    {
+        fprintf(stderr, "asset: building or reading back the pack failed\n");
+    }
+
+    for(int AssetIndex = 0; AssetIndex < AssetCount; ++AssetIndex)
+    {
+        builder_FreeAsset(&Assets[AssetIndex]);
+    }
+
+    uint64 FaultCounts[BENCH_ASSET_CASE_COUNT] = {};
+
+    for(int Case = 0; Passed && (Case < BENCH_ASSET_CASE_COUNT); ++Case)
+    {
+        Timings->Count = 0;
+
+        for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+        {
+            uint64 StartFaultCount = bench_GetPageFaultCount();
+            uint64 StartCounter = bench_GetWallClock();
+            uint64 StartCycleCount = __rdtsc();
+
+            if(Case == BENCH_ASSET_CASE_FREAD_DECODE)
+            {
+                for(int AssetIndex = 0; AssetIndex < AssetCount; ++AssetIndex)
+                {
+                    BUILDER_ASSET Asset;
+                    bench_GetAssetSourcePath(Path, sizeof(Path), AssetIndex);
+
+                    if(builder_LoadAsset(&Asset, "asset", Path))
+                    {
+                        builder_FreeAsset(&Asset);
+                    }
+                }
+            }
+            else
+            {
+                uint64 PackSize;
+                void *PackMemory = bench_MapFile(BENCH_ASSET_PACK_PATH, &PackSize);
+                ASSET_PACK Pack;
+
+                if(asset_OpenPack(&Pack, PackMemory, PackSize))
+                {
+                    if(Case == BENCH_ASSET_CASE_MAP_ONE)
+                    {
+                        RENDER_BITMAP Bitmap;
+                        if(asset_GetBitmap(&Pack, asset_FindAsset(&Pack, "asset7", ASSET_TYPE_BITMAP), &Bitmap))
+                        {
+                            bench_TouchMemory(Bitmap.Memory, (uint64) Bitmap.Pitch * Bitmap.Height);
+                        }
+                    }
+                    else if(Case == BENCH_ASSET_CASE_MAP_ALL)
+                    {
+                        for(uint32 AssetIndex = 0; AssetIndex < Pack.AssetCount; ++AssetIndex)
+                        {
+                            bench_TouchMemory(Pack.Base + Pack.Entries[AssetIndex].DataOffset, Pack.Entries[AssetIndex].DataSize);
+                        }
+                    }
+                    else if(Case == BENCH_ASSET_CASE_STREAM)
+                    {
+                        asset_InitCache(Cache, Budget, BENCH_ASSET_STREAM_BUDGET);
+                        bench_StreamAssets(Cache, &Platform, &Pack, 0);
+                    }
+                }
+
+                bench_UnmapFile(PackMemory, PackSize);
+            }
+
+            uint64 EndCycleCount = __rdtsc();
+            uint64 EndCounter = bench_GetWallClock();
+
+            if(Repetition >= 0)
+            {
+                Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                ++Timings->Count;
+
+                FaultCounts[Case] += bench_GetPageFaultCount() - StartFaultCount;
+            }
+        }
+
+        //Units are the assets available after the case, bytes what the game would go on to use
+        bench_Report(Settings, Output, Timings, BENCH_FAMILY_ASSET, SIMD_LEVEL_AUTO, BenchAssetCaseNames[Case], AssetCount, PayloadSize);
+    }
+
+    //Page faults show what each case makes resident, a mapped pack only costs the pages that get touched
+    if(Passed && FaultCounts[BENCH_ASSET_CASE_FREAD_DECODE])
+    {
+        fprintf(stderr, "asset: page faults per repetition");
+        for(int Case = 0; Case < BENCH_ASSET_CASE_COUNT; ++Case)
+        {
+            fprintf(stderr, "\t %s %llu", BenchAssetCaseNames[Case], (unsigned long long) (FaultCounts[Case] / (uint64) Settings->RepetitionCount));
+        }
+        fprintf(stderr, "\n");
+    }
+
+    //Counters from the last timed stream, one pass over the pack through the budget
+    if(Passed)
+    {
+        fprintf(stderr, "asset: stream through %llu MB, %llu hits, %llu misses, %llu loads, %llu evictions\n", (unsigned long long) (StreamStats.BudgetSize / Megabytes(1)),
+                (unsigned long long) StreamStats.Hits, (unsigned long long) StreamStats.Misses, (unsigned long long) StreamStats.Loads, (unsigned long long) StreamStats.Evictions);
+    }
+
+    for(int AssetIndex = 0; AssetIndex < AssetCount; ++AssetIndex)
+    {
+        bench_GetAssetSourcePath(Path, sizeof(Path), AssetIndex);
+        remove(Path);
+    }
+    remove(BENCH_ASSET_PACK_PATH);
+
+    free(Budget);
+    free(Cache);
+    free(Assets);
+    return Passed;
+}
+
+//Every level must convert a noise frame to the same planes as scalar, pitch wider than the rows
+internal bool32 bench_CheckCapture(int Width, int Height, SIMD_LEVEL Best)
+{
+    int Pitch = (Width + 3) * 4;
+    size_t PlaneSize = capture_GetPlaneSize(Width, Height);
+    uint32 *Pixels = (uint32 *) malloc((size_t) Pitch * Height);
+    uint8 *Reference = (uint8 *) malloc(PlaneSize);
+    uint8 *Planes = (uint8 *) malloc(PlaneSize);
+
+    uint32 Random = 0x1B873593;
+    for(int PixelIndex = 0; PixelIndex < (Pitch / 4) * Height; ++PixelIndex)
+    {
+        Pixels[PixelIndex] = bench_NextRandom(&Random);
+    }
+
+    //Channels at both ends of their range, where the 16 bit sums come closest to wrapping
+    Pixels[0] = 0xFFFFFFFF;
+    Pixels[1] = 0x00000000;
+    if(Height > 1)
+    {
+        Pixels[Pitch / 4] = 0x00FF0000;
+        Pixels[(Pitch / 4) + 1] = 0x000000FF;
+    }
+
+    capture_SelectKernels(SIMD_LEVEL_SCALAR);
+    capture_ConvertFrame(Reference, Pixels, Width, Height, Pitch);
+
+    bool32 Passed = true;
+
+    for(int Level = SIMD_LEVEL_SSE2; Level <= Best; ++Level)
+    {
+        capture_SelectKernels((SIMD_LEVEL) Level);
+        memset(Planes, 0xCD, PlaneSize);
+        capture_ConvertFrame(Planes, Pixels, Width, Height, Pitch);
+
+        if(memcmp(Planes, Reference, PlaneSize) != 0)
+        {
+            fprintf(stderr, "capture: %dx%d %s planes differ from scalar\n", Width, Height, SimdLevelNames[Level]);
+            Passed = false;
+        }
+    }
+
+    free(Planes);
+    free(Reference);
+    free(Pixels);
+
+    return Passed;
+}
+
+internal bool32 bench_RunCapture(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+    bool32 Passed = true;
+
+    for(int SizeIndex = 0; SizeIndex < (int) ArrayCount(BenchCaptureCheckSizes); ++SizeIndex)
+    {
+        Passed = bench_CheckCapture(BenchCaptureCheckSizes[SizeIndex].Width, BenchCaptureCheckSizes[SizeIndex].Height, Best) && Passed;
+    }
+
+    for(int SizeIndex = 0; SizeIndex < (int) ArrayCount(BenchRenderSizes); ++SizeIndex)
+    {
+        BENCH_RENDER_SIZE *Size = &BenchRenderSizes[SizeIndex];
+
+        if(!bench_CheckCapture(Size->Width, Size->Height, Best))
+        {
+            Passed = false;
+            continue;
+        }
+
+        int Pitch = Size->Width * 4;
+        size_t PlaneSize = capture_GetPlaneSize(Size->Width, Size->Height);
+        uint32 *Pixels = (uint32 *) malloc((size_t) Pitch * Size->Height);
+        uint8 *Planes = (uint8 *) malloc(PlaneSize);
+
+        uint32 Random = 0x2545F491;
+        for(int PixelIndex = 0; PixelIndex < Size->Width * Size->Height; ++PixelIndex)
+        {
+            Pixels[PixelIndex] = bench_NextRandom(&Random);
+        }
+
+        for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+        {
+            capture_SelectKernels((SIMD_LEVEL) Level);
+            Timings->Count = 0;
+
+            for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+            {
+                uint64 StartCounter = bench_GetWallClock();
+                uint64 StartCycleCount = __rdtsc();
+
+                capture_ConvertFrame(Planes, Pixels, Size->Width, Size->Height, Pitch);
+
+                uint64 EndCycleCount = __rdtsc();
+                uint64 EndCounter = bench_GetWallClock();
+
+                if(Repetition >= 0)
+                {
+                    Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                    Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                    ++Timings->Count;
+                }
+            }
+
+            uint64 PixelCount = (uint64) Size->Width * Size->Height;
+            bench_Report(Settings, Output, Timings, BENCH_FAMILY_CAPTURE, (SIMD_LEVEL) Level, Size->Name, PixelCount, (PixelCount * 4) + PlaneSize);
+        }
+
+        free(Planes);
+        free(Pixels);
+    }
+
+    capture_SelectKernels(SIMD_LEVEL_AUTO);
+
+    return Passed;
+}
+
+//Stage 0 draws the gradient, stage 1 fills and blits over it, both then present to BGRX8888
+//The fills cover the whole frame, so the gradient is compared before they hide it
+internal void bench_DrawFormatFrame(HANDMADE_OFFSCREEN_BUFFER *Buffer, HANDMADE_OFFSCREEN_BUFFER *Presented, RENDER_BITMAP *Sprite, int Stage)
+{
+    if(Stage == 0)
+    {
+        render_Gradient(Buffer, 7, 3);
+    }
+    else
+    {
+        bench_DrawRectangles(Buffer, 1);
+        bench_DrawSprites(Buffer, Sprite, 2);
+    }
+
+    pixel_ConvertRect(Presented, Buffer, render_GetBufferRect(Buffer));
+}
+
+//Every level must reproduce the scalar frame and its presented copy exactly at each stage, for every format
+//Pitch is wider than the rows and Width is odd so every kernel's scalar tail runs
+internal bool32 bench_CheckFormat(HANDMADE_PIXEL_FORMAT Format, RENDER_BITMAP *Sprite, SIMD_LEVEL Best)
+{
+    int Width = 1001;
+    int Height = 777;
+
+    HANDMADE_OFFSCREEN_BUFFER Buffer = {};
+    Buffer.BitmapWidth = Width;
+    Buffer.BitmapHeight = Height;
+    Buffer.Pitch = (Width + 37) * PixelFormatBytes[Format];
+    Buffer.Format = Format;
+
+    HANDMADE_OFFSCREEN_BUFFER Presented = {};
+    Presented.BitmapWidth = Width;
+    Presented.BitmapHeight = Height;
+    Presented.Pitch = Width * 4;
+
+    //Frame then its presented copy, once per stage
+    size_t StageSize = ((size_t) Buffer.Pitch * Height) + ((size_t) Presented.Pitch * Height);
+    uint8 *Reference = (uint8 *) malloc(2 * StageSize);
+    uint8 *Frame = (uint8 *) calloc(1, StageSize);
+
+    render_SelectKernels(SIMD_LEVEL_SCALAR);
+    pixel_SelectKernels(SIMD_LEVEL_SCALAR);
+    Buffer.BitmapMemory = Frame;
+    Presented.BitmapMemory = Frame + ((size_t) Buffer.Pitch * Height);
+
+    for(int Stage = 0; Stage < 2; ++Stage)
+    {
+        bench_DrawFormatFrame(&Buffer, &Presented, Sprite, Stage);
+        memcpy(Reference + (Stage * StageSize), Frame, StageSize);
+    }
+
+    bool32 Passed = true;
+
+    for(int Level = SIMD_LEVEL_SSE2; Level <= Best; ++Level)
+    {
+        render_SelectKernels((SIMD_LEVEL) Level);
+        pixel_SelectKernels((SIMD_LEVEL) Level);
+        memset(Frame, 0, StageSize);
+
+        for(int Stage = 0; Stage < 2; ++Stage)
+        {
+            bench_DrawFormatFrame(&Buffer, &Presented, Sprite, Stage);
+
+            if(memcmp(Frame, Reference + (Stage * StageSize), StageSize) != 0)
+            {
+                fprintf(stderr, "format: %s %s %s output differs from scalar\n", PixelFormatNames[Format], SimdLevelNames[Level], (Stage == 0) ? "gradient" : "draw");
+                Passed = false;
+            }
+        }
+    }
+
+    free(Frame);
+    free(Reference);
+
+    return Passed;
+}
+
+internal bool32 bench_RunFormat(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    BENCH_RENDER_SIZE *Size = &BenchRenderSizes[1];
+    uint64 PixelCount = (uint64) Size->Width * Size->Height;
+
+    uint32 Random = 0x68E31DA4;
+    local uint32 SpriteTexels[BENCH_SPRITE_SIZE * BENCH_SPRITE_SIZE];
+    RENDER_BITMAP Sprite = bench_MakeSprite(SpriteTexels, &Random);
+
+    HANDMADE_OFFSCREEN_BUFFER Presented = {};
+    Presented.BitmapMemory = malloc(PixelCount * 4);
+    Presented.BitmapWidth = Size->Width;
+    Presented.BitmapHeight = Size->Height;
+    Presented.Pitch = Size->Width * 4;
+
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+    bool32 Passed = true;
+
+    for(int Format = 0; Format < HANDMADE_PIXEL_FORMAT_COUNT; ++Format)
+    {
+        if(!bench_CheckFormat((HANDMADE_PIXEL_FORMAT) Format, &Sprite, Best))
+        {
+            Passed = false;
+            continue;
+        }
+
+        int BytesPerPixel = PixelFormatBytes[Format];
+
+        HANDMADE_OFFSCREEN_BUFFER Buffer = {};
+        Buffer.BitmapMemory = calloc(PixelCount, BytesPerPixel);
+        Buffer.BitmapWidth = Size->Width;
+        Buffer.BitmapHeight = Size->Height;
+        Buffer.Pitch = Size->Width * BytesPerPixel;
+        Buffer.Format = (HANDMADE_PIXEL_FORMAT) Format;
+
+        for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+        {
+            render_SelectKernels((SIMD_LEVEL) Level);
+            pixel_SelectKernels((SIMD_LEVEL) Level);
+
+            for(int Kernel = 0; Kernel < BENCH_FORMAT_KERNEL_COUNT; ++Kernel)
+            {
+                Timings->Count = 0;
+
+                for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+                {
+                    uint64 StartCounter = bench_GetWallClock();
+                    uint64 StartCycleCount = __rdtsc();
+
+                    uint32 Seed = 0x1234 + Repetition;
+
+                    switch(Kernel)
+                    {
+                        case BENCH_FORMAT_KERNEL_GRADIENT: render_Gradient(&Buffer, Repetition, Repetition * 2); break;
+                        case BENCH_FORMAT_KERNEL_RECT: bench_DrawRectangles(&Buffer, Seed); break;
+                        case BENCH_FORMAT_KERNEL_BLIT: bench_DrawSprites(&Buffer, &Sprite, Seed); break;
+                        default: pixel_ConvertRect(&Presented, &Buffer, render_GetBufferRect(&Buffer)); break;
+                    }
+
+                    uint64 EndCycleCount = __rdtsc();
+                    uint64 EndCounter = bench_GetWallClock();
+
+                    if(Repetition >= 0)
+                    {
+                        Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                        Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                        ++Timings->Count;
+                    }
+                }
+
+                //Same units as the render and draw families, bytes follow the format so the narrower ones show what they save
+                uint64 UnitCount = PixelCount;
+                uint64 Bytes = PixelCount * BytesPerPixel;
+                if(Kernel == BENCH_FORMAT_KERNEL_RECT)
+                {
+                    UnitCount = (uint64) BENCH_SPRITE_SIZE * BENCH_SPRITE_SIZE * BENCH_RECT_COUNT;
+                    Bytes = UnitCount * BytesPerPixel;
+                }
+                else if(Kernel == BENCH_FORMAT_KERNEL_BLIT)
+                {
+                    UnitCount = (uint64) BENCH_SPRITE_SIZE * BENCH_SPRITE_SIZE * BENCH_SPRITE_COUNT;
+                    Bytes = UnitCount * (16 + (2 * BytesPerPixel));
+                }
+                else if(Kernel == BENCH_FORMAT_KERNEL_PRESENT)
+                {
+                    Bytes = PixelCount * (BytesPerPixel + 4);
+                }
+
+                char SizeName[64];
+                snprintf(SizeName, sizeof(SizeName), "%s_%s_%s", PixelFormatNames[Format], BenchFormatKernelNames[Kernel], Size->Name);
+                bench_Report(Settings, Output, Timings, BENCH_FAMILY_FORMAT, (SIMD_LEVEL) Level, SizeName, UnitCount, Bytes);
+            }
+        }
+
+        free(Buffer.BitmapMemory);
+    }
+
+    render_SelectKernels(SIMD_LEVEL_AUTO);
+    pixel_SelectKernels(SIMD_LEVEL_AUTO);
+
+    free(Presented.BitmapMemory);
+
+    return Passed;
+}
+
+//Streams DestFrames out in uneven blocks, reading Source from the start
+//Even blocks ask for a number of outputs the way a device would, odd ones hand over a number of inputs the way a replay would
+internal void bench_ResampleUneven(RESAMPLE_CONTEXT *Context, int16 *Source, int16 *Dest, int DestFrames)
+{
+    int Read = 0;
+    int Written = 0;
+
+    for(int Block = 0; Written < DestFrames; ++Block)
+    {
+        int Count = 1 + ((Block * 389) % 977);
+        int InputFrames = Count;
+
+        if((Block & 1) && (resample_GetOutputFrames(Context, InputFrames) <= DestFrames - Written))
+        {
+            Count = resample_GetOutputFrames(Context, InputFrames);
+        }
+        else
+        {
+            if(Count > DestFrames - Written)
+            {
+                Count = DestFrames - Written;
+            }
+
+            InputFrames = resample_GetInputFrames(Context, Count);
+        }
+
+        resample_Process(Context, Source + (Read * 2), InputFrames, Dest + (Written * 2), Count);
+
+        Read += InputFrames;
+        Written += Count;
+    }
+}
+
+//Scalar must turn a sine into the same sine at the output rate to within the quality's minimum SNR
+//Every level must then stay within one step of scalar on full scale noise, which overshoots and clamps
+//Sums run in a different order per level, so a value right on a rounding boundary may land either side
+internal bool32 bench_CheckResample(BENCH_RESAMPLE_CASE *Case, RESAMPLE_QUALITY Quality, SIMD_LEVEL Best)
+{
+    int DestFrames = Case->OutputRate / 2;
+    int SourceFrames = (int) (((int64) DestFrames * Case->InputRate) / Case->OutputRate) + RESAMPLE_MAX_TAPS + 1;
+
+    int16 *Source = (int16 *) malloc((size_t) SourceFrames * 2 * sizeof(int16));
+    int16 *Reference = (int16 *) malloc((size_t) DestFrames * 2 * sizeof(int16));
+    int16 *Dest = (int16 *) malloc((size_t) DestFrames * 2 * sizeof(int16));
+    void *Memory = malloc(resample_GetMemorySize(Case->InputRate, Case->OutputRate, Quality));
+
+    float64 Pi = 3.14159265358979323846;
+    for(int Frame = 0; Frame < SourceFrames; ++Frame)
+    {
+        int16 Value = (int16) lrint(16000.0 * sin((2.0 * Pi * 997.0 * (float64) Frame) / (float64) Case->InputRate));
+        Source[(Frame * 2)] = Value;
+        Source[(Frame * 2) + 1] = (int16) -Value;
+    }
+
+    RESAMPLE_CONTEXT Context;
+    resample_SelectKernels(SIMD_LEVEL_SCALAR);
+    resample_InitContext(&Context, Memory, Case->InputRate, Case->OutputRate, Quality);
+    bench_ResampleUneven(&Context, Source, Reference, DestFrames);
+
+    //The first outputs still read the silence before the sine
+    float64 Signal = 0.0;
+    float64 Error = 0.0;
+    for(int Frame = Context.TapCount; Frame < DestFrames; ++Frame)
+    {
+        float64 Expected = 16000.0 * sin((2.0 * Pi * 997.0 * (float64) Frame) / (float64) Case->OutputRate);
+        float64 Left = (float64) Reference[(Frame * 2)] - Expected;
+        float64 Right = (float64) Reference[(Frame * 2) + 1] + Expected;
+
+        Signal += 2.0 * Expected * Expected;
+        Error += (Left * Left) + (Right * Right);
+    }
+
+    float64 SNR = 10.0 * log10(Signal / ((Error > 0.0) ? Error : 1e-9));
+    bool32 Passed = true;
+
+    if(SNR < BenchResampleMinimumSNR[Quality])
+    {
+        fprintf(stderr, "resample: %s %s sine is only %0.1f dB above its error, needs %0.1f\n",
+                ResampleQualityNames[Quality], Case->Name, SNR, BenchResampleMinimumSNR[Quality]);
+        Passed = false;
+    }
+
+    uint32 Random = 0x85EBCA6B;
+    for(int Sample = 0; Sample < SourceFrames * 2; ++Sample)
+    {
+        Source[Sample] = (int16) (bench_NextRandom(&Random) >> 16);
+    }
+
+    resample_Reset(&Context);
+    bench_ResampleUneven(&Context, Source, Reference, DestFrames);
+
+    for(int Level = SIMD_LEVEL_SSE2; Level <= Best; ++Level)
+    {
+        resample_SelectKernels((SIMD_LEVEL) Level);
+        resample_Reset(&Context);
+        bench_ResampleUneven(&Context, Source, Dest, DestFrames);
+
+        int MaxDifference = 0;
+        for(int Sample = 0; Sample < DestFrames * 2; ++Sample)
+        {
+            int Difference = abs((int) Dest[Sample] - (int) Reference[Sample]);
+            if(Difference > MaxDifference)
+            {
+                MaxDifference = Difference;
+            }
+        }
+
+        if(MaxDifference > 1)
+        {
+            fprintf(stderr, "resample: %s %s %s is up to %d away from scalar\n", ResampleQualityNames[Quality], Case->Name, SimdLevelNames[Level], MaxDifference);
+            Passed = false;
+        }
+    }
+
+    free(Memory);
+    free(Dest);
+    free(Reference);
+    free(Source);
+
+    return Passed;
+}
+
+internal bool32 bench_RunResample(BENCH_SETTINGS *Settings, FILE *Output, BENCH_TIMINGS *Timings)
+{
+    local int16 Dest[BENCH_RESAMPLE_BLOCK * 2];
+
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+    bool32 Passed = true;
+
+    int16 *Source = (int16 *) malloc((size_t) BENCH_RESAMPLE_SOURCE_FRAMES * 2 * sizeof(int16));
+    uint32 Random = 0x27D4EB2F;
+    for(int Sample = 0; Sample < BENCH_RESAMPLE_SOURCE_FRAMES * 2; ++Sample)
+    {
+        Source[Sample] = (int16) (bench_NextRandom(&Random) >> 17);
+    }
+
+    for(int CaseIndex = 0; CaseIndex < (int) ArrayCount(BenchResampleCases); ++CaseIndex)
+    {
+        BENCH_RESAMPLE_CASE *Case = &BenchResampleCases[CaseIndex];
+
+        for(int Quality = 0; Quality < RESAMPLE_QUALITY_COUNT; ++Quality)
+        {
+            if(!bench_CheckResample(Case, (RESAMPLE_QUALITY) Quality, Best))
+            {
+                Passed = false;
+                continue;
+            }
+
+            RESAMPLE_CONTEXT Context;
+            void *Memory = malloc(resample_GetMemorySize(Case->InputRate, Case->OutputRate, (RESAMPLE_QUALITY) Quality));
+
+            char SizeName[64];
+            snprintf(SizeName, sizeof(SizeName), "%s_%s", ResampleQualityNames[Quality], Case->Name);
+
+            for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+            {
+                resample_SelectKernels((SIMD_LEVEL) Level);
+                resample_InitContext(&Context, Memory, Case->InputRate, Case->OutputRate, (RESAMPLE_QUALITY) Quality);
+
+                int Read = 0;
+                Timings->Count = 0;
+
+                for(int Repetition = -Settings->WarmUpCount; Repetition < Settings->RepetitionCount; ++Repetition)
+                {
+                    int InputFrames = resample_GetInputFrames(&Context, BENCH_RESAMPLE_BLOCK);
+                    if(Read + InputFrames > BENCH_RESAMPLE_SOURCE_FRAMES)
+                    {
+                        Read = 0;
+                    }
+
+                    uint64 StartCounter = bench_GetWallClock();
+                    uint64 StartCycleCount = __rdtsc();
+
+                    resample_Process(&Context, Source + (Read * 2), InputFrames, Dest, BENCH_RESAMPLE_BLOCK);
+
+                    uint64 EndCycleCount = __rdtsc();
+                    uint64 EndCounter = bench_GetWallClock();
+
+                    Read += InputFrames;
+
+                    if(Repetition >= 0)
+                    {
+                        Timings->NS[Timings->Count] = EndCounter - StartCounter;
+                        Timings->Cycles[Timings->Count] = EndCycleCount - StartCycleCount;
+                        ++Timings->Count;
+                    }
+                }
+
+                //Units are output frames, the input frames behind them are read once and the output written
+                uint64 InputFrames = ((uint64) BENCH_RESAMPLE_BLOCK * Case->InputRate) / Case->OutputRate;
+                bench_Report(Settings, Output, Timings, BENCH_FAMILY_RESAMPLE, (SIMD_LEVEL) Level, SizeName, BENCH_RESAMPLE_BLOCK,
+                             (InputFrames + BENCH_RESAMPLE_BLOCK) * AUDIO_CHANNEL_COUNT * sizeof(int16));
+            }
+
+            free(Memory);
+        }
+    }
+
+    resample_SelectKernels(SIMD_LEVEL_AUTO);
+    free(Source);
+
+    return Passed;
+}
+
+internal void bench_PrintUsage(char *ProgramName)
+{
+    fprintf(stderr, "Usage: %s [-k render|sound|copy|draw|asset|scale|capture|format|resample] [-w warmup] [-n repetitions] [-r samplerate] [-tag name] [-o results.tsv]\n"
+                    "\t-k runs one family, all run by default. -n is at most %d\n"
+                    "\t-k draw, -k scale, -k capture and -k format first check every level against scalar and exit 1 on a mismatch\n"
+                    "\t-k sound first checks a sound and a stream at another rate come out of the mixer at its rate\n"
+                    "\t-k resample first checks a sine against each quality's minimum SNR and every level within one step of scalar\n"
+                    "\t-k asset writes its source files and pack to the current directory and deletes them after\n"
+                    "\t-o appends rows, writing the header only to a new file\n"
+                    "\tcycles are TSC ticks, gb_per_s counts bytes read plus written by one repetition over its median time\n", ProgramName, BENCH_MAX_REPETITIONS);
+}
+
+int main(int ArgumentCount, char **Arguments)
+{
+    BENCH_SETTINGS Settings = {};
+    Settings.WarmUpCount = 5;
+    Settings.RepetitionCount = 50;
+    Settings.SampleRate = 48000;
+    Settings.Tag = (char *) "local";
+
+    bool32 FamilyChosen = false;
+
+    for(int ArgumentIndex = 1; ArgumentIndex < ArgumentCount; ArgumentIndex += 2)
+    {
+        char *Argument = Arguments[ArgumentIndex];
+        char *Value = (ArgumentIndex + 1 < ArgumentCount) ? Arguments[ArgumentIndex + 1] : 0;
+        bool32 Valid = true;
+
+        if(!Value)
+        {
+            Valid = false;
+        }
+        else if(strcmp(Argument, "-w") == 0)
+        {
+            Settings.WarmUpCount = atoi(Value);
+        }
+        else if(strcmp(Argument, "-n") == 0)
+        {
+            Settings.RepetitionCount = atoi(Value);
+        }
+        else if(strcmp(Argument, "-r") == 0)
+        {
+            Settings.SampleRate = atoi(Value);
+        }
+        else if(strcmp(Argument, "-tag") == 0)
+        {
+            Settings.Tag = Value;
+        }
+        else if(strcmp(Argument, "-o") == 0)
+        {
+            Settings.OutputPath = Value;
+        }
+        else if(strcmp(Argument, "-k") == 0)
+        {
+            Valid = false;
+            for(int Family = 0; Family < BENCH_FAMILY_COUNT; ++Family)
+            {
+                if(strcmp(Value, BenchFamilyNames[Family]) == 0)
+                {
+                    Settings.RunFamily[Family] = true;
+                    FamilyChosen = true;
+                    Valid = true;
+                }
+            }
+        }
+        else
+        {
+            Valid = false;
+        }
+
+        if(!Valid)
+        {
+            bench_PrintUsage(Arguments[0]);
+            return 1;
+        }
+    }
+
+    if((Settings.WarmUpCount < 0) || (Settings.RepetitionCount < 1) || (Settings.RepetitionCount > BENCH_MAX_REPETITIONS) || (Settings.SampleRate <= 0))
+    {
+        bench_PrintUsage(Arguments[0]);
+        return 1;
+    }
+
+    if(!FamilyChosen)
+    {
+        for(int Family = 0; Family < BENCH_FAMILY_COUNT; ++Family)
+        {
+            Settings.RunFamily[Family] = true;
+        }
+    }
+
+    FILE *Output = 0;
+
+    if(Settings.OutputPath)
+    {
+        Output = fopen(Settings.OutputPath, "ab");
+        if(!Output)
+        {
+            fprintf(stderr, "Can't open %s\n", Settings.OutputPath);
+            return 1;
+        }
+
+        fseek(Output, 0, SEEK_END);
+        if(ftell(Output) == 0)
+        {
+            bench_PrintHeader(Output);
+        }
+    }
+
+    local BENCH_TIMINGS Timings;
+    bench_PrintHeader(stdout);
+
+    bool32 Passed = true;
+
+    if(Settings.RunFamily[BENCH_FAMILY_RENDER])
+    {
+        bench_RunRender(&Settings, Output, &Timings);
+    }
+
+    if(Settings.RunFamily[BENCH_FAMILY_SOUND])
+    {
+        Passed = bench_RunSound(&Settings, Output, &Timings);
+    }
+
+    if(Settings.RunFamily[BENCH_FAMILY_COPY])
+    {
+        bench_RunCopy(&Settings, Output, &Timings);
+    }
+
+    if(Settings.RunFamily[BENCH_FAMILY_DRAW])
+    {
+        Passed = bench_RunDraw(&Settings, Output, &Timings) && Passed;
+    }
+
+    if(Settings.RunFamily[BENCH_FAMILY_ASSET])
+    {
+        Passed = bench_RunAsset(&Settings, Output, &Timings) && Passed;
+    }
+
+    if(Settings.RunFamily[BENCH_FAMILY_SCALE])
+    {
+        Passed = bench_RunScale(&Settings, Output, &Timings) && Passed;
+    }
+
+    if(Settings.RunFamily[BENCH_FAMILY_CAPTURE])
+    {
+        Passed = bench_RunCapture(&Settings, Output, &Timings) && Passed;
+    }
+
+    if(Settings.RunFamily[BENCH_FAMILY_FORMAT])
+    {
+        Passed = bench_RunFormat(&Settings, Output, &Timings) && Passed;
+    }
+
+    if(Settings.RunFamily[BENCH_FAMILY_RESAMPLE])
+    {
+        Passed = bench_RunResample(&Settings, Output, &Timings) && Passed;
+    }
+
+    if(Output)
+    {
+        fclose(Output);
+    }
+
+    return Passed ? 0 : 1;
+}
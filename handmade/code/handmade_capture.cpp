@@ -0,0 +1,384 @@
+#include "handmade_capture.h"
+
+//Active kernel, chosen from CPUID on first use unless the platform picked a level
+global capture_convert_rows *capture_ConvertRows_Kernel;
+
+//Reference math, the SIMD kernels do the same in 16 bit lanes
+//Y = ((66R + 129G + 25B + 128) >> 8) + 16 peaks at 56228, so it fits unsigned 16 bits
+//U and V carry their +128 as 128 << 8 before the shift, which keeps every sum between 0 and 61456
+internal uint8 capture_GetLuma(uint32 Pixel)
+{
+    uint32 R = (Pixel >> 16) & 0xFF;
+    uint32 G = (Pixel >> 8) & 0xFF;
+    uint32 B = Pixel & 0xFF;
+
+    return (uint8) ((((66 * R) + (129 * G) + (25 * B) + 128) >> 8) + 16);
+}
+
+internal void capture_GetChroma(uint8 *U, uint8 *V, uint32 A, uint32 B, uint32 C, uint32 D)
+{
+    uint32 Red = ((((A >> 16) & 0xFF) + ((B >> 16) & 0xFF) + ((C >> 16) & 0xFF) + ((D >> 16) & 0xFF)) + 2) >> 2;
+    uint32 Green = ((((A >> 8) & 0xFF) + ((B >> 8) & 0xFF) + ((C >> 8) & 0xFF) + ((D >> 8) & 0xFF)) + 2) >> 2;
+    uint32 Blue = (((A & 0xFF) + (B & 0xFF) + (C & 0xFF) + (D & 0xFF)) + 2) >> 2;
+
+    *U = (uint8) (((112 * Blue) - (74 * Green) - (38 * Red) + 32896) >> 8);
+    *V = (uint8) (((112 * Red) - (94 * Green) - (18 * Blue) + 32896) >> 8);
+}
+
+//Scalar from pixel X to the end of the row, X is always even
+internal void capture_ConvertTail(uint8 *LumaTop, uint8 *LumaBottom, uint8 *ChromaU, uint8 *ChromaV, uint32 *Top, uint32 *Bottom, int X, int Width)
+{
+    for(; X < Width; X += 2)
+    {
+        int Right = (X + 1 < Width) ? (X + 1) : X;
+
+        LumaTop[X] = capture_GetLuma(Top[X]);
+        LumaBottom[X] = capture_GetLuma(Bottom[X]);
+
+        if(Right != X)
+        {
+            LumaTop[Right] = capture_GetLuma(Top[Right]);
+            LumaBottom[Right] = capture_GetLuma(Bottom[Right]);
+        }
+
+        capture_GetChroma(&ChromaU[X / 2], &ChromaV[X / 2], Top[X], Top[Right], Bottom[X], Bottom[Right]);
+    }
+}
+
+internal CAPTURE_CONVERT_ROWS(capture_ConvertRows_Scalar)
+{
+    capture_ConvertTail(LumaTop, LumaBottom, ChromaU, ChromaV, Top, Bottom, 0, Width);
+}
+
+//8 pixels as three planes of 16 bit channels
+internal HANDMADE_TARGET_SSE2 void capture_UnpackPixels_SSE2(uint32 *Pixels, __m128i *R, __m128i *G, __m128i *B)
+{
+    __m128i Mask = _mm_set1_epi32(0xFF);
+    __m128i Low = _mm_loadu_si128((__m128i *) Pixels);
+    __m128i High = _mm_loadu_si128((__m128i *) (Pixels + 4));
+
+    *R = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(Low, 16), Mask), _mm_and_si128(_mm_srli_epi32(High, 16), Mask));
+    *G = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(Low, 8), Mask), _mm_and_si128(_mm_srli_epi32(High, 8), Mask));
+    *B = _mm_packs_epi32(_mm_and_si128(Low, Mask), _mm_and_si128(High, Mask));
+}
+
+internal HANDMADE_TARGET_SSE2 __m128i capture_GetLuma_SSE2(__m128i R, __m128i G, __m128i B)
+{
+    __m128i Sum = _mm_add_epi16(_mm_mullo_epi16(R, _mm_set1_epi16(66)), _mm_mullo_epi16(G, _mm_set1_epi16(129)));
+    Sum = _mm_add_epi16(Sum, _mm_add_epi16(_mm_mullo_epi16(B, _mm_set1_epi16(25)), _mm_set1_epi16(128)));
+
+    return _mm_add_epi16(_mm_srli_epi16(Sum, 8), _mm_set1_epi16(16));
+}
+
+//Top + Bottom, then neighbouring lanes summed into 32 bits and averaged, packed back to 16 bits with the 4 averages repeated
+internal HANDMADE_TARGET_SSE2 __m128i capture_AverageBlocks_SSE2(__m128i Top, __m128i Bottom)
+{
+    __m128i Sum = _mm_madd_epi16(_mm_add_epi16(Top, Bottom), _mm_set1_epi16(1));
+    __m128i Average = _mm_srli_epi32(_mm_add_epi32(Sum, _mm_set1_epi32(2)), 2);
+
+    return _mm_packs_epi32(Average, Average);
+}
+
+//Wraps modulo 2^16 on the way, the final sum is always in range so the bits come out right
+internal HANDMADE_TARGET_SSE2 __m128i capture_GetChroma_SSE2(__m128i Plus, __m128i MinusA, __m128i MinusB, int16 FactorA, int16 FactorB)
+{
+    __m128i Sum = _mm_mullo_epi16(Plus, _mm_set1_epi16(112));
+    Sum = _mm_sub_epi16(Sum, _mm_mullo_epi16(MinusA, _mm_set1_epi16(FactorA)));
+    Sum = _mm_sub_epi16(Sum, _mm_mullo_epi16(MinusB, _mm_set1_epi16(FactorB)));
+    Sum = _mm_add_epi16(Sum, _mm_set1_epi16((int16) 32896));
+
+    return _mm_srli_epi16(Sum, 8);
+}
+
+internal HANDMADE_TARGET_SSE2 CAPTURE_CONVERT_ROWS(capture_ConvertRows_SSE2)
+{
+    int X = 0;
+
+    for(; X + 8 <= Width; X += 8)
+    {
+        __m128i TopR, TopG, TopB;
+        __m128i BottomR, BottomG, BottomB;
+        capture_UnpackPixels_SSE2(Top + X, &TopR, &TopG, &TopB);
+        capture_UnpackPixels_SSE2(Bottom + X, &BottomR, &BottomG, &BottomB);
+
+        __m128i LumaT = capture_GetLuma_SSE2(TopR, TopG, TopB);
+        __m128i LumaB = capture_GetLuma_SSE2(BottomR, BottomG, BottomB);
+        _mm_storel_epi64((__m128i *) (LumaTop + X), _mm_packus_epi16(LumaT, LumaT));
+        _mm_storel_epi64((__m128i *) (LumaBottom + X), _mm_packus_epi16(LumaB, LumaB));
+
+        __m128i R = capture_AverageBlocks_SSE2(TopR, BottomR);
+        __m128i G = capture_AverageBlocks_SSE2(TopG, BottomG);
+        __m128i B = capture_AverageBlocks_SSE2(TopB, BottomB);
+
+        __m128i U = capture_GetChroma_SSE2(B, G, R, 74, 38);
+        __m128i V = capture_GetChroma_SSE2(R, G, B, 94, 18);
+        *(int32 *) (ChromaU + (X / 2)) = _mm_cvtsi128_si32(_mm_packus_epi16(U, U));
+        *(int32 *) (ChromaV + (X / 2)) = _mm_cvtsi128_si32(_mm_packus_epi16(V, V));
+    }
+
+    capture_ConvertTail(LumaTop, LumaBottom, ChromaU, ChromaV, Top, Bottom, X, Width);
+}
+
+//16 pixels, packs interleaves the 128 bit lanes so the quadwords are put back in pixel order
+internal HANDMADE_TARGET_AVX2 void capture_UnpackPixels_AVX2(uint32 *Pixels, __m256i *R, __m256i *G, __m256i *B)
+{
+    __m256i Mask = _mm256_set1_epi32(0xFF);
+    __m256i Low = _mm256_loadu_si256((__m256i *) Pixels);
+    __m256i High = _mm256_loadu_si256((__m256i *) (Pixels + 8));
+
+    *R = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(Low, 16), Mask), _mm256_and_si256(_mm256_srli_epi32(High, 16), Mask));
+    *G = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(Low, 8), Mask), _mm256_and_si256(_mm256_srli_epi32(High, 8), Mask));
+    *B = _mm256_packs_epi32(_mm256_and_si256(Low, Mask), _mm256_and_si256(High, Mask));
+
+    *R = _mm256_permute4x64_epi64(*R, _MM_SHUFFLE(3, 1, 2, 0));
+    *G = _mm256_permute4x64_epi64(*G, _MM_SHUFFLE(3, 1, 2, 0));
+    *B = _mm256_permute4x64_epi64(*B, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+internal HANDMADE_TARGET_AVX2 __m256i capture_GetLuma_AVX2(__m256i R, __m256i G, __m256i B)
+{
+    __m256i Sum = _mm256_add_epi16(_mm256_mullo_epi16(R, _mm256_set1_epi16(66)), _mm256_mullo_epi16(G, _mm256_set1_epi16(129)));
+    Sum = _mm256_add_epi16(Sum, _mm256_add_epi16(_mm256_mullo_epi16(B, _mm256_set1_epi16(25)), _mm256_set1_epi16(128)));
+
+    return _mm256_add_epi16(_mm256_srli_epi16(Sum, 8), _mm256_set1_epi16(16));
+}
+
+//8 averages, the first 4 in the low lane and the last 4 in the high lane, each repeated
+internal HANDMADE_TARGET_AVX2 __m256i capture_AverageBlocks_AVX2(__m256i Top, __m256i Bottom)
+{
+    __m256i Sum = _mm256_madd_epi16(_mm256_add_epi16(Top, Bottom), _mm256_set1_epi16(1));
+    __m256i Average = _mm256_srli_epi32(_mm256_add_epi32(Sum, _mm256_set1_epi32(2)), 2);
+
+    return _mm256_packs_epi32(Average, Average);
+}
+
+internal HANDMADE_TARGET_AVX2 __m256i capture_GetChroma_AVX2(__m256i Plus, __m256i MinusA, __m256i MinusB, int16 FactorA, int16 FactorB)
+{
+    __m256i Sum = _mm256_mullo_epi16(Plus, _mm256_set1_epi16(112));
+    Sum = _mm256_sub_epi16(Sum, _mm256_mullo_epi16(MinusA, _mm256_set1_epi16(FactorA)));
+    Sum = _mm256_sub_epi16(Sum, _mm256_mullo_epi16(MinusB, _mm256_set1_epi16(FactorB)));
+    Sum = _mm256_add_epi16(Sum, _mm256_set1_epi16((int16) 32896));
+
+    return _mm256_srli_epi16(Sum, 8);
+}
+
+internal HANDMADE_TARGET_AVX2 CAPTURE_CONVERT_ROWS(capture_ConvertRows_AVX2)
+{
+    //First dword of each lane holds 4 chroma bytes
+    __m256i ChromaOrder = _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+    int X = 0;
+
+    for(; X + 16 <= Width; X += 16)
+    {
+        __m256i TopR, TopG, TopB;
+        __m256i BottomR, BottomG, BottomB;
+        capture_UnpackPixels_AVX2(Top + X, &TopR, &TopG, &TopB);
+        capture_UnpackPixels_AVX2(Bottom + X, &BottomR, &BottomG, &BottomB);
+
+        __m256i LumaT = capture_GetLuma_AVX2(TopR, TopG, TopB);
+        __m256i LumaB = capture_GetLuma_AVX2(BottomR, BottomG, BottomB);
+        LumaT = _mm256_permute4x64_epi64(_mm256_packus_epi16(LumaT, LumaT), _MM_SHUFFLE(3, 1, 2, 0));
+        LumaB = _mm256_permute4x64_epi64(_mm256_packus_epi16(LumaB, LumaB), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i *) (LumaTop + X), _mm256_castsi256_si128(LumaT));
+        _mm_storeu_si128((__m128i *) (LumaBottom + X), _mm256_castsi256_si128(LumaB));
+
+        __m256i R = capture_AverageBlocks_AVX2(TopR, BottomR);
+        __m256i G = capture_AverageBlocks_AVX2(TopG, BottomG);
+        __m256i B = capture_AverageBlocks_AVX2(TopB, BottomB);
+
+        __m256i U = capture_GetChroma_AVX2(B, G, R, 74, 38);
+        __m256i V = capture_GetChroma_AVX2(R, G, B, 94, 18);
+        U = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(U, U), ChromaOrder);
+        V = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(V, V), ChromaOrder);
+        _mm_storel_epi64((__m128i *) (ChromaU + (X / 2)), _mm256_castsi256_si128(U));
+        _mm_storel_epi64((__m128i *) (ChromaV + (X / 2)), _mm256_castsi256_si128(V));
+    }
+
+    capture_ConvertTail(LumaTop, LumaBottom, ChromaU, ChromaV, Top, Bottom, X, Width);
+}
+
+internal SIMD_LEVEL capture_SelectKernels(SIMD_LEVEL Requested)
+{
+    SIMD_LEVEL Selected = cpu_SelectSimdLevel(Requested);
+
+    switch(Selected)
+    {
+        case SIMD_LEVEL_AVX2:
+        {
+            capture_ConvertRows_Kernel = capture_ConvertRows_AVX2;
+            break;
+        }
+
+        case SIMD_LEVEL_SSE2:
+        {
+            capture_ConvertRows_Kernel = capture_ConvertRows_SSE2;
+            break;
+        }
+
+        default:
+        {
+            capture_ConvertRows_Kernel = capture_ConvertRows_Scalar;
+            break;
+        }
+    }
+
+    return Selected;
+}
+
+//Full size luma then quarter size U and V, rounded up for odd sizes
+internal size_t capture_GetPlaneSize(int Width, int Height)
+{
+    size_t ChromaSize = (size_t) ((Width + 1) / 2) * (size_t) ((Height + 1) / 2);
+    return ((size_t) Width * (size_t) Height) + (ChromaSize * 2);
+}
+
+internal size_t capture_GetMemorySize(int Width, int Height, int SlotCount)
+{
+    return ((size_t) SlotCount * (size_t) Width * (size_t) Height * 4) + capture_GetPlaneSize(Width, Height);
+}
+
+//Planes must be capture_GetPlaneSize bytes, an odd Height repeats the last row into the last chroma row
+internal void capture_ConvertFrame(uint8 *Planes, void *Pixels, int Width, int Height, int Pitch)
+{
+    if(!capture_ConvertRows_Kernel)
+    {
+        capture_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+
+    int ChromaWidth = (Width + 1) / 2;
+    uint8 *Luma = Planes;
+    uint8 *ChromaU = Luma + ((size_t) Width * (size_t) Height);
+    uint8 *ChromaV = ChromaU + ((size_t) ChromaWidth * (size_t) ((Height + 1) / 2));
+
+    for(int Y = 0; Y < Height; Y += 2)
+    {
+        int BottomY = (Y + 1 < Height) ? (Y + 1) : Y;
+        uint32 *Top = (uint32 *) ((uint8 *) Pixels + ((size_t) Y * (size_t) Pitch));
+        uint32 *Bottom = (uint32 *) ((uint8 *) Pixels + ((size_t) BottomY * (size_t) Pitch));
+
+        capture_ConvertRows_Kernel(Luma + ((size_t) Y * (size_t) Width), Luma + ((size_t) BottomY * (size_t) Width),
+                                   ChromaU + ((size_t) (Y / 2) * (size_t) ChromaWidth), ChromaV + ((size_t) (Y / 2) * (size_t) ChromaWidth),
+                                   Top, Bottom, Width);
+    }
+}
+
+//Memory must be capture_GetMemorySize bytes, SlotCount a power of two up to CAPTURE_MAX_SLOTS
+//Writes the stream header, the platform then starts a thread running capture_WriterLoop
+internal bool32 capture_Begin(CAPTURE_QUEUE *Queue, void *Memory, char *Path, int Width, int Height, int SlotCount, int FrameRate,
+                              void *SemaphoreHandle, jobs_signal_semaphore *SignalSemaphore, jobs_wait_semaphore *WaitSemaphore)
+{
+    *Queue = {};
+
+    if(!Memory || (Width <= 0) || (Height <= 0) || (SlotCount < 1) || (SlotCount > CAPTURE_MAX_SLOTS) || (SlotCount & (SlotCount - 1)))
+    {
+        return false;
+    }
+
+    Queue->File = fopen(Path, "wb");
+    if(!Queue->File)
+    {
+        return false;
+    }
+
+    //C420jpeg is chroma sited between the 4 pixels it averages
+    fprintf(Queue->File, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", Width, Height, FrameRate);
+
+    Queue->Width = Width;
+    Queue->Height = Height;
+    Queue->SlotCount = SlotCount;
+    Queue->FrameRate = FrameRate;
+    Queue->SlotSize = (size_t) Width * (size_t) Height * 4;
+    Queue->Slots = (uint8 *) Memory;
+    Queue->Planes = Queue->Slots + (Queue->SlotSize * (size_t) SlotCount);
+    Queue->SemaphoreHandle = SemaphoreHandle;
+    Queue->SignalSemaphore = SignalSemaphore;
+    Queue->WaitSemaphore = WaitSemaphore;
+    Queue->Running = true;
+
+    return true;
+}
+
+//Frame thread: one copy into a free slot, or a dropped frame if the writer still holds every slot
+//A frame of a different size than the stream is dropped as well
+internal bool32 capture_SubmitFrame(CAPTURE_QUEUE *Queue, HANDMADE_OFFSCREEN_BUFFER *Frame)
+{
+    int64 WriteIndex = Queue->WriteIndex;
+
+    if(((WriteIndex - atomic_LoadInt64(&Queue->ReadIndex)) >= Queue->SlotCount) ||
+       (Frame->BitmapWidth != Queue->Width) || (Frame->BitmapHeight != Queue->Height))
+    {
+        ++Queue->DroppedCount;
+        return false;
+    }
+
+    uint8 *Slot = Queue->Slots + (Queue->SlotSize * (size_t) (WriteIndex & (Queue->SlotCount - 1)));
+    size_t RowSize = (size_t) Queue->Width * 4;
+
+    for(int Y = 0; Y < Queue->Height; ++Y)
+    {
+        memcpy(Slot + (RowSize * (size_t) Y), (uint8 *) Frame->BitmapMemory + ((size_t) Y * (size_t) Frame->Pitch), RowSize);
+    }
+
+    atomic_StoreInt64(&Queue->WriteIndex, WriteIndex + 1);
+    Queue->SignalSemaphore(Queue->SemaphoreHandle, 1);
+
+    return true;
+}
+
+//Writer thread: converts and appends every submitted frame, returns once capture_End was called and the pool is drained
+//A failed write drops frames from then on but keeps freeing slots, so the frame thread sees the same behaviour either way
+internal void capture_WriterLoop(CAPTURE_QUEUE *Queue)
+{
+    size_t PlaneSize = capture_GetPlaneSize(Queue->Width, Queue->Height);
+
+    for(;;)
+    {
+        //Read before draining, so every frame submitted before capture_End is seen by the last pass
+        bool32 Running = Queue->Running;
+        CompletePreviousReadsBeforeFutureReads;
+
+        int64 ReadIndex = Queue->ReadIndex;
+        int64 WriteIndex = atomic_LoadInt64(&Queue->WriteIndex);
+
+        for(; ReadIndex < WriteIndex; ++ReadIndex)
+        {
+            if(!Queue->WriteFailed)
+            {
+                uint8 *Slot = Queue->Slots + (Queue->SlotSize * (size_t) (ReadIndex & (Queue->SlotCount - 1)));
+                capture_ConvertFrame(Queue->Planes, Slot, Queue->Width, Queue->Height, Queue->Width * 4);
+
+                if((fwrite("FRAME\n", 1, 6, Queue->File) == 6) && (fwrite(Queue->Planes, 1, PlaneSize, Queue->File) == PlaneSize))
+                {
+                    ++Queue->WrittenCount;
+                }
+                else
+                {
+                    Queue->WriteFailed = true;
+                }
+            }
+
+            atomic_StoreInt64(&Queue->ReadIndex, ReadIndex + 1);
+        }
+
+        if(!Running)
+        {
+            break;
+        }
+
+        Queue->WaitSemaphore(Queue->SemaphoreHandle);
+    }
+
+    if(fclose(Queue->File) != 0)
+    {
+        Queue->WriteFailed = true;
+    }
+    Queue->File = 0;
+}
+
+//Frame thread, after its last submit, then the platform joins the writer before reading the counts
+internal void capture_End(CAPTURE_QUEUE *Queue)
+{
+    CompletePreviousWritesBeforeFutureWrites;
+    Queue->Running = false;
+    Queue->SignalSemaphore(Queue->SemaphoreHandle, 1);
+}
@@ -0,0 +1,53 @@
+#if !defined(HANDMADE_CAPTURE_H)
+
+//Frame capture to a Y4M file, raw YUV 4:2:0 any player or ffmpeg reads, for comparing runs frame by frame
+//The frame thread copies each presented frame into a free slot of a fixed pool and moves on, it never waits
+//A writer thread the platform owns converts slots to YUV and appends them, when it falls behind frames are dropped and counted
+//Include after stdio.h and string.h, like handmade_debug.cpp
+
+#define CAPTURE_MAX_SLOTS 64
+
+//Two source rows to their luma rows and one row of each chroma plane, BT.601 studio range with every 2x2 block averaged
+//Pixels are 0xXXRRGGBB like the backbuffer, an odd Width repeats the last pixel into the last chroma sample
+#define CAPTURE_CONVERT_ROWS(name) void name(uint8 *LumaTop, uint8 *LumaBottom, uint8 *ChromaU, uint8 *ChromaV, uint32 *Top, uint32 *Bottom, int Width)
+typedef CAPTURE_CONVERT_ROWS(capture_convert_rows);
+
+//Single producer, single consumer, indices count frames ever submitted or written like AUDIO_RING_BUFFER
+struct CAPTURE_QUEUE
+{
+    int Width;
+    int Height;
+    int SlotCount; //Must be a power of two
+    int FrameRate;
+    size_t SlotSize;
+    uint8 *Slots; //SlotCount frames of Width * 4 byte rows
+    uint8 *Planes; //Y, U then V of the frame being written, writer only
+    FILE *File;
+    void *SemaphoreHandle; //Signalled once per submitted frame
+    jobs_signal_semaphore *SignalSemaphore;
+    jobs_wait_semaphore *WaitSemaphore;
+    bool32 volatile Running;
+    uint8 PadHeader[44];
+
+    int64 volatile WriteIndex; //Frame thread only
+    int64 DroppedCount; //Frames that found every slot full
+    uint8 PadWrite[48];
+
+    int64 volatile ReadIndex; //Writer only
+    int64 WrittenCount; //Frames that reached the file
+    bool32 WriteFailed;
+    uint8 PadRead[44];
+};
+
+internal SIMD_LEVEL capture_SelectKernels(SIMD_LEVEL Requested);
+internal size_t capture_GetPlaneSize(int Width, int Height);
+internal size_t capture_GetMemorySize(int Width, int Height, int SlotCount);
+internal void capture_ConvertFrame(uint8 *Planes, void *Pixels, int Width, int Height, int Pitch);
+internal bool32 capture_Begin(CAPTURE_QUEUE *Queue, void *Memory, char *Path, int Width, int Height, int SlotCount, int FrameRate,
+                              void *SemaphoreHandle, jobs_signal_semaphore *SignalSemaphore, jobs_wait_semaphore *WaitSemaphore);
+internal bool32 capture_SubmitFrame(CAPTURE_QUEUE *Queue, HANDMADE_OFFSCREEN_BUFFER *Frame);
+internal void capture_WriterLoop(CAPTURE_QUEUE *Queue);
+internal void capture_End(CAPTURE_QUEUE *Queue);
+
+#define HANDMADE_CAPTURE_H
+#endif
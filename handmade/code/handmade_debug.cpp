@@ -0,0 +1,550 @@
+#include "handmade_debug.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//Platform side of the profiler: flips the thread tables once a frame, rolls the finished events up into a call tree
+//and optionally streams every block to a Chrome trace (chrome://tracing or ui.perfetto.dev)
+
+#define DEBUG_MAX_NODES 1024
+#define DEBUG_MAX_DEPTH 64
+#define DEBUG_MAX_NAME 64
+
+//Blocks with the same name under the same parent share a node, whichever thread ran them
+struct DEBUG_NODE
+{
+    char Name[DEBUG_MAX_NAME];
+    int Parent;
+    int FirstChild;
+    int NextSibling;
+    uint64 Cycles; //Includes children
+    uint64 HitCount;
+};
+
+//Accumulates until the platform resets it, node 0 is the root every thread's outermost blocks hang off
+struct DEBUG_COLLATION
+{
+    DEBUG_NODE Nodes[DEBUG_MAX_NODES];
+    int NodeCount;
+    int FrameCount;
+    uint64 DroppedEventCount; //Thread filled its half before the frame ended
+    uint64 UnmatchedEventCount; //Block straddled a frame flip or nested deeper than DEBUG_MAX_DEPTH
+};
+
+struct DEBUG_TRACE
+{
+    FILE *File;
+    uint64 EventCount;
+    uint64 BaseClock;
+    float64 MicrosecondsPerCycle;
+};
+
+internal void debug_ResetCollation(DEBUG_COLLATION *Collation)
+{
+    Collation->NodeCount = 1;
+    Collation->FrameCount = 0;
+    Collation->DroppedEventCount = 0;
+    Collation->UnmatchedEventCount = 0;
+
+    DEBUG_NODE *Root = &Collation->Nodes[0];
+    *Root = {};
+    Root->Parent = -1;
+    Root->FirstChild = -1;
+    Root->NextSibling = -1;
+}
+
+//Returns -1 once the node table is full
+internal int debug_GetChildNode(DEBUG_COLLATION *Collation, int Parent, const char *Name)
+{
+    int Child = Collation->Nodes[Parent].FirstChild;
+
+    while(Child >= 0)
+    {
+        if(strncmp(Collation->Nodes[Child].Name, Name, DEBUG_MAX_NAME - 1) == 0)
+        {
+            return Child;
+        }
+
+        Child = Collation->Nodes[Child].NextSibling;
+    }
+
+    if(Collation->NodeCount == DEBUG_MAX_NODES)
+    {
+        return -1;
+    }
+
+    Child = Collation->NodeCount++;
+
+    DEBUG_NODE *Node = &Collation->Nodes[Child];
+    *Node = {};
+    strncpy(Node->Name, Name, DEBUG_MAX_NAME - 1);
+    Node->Parent = Parent;
+    Node->FirstChild = -1;
+    Node->NextSibling = Collation->Nodes[Parent].FirstChild;
+    Collation->Nodes[Parent].FirstChild = Child;
+
+    return Child;
+}
+
+internal bool32 debug_BeginTrace(DEBUG_TRACE *Trace, char *Path, float64 MicrosecondsPerCycle)
+{
+    *Trace = {};
+    Trace->File = fopen(Path, "wb");
+
+    if(!Trace->File)
+    {
+        return false;
+    }
+
+    Trace->BaseClock = __rdtsc();
+    Trace->MicrosecondsPerCycle = MicrosecondsPerCycle;
+    fprintf(Trace->File, "{\"traceEvents\":[\n");
+
+    return true;
+}
+
+internal void debug_EndTrace(DEBUG_TRACE *Trace)
+{
+    if(Trace->File)
+    {
+        fprintf(Trace->File, "\n]}\n");
+        fclose(Trace->File);
+        Trace->File = 0;
+    }
+}
+
+//Complete ("X") events, one per matched block
+internal void debug_WriteTraceEvent(DEBUG_TRACE *Trace, const char *Name, uint32 ThreadIndex, uint64 BeginClock, uint64 EndClock)
+{
+    if(BeginClock < Trace->BaseClock)
+    {
+        return;
+    }
+
+    float64 Timestamp = (float64) (BeginClock - Trace->BaseClock) * Trace->MicrosecondsPerCycle;
+    float64 Duration = (float64) (EndClock - BeginClock) * Trace->MicrosecondsPerCycle;
+
+    fprintf(Trace->File, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            Trace->EventCount ? ",\n" : "", Name, ThreadIndex, Timestamp, Duration);
+    ++Trace->EventCount;
+}
+
+//Call once a frame from one thread, after the frame's jobs are done. Trace may be 0
+//Threads still logging land in the other half and are collated next frame
+internal void debug_EndFrame(DEBUG_TABLE *Table, DEBUG_COLLATION *Collation, DEBUG_TRACE *Trace)
+{
+    uint32 NewEventArray = !Table->CurrentEventArray;
+    Table->CurrentEventArray = NewEventArray;
+
+    uint32 ThreadCount = Table->ThreadCount;
+    if(ThreadCount > DEBUG_MAX_THREADS)
+    {
+        ThreadCount = DEBUG_MAX_THREADS;
+    }
+
+    for(uint32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        DEBUG_THREAD *Thread = &Table->Threads[ThreadIndex];
+
+        if(!Thread->ThreadID)
+        {
+            continue;
+        }
+
+        uint64 ArrayIndex_EventIndex = atomic_ExchangeUInt64(&Thread->EventArrayIndex_EventIndex, (uint64) NewEventArray << 32);
+        DEBUG_EVENT *Events = Thread->Events[(ArrayIndex_EventIndex >> 32) & 1];
+        uint32 EventCount = (uint32) ArrayIndex_EventIndex;
+
+        if(EventCount > DEBUG_MAX_EVENTS)
+        {
+            Collation->DroppedEventCount += EventCount - DEBUG_MAX_EVENTS;
+            EventCount = DEBUG_MAX_EVENTS;
+        }
+
+        //Open blocks on this thread, innermost last
+        int OpenNodes[DEBUG_MAX_DEPTH];
+        DEBUG_EVENT *OpenEvents[DEBUG_MAX_DEPTH];
+        int Depth = 0;
+
+        for(uint32 EventIndex = 0; EventIndex < EventCount; ++EventIndex)
+        {
+            DEBUG_EVENT *Event = &Events[EventIndex];
+
+            if(Event->Type == DEBUG_EVENT_BEGIN_BLOCK)
+            {
+                int Parent = Depth ? OpenNodes[Depth - 1] : 0;
+                int Node = (Depth < DEBUG_MAX_DEPTH) ? debug_GetChildNode(Collation, Parent, Event->Name) : -1;
+
+                if(Node >= 0)
+                {
+                    OpenNodes[Depth] = Node;
+                    OpenEvents[Depth] = Event;
+                    ++Depth;
+                }
+                else
+                {
+                    ++Collation->UnmatchedEventCount;
+                }
+            }
+            else if(Depth && (OpenEvents[Depth - 1]->Name == Event->Name))
+            {
+                --Depth;
+                DEBUG_NODE *Node = &Collation->Nodes[OpenNodes[Depth]];
+                Node->Cycles += Event->Clock - OpenEvents[Depth]->Clock;
+                ++Node->HitCount;
+
+                if(Trace && Trace->File)
+                {
+                    debug_WriteTraceEvent(Trace, Event->Name, ThreadIndex, OpenEvents[Depth]->Clock, Event->Clock);
+                }
+            }
+            else
+            {
+                ++Collation->UnmatchedEventCount;
+            }
+        }
+
+        Collation->UnmatchedEventCount += Depth;
+    }
+
+    ++Collation->FrameCount;
+}
+
+//Appends to Dest, stops writing once it is full
+internal int debug_FormatNode(DEBUG_COLLATION *Collation, int NodeIndex, int Indent, char *Dest, int DestSize, int Used)
+{
+    DEBUG_NODE *Node = &Collation->Nodes[NodeIndex];
+    float64 FrameCount = (float64) Collation->FrameCount;
+
+    uint64 ChildCycles = 0;
+    for(int Child = Node->FirstChild; Child >= 0; Child = Collation->Nodes[Child].NextSibling)
+    {
+        ChildCycles += Collation->Nodes[Child].Cycles;
+    }
+
+    if(Used < DestSize)
+    {
+        Used += snprintf(Dest + Used, DestSize - Used, "%*s%-*s %12.0f cycles/frame\t %12.0f self\t %8.2f hits/frame\t %10.0f cycles/hit\n",
+                         Indent * 2, "", 40 - (Indent * 2), Node->Name, (float64) Node->Cycles / FrameCount, (float64) (Node->Cycles - ChildCycles) / FrameCount,
+                         (float64) Node->HitCount / FrameCount, Node->HitCount ? ((float64) Node->Cycles / (float64) Node->HitCount) : 0.0);
+    }
+
+    for(int Child = Node->FirstChild; Child >= 0; Child = Collation->Nodes[Child].NextSibling)
+    {
+        Used = debug_FormatNode(Collation, Child, Indent + 1, Dest, DestSize, Used);
+    }
+
+    return Used;
+}
+
+//Call tree averaged over every frame since the last reset, one line per node
+internal void debug_FormatCollation(DEBUG_COLLATION *Collation, char *Dest, int DestSize)
+{
+    int Used = 0;
+    Dest[0] = 0;
+
+    if(Collation->FrameCount == 0)
+    {
+        return;
+    }
+
+    for(int Child = Collation->Nodes[0].FirstChild; Child >= 0; Child = Collation->Nodes[Child].NextSibling)
+    {
+        Used = debug_FormatNode(Collation, Child, 0, Dest, DestSize, Used);
+    }
+
+    if((Used < DestSize) && (Collation->DroppedEventCount || Collation->UnmatchedEventCount))
+    {
+        snprintf(Dest + Used, DestSize - Used, "%llu events dropped, %llu unmatched\n",
+                 (unsigned long long) Collation->DroppedEventCount, (unsigned long long) Collation->UnmatchedEventCount);
+    }
+}
+
+//Platform side of the logger: one writer thread drains every thread's ring, formats the records and hands each line to Write
+//Include after handmade_jobs.h, the writer sleeps on a platform semaphore the frame loop signals once a frame
+
+//Text is one formatted line ending in a newline and a terminator, Length leaves the terminator out
+#define DEBUG_LOG_WRITE(name) void name(void *Context, uint32 Level, char *Text, int Length)
+typedef DEBUG_LOG_WRITE(debug_log_write);
+
+#define DEBUG_LOG_MAX_LINE 1024
+
+global const char *DebugLogLevelNames[DEBUG_LOG_LEVEL_COUNT] = {"error", "warning", "info", "message"};
+global uint32 DebugLogSessionCount;
+
+struct DEBUG_LOG_WRITER
+{
+    DEBUG_LOG *Log;
+    debug_log_write *Write;
+    void *WriteContext;
+    void *SemaphoreHandle;
+    jobs_signal_semaphore *SignalSemaphore;
+    jobs_wait_semaphore *WaitSemaphore;
+    bool32 volatile Running;
+    uint64 BaseClock;
+    float64 MillisecondsPerCycle;
+    int64 WrittenCount; //Writer only
+};
+
+//Log must be zeroed, the platform points GlobalDebugLog and HANDMADE_PLATFORM at it once this returns
+internal void debug_BeginLog(DEBUG_LOG_WRITER *Writer, DEBUG_LOG *Log, float64 MicrosecondsPerCycle, debug_log_write *Write, void *WriteContext,
+                             void *SemaphoreHandle, jobs_signal_semaphore *SignalSemaphore, jobs_wait_semaphore *WaitSemaphore)
+{
+    *Writer = {};
+    Writer->Log = Log;
+    Writer->Write = Write;
+    Writer->WriteContext = WriteContext;
+    Writer->SemaphoreHandle = SemaphoreHandle;
+    Writer->SignalSemaphore = SignalSemaphore;
+    Writer->WaitSemaphore = WaitSemaphore;
+    Writer->Running = true;
+    Writer->BaseClock = __rdtsc();
+    Writer->MillisecondsPerCycle = MicrosecondsPerCycle / 1000.0;
+
+    Log->Session = ++DebugLogSessionCount;
+}
+
+//Conversions are formatted one at a time with snprintf from the stored type, length modifiers in Format are replaced to match it
+//Returns the length written, Dest always ends up terminated
+internal int debug_FormatLogText(DEBUG_LOG_RECORD *Record, char *Dest, int DestSize)
+{
+    int Used = 0;
+    int ArgIndex = 0;
+
+    for(const char *At = Record->Format; *At && (Used < (DestSize - 1)); )
+    {
+        if((At[0] != '%') || (At[1] == '%'))
+        {
+            Dest[Used++] = *At;
+            At += (At[0] == '%') ? 2 : 1;
+            continue;
+        }
+
+        //Flags, width and precision are kept, * is not supported
+        char Spec[32];
+        int SpecLength = 0;
+        Spec[SpecLength++] = *At++;
+
+        while(*At && strchr("-+ #0123456789.", *At) && (SpecLength < (int) sizeof(Spec) - 4))
+        {
+            Spec[SpecLength++] = *At++;
+        }
+
+        while(*At && strchr("hlLqjzt", *At))
+        {
+            ++At;
+        }
+
+        char Conversion = *At;
+        if(!Conversion)
+        {
+            break;
+        }
+        ++At;
+
+        if(ArgIndex >= Record->ArgCount)
+        {
+            Used += snprintf(Dest + Used, DestSize - Used, "<missing>");
+            Used = (Used < DestSize) ? Used : (DestSize - 1);
+            continue;
+        }
+
+        uint32 Type = Record->ArgTypes[ArgIndex];
+        uint64 Value = Record->Args[ArgIndex];
+        ++ArgIndex;
+
+        union
+        {
+            uint64 Bits;
+            float64 Float;
+        } Convert;
+        Convert.Bits = Value;
+
+        int Written = 0;
+
+        if(strchr("diouxXc", Conversion))
+        {
+            //Unsigned conversions of a 32 bit argument see only its own bits, as printf would
+            if((Type == DEBUG_LOG_ARG_INT32) && (Conversion != 'd') && (Conversion != 'i'))
+            {
+                Value &= 0xFFFFFFFF;
+            }
+            else if(Type == DEBUG_LOG_ARG_FLOAT)
+            {
+                Value = (uint64) (int64) Convert.Float;
+            }
+
+            if(Conversion == 'c')
+            {
+                Spec[SpecLength++] = 'c';
+                Spec[SpecLength] = 0;
+                Written = snprintf(Dest + Used, DestSize - Used, Spec, (int) Value);
+            }
+            else
+            {
+                Spec[SpecLength++] = 'l';
+                Spec[SpecLength++] = 'l';
+                Spec[SpecLength++] = Conversion;
+                Spec[SpecLength] = 0;
+                Written = snprintf(Dest + Used, DestSize - Used, Spec, (unsigned long long) Value);
+            }
+        }
+        else if(strchr("fFeEgGaA", Conversion))
+        {
+            Spec[SpecLength++] = Conversion;
+            Spec[SpecLength] = 0;
+            Written = snprintf(Dest + Used, DestSize - Used, Spec, (Type == DEBUG_LOG_ARG_FLOAT) ? Convert.Float : (float64) (int64) Value);
+        }
+        else if(Conversion == 's')
+        {
+            Spec[SpecLength++] = 's';
+            Spec[SpecLength] = 0;
+            Written = snprintf(Dest + Used, DestSize - Used, Spec, (Type == DEBUG_LOG_ARG_STRING) ? (Record->Text + Value) : "(not a string)");
+        }
+        else
+        {
+            Spec[SpecLength++] = 'p';
+            Spec[SpecLength] = 0;
+            Written = snprintf(Dest + Used, DestSize - Used, Spec, (void *) (size_t) Value);
+        }
+
+        Used += (Written > 0) ? Written : 0;
+        Used = (Used < DestSize) ? Used : (DestSize - 1);
+    }
+
+    Dest[Used] = 0;
+    return Used;
+}
+
+//Time since debug_BeginLog, slot index of the thread and level in front, then the text, then strerror for errors
+internal int debug_FormatLogRecord(DEBUG_LOG_WRITER *Writer, uint32 ThreadIndex, DEBUG_LOG_RECORD *Record, char *Dest, int DestSize)
+{
+    int Used = 0;
+
+    if(Record->Level != DEBUG_LOG_MESSAGE)
+    {
+        float64 Milliseconds = (Record->Clock > Writer->BaseClock) ? ((float64) (Record->Clock - Writer->BaseClock) * Writer->MillisecondsPerCycle) : 0.0;
+        Used = snprintf(Dest, DestSize, "[%10.3f ms] T%u %s: ", Milliseconds, ThreadIndex, DebugLogLevelNames[Record->Level]);
+    }
+
+    //Room is kept for the newline
+    Used += debug_FormatLogText(Record, Dest + Used, DestSize - Used - 1);
+
+    if((Record->Level == DEBUG_LOG_ERROR) && Record->ErrorCode)
+    {
+        Used += snprintf(Dest + Used, DestSize - Used - 1, ": %s", strerror(Record->ErrorCode));
+        Used = (Used < (DestSize - 2)) ? Used : (DestSize - 2);
+    }
+
+    Dest[Used++] = '\n';
+    Dest[Used] = 0;
+
+    return Used;
+}
+
+//Writer thread only. Threads are taken in slot order, so lines from different threads may be out of time order
+internal void debug_DrainLog(DEBUG_LOG_WRITER *Writer)
+{
+    DEBUG_LOG *Log = Writer->Log;
+    char Line[DEBUG_LOG_MAX_LINE];
+
+    uint32 ThreadCount = Log->ThreadCount;
+    if(ThreadCount > DEBUG_MAX_THREADS)
+    {
+        ThreadCount = DEBUG_MAX_THREADS;
+    }
+
+    for(uint32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        DEBUG_LOG_THREAD *Thread = &Log->Threads[ThreadIndex];
+
+        if(!Thread->ThreadID)
+        {
+            continue;
+        }
+
+        int64 WriteIndex = atomic_LoadInt64(&Thread->WriteIndex);
+        int64 ReadIndex = Thread->ReadIndex;
+
+        for(; ReadIndex < WriteIndex; ++ReadIndex)
+        {
+            DEBUG_LOG_RECORD *Record = &Thread->Records[ReadIndex & (DEBUG_LOG_RECORD_COUNT - 1)];
+            int Length = debug_FormatLogRecord(Writer, ThreadIndex, Record, Line, sizeof(Line));
+            Writer->Write(Writer->WriteContext, Record->Level, Line, Length);
+            ++Writer->WrittenCount;
+
+            //Slot goes back to the owner only once it has been read
+            atomic_StoreInt64(&Thread->ReadIndex, ReadIndex + 1);
+        }
+    }
+}
+
+//Body of the platform's writer thread, returns after debug_EndLog once everything logged before it is written
+internal void debug_LogWriterLoop(DEBUG_LOG_WRITER *Writer)
+{
+    for(;;)
+    {
+        bool32 Running = Writer->Running;
+        CompletePreviousReadsBeforeFutureReads;
+
+        debug_DrainLog(Writer);
+
+        if(!Running)
+        {
+            break;
+        }
+
+        Writer->WaitSemaphore(Writer->SemaphoreHandle);
+    }
+}
+
+//Once a frame, records logged since sit in their rings until then
+internal void debug_SignalLog(DEBUG_LOG_WRITER *Writer)
+{
+    Writer->SignalSemaphore(Writer->SemaphoreHandle, 1);
+}
+
+//Waits until everything logged so far is written, before unloading the library whose format strings the records point at
+internal void debug_FlushLog(DEBUG_LOG_WRITER *Writer)
+{
+    DEBUG_LOG *Log = Writer->Log;
+    debug_SignalLog(Writer);
+
+    uint32 ThreadCount = Log->ThreadCount;
+    if(ThreadCount > DEBUG_MAX_THREADS)
+    {
+        ThreadCount = DEBUG_MAX_THREADS;
+    }
+
+    for(uint32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        DEBUG_LOG_THREAD *Thread = &Log->Threads[ThreadIndex];
+        int64 WriteIndex = atomic_LoadInt64(&Thread->WriteIndex);
+
+        while(atomic_LoadInt64(&Thread->ReadIndex) < WriteIndex)
+        {
+            _mm_pause();
+        }
+    }
+}
+
+//Writer drains what is left and returns from debug_LogWriterLoop, the platform then joins it
+internal void debug_EndLog(DEBUG_LOG_WRITER *Writer)
+{
+    CompletePreviousWritesBeforeFutureWrites;
+    Writer->Running = false;
+    debug_SignalLog(Writer);
+}
+
+//Records every thread has dropped so far, for the platform's summary
+internal int64 debug_GetLogDroppedCount(DEBUG_LOG *Log)
+{
+    int64 DroppedCount = 0;
+
+    for(uint32 ThreadIndex = 0; (ThreadIndex < Log->ThreadCount) && (ThreadIndex < DEBUG_MAX_THREADS); ++ThreadIndex)
+    {
+        DroppedCount += Log->Threads[ThreadIndex].DroppedCount;
+    }
+
+    return DroppedCount;
+}
@@ -0,0 +1,381 @@
+#if !defined(HANDMADE_DEBUG_H)
+
+#include <errno.h>
+#include <string.h>
+
+//Hot path profiler: TIMED_BLOCK / TIMED_FUNCTION log a begin and end cycle count into a table owned by the calling thread
+//Each thread's events are double buffered by frame, once a frame the platform collates the finished half into a call tree (handmade_debug.cpp)
+//No locks, a block costs two rdtsc and two uncontended atomic adds. Build with -DHANDMADE_PROFILE=0 to compile every block out
+
+#if !defined(HANDMADE_PROFILE)
+#define HANDMADE_PROFILE 1
+#endif
+
+#define DEBUG_MAX_THREADS 32
+#define DEBUG_MAX_EVENTS 16384 //Per thread per frame, the rest are dropped and counted
+
+enum DEBUG_EVENT_TYPE
+{
+    DEBUG_EVENT_BEGIN_BLOCK,
+    DEBUG_EVENT_END_BLOCK,
+};
+
+struct DEBUG_EVENT
+{
+    uint64 Clock;
+    const char *Name; //Literal in the module that logged it, collation copies it before that module can be unloaded
+    uint32 Type;
+};
+
+struct DEBUG_THREAD
+{
+    uint64 volatile ThreadID; //0 until the owning thread has claimed the slot
+
+    //Half being written in the top 32 bits, events written to it in the bottom 32
+    //One atomic add hands the owner its slot, one exchange lets the collator flip halves without stopping anyone
+    uint64 volatile EventArrayIndex_EventIndex;
+
+    DEBUG_EVENT Events[2][DEBUG_MAX_EVENTS];
+};
+
+//Allocated by the platform and shared with the game library through HANDMADE_PLATFORM
+struct DEBUG_TABLE
+{
+    uint32 volatile ThreadCount;
+    uint32 volatile CurrentEventArray;
+    DEBUG_THREAD Threads[DEBUG_MAX_THREADS];
+};
+
+//Per module, the game library picks it up from HANDMADE_PLATFORM on every call. 0 records nothing
+global DEBUG_TABLE *GlobalDebugTable;
+global HANDMADE_THREAD_LOCAL DEBUG_THREAD *GlobalDebugThread;
+
+//Cached per thread after the first lookup, a freshly loaded library finds the thread's old slot by ID
+internal DEBUG_THREAD *debug_GetThread(DEBUG_TABLE *Table)
+{
+    if(GlobalDebugThread)
+    {
+        return GlobalDebugThread;
+    }
+
+    uint64 ThreadID = cpu_GetThreadID();
+    uint32 ThreadCount = Table->ThreadCount;
+
+    for(uint32 ThreadIndex = 0; (ThreadIndex < ThreadCount) && (ThreadIndex < DEBUG_MAX_THREADS); ++ThreadIndex)
+    {
+        if(Table->Threads[ThreadIndex].ThreadID == ThreadID)
+        {
+            GlobalDebugThread = &Table->Threads[ThreadIndex];
+            return GlobalDebugThread;
+        }
+    }
+
+    uint32 ThreadIndex = atomic_IncrementUInt32(&Table->ThreadCount) - 1;
+    if(ThreadIndex >= DEBUG_MAX_THREADS)
+    {
+        return 0;
+    }
+
+    DEBUG_THREAD *Thread = &Table->Threads[ThreadIndex];
+    Thread->EventArrayIndex_EventIndex = (uint64) Table->CurrentEventArray << 32;
+
+    //Collator skips the slot until the ID shows up, by then the index is valid
+    CompletePreviousWritesBeforeFutureWrites;
+    Thread->ThreadID = ThreadID;
+
+    GlobalDebugThread = Thread;
+    return Thread;
+}
+
+inline void debug_RecordEvent(const char *Name, uint32 Type)
+{
+    DEBUG_TABLE *Table = GlobalDebugTable;
+
+    if(Table)
+    {
+        DEBUG_THREAD *Thread = debug_GetThread(Table);
+
+        if(Thread)
+        {
+            uint64 ArrayIndex_EventIndex = atomic_AddUInt64(&Thread->EventArrayIndex_EventIndex, 1);
+            uint32 EventIndex = (uint32) ArrayIndex_EventIndex;
+
+            if(EventIndex < DEBUG_MAX_EVENTS)
+            {
+                DEBUG_EVENT *Event = &Thread->Events[(ArrayIndex_EventIndex >> 32) & 1][EventIndex];
+                Event->Clock = __rdtsc();
+                Event->Name = Name;
+                Event->Type = Type;
+            }
+        }
+    }
+}
+
+//Scope guard, the end event is logged however the block exits
+struct DEBUG_TIMED_BLOCK
+{
+    const char *Name;
+
+    DEBUG_TIMED_BLOCK(const char *BlockName)
+    {
+        Name = BlockName;
+        debug_RecordEvent(Name, DEBUG_EVENT_BEGIN_BLOCK);
+    }
+
+    ~DEBUG_TIMED_BLOCK()
+    {
+        debug_RecordEvent(Name, DEBUG_EVENT_END_BLOCK);
+    }
+};
+
+#if HANDMADE_PROFILE
+#define TIMED_BLOCK__(Name, Line) DEBUG_TIMED_BLOCK TimedBlock_##Line(Name)
+#define TIMED_BLOCK_(Name, Line) TIMED_BLOCK__(Name, Line)
+#define TIMED_BLOCK(Name) TIMED_BLOCK_(Name, __LINE__)
+#define TIMED_FUNCTION() TIMED_BLOCK_(__FUNCTION__, __LINE__)
+#else
+#define TIMED_BLOCK(Name)
+#define TIMED_FUNCTION()
+#endif
+
+//Logger: debug_LogError / debug_LogWarning / debug_LogInfo / debug_Message take printf style arguments but format nothing
+//The call copies the format pointer, its arguments, a cycle count and errno into a ring owned by the calling thread and returns
+//A writer thread the platform owns formats and writes them (handmade_debug.cpp). A full ring drops the record and counts it, it never waits
+
+#define DEBUG_LOG_RECORD_COUNT 256 //Per thread, must be a power of two
+#define DEBUG_LOG_MAX_ARGS 6
+#define DEBUG_LOG_TEXT_SIZE 64 //Strings passed for %s are copied here, shared by every one in the record and cut short when it fills
+
+enum DEBUG_LOG_LEVEL
+{
+    DEBUG_LOG_ERROR, //Adds strerror of the errno at the call
+    DEBUG_LOG_WARNING,
+    DEBUG_LOG_INFO,
+    DEBUG_LOG_MESSAGE, //Written as is, no time, thread or level in front
+
+    DEBUG_LOG_LEVEL_COUNT
+};
+
+//Integers are widened to 64 bits, INT32 remembers the argument was narrower so %x of a negative int prints 8 digits
+enum DEBUG_LOG_ARG_TYPE
+{
+    DEBUG_LOG_ARG_INT32,
+    DEBUG_LOG_ARG_INT64,
+    DEBUG_LOG_ARG_FLOAT,
+    DEBUG_LOG_ARG_POINTER,
+    DEBUG_LOG_ARG_STRING, //Value is the offset of the copy in Text
+};
+
+struct DEBUG_LOG_RECORD
+{
+    uint64 Clock;
+    const char *Format; //Literal in the module that logged it, the platform drains the log before unloading the game library
+    uint8 Level;
+    uint8 ArgCount;
+    uint8 ArgTypes[DEBUG_LOG_MAX_ARGS];
+    int32 ErrorCode;
+    uint32 TextUsed;
+    uint64 Args[DEBUG_LOG_MAX_ARGS];
+    char Text[DEBUG_LOG_TEXT_SIZE];
+};
+
+//Single producer, single consumer, indices count records ever written or read like AUDIO_RING_BUFFER
+struct DEBUG_LOG_THREAD
+{
+    uint64 volatile ThreadID; //0 until the owning thread has claimed the slot
+    int64 volatile WriteIndex; //Owner only
+    int64 volatile DroppedCount; //Owner only, read by the writer for its totals
+    uint8 PadWrite[40];
+
+    int64 volatile ReadIndex; //Writer only
+    uint8 PadRead[56];
+
+    DEBUG_LOG_RECORD Records[DEBUG_LOG_RECORD_COUNT];
+};
+
+//Allocated by the platform and shared with the game library through HANDMADE_PLATFORM like DEBUG_TABLE
+struct DEBUG_LOG
+{
+    uint32 Session; //Set by debug_BeginLog, different for every log so a freed one's slots are never reused from the cache
+    uint32 volatile ThreadCount;
+    DEBUG_LOG_THREAD Threads[DEBUG_MAX_THREADS];
+};
+
+//Per module like GlobalDebugTable. 0 drops every record
+global DEBUG_LOG *GlobalDebugLog;
+global HANDMADE_THREAD_LOCAL DEBUG_LOG_THREAD *GlobalDebugLogThread;
+global HANDMADE_THREAD_LOCAL uint32 GlobalDebugLogSession;
+
+//Same claim as debug_GetThread, in the log's own table
+internal DEBUG_LOG_THREAD *debug_GetLogThread(DEBUG_LOG *Log)
+{
+    if(GlobalDebugLogThread && (GlobalDebugLogSession == Log->Session))
+    {
+        return GlobalDebugLogThread;
+    }
+
+    //The cached slot belongs to an older log, the session is only taken once a slot in this one is
+    GlobalDebugLogThread = 0;
+
+    uint64 ThreadID = cpu_GetThreadID();
+    uint32 ThreadCount = Log->ThreadCount;
+
+    for(uint32 ThreadIndex = 0; (ThreadIndex < ThreadCount) && (ThreadIndex < DEBUG_MAX_THREADS); ++ThreadIndex)
+    {
+        if(Log->Threads[ThreadIndex].ThreadID == ThreadID)
+        {
+            GlobalDebugLogThread = &Log->Threads[ThreadIndex];
+            GlobalDebugLogSession = Log->Session;
+            return GlobalDebugLogThread;
+        }
+    }
+
+    uint32 ThreadIndex = atomic_IncrementUInt32(&Log->ThreadCount) - 1;
+    if(ThreadIndex >= DEBUG_MAX_THREADS)
+    {
+        return 0;
+    }
+
+    DEBUG_LOG_THREAD *Thread = &Log->Threads[ThreadIndex];
+
+    //Writer skips the slot until the ID shows up, by then the indices are valid
+    CompletePreviousWritesBeforeFutureWrites;
+    Thread->ThreadID = ThreadID;
+
+    GlobalDebugLogThread = Thread;
+    GlobalDebugLogSession = Log->Session;
+    return Thread;
+}
+
+//One overload per kind of argument, picked at compile time so the call site does no more than store them
+template <typename T> inline void debug_PackLogArg(DEBUG_LOG_RECORD *Record, T Value)
+{
+    Record->ArgTypes[Record->ArgCount] = (sizeof(T) > 4) ? DEBUG_LOG_ARG_INT64 : DEBUG_LOG_ARG_INT32;
+    Record->Args[Record->ArgCount++] = (uint64) (int64) Value;
+}
+
+template <typename T> inline void debug_PackLogArg(DEBUG_LOG_RECORD *Record, T *Value)
+{
+    Record->ArgTypes[Record->ArgCount] = DEBUG_LOG_ARG_POINTER;
+    Record->Args[Record->ArgCount++] = (uint64) (size_t) Value;
+}
+
+inline void debug_PackLogArg(DEBUG_LOG_RECORD *Record, float64 Value)
+{
+    union
+    {
+        float64 Float;
+        uint64 Bits;
+    } Convert;
+    Convert.Float = Value;
+
+    Record->ArgTypes[Record->ArgCount] = DEBUG_LOG_ARG_FLOAT;
+    Record->Args[Record->ArgCount++] = Convert.Bits;
+}
+
+inline void debug_PackLogArg(DEBUG_LOG_RECORD *Record, float32 Value)
+{
+    debug_PackLogArg(Record, (float64) Value);
+}
+
+inline void debug_PackLogArg(DEBUG_LOG_RECORD *Record, const char *Value)
+{
+    uint32 Offset = Record->TextUsed;
+    uint32 Length = 0;
+
+    if(Value)
+    {
+        while(Value[Length] && ((Offset + Length + 1) < DEBUG_LOG_TEXT_SIZE))
+        {
+            Record->Text[Offset + Length] = Value[Length];
+            ++Length;
+        }
+    }
+
+    Record->Text[Offset + Length] = 0;
+    Record->TextUsed = ((Offset + Length + 1) < DEBUG_LOG_TEXT_SIZE) ? (Offset + Length + 1) : (DEBUG_LOG_TEXT_SIZE - 1);
+
+    Record->ArgTypes[Record->ArgCount] = DEBUG_LOG_ARG_STRING;
+    Record->Args[Record->ArgCount++] = Offset;
+}
+
+inline void debug_PackLogArg(DEBUG_LOG_RECORD *Record, char *Value)
+{
+    debug_PackLogArg(Record, (const char *) Value);
+}
+
+//End of the argument list, nothing left to store
+inline void debug_PackLogArgs(DEBUG_LOG_RECORD *)
+{
+}
+
+template <typename T, typename... ARGS> inline void debug_PackLogArgs(DEBUG_LOG_RECORD *Record, T Value, ARGS... Rest)
+{
+    debug_PackLogArg(Record, Value);
+    debug_PackLogArgs(Record, Rest...);
+}
+
+template <typename... ARGS> inline void debug_Log(uint32 Level, int32 ErrorCode, const char *Format, ARGS... Args)
+{
+    static_assert(sizeof...(ARGS) <= DEBUG_LOG_MAX_ARGS, "Too many arguments for one log record");
+
+    DEBUG_LOG *Log = GlobalDebugLog;
+
+    if(Log)
+    {
+        DEBUG_LOG_THREAD *Thread = debug_GetLogThread(Log);
+
+        if(Thread)
+        {
+            int64 WriteIndex = Thread->WriteIndex;
+
+            if((WriteIndex - atomic_LoadInt64(&Thread->ReadIndex)) >= DEBUG_LOG_RECORD_COUNT)
+            {
+                ++Thread->DroppedCount;
+                return;
+            }
+
+            DEBUG_LOG_RECORD *Record = &Thread->Records[WriteIndex & (DEBUG_LOG_RECORD_COUNT - 1)];
+            Record->Clock = __rdtsc();
+            Record->Format = Format;
+            Record->Level = (uint8) Level;
+            Record->ArgCount = 0;
+            Record->ErrorCode = ErrorCode;
+            Record->TextUsed = 0;
+            debug_PackLogArgs(Record, Args...);
+
+            atomic_StoreInt64(&Thread->WriteIndex, WriteIndex + 1);
+        }
+    }
+}
+
+//No trailing newline, the writer ends every record with one
+//debug_Message is for debugging only and compiles out unless DEBUG is defined
+#ifndef DEBUG
+#define debug_Message(...)
+#else
+#define debug_Message(...) debug_Log(DEBUG_LOG_MESSAGE, 0, __VA_ARGS__)
+#endif
+
+//If errno is 0, print "None", otherwise print the errno for logging
+#define debug_CleanErrno() (errno == 0 ? "None" : strerror(errno))
+
+//Logging at a range of severity levels, errors carry the errno at the call
+#define debug_LogError(...) debug_Log(DEBUG_LOG_ERROR, errno, __VA_ARGS__)
+#define debug_LogWarning(...) debug_Log(DEBUG_LOG_WARNING, 0, __VA_ARGS__)
+#define debug_LogInfo(...) debug_Log(DEBUG_LOG_INFO, 0, __VA_ARGS__)
+
+//General use error check that logs and jumps to the caller's 'error' label
+#define debug_CheckError(A, ...) if(!(A)) {debug_LogError(__VA_ARGS__); errno = 0; goto error;}
+
+//Check if memory is allocated and log if not
+#define debug_CheckMemory(A) debug_CheckError((A), "Out of Memory!")
+
+//Use to account for unknown scenarios (example: Switch default case)
+#define debug_CheckAgainst(...) {debug_LogError(__VA_ARGS__); errno = 0; goto error;}
+
+//Check assertion and log a debug message
+#define debug_Assert(A, ...) if(!(A)) {debug_Message(__VA_ARGS__); errno = 0; goto error;}
+
+#define HANDMADE_DEBUG_H
+#endif
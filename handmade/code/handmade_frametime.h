@@ -0,0 +1,121 @@
+#if !defined(HANDMADE_FRAMETIME_H)
+
+//Rolling frame time histogram over the last FRAME_HISTOGRAM_WINDOW frames
+//Fixed width buckets keep adds O(1), percentiles are read at bucket resolution when dumped
+
+#define FRAME_HISTOGRAM_WINDOW 1024
+#define FRAME_HISTOGRAM_BUCKET_MS 0.1f
+#define FRAME_HISTOGRAM_BUCKET_COUNT 1000 //Last bucket also takes everything over 100 ms
+
+struct FRAME_HISTOGRAM
+{
+    float32 TargetMS; //0 when the loop is unlocked, nothing counts as missed
+    float32 FrameMS[FRAME_HISTOGRAM_WINDOW]; //Ring of the frames currently counted in Buckets
+    uint32 Buckets[FRAME_HISTOGRAM_BUCKET_COUNT];
+    int NextFrame;
+    int WindowCount;
+
+    //Since startup, not rolled
+    int64 FrameCount;
+    int64 MissedFrameCount; //Work alone ran past the target, the loop resynced instead of catching up
+};
+
+internal int frame_GetBucket(float32 MS)
+{
+    int Bucket = (int) (MS / FRAME_HISTOGRAM_BUCKET_MS);
+
+    if(Bucket < 0)
+    {
+        Bucket = 0;
+    }
+    if(Bucket >= FRAME_HISTOGRAM_BUCKET_COUNT)
+    {
+        Bucket = FRAME_HISTOGRAM_BUCKET_COUNT - 1;
+    }
+
+    return Bucket;
+}
+
+internal void frame_InitHistogram(FRAME_HISTOGRAM *Histogram, float32 TargetMS)
+{
+    *Histogram = {};
+    Histogram->TargetMS = TargetMS;
+}
+
+//MS is the full frame, start to start, so sleep overshoot shows up as jitter
+internal void frame_AddFrame(FRAME_HISTOGRAM *Histogram, float32 MS, bool32 Missed)
+{
+    if(Histogram->WindowCount == FRAME_HISTOGRAM_WINDOW)
+    {
+        --Histogram->Buckets[frame_GetBucket(Histogram->FrameMS[Histogram->NextFrame])];
+    }
+    else
+    {
+        ++Histogram->WindowCount;
+    }
+
+    Histogram->FrameMS[Histogram->NextFrame] = MS;
+    ++Histogram->Buckets[frame_GetBucket(MS)];
+    Histogram->NextFrame = (Histogram->NextFrame + 1) % FRAME_HISTOGRAM_WINDOW;
+
+    ++Histogram->FrameCount;
+    if(Missed)
+    {
+        ++Histogram->MissedFrameCount;
+    }
+}
+
+//Upper edge of the bucket holding the given fraction of the window
+internal float32 frame_GetPercentileMS(FRAME_HISTOGRAM *Histogram, float32 Fraction)
+{
+    uint32 Rank = (uint32) (Fraction * (float32) Histogram->WindowCount);
+    if(Rank >= (uint32) Histogram->WindowCount)
+    {
+        Rank = Histogram->WindowCount - 1;
+    }
+
+    uint32 Seen = 0;
+    for(int Bucket = 0; Bucket < FRAME_HISTOGRAM_BUCKET_COUNT; ++Bucket)
+    {
+        Seen += Histogram->Buckets[Bucket];
+        if(Seen > Rank)
+        {
+            return (float32) (Bucket + 1) * FRAME_HISTOGRAM_BUCKET_MS;
+        }
+    }
+
+    return 0.0f;
+}
+
+//Exact, the window keeps the raw times
+internal float32 frame_GetMaxMS(FRAME_HISTOGRAM *Histogram)
+{
+    float32 Max = 0.0f;
+
+    for(int Frame = 0; Frame < Histogram->WindowCount; ++Frame)
+    {
+        if(Histogram->FrameMS[Frame] > Max)
+        {
+            Max = Histogram->FrameMS[Frame];
+        }
+    }
+
+    return Max;
+}
+
+//One line summary for the platform's log
+internal void frame_FormatHistogram(FRAME_HISTOGRAM *Histogram, char *Dest, int DestSize)
+{
+    if(Histogram->WindowCount == 0)
+    {
+        snprintf(Dest, DestSize, "no frames\n");
+        return;
+    }
+
+    snprintf(Dest, DestSize, "last %d frames: %0.1f ms p50\t %0.1f ms p99\t %0.2f ms max\t %lld/%lld missed %0.2f ms target\n",
+             Histogram->WindowCount, frame_GetPercentileMS(Histogram, 0.5f), frame_GetPercentileMS(Histogram, 0.99f), frame_GetMaxMS(Histogram),
+             (long long) Histogram->MissedFrameCount, (long long) Histogram->FrameCount, Histogram->TargetMS);
+}
+
+#define HANDMADE_FRAMETIME_H
+#endif
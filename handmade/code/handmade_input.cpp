@@ -0,0 +1,140 @@
+#include "handmade_input.h"
+
+//Call before either thread touches the ring
+internal void input_InitRing(INPUT_EVENT_RING *Ring)
+{
+    Ring->WriteIndex = 0;
+    Ring->DroppedCount = 0;
+    Ring->ReadIndex = 0;
+}
+
+//Producer side. A full ring means no frame has gathered for INPUT_RING_SIZE transitions, the event is dropped and counted
+internal bool32 input_PushEvent(INPUT_EVENT_RING *Ring, uint64 Timestamp, uint32 ControllerIndex, uint32 ButtonIndex, bool32 IsDown)
+{
+    int64 WriteIndex = Ring->WriteIndex;
+
+    if((WriteIndex - atomic_LoadInt64(&Ring->ReadIndex)) >= INPUT_RING_SIZE)
+    {
+        ++Ring->DroppedCount;
+        return false;
+    }
+
+    INPUT_RAW_EVENT *Event = &Ring->Events[WriteIndex & (INPUT_RING_SIZE - 1)];
+    Event->Timestamp = Timestamp;
+    Event->ControllerIndex = (uint8) ControllerIndex;
+    Event->ButtonIndex = (uint8) ButtonIndex;
+    Event->IsDown = IsDown ? 1 : 0;
+
+    //Release, the frame must see the event before it sees the new index
+    atomic_StoreInt64(&Ring->WriteIndex, WriteIndex + 1);
+
+    return true;
+}
+
+//Consumer side, once a frame. Everything stamped before WindowEnd is taken from every ring, merged into time order and
+//applied on top of where OldInput's buttons ended, later events stay queued for the next frame
+//Events stamped before WindowStart were pushed late and count as happening at the start. Analog values are left alone
+internal void input_GatherFrame(INPUT_EVENT_RING **Rings, int RingCount, uint64 WindowStart, uint64 WindowEnd, float64 SecondsPerTick,
+                                HANDMADE_INPUT_USER *OldInput, HANDMADE_INPUT_USER *NewInput, INPUT_STATS *Stats)
+{
+    for(int ControllerIndex = 0; ControllerIndex < HANDMADE_INPUT_MAX_CONTROLLERS; ++ControllerIndex)
+    {
+        HANDMADE_INPUT_CONTROLLER *OldController = &OldInput->Controllers[ControllerIndex];
+        HANDMADE_INPUT_CONTROLLER *NewController = &NewInput->Controllers[ControllerIndex];
+
+        for(int ButtonIndex = 0; ButtonIndex < HANDMADE_INPUT_BUTTON_COUNT; ++ButtonIndex)
+        {
+            NewController->Buttons[ButtonIndex].EndedDown = OldController->Buttons[ButtonIndex].EndedDown;
+            NewController->Buttons[ButtonIndex].HalfTransitionCount = 0;
+        }
+    }
+
+    NewInput->FrameSeconds = (float32) ((float64) (WindowEnd - WindowStart) * SecondsPerTick);
+    NewInput->EventCount = 0;
+
+    //Write indices are read once, a producer racing ahead only adds events the next frame will take
+    int64 WriteIndices[INPUT_MAX_RINGS];
+    RingCount = (RingCount < INPUT_MAX_RINGS) ? RingCount : INPUT_MAX_RINGS;
+
+    for(int RingIndex = 0; RingIndex < RingCount; ++RingIndex)
+    {
+        WriteIndices[RingIndex] = atomic_LoadInt64(&Rings[RingIndex]->WriteIndex);
+    }
+
+    for(;;)
+    {
+        //Each ring is already in time order, so the oldest head of all of them is next
+        INPUT_EVENT_RING *Next = 0;
+        INPUT_RAW_EVENT *Event = 0;
+
+        for(int RingIndex = 0; RingIndex < RingCount; ++RingIndex)
+        {
+            INPUT_EVENT_RING *Ring = Rings[RingIndex];
+
+            if(Ring->ReadIndex < WriteIndices[RingIndex])
+            {
+                INPUT_RAW_EVENT *Head = &Ring->Events[Ring->ReadIndex & (INPUT_RING_SIZE - 1)];
+
+                if((Head->Timestamp < WindowEnd) && (!Event || (Head->Timestamp < Event->Timestamp)))
+                {
+                    Next = Ring;
+                    Event = Head;
+                }
+            }
+        }
+
+        if(!Next)
+        {
+            break;
+        }
+
+        uint64 Timestamp = Event->Timestamp;
+        uint32 ControllerIndex = Event->ControllerIndex;
+        uint32 ButtonIndex = Event->ButtonIndex;
+        bool32 IsDown = Event->IsDown;
+
+        //Slot goes back to the producer once it has been copied out
+        atomic_StoreInt64(&Next->ReadIndex, Next->ReadIndex + 1);
+
+        if((ControllerIndex >= HANDMADE_INPUT_MAX_CONTROLLERS) || (ButtonIndex >= HANDMADE_INPUT_BUTTON_COUNT))
+        {
+            continue;
+        }
+
+        //Two keys mapped to one button can repeat a state, only real transitions count
+        HANDMADE_INPUT_CONTROLLER_BUTTON_STATE *Button = &NewInput->Controllers[ControllerIndex].Buttons[ButtonIndex];
+        if(Button->EndedDown == IsDown)
+        {
+            continue;
+        }
+
+        Button->EndedDown = IsDown;
+        ++Button->HalfTransitionCount;
+        ++Stats->EventCount;
+
+        if(NewInput->EventCount < HANDMADE_INPUT_MAX_EVENTS)
+        {
+            HANDMADE_INPUT_EVENT *Listed = &NewInput->Events[NewInput->EventCount++];
+            Listed->Time = (Timestamp > WindowStart) ? (float32) ((float64) (Timestamp - WindowStart) * SecondsPerTick) : 0.0f;
+            Listed->ControllerIndex = (uint8) ControllerIndex;
+            Listed->ButtonIndex = (uint8) ButtonIndex;
+            Listed->IsDown = IsDown ? 1 : 0;
+            Listed->Pad = 0;
+        }
+        else
+        {
+            ++Stats->UnlistedCount;
+        }
+    }
+
+    for(int ControllerIndex = 0; ControllerIndex < HANDMADE_INPUT_MAX_CONTROLLERS; ++ControllerIndex)
+    {
+        for(int ButtonIndex = 0; ButtonIndex < HANDMADE_INPUT_BUTTON_COUNT; ++ButtonIndex)
+        {
+            if(NewInput->Controllers[ControllerIndex].Buttons[ButtonIndex].HalfTransitionCount > 1)
+            {
+                ++Stats->MultiTransitionCount;
+            }
+        }
+    }
+}
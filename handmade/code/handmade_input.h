@@ -0,0 +1,43 @@
+#if !defined(HANDMADE_INPUT_H)
+
+//Platform side of input: whatever sees a button change pushes it into its own ring the moment it happens, timestamped
+//with the platform's counter, and once a frame every ring is gathered into HANDMADE_INPUT_USER
+//Sources can run faster than the frame (a pad poll thread, the window procedure's message times), so a tap that starts
+//and ends between two frames still reaches the game as two transitions instead of vanishing between polls
+//Rings are single producer/single consumer like AUDIO_RING_BUFFER, indices count every event ever pushed or gathered
+
+#define INPUT_RING_SIZE 256
+#define INPUT_MAX_RINGS 4
+
+struct INPUT_RAW_EVENT
+{
+    uint64 Timestamp; //Platform counter ticks
+    uint8 ControllerIndex;
+    uint8 ButtonIndex;
+    uint8 IsDown;
+    uint8 Pad[5];
+};
+
+//Each index lives on its own cache line, only its owning thread stores to it
+struct INPUT_EVENT_RING
+{
+    int64 volatile WriteIndex; //Producer only
+    int64 volatile DroppedCount; //Transitions that found the ring full
+    uint8 PadWrite[48];
+
+    int64 volatile ReadIndex; //Consumer only
+    uint8 PadRead[56];
+
+    INPUT_RAW_EVENT Events[INPUT_RING_SIZE];
+};
+
+//Running totals for the platform's summary
+struct INPUT_STATS
+{
+    int64 EventCount;
+    int64 UnlistedCount; //Applied to the button states, but past HANDMADE_INPUT_MAX_EVENTS
+    int64 MultiTransitionCount; //Buttons that moved more than once in a frame, a poll per frame would have missed all but the last
+};
+
+#define HANDMADE_INPUT_H
+#endif
@@ -0,0 +1,232 @@
+#if !defined(HANDMADE_INTRINSICS_H)
+
+//Compiler specific SIMD headers and CPUID access
+//MSVC will emit any instruction set without flags, GCC/Clang need the target marked per function
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HANDMADE_TARGET_SSE2
+#define HANDMADE_TARGET_AVX2
+#define HANDMADE_THREAD_LOCAL __declspec(thread)
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#define HANDMADE_TARGET_SSE2 __attribute__((target("sse2")))
+#define HANDMADE_TARGET_AVX2 __attribute__((target("avx2")))
+#define HANDMADE_THREAD_LOCAL __thread
+#endif
+
+//Instruction set a kernel family runs at, AUTO picks the widest the CPU supports
+enum SIMD_LEVEL
+{
+    SIMD_LEVEL_AUTO,
+    SIMD_LEVEL_SCALAR,
+    SIMD_LEVEL_SSE2,
+    SIMD_LEVEL_AVX2,
+
+    SIMD_LEVEL_COUNT
+};
+
+global const char * const SimdLevelNames[SIMD_LEVEL_COUNT] = {"auto", "scalar", "sse2", "avx2"};
+
+struct HANDMADE_CPU_FEATURES
+{
+    bool32 SSE2;
+    bool32 SSE41;
+    bool32 AVX2;
+};
+
+internal void cpu_CPUID(uint32 Leaf, uint32 SubLeaf, uint32 *Registers)
+{
+#if defined(_MSC_VER)
+    int Result[4];
+    __cpuidex(Result, Leaf, SubLeaf);
+    Registers[0] = Result[0];
+    Registers[1] = Result[1];
+    Registers[2] = Result[2];
+    Registers[3] = Result[3];
+#else
+    __cpuid_count(Leaf, SubLeaf, Registers[0], Registers[1], Registers[2], Registers[3]);
+#endif
+}
+
+//Extended control register, tells if the OS saves YMM state on context switch
+internal uint64 cpu_XGETBV(uint32 Index)
+{
+#if defined(_MSC_VER)
+    return _xgetbv(Index);
+#else
+    uint32 Low;
+    uint32 High;
+    __asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(Index));
+    return ((uint64) High << 32) | Low;
+#endif
+}
+
+internal HANDMADE_CPU_FEATURES cpu_QueryFeatures(void)
+{
+    HANDMADE_CPU_FEATURES Features = {};
+
+    uint32 Registers[4];
+    cpu_CPUID(0, 0, Registers);
+    uint32 MaxLeaf = Registers[0];
+
+    if(MaxLeaf >= 1)
+    {
+        cpu_CPUID(1, 0, Registers);
+        Features.SSE2 = (Registers[3] & (1 << 26)) != 0;
+        Features.SSE41 = (Registers[2] & (1 << 19)) != 0;
+
+        bool32 OSXSave = (Registers[2] & (1 << 27)) != 0;
+        bool32 AVX = (Registers[2] & (1 << 28)) != 0;
+
+        //XMM and YMM state both enabled by the OS
+        bool32 OSSavesYMM = OSXSave && ((cpu_XGETBV(0) & 6) == 6);
+
+        if(AVX && OSSavesYMM && (MaxLeaf >= 7))
+        {
+            cpu_CPUID(7, 0, Registers);
+            Features.AVX2 = (Registers[1] & (1 << 5)) != 0;
+        }
+    }
+
+    return Features;
+}
+
+//Widest level the CPU supports, a requested level the CPU can't run falls back to the best available
+internal SIMD_LEVEL cpu_SelectSimdLevel(SIMD_LEVEL Requested)
+{
+    HANDMADE_CPU_FEATURES Features = cpu_QueryFeatures();
+
+    SIMD_LEVEL Best = SIMD_LEVEL_SCALAR;
+    if(Features.SSE2)
+    {
+        Best = SIMD_LEVEL_SSE2;
+    }
+    if(Features.AVX2)
+    {
+        Best = SIMD_LEVEL_AVX2;
+    }
+
+    SIMD_LEVEL Selected = Best;
+    if((Requested != SIMD_LEVEL_AUTO) && (Requested < Best))
+    {
+        Selected = Requested;
+    }
+
+    return Selected;
+}
+
+//Address of the thread's own control block, unique per live thread and the same seen from the exe or the game library
+//Windows x64 keeps the TEB self pointer at gs:0x30, Linux x64 keeps the TCB self pointer at fs:0
+internal uint64 cpu_GetThreadID(void)
+{
+#if defined(_MSC_VER)
+    return (uint64) __readgsqword(0x30);
+#else
+    uint64 ThreadID;
+    __asm__ volatile("mov %%fs:0, %0" : "=r"(ThreadID));
+    return ThreadID;
+#endif
+}
+
+//Interlocked operations are full barriers, the fences below order plain loads and stores around them
+#if defined(_MSC_VER)
+#define CompletePreviousWritesBeforeFutureWrites _WriteBarrier(); _mm_sfence()
+#define CompletePreviousReadsBeforeFutureReads _ReadBarrier()
+#define FullMemoryBarrier _ReadWriteBarrier(); _mm_mfence()
+
+//Returns the value that was in memory before the exchange
+internal uint32 atomic_CompareExchangeUInt32(uint32 volatile *Value, uint32 New, uint32 Expected)
+{
+    return (uint32) _InterlockedCompareExchange((long volatile *) Value, (long) New, (long) Expected);
+}
+
+//Returns the incremented value
+internal uint32 atomic_IncrementUInt32(uint32 volatile *Value)
+{
+    return (uint32) _InterlockedIncrement((long volatile *) Value);
+}
+
+//Returns the decremented value
+internal uint32 atomic_DecrementUInt32(uint32 volatile *Value)
+{
+    return (uint32) _InterlockedDecrement((long volatile *) Value);
+}
+
+internal int64 atomic_CompareExchangeInt64(int64 volatile *Value, int64 New, int64 Expected)
+{
+    return _InterlockedCompareExchange64((__int64 volatile *) Value, New, Expected);
+}
+
+//Both return the value that was in memory before
+internal uint64 atomic_AddUInt64(uint64 volatile *Value, uint64 Addend)
+{
+    return (uint64) _InterlockedExchangeAdd64((__int64 volatile *) Value, (__int64) Addend);
+}
+
+internal uint64 atomic_ExchangeUInt64(uint64 volatile *Value, uint64 New)
+{
+    return (uint64) _InterlockedExchange64((__int64 volatile *) Value, (__int64) New);
+}
+
+//Aligned 64 bit loads and stores are atomic on x64, volatile keeps MSVC from reordering them
+internal int64 atomic_LoadInt64(int64 volatile *Value)
+{
+    int64 Result = *Value;
+    _ReadWriteBarrier();
+    return Result;
+}
+
+internal void atomic_StoreInt64(int64 volatile *Value, int64 New)
+{
+    _ReadWriteBarrier();
+    *Value = New;
+}
+#else
+#define CompletePreviousWritesBeforeFutureWrites __atomic_thread_fence(__ATOMIC_RELEASE)
+#define CompletePreviousReadsBeforeFutureReads __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define FullMemoryBarrier __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+internal uint32 atomic_CompareExchangeUInt32(uint32 volatile *Value, uint32 New, uint32 Expected)
+{
+    return __sync_val_compare_and_swap(Value, Expected, New);
+}
+
+internal uint32 atomic_IncrementUInt32(uint32 volatile *Value)
+{
+    return __sync_add_and_fetch(Value, 1);
+}
+
+internal uint32 atomic_DecrementUInt32(uint32 volatile *Value)
+{
+    return __sync_sub_and_fetch(Value, 1);
+}
+
+internal int64 atomic_CompareExchangeInt64(int64 volatile *Value, int64 New, int64 Expected)
+{
+    return __sync_val_compare_and_swap(Value, Expected, New);
+}
+
+internal uint64 atomic_AddUInt64(uint64 volatile *Value, uint64 Addend)
+{
+    return __sync_fetch_and_add(Value, Addend);
+}
+
+internal uint64 atomic_ExchangeUInt64(uint64 volatile *Value, uint64 New)
+{
+    return __atomic_exchange_n(Value, New, __ATOMIC_SEQ_CST);
+}
+
+internal int64 atomic_LoadInt64(int64 volatile *Value)
+{
+    return __atomic_load_n(Value, __ATOMIC_ACQUIRE);
+}
+
+internal void atomic_StoreInt64(int64 volatile *Value, int64 New)
+{
+    __atomic_store_n(Value, New, __ATOMIC_RELEASE);
+}
+#endif
+
+#define HANDMADE_INTRINSICS_H
+#endif
@@ -0,0 +1,340 @@
+#include "handmade_jobs.h"
+
+//Queues the calling thread has a deque in, the thread that makes several queues owns deque 0 of each
+struct JOBS_MEMBERSHIP
+{
+    HANDMADE_WORK_QUEUE *Queue;
+    int ThreadIndex;
+};
+
+global HANDMADE_THREAD_LOCAL JOBS_MEMBERSHIP jobs_Memberships[JOBS_MAX_QUEUES_PER_THREAD];
+global HANDMADE_THREAD_LOCAL int jobs_MembershipCount;
+
+//Re-joining a queue replaces the old index
+internal void jobs_JoinQueue(HANDMADE_WORK_QUEUE *Queue, int ThreadIndex)
+{
+    for(int Index = 0; Index < jobs_MembershipCount; ++Index)
+    {
+        if(jobs_Memberships[Index].Queue == Queue)
+        {
+            jobs_Memberships[Index].ThreadIndex = ThreadIndex;
+            return;
+        }
+    }
+
+    Assert(jobs_MembershipCount < JOBS_MAX_QUEUES_PER_THREAD);
+    jobs_Memberships[jobs_MembershipCount].Queue = Queue;
+    jobs_Memberships[jobs_MembershipCount].ThreadIndex = ThreadIndex;
+    ++jobs_MembershipCount;
+}
+
+//Index of the calling thread's deque in Queue, -1 for threads that aren't part of it
+internal int jobs_GetThreadIndex(HANDMADE_WORK_QUEUE *Queue)
+{
+    for(int Index = 0; Index < jobs_MembershipCount; ++Index)
+    {
+        if(jobs_Memberships[Index].Queue == Queue)
+        {
+            return jobs_Memberships[Index].ThreadIndex;
+        }
+    }
+
+    return -1;
+}
+
+internal size_t jobs_GetDequeMemorySize(int ThreadCount)
+{
+    return sizeof(JOBS_DEQUE) * (size_t) ThreadCount;
+}
+
+//Call on the thread that will push work, it becomes thread 0, then start ThreadCount - 1 workers on jobs_WorkerLoop
+internal void jobs_InitQueue(HANDMADE_WORK_QUEUE *Queue, int ThreadCount, JOBS_DEQUE *Deques, void *SemaphoreHandle, jobs_signal_semaphore *SignalSemaphore, jobs_wait_semaphore *WaitSemaphore)
+{
+    Queue->ThreadCount = ThreadCount;
+    Queue->PendingCount = 0;
+    Queue->SleepingCount = 0;
+    Queue->SemaphoreHandle = SemaphoreHandle;
+    Queue->SignalSemaphore = SignalSemaphore;
+    Queue->WaitSemaphore = WaitSemaphore;
+    Queue->Deques = Deques;
+
+    for(int ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        JOBS_DEQUE *Deque = &Deques[ThreadIndex];
+        Deque->Top = 0;
+        Deque->Bottom = 0;
+        Deque->Stats = {};
+        Deque->RandomState = 0x9E3779B9u * (uint32) (ThreadIndex + 1);
+    }
+
+    jobs_JoinQueue(Queue, 0);
+}
+
+//Owner only, false when the deque is full
+internal bool32 jobs_Push(JOBS_DEQUE *Deque, JOBS_ENTRY Entry)
+{
+    int64 Bottom = Deque->Bottom;
+    int64 Top = atomic_LoadInt64(&Deque->Top);
+
+    if((Bottom - Top) >= JOBS_DEQUE_SIZE)
+    {
+        return false;
+    }
+
+    Deque->Entries[Bottom & (JOBS_DEQUE_SIZE - 1)] = Entry;
+
+    //Entry has to be visible before a thief can see the new Bottom
+    CompletePreviousWritesBeforeFutureWrites;
+    atomic_StoreInt64(&Deque->Bottom, Bottom + 1);
+
+    return true;
+}
+
+//Owner only, takes the newest entry (LIFO keeps the owner in warm cache)
+internal bool32 jobs_Pop(JOBS_DEQUE *Deque, JOBS_ENTRY *Entry)
+{
+    int64 Bottom = Deque->Bottom - 1;
+    atomic_StoreInt64(&Deque->Bottom, Bottom);
+
+    //Claim Bottom before reading Top, otherwise a thief and the owner can both take the last entry
+    FullMemoryBarrier;
+
+    int64 Top = atomic_LoadInt64(&Deque->Top);
+    bool32 Result = false;
+
+    if(Top <= Bottom)
+    {
+        *Entry = Deque->Entries[Bottom & (JOBS_DEQUE_SIZE - 1)];
+        Result = true;
+
+        if(Top == Bottom)
+        {
+            //Last entry, race any thief for it through Top
+            if(atomic_CompareExchangeInt64(&Deque->Top, Top + 1, Top) != Top)
+            {
+                Result = false;
+            }
+
+            atomic_StoreInt64(&Deque->Bottom, Bottom + 1);
+        }
+    }
+    else
+    {
+        atomic_StoreInt64(&Deque->Bottom, Bottom + 1);
+    }
+
+    return Result;
+}
+
+//Any thread, takes the oldest entry
+internal bool32 jobs_Steal(JOBS_DEQUE *Deque, JOBS_ENTRY *Entry)
+{
+    int64 Top = atomic_LoadInt64(&Deque->Top);
+    FullMemoryBarrier;
+    int64 Bottom = atomic_LoadInt64(&Deque->Bottom);
+
+    bool32 Result = false;
+
+    if(Top < Bottom)
+    {
+        //Copy first, the slot can only be reused once Top moves and then the exchange fails
+        *Entry = Deque->Entries[Top & (JOBS_DEQUE_SIZE - 1)];
+
+        if(atomic_CompareExchangeInt64(&Deque->Top, Top + 1, Top) == Top)
+        {
+            Result = true;
+        }
+    }
+
+    return Result;
+}
+
+internal void jobs_RunEntry(HANDMADE_WORK_QUEUE *Queue, JOBS_DEQUE *Deque, JOBS_ENTRY Entry)
+{
+    Entry.Callback(Queue, Entry.Data);
+    ++Deque->Stats.Executed;
+
+    atomic_DecrementUInt32(&Queue->PendingCount);
+}
+
+//Own deque first, then every other deque starting from a random victim
+internal bool32 jobs_FindAndRunJob(HANDMADE_WORK_QUEUE *Queue, int ThreadIndex)
+{
+    JOBS_DEQUE *Deque = &Queue->Deques[ThreadIndex];
+    JOBS_ENTRY Entry;
+
+    if(jobs_Pop(Deque, &Entry))
+    {
+        jobs_RunEntry(Queue, Deque, Entry);
+        return true;
+    }
+
+    int ThreadCount = Queue->ThreadCount;
+    if(ThreadCount > 1)
+    {
+        //Xorshift, per thread so victims don't line up
+        uint32 Random = Deque->RandomState;
+        Random ^= Random << 13;
+        Random ^= Random >> 17;
+        Random ^= Random << 5;
+        Deque->RandomState = Random;
+
+        int FirstVictim = (int) (Random % (uint32) ThreadCount);
+
+        for(int VictimOffset = 0; VictimOffset < ThreadCount; ++VictimOffset)
+        {
+            int VictimIndex = (FirstVictim + VictimOffset) % ThreadCount;
+            if(VictimIndex == ThreadIndex)
+            {
+                continue;
+            }
+
+            ++Deque->Stats.StealAttempts;
+
+            if(jobs_Steal(&Queue->Deques[VictimIndex], &Entry))
+            {
+                ++Deque->Stats.Steals;
+                jobs_RunEntry(Queue, Deque, Entry);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+internal bool32 jobs_AnyWorkQueued(HANDMADE_WORK_QUEUE *Queue)
+{
+    for(int ThreadIndex = 0; ThreadIndex < Queue->ThreadCount; ++ThreadIndex)
+    {
+        JOBS_DEQUE *Deque = &Queue->Deques[ThreadIndex];
+
+        if(atomic_LoadInt64(&Deque->Top) < atomic_LoadInt64(&Deque->Bottom))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+internal PLATFORM_ADD_WORK_ENTRY(jobs_AddWorkEntry)
+{
+    int ThreadIndex = jobs_GetThreadIndex(Queue);
+
+    //Threads outside the queue have no deque to push to
+    if(ThreadIndex < 0)
+    {
+        Callback(Queue, Data);
+        return;
+    }
+
+    JOBS_DEQUE *Deque = &Queue->Deques[ThreadIndex];
+
+    JOBS_ENTRY Entry;
+    Entry.Callback = Callback;
+    Entry.Data = Data;
+
+    atomic_IncrementUInt32(&Queue->PendingCount);
+    ++Deque->Stats.Pushed;
+
+    if(!jobs_Push(Deque, Entry))
+    {
+        //Deque full, running it here is the back pressure
+        ++Deque->Stats.RanInline;
+        jobs_RunEntry(Queue, Deque, Entry);
+        return;
+    }
+
+    //Pairs with the barrier a worker takes between announcing it sleeps and checking for work
+    FullMemoryBarrier;
+
+    if(Queue->SleepingCount > 0)
+    {
+        Queue->SignalSemaphore(Queue->SemaphoreHandle, 1);
+    }
+}
+
+internal PLATFORM_COMPLETE_ALL_WORK(jobs_CompleteAllWork)
+{
+    int ThreadIndex = jobs_GetThreadIndex(Queue);
+
+    if(ThreadIndex < 0)
+    {
+        while(Queue->PendingCount != 0)
+        {
+            _mm_pause();
+        }
+
+        return;
+    }
+
+    while(Queue->PendingCount != 0)
+    {
+        if(!jobs_FindAndRunJob(Queue, ThreadIndex))
+        {
+            _mm_pause();
+        }
+    }
+}
+
+//Body of every worker thread, never returns
+internal void jobs_WorkerLoop(HANDMADE_WORK_QUEUE *Queue, int ThreadIndex)
+{
+    jobs_JoinQueue(Queue, ThreadIndex);
+
+    int SpinCount = 0;
+
+    for(;;)
+    {
+        if(jobs_FindAndRunJob(Queue, ThreadIndex))
+        {
+            SpinCount = 0;
+            continue;
+        }
+
+        if(++SpinCount < JOBS_SPIN_COUNT)
+        {
+            _mm_pause();
+            continue;
+        }
+
+        //Announce before the last check so a pusher either sees us sleeping or we see its job
+        atomic_IncrementUInt32(&Queue->SleepingCount);
+
+        if(!jobs_AnyWorkQueued(Queue))
+        {
+            Queue->WaitSemaphore(Queue->SemaphoreHandle);
+        }
+
+        atomic_DecrementUInt32(&Queue->SleepingCount);
+        SpinCount = 0;
+    }
+}
+
+//Totals across every thread, only meaningful once the queue is idle
+internal JOBS_THREAD_STATS jobs_GetStats(HANDMADE_WORK_QUEUE *Queue)
+{
+    JOBS_THREAD_STATS Total = {};
+
+    for(int ThreadIndex = 0; ThreadIndex < Queue->ThreadCount; ++ThreadIndex)
+    {
+        JOBS_THREAD_STATS *Stats = &Queue->Deques[ThreadIndex].Stats;
+
+        Total.Pushed += Stats->Pushed;
+        Total.Executed += Stats->Executed;
+        Total.RanInline += Stats->RanInline;
+        Total.StealAttempts += Stats->StealAttempts;
+        Total.Steals += Stats->Steals;
+    }
+
+    return Total;
+}
+
+internal void jobs_ResetStats(HANDMADE_WORK_QUEUE *Queue)
+{
+    for(int ThreadIndex = 0; ThreadIndex < Queue->ThreadCount; ++ThreadIndex)
+    {
+        Queue->Deques[ThreadIndex].Stats = {};
+    }
+}
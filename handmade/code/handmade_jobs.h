@@ -0,0 +1,67 @@
+#if !defined(HANDMADE_JOBS_H)
+
+//Work stealing job system behind HANDMADE_PLATFORM::AddWorkEntry/CompleteAllWork
+//Every thread owns a Chase-Lev deque: the owner pushes and pops at the bottom, idle threads steal from the top
+//Only threads belonging to the queue (the thread that made it plus its workers) may push, a thread can belong to several queues
+
+#define JOBS_MAX_THREADS 64
+#define JOBS_MAX_QUEUES_PER_THREAD 4
+#define JOBS_DEQUE_SIZE 4096 //Must be a power of two
+#define JOBS_SPIN_COUNT 64 //Failed searches before a worker goes to sleep
+
+struct JOBS_ENTRY
+{
+    platform_work_queue_callback *Callback;
+    void *Data;
+};
+
+//Only ever written by the owning thread
+struct JOBS_THREAD_STATS
+{
+    uint64 Pushed;
+    uint64 Executed;
+    uint64 RanInline; //Deque was full so the pushing thread ran the job itself
+    uint64 StealAttempts;
+    uint64 Steals;
+};
+
+//Top and Bottom live on their own cache lines, thieves hammer Top while the owner works Bottom
+struct JOBS_DEQUE
+{
+    int64 volatile Top;
+    uint8 PadTop[56];
+
+    int64 volatile Bottom;
+    uint8 PadBottom[56];
+
+    JOBS_THREAD_STATS Stats;
+    uint32 RandomState;
+    uint8 PadStats[20];
+
+    JOBS_ENTRY Entries[JOBS_DEQUE_SIZE];
+};
+
+//Idle workers sleep on a platform semaphore
+#define JOBS_SIGNAL_SEMAPHORE(name) void name(void *SemaphoreHandle, int Count)
+typedef JOBS_SIGNAL_SEMAPHORE(jobs_signal_semaphore);
+
+#define JOBS_WAIT_SEMAPHORE(name) void name(void *SemaphoreHandle)
+typedef JOBS_WAIT_SEMAPHORE(jobs_wait_semaphore);
+
+struct HANDMADE_WORK_QUEUE
+{
+    int ThreadCount; //Workers plus the owning thread at index 0
+
+    //Jobs pushed but not yet finished, nested pushes count before their parent finishes
+    uint32 volatile PendingCount;
+    uint32 volatile SleepingCount;
+
+    void *SemaphoreHandle;
+    jobs_signal_semaphore *SignalSemaphore;
+    jobs_wait_semaphore *WaitSemaphore;
+
+    JOBS_DEQUE *Deques; //ThreadCount entries, 64 byte aligned
+};
+
+#define HANDMADE_JOBS_H
+#endif
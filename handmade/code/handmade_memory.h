@@ -0,0 +1,86 @@
+#if !defined(HANDMADE_MEMORY_H)
+
+//Push allocators over the platform's memory block, nothing is ever freed individually
+//Temporary memory rolls an arena back to where it was when the scope began
+
+#define MEMORY_DEFAULT_ALIGNMENT 16
+
+struct MEMORY_ARENA
+{
+    size_t Size;
+    uint8 *Base;
+    size_t Used;
+    int TemporaryCount;
+};
+
+struct TEMPORARY_MEMORY
+{
+    MEMORY_ARENA *Arena;
+    size_t Used;
+};
+
+internal void memory_InitArena(MEMORY_ARENA *Arena, size_t Size, void *Base)
+{
+    Arena->Size = Size;
+    Arena->Base = (uint8 *) Base;
+    Arena->Used = 0;
+    Arena->TemporaryCount = 0;
+}
+
+//Alignment must be a power of two
+internal void *memory_PushSize_(MEMORY_ARENA *Arena, size_t Size, size_t Alignment)
+{
+    size_t AlignmentMask = Alignment - 1;
+    size_t Current = (size_t) (Arena->Base + Arena->Used);
+    size_t AlignmentOffset = (Alignment - (Current & AlignmentMask)) & AlignmentMask;
+
+    Assert((Arena->Used + AlignmentOffset + Size) <= Arena->Size);
+
+    void *Result = Arena->Base + Arena->Used + AlignmentOffset;
+    Arena->Used += AlignmentOffset + Size;
+
+    return Result;
+}
+
+#define memory_PushStruct(Arena, Type) (Type *) memory_PushSize_(Arena, sizeof(Type), MEMORY_DEFAULT_ALIGNMENT)
+#define memory_PushArray(Arena, Count, Type) (Type *) memory_PushSize_(Arena, (Count) * sizeof(Type), MEMORY_DEFAULT_ALIGNMENT)
+#define memory_PushSize(Arena, Size) memory_PushSize_(Arena, Size, MEMORY_DEFAULT_ALIGNMENT)
+
+//Carves a child arena out of the parent, the child's memory is never returned to the parent
+internal void memory_SubArena(MEMORY_ARENA *Result, MEMORY_ARENA *Arena, size_t Size)
+{
+    memory_InitArena(Result, Size, memory_PushSize(Arena, Size));
+}
+
+internal TEMPORARY_MEMORY memory_BeginTemporaryMemory(MEMORY_ARENA *Arena)
+{
+    TEMPORARY_MEMORY Result;
+    Result.Arena = Arena;
+    Result.Used = Arena->Used;
+
+    ++Arena->TemporaryCount;
+
+    return Result;
+}
+
+//Scopes must end in the reverse order they began
+internal void memory_EndTemporaryMemory(TEMPORARY_MEMORY TemporaryMemory)
+{
+    MEMORY_ARENA *Arena = TemporaryMemory.Arena;
+
+    Assert(Arena->Used >= TemporaryMemory.Used);
+    Assert(Arena->TemporaryCount > 0);
+
+    Arena->Used = TemporaryMemory.Used;
+    --Arena->TemporaryCount;
+}
+
+//Call once per frame, a leaked temporary scope would slowly eat the arena
+internal void memory_CheckArena(MEMORY_ARENA *Arena)
+{
+    (void) Arena; //Only the Assert reads it
+    Assert(Arena->TemporaryCount == 0);
+}
+
+#define HANDMADE_MEMORY_H
+#endif
@@ -0,0 +1,103 @@
+#include "handmade.h"
+#include "handmade_memory.h"
+#include "handmade_render.cpp"
+#include "handmade_sound.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "handmade_asset_builder.cpp"
+
+//Bakes source art into a pack file: handmade_packer handmade.hha player=art/player.bmp blip=sound/blip.wav ...
+//Each asset is looked up at runtime by the name before the '='
+
+#define PACKER_MAX_ASSETS 4096
+
+int main(int ArgumentCount, char **Arguments)
+{
+    if(ArgumentCount < 2)
+    {
+        fprintf(stderr, "Usage: %s pack.hha [name=file.bmp|file.wav ...]\n"
+                        "\tbitmaps are 24 or 32 bit uncompressed, sounds 16 bit PCM or 32 bit float, mono or stereo\n"
+                        "\tsounds of %d seconds or more are streamed, shorter ones decoded to 16 bit\n"
+                        "\tsounds keep their rate, the game converts any not at the rate it mixes at as they play\n"
+                        "\tnames are at most %d characters\n", Arguments[0], BUILDER_STREAM_MIN_SECONDS, ASSET_MAX_NAME - 1);
+        return 1;
+    }
+
+    int AssetCount = ArgumentCount - 2;
+    if(AssetCount > PACKER_MAX_ASSETS)
+    {
+        fprintf(stderr, "At most %d assets per pack\n", PACKER_MAX_ASSETS);
+        return 1;
+    }
+
+    BUILDER_ASSET *Assets = (BUILDER_ASSET *) calloc((size_t) (AssetCount ? AssetCount : 1), sizeof(BUILDER_ASSET));
+    uint64 PayloadSize = 0;
+
+    for(int AssetIndex = 0; AssetIndex < AssetCount; ++AssetIndex)
+    {
+        char *Argument = Arguments[AssetIndex + 2];
+        char *Equals = strchr(Argument, '=');
+
+        if(!Equals || (Equals == Argument))
+        {
+            fprintf(stderr, "Expected name=file, got %s\n", Argument);
+            return 1;
+        }
+
+        *Equals = 0;
+        char *Name = Argument;
+        char *Path = Equals + 1;
+
+        for(int OtherIndex = 0; OtherIndex < AssetIndex; ++OtherIndex)
+        {
+            if(strcmp(Assets[OtherIndex].Name, Name) == 0)
+            {
+                fprintf(stderr, "%s is named twice\n", Name);
+                return 1;
+            }
+        }
+
+        if(!builder_LoadAsset(&Assets[AssetIndex], Name, Path))
+        {
+            fprintf(stderr, "Can't load %s from %s\n", Name, Path);
+            return 1;
+        }
+
+        BUILDER_ASSET *Asset = &Assets[AssetIndex];
+        if(Asset->Type == ASSET_TYPE_BITMAP)
+        {
+            printf("%-32s bitmap %dx%d\n", Name, Asset->Bitmap.Width, Asset->Bitmap.Height);
+            PayloadSize += (uint64) Asset->Bitmap.Pitch * Asset->Bitmap.Height;
+        }
+        else if(Asset->Type == ASSET_TYPE_STREAM)
+        {
+            printf("%-32s stream %d channels, %d %s samples at %d Hz\n", Name, Asset->Stream.ChannelCount, Asset->Stream.SampleCount,
+                   (Asset->Stream.Format == SOUND_SAMPLE_FORMAT_INT16) ? "int16" : "float32", Asset->Stream.SampleRate);
+            PayloadSize += builder_GetStreamSize(&Asset->Stream);
+        }
+        else
+        {
+            printf("%-32s sound %d channels, %d samples at %d Hz\n", Name, Asset->Sound.ChannelCount, Asset->Sound.SampleCount, Asset->Sound.SampleRate);
+            PayloadSize += (uint64) Asset->Sound.SampleCount * Asset->Sound.ChannelCount * sizeof(int16);
+        }
+    }
+
+    if(!builder_WritePack(Arguments[1], Assets, AssetCount))
+    {
+        fprintf(stderr, "Can't write %s\n", Arguments[1]);
+        return 1;
+    }
+
+    printf("Wrote %s: %d assets, %llu payload bytes\n", Arguments[1], AssetCount, (unsigned long long) PayloadSize);
+
+    for(int AssetIndex = 0; AssetIndex < AssetCount; ++AssetIndex)
+    {
+        builder_FreeAsset(&Assets[AssetIndex]);
+    }
+    free(Assets);
+
+    return 0;
+}
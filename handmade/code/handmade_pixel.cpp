@@ -0,0 +1,198 @@
+#include "handmade_pixel.h"
+
+//Active kernels per source format, chosen from CPUID on first use unless the platform picked a level
+global pixel_convert_row *pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_COUNT];
+
+//Every index unpacked once, for the kernels that look colours up instead of widening bits
+global uint32 pixel_Palette[256];
+
+template <typename FORMAT> internal PIXEL_CONVERT_ROW(pixel_ConvertRow_Scalar)
+{
+    typename FORMAT::PIXEL *Pixel = (typename FORMAT::PIXEL *) Source;
+
+    for(int Index = 0; Index < Count; ++Index)
+    {
+        Dest[Index] = FORMAT::Unpack(Pixel[Index]);
+    }
+}
+
+internal HANDMADE_TARGET_SSE2 PIXEL_CONVERT_ROW(pixel_ConvertRow_BGRX8888_SSE2)
+{
+    uint32 *Pixel = (uint32 *) Source;
+
+    int Index = 0;
+    for(; Index + 4 <= Count; Index += 4)
+    {
+        _mm_storeu_si128((__m128i *) (Dest + Index), _mm_loadu_si128((__m128i *) (Pixel + Index)));
+    }
+
+    for(; Index < Count; ++Index)
+    {
+        Dest[Index] = Pixel[Index];
+    }
+}
+
+internal HANDMADE_TARGET_AVX2 PIXEL_CONVERT_ROW(pixel_ConvertRow_BGRX8888_AVX2)
+{
+    uint32 *Pixel = (uint32 *) Source;
+
+    int Index = 0;
+    for(; Index + 8 <= Count; Index += 8)
+    {
+        _mm256_storeu_si256((__m256i *) (Dest + Index), _mm256_loadu_si256((__m256i *) (Pixel + Index)));
+    }
+
+    for(; Index < Count; ++Index)
+    {
+        Dest[Index] = Pixel[Index];
+    }
+}
+
+//Channels widened in 16 bit lanes, then blue and green interleaved with red into 32 bit pixels
+internal HANDMADE_TARGET_SSE2 PIXEL_CONVERT_ROW(pixel_ConvertRow_RGB565_SSE2)
+{
+    uint16 *Pixel = (uint16 *) Source;
+    __m128i GreenMask = _mm_set1_epi16(0x3F);
+    __m128i BlueMask = _mm_set1_epi16(0x1F);
+
+    int Index = 0;
+    for(; Index + 8 <= Count; Index += 8)
+    {
+        __m128i Packed = _mm_loadu_si128((__m128i *) (Pixel + Index));
+
+        __m128i Red = _mm_srli_epi16(Packed, 11);
+        __m128i Green = _mm_and_si128(_mm_srli_epi16(Packed, 5), GreenMask);
+        __m128i Blue = _mm_and_si128(Packed, BlueMask);
+
+        Red = _mm_or_si128(_mm_slli_epi16(Red, 3), _mm_srli_epi16(Red, 2));
+        Green = _mm_or_si128(_mm_slli_epi16(Green, 2), _mm_srli_epi16(Green, 4));
+        Blue = _mm_or_si128(_mm_slli_epi16(Blue, 3), _mm_srli_epi16(Blue, 2));
+
+        __m128i BlueGreen = _mm_or_si128(Blue, _mm_slli_epi16(Green, 8));
+        _mm_storeu_si128((__m128i *) (Dest + Index), _mm_unpacklo_epi16(BlueGreen, Red));
+        _mm_storeu_si128((__m128i *) (Dest + Index + 4), _mm_unpackhi_epi16(BlueGreen, Red));
+    }
+
+    pixel_ConvertRow_Scalar<PIXEL_RGB565>(Dest + Index, Pixel + Index, Count - Index);
+}
+
+//Unpacks work within 128 bit halves, so the two halves of the result are swapped back into pixel order on the way out
+internal HANDMADE_TARGET_AVX2 PIXEL_CONVERT_ROW(pixel_ConvertRow_RGB565_AVX2)
+{
+    uint16 *Pixel = (uint16 *) Source;
+    __m256i GreenMask = _mm256_set1_epi16(0x3F);
+    __m256i BlueMask = _mm256_set1_epi16(0x1F);
+
+    int Index = 0;
+    for(; Index + 16 <= Count; Index += 16)
+    {
+        __m256i Packed = _mm256_loadu_si256((__m256i *) (Pixel + Index));
+
+        __m256i Red = _mm256_srli_epi16(Packed, 11);
+        __m256i Green = _mm256_and_si256(_mm256_srli_epi16(Packed, 5), GreenMask);
+        __m256i Blue = _mm256_and_si256(Packed, BlueMask);
+
+        Red = _mm256_or_si256(_mm256_slli_epi16(Red, 3), _mm256_srli_epi16(Red, 2));
+        Green = _mm256_or_si256(_mm256_slli_epi16(Green, 2), _mm256_srli_epi16(Green, 4));
+        Blue = _mm256_or_si256(_mm256_slli_epi16(Blue, 3), _mm256_srli_epi16(Blue, 2));
+
+        __m256i BlueGreen = _mm256_or_si256(Blue, _mm256_slli_epi16(Green, 8));
+        __m256i Low = _mm256_unpacklo_epi16(BlueGreen, Red);
+        __m256i High = _mm256_unpackhi_epi16(BlueGreen, Red);
+
+        _mm256_storeu_si256((__m256i *) (Dest + Index), _mm256_permute2x128_si256(Low, High, 0x20));
+        _mm256_storeu_si256((__m256i *) (Dest + Index + 8), _mm256_permute2x128_si256(Low, High, 0x31));
+    }
+
+    pixel_ConvertRow_Scalar<PIXEL_RGB565>(Dest + Index, Pixel + Index, Count - Index);
+}
+
+//SSE2 has no gather, one lookup per pixel still beats widening the bits
+internal PIXEL_CONVERT_ROW(pixel_ConvertRow_Indexed8_Table)
+{
+    uint8 *Pixel = (uint8 *) Source;
+
+    for(int Index = 0; Index < Count; ++Index)
+    {
+        Dest[Index] = pixel_Palette[Pixel[Index]];
+    }
+}
+
+internal HANDMADE_TARGET_AVX2 PIXEL_CONVERT_ROW(pixel_ConvertRow_Indexed8_AVX2)
+{
+    uint8 *Pixel = (uint8 *) Source;
+
+    int Index = 0;
+    for(; Index + 8 <= Count; Index += 8)
+    {
+        __m256i Indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i *) (Pixel + Index)));
+        _mm256_storeu_si256((__m256i *) (Dest + Index), _mm256_i32gather_epi32((int *) pixel_Palette, Indices, 4));
+    }
+
+    pixel_ConvertRow_Indexed8_Table(Dest + Index, Pixel + Index, Count - Index);
+}
+
+//Returns the level actually used, which may be lower than requested
+internal SIMD_LEVEL pixel_SelectKernels(SIMD_LEVEL Requested)
+{
+    SIMD_LEVEL Selected = cpu_SelectSimdLevel(Requested);
+
+    for(int Index = 0; Index < 256; ++Index)
+    {
+        pixel_Palette[Index] = PIXEL_INDEXED8::Unpack((uint8) Index);
+    }
+
+    switch(Selected)
+    {
+        case SIMD_LEVEL_AVX2:
+        {
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = pixel_ConvertRow_BGRX8888_AVX2;
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = pixel_ConvertRow_RGB565_AVX2;
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = pixel_ConvertRow_Indexed8_AVX2;
+            break;
+        }
+
+        case SIMD_LEVEL_SSE2:
+        {
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = pixel_ConvertRow_BGRX8888_SSE2;
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = pixel_ConvertRow_RGB565_SSE2;
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = pixel_ConvertRow_Indexed8_Table;
+            break;
+        }
+
+        default:
+        {
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = pixel_ConvertRow_Scalar<PIXEL_BGRX8888>;
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = pixel_ConvertRow_Scalar<PIXEL_RGB565>;
+            pixel_ConvertRow_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = pixel_ConvertRow_Scalar<PIXEL_INDEXED8>;
+            break;
+        }
+    }
+
+    return Selected;
+}
+
+//Present step: Rect of Source widened into the same pixels of Dest, which must be BGRX8888 and at least as large
+//Returns the bytes written
+internal uint64 pixel_ConvertRect(HANDMADE_OFFSCREEN_BUFFER *Dest, HANDMADE_OFFSCREEN_BUFFER *Source, HANDMADE_RECT Rect)
+{
+    if(!pixel_ConvertRow_Kernels[0])
+    {
+        pixel_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+
+    pixel_convert_row *Kernel = pixel_ConvertRow_Kernels[Source->Format];
+    int Count = Rect.MaxX - Rect.MinX;
+
+    uint8 *SourceRow = (uint8 *) Source->BitmapMemory + (Rect.MinY * Source->Pitch) + (Rect.MinX * PixelFormatBytes[Source->Format]);
+    uint8 *DestRow = (uint8 *) Dest->BitmapMemory + (Rect.MinY * Dest->Pitch) + (Rect.MinX * 4);
+
+    for(int Y = Rect.MinY; Y < Rect.MaxY; ++Y)
+    {
+        Kernel((uint32 *) DestRow, SourceRow, Count);
+        SourceRow += Source->Pitch;
+        DestRow += Dest->Pitch;
+    }
+
+    return (uint64) Count * (uint64) (Rect.MaxY - Rect.MinY) * 4;
+}
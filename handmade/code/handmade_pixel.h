@@ -0,0 +1,83 @@
+#if !defined(HANDMADE_PIXEL_H)
+
+//Compile time traits for each HANDMADE_PIXEL_FORMAT, kernels are templates over one so every format gets its own loop
+//with packing inlined and nothing decided per pixel
+//Pack takes 0xAARRGGBB and keeps the top bits of each channel, Unpack widens them back by repeating those bits so 0xFF stays 0xFF
+//Only BGRX8888 keeps the fourth byte, the others unpack it as 0 like the gradient writes it
+
+struct PIXEL_BGRX8888
+{
+    typedef uint32 PIXEL;
+
+    static PIXEL Pack(uint32 Colour)
+    {
+        return Colour;
+    }
+
+    static uint32 Unpack(PIXEL Pixel)
+    {
+        return Pixel;
+    }
+
+    //Copies of one pixel filling 32 bits, for wide stores
+    static uint32 Replicate(PIXEL Pixel)
+    {
+        return Pixel;
+    }
+};
+
+struct PIXEL_RGB565
+{
+    typedef uint16 PIXEL;
+
+    static PIXEL Pack(uint32 Colour)
+    {
+        return (PIXEL) (((Colour >> 8) & 0xF800) | ((Colour >> 5) & 0x07E0) | ((Colour >> 3) & 0x001F));
+    }
+
+    static uint32 Unpack(PIXEL Pixel)
+    {
+        uint32 Red = (Pixel >> 11) & 0x1F;
+        uint32 Green = (Pixel >> 5) & 0x3F;
+        uint32 Blue = Pixel & 0x1F;
+
+        return (((Red << 3) | (Red >> 2)) << 16) | (((Green << 2) | (Green >> 4)) << 8) | ((Blue << 3) | (Blue >> 2));
+    }
+
+    static uint32 Replicate(PIXEL Pixel)
+    {
+        return (uint32) Pixel * 0x00010001;
+    }
+};
+
+//Palette is fixed, so indices pack and unpack without a lookup: 3 bits red, 3 green, 2 blue
+struct PIXEL_INDEXED8
+{
+    typedef uint8 PIXEL;
+
+    static PIXEL Pack(uint32 Colour)
+    {
+        return (PIXEL) (((Colour >> 16) & 0xE0) | ((Colour >> 11) & 0x1C) | ((Colour >> 6) & 0x03));
+    }
+
+    static uint32 Unpack(PIXEL Pixel)
+    {
+        uint32 Red = Pixel >> 5;
+        uint32 Green = (Pixel >> 2) & 0x07;
+        uint32 Blue = Pixel & 0x03;
+
+        return (((Red << 5) | (Red << 2) | (Red >> 1)) << 16) | (((Green << 5) | (Green << 2) | (Green >> 1)) << 8) | (Blue * 0x55);
+    }
+
+    static uint32 Replicate(PIXEL Pixel)
+    {
+        return (uint32) Pixel * 0x01010101;
+    }
+};
+
+//Count pixels of one format widened to 0xXXRRGGBB, which is what both platforms present
+#define PIXEL_CONVERT_ROW(name) void name(uint32 *Dest, void *Source, int Count)
+typedef PIXEL_CONVERT_ROW(pixel_convert_row);
+
+#define HANDMADE_PIXEL_H
+#endif
@@ -0,0 +1,1021 @@
+#include "handmade_pixel.h"
+#include "handmade_render.h"
+
+//Active kernels per backbuffer format, chosen from CPUID on first use unless the platform picked a level
+global render_gradient *render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_COUNT];
+global render_fill_rect *render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_COUNT];
+global render_blit *render_Blit_Kernels[HANDMADE_PIXEL_FORMAT_COUNT];
+
+template <typename FORMAT> internal RENDER_GRADIENT(render_Gradient_Scalar)
+{    
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory; 
+
+    //Animation loops
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        typename FORMAT::PIXEL *Pixel = (typename FORMAT::PIXEL *) Row;
+
+        for(int X = 0; X < Buffer->BitmapWidth; ++X)
+        {
+            //Pixels in memory = 0x xxBBGGRR (Little Endian)
+            uint8 Blue = (X + XOffset);
+            uint8 Green = (Y + YOffset);
+
+            //Pixel increments by 1 * sizeof(PIXEL), 4 bytes for BGRX8888
+            //xx BB GG RR -> xx RR GG BB from Little Endian
+            *Pixel++ = FORMAT::Pack((Green << 8) | Blue); //Shift and Or RGB values together, then down to the format
+        }
+
+        //Pitch moves from one row to the next (in bytes)
+        Row += Buffer->Pitch;
+    }
+}
+
+//4 pixels per iteration, X + XOffset is kept in 32 bit lanes and masked to the low byte
+//so wrap around matches the uint8 truncation in the scalar path exactly
+internal HANDMADE_TARGET_SSE2 RENDER_GRADIENT(render_Gradient_SSE2)
+{
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory;
+
+    __m128i LaneIndex = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i LaneStep = _mm_set1_epi32(4);
+    __m128i BlueMask = _mm_set1_epi32(0xFF);
+    __m128i XStart = _mm_add_epi32(_mm_set1_epi32(XOffset), LaneIndex);
+
+    int Width = Buffer->BitmapWidth;
+
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        uint32 *Pixel = (uint32 *) Row;
+
+        uint8 Green = (Y + YOffset);
+        __m128i GreenWide = _mm_set1_epi32(Green << 8);
+        __m128i X4 = XStart;
+
+        int X = 0;
+        for(; X + 4 <= Width; X += 4)
+        {
+            __m128i Colour = _mm_or_si128(_mm_and_si128(X4, BlueMask), GreenWide);
+            _mm_storeu_si128((__m128i *) (Pixel + X), Colour);
+
+            X4 = _mm_add_epi32(X4, LaneStep);
+        }
+
+        //Remainder when the width isn't a multiple of 4
+        for(; X < Width; ++X)
+        {
+            uint8 Blue = (X + XOffset);
+            Pixel[X] = ((Green << 8) | Blue);
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+//16 pixels per iteration as two 8 wide stores, then one 8 wide and scalar tails
+internal HANDMADE_TARGET_AVX2 RENDER_GRADIENT(render_Gradient_AVX2)
+{
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory;
+
+    __m256i LaneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i LaneStep = _mm256_set1_epi32(8);
+    __m256i BlueMask = _mm256_set1_epi32(0xFF);
+    __m256i XStart = _mm256_add_epi32(_mm256_set1_epi32(XOffset), LaneIndex);
+
+    int Width = Buffer->BitmapWidth;
+
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        uint32 *Pixel = (uint32 *) Row;
+
+        uint8 Green = (Y + YOffset);
+        __m256i GreenWide = _mm256_set1_epi32(Green << 8);
+        __m256i X8 = XStart;
+
+        int X = 0;
+        for(; X + 16 <= Width; X += 16)
+        {
+            __m256i Colour0 = _mm256_or_si256(_mm256_and_si256(X8, BlueMask), GreenWide);
+            X8 = _mm256_add_epi32(X8, LaneStep);
+            __m256i Colour1 = _mm256_or_si256(_mm256_and_si256(X8, BlueMask), GreenWide);
+            X8 = _mm256_add_epi32(X8, LaneStep);
+
+            _mm256_storeu_si256((__m256i *) (Pixel + X), Colour0);
+            _mm256_storeu_si256((__m256i *) (Pixel + X + 8), Colour1);
+        }
+
+        if(X + 8 <= Width)
+        {
+            __m256i Colour = _mm256_or_si256(_mm256_and_si256(X8, BlueMask), GreenWide);
+            _mm256_storeu_si256((__m256i *) (Pixel + X), Colour);
+            X += 8;
+        }
+
+        for(; X < Width; ++X)
+        {
+            uint8 Blue = (X + XOffset);
+            Pixel[X] = ((Green << 8) | Blue);
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+//RGB565 keeps X + XOffset in 16 bit lanes, their low byte wraps exactly like the uint8 in the scalar path
+internal HANDMADE_TARGET_SSE2 RENDER_GRADIENT(render_Gradient_RGB565_SSE2)
+{
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory;
+
+    __m128i LaneStep = _mm_set1_epi16(8);
+    __m128i BlueMask = _mm_set1_epi16(0xF8);
+    __m128i XStart = _mm_add_epi16(_mm_set1_epi16((int16) XOffset), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7));
+
+    int Width = Buffer->BitmapWidth;
+
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        uint16 *Pixel = (uint16 *) Row;
+
+        uint8 Green = (Y + YOffset);
+        __m128i GreenWide = _mm_set1_epi16((int16) ((Green >> 2) << 5));
+        __m128i X8 = XStart;
+
+        int X = 0;
+        for(; X + 8 <= Width; X += 8)
+        {
+            __m128i Colour = _mm_or_si128(_mm_srli_epi16(_mm_and_si128(X8, BlueMask), 3), GreenWide);
+            _mm_storeu_si128((__m128i *) (Pixel + X), Colour);
+
+            X8 = _mm_add_epi16(X8, LaneStep);
+        }
+
+        for(; X < Width; ++X)
+        {
+            uint8 Blue = (X + XOffset);
+            Pixel[X] = PIXEL_RGB565::Pack((Green << 8) | Blue);
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+internal HANDMADE_TARGET_AVX2 RENDER_GRADIENT(render_Gradient_RGB565_AVX2)
+{
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory;
+
+    __m256i LaneStep = _mm256_set1_epi16(16);
+    __m256i BlueMask = _mm256_set1_epi16(0xF8);
+    __m256i XStart = _mm256_add_epi16(_mm256_set1_epi16((int16) XOffset), _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+    int Width = Buffer->BitmapWidth;
+
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        uint16 *Pixel = (uint16 *) Row;
+
+        uint8 Green = (Y + YOffset);
+        __m256i GreenWide = _mm256_set1_epi16((int16) ((Green >> 2) << 5));
+        __m256i X16 = XStart;
+
+        int X = 0;
+        for(; X + 16 <= Width; X += 16)
+        {
+            __m256i Colour = _mm256_or_si256(_mm256_srli_epi16(_mm256_and_si256(X16, BlueMask), 3), GreenWide);
+            _mm256_storeu_si256((__m256i *) (Pixel + X), Colour);
+
+            X16 = _mm256_add_epi16(X16, LaneStep);
+        }
+
+        for(; X < Width; ++X)
+        {
+            uint8 Blue = (X + XOffset);
+            Pixel[X] = PIXEL_RGB565::Pack((Green << 8) | Blue);
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+//Indexed keeps X + XOffset in byte lanes, which wrap on their own
+//A 16 bit shift drags the neighbouring byte's bits in above bit 1, the mask leaves only blue's top two
+internal HANDMADE_TARGET_SSE2 RENDER_GRADIENT(render_Gradient_Indexed8_SSE2)
+{
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory;
+
+    __m128i LaneStep = _mm_set1_epi8(16);
+    __m128i BlueMask = _mm_set1_epi8(0x03);
+    __m128i XStart = _mm_add_epi8(_mm_set1_epi8((char) XOffset), _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+    int Width = Buffer->BitmapWidth;
+
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        uint8 *Pixel = Row;
+
+        uint8 Green = (Y + YOffset);
+        __m128i GreenWide = _mm_set1_epi8((char) ((Green >> 5) << 2));
+        __m128i X16 = XStart;
+
+        int X = 0;
+        for(; X + 16 <= Width; X += 16)
+        {
+            __m128i Colour = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(X16, 6), BlueMask), GreenWide);
+            _mm_storeu_si128((__m128i *) (Pixel + X), Colour);
+
+            X16 = _mm_add_epi8(X16, LaneStep);
+        }
+
+        for(; X < Width; ++X)
+        {
+            uint8 Blue = (X + XOffset);
+            Pixel[X] = PIXEL_INDEXED8::Pack((Green << 8) | Blue);
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+internal HANDMADE_TARGET_AVX2 RENDER_GRADIENT(render_Gradient_Indexed8_AVX2)
+{
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory;
+
+    __m256i LaneStep = _mm256_set1_epi8(32);
+    __m256i BlueMask = _mm256_set1_epi8(0x03);
+    __m256i XStart = _mm256_add_epi8(_mm256_set1_epi8((char) XOffset), _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                                                                         16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31));
+
+    int Width = Buffer->BitmapWidth;
+
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        uint8 *Pixel = Row;
+
+        uint8 Green = (Y + YOffset);
+        __m256i GreenWide = _mm256_set1_epi8((char) ((Green >> 5) << 2));
+        __m256i X32 = XStart;
+
+        int X = 0;
+        for(; X + 32 <= Width; X += 32)
+        {
+            __m256i Colour = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(X32, 6), BlueMask), GreenWide);
+            _mm256_storeu_si256((__m256i *) (Pixel + X), Colour);
+
+            X32 = _mm256_add_epi8(X32, LaneStep);
+        }
+
+        for(; X < Width; ++X)
+        {
+            uint8 Blue = (X + XOffset);
+            Pixel[X] = PIXEL_INDEXED8::Pack((Green << 8) | Blue);
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+template <typename FORMAT> internal RENDER_FILL_RECT(render_FillRect_Scalar)
+{
+    typedef typename FORMAT::PIXEL PIXEL;
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory + (MinY * Buffer->Pitch) + (MinX * (int) sizeof(PIXEL));
+    PIXEL Packed = FORMAT::Pack(Colour);
+
+    for(int Y = MinY; Y < MaxY; ++Y)
+    {
+        PIXEL *Pixel = (PIXEL *) Row;
+
+        for(int X = MinX; X < MaxX; ++X)
+        {
+            *Pixel++ = Packed;
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+//The packed colour is repeated across the register, so one store covers 16 / sizeof(PIXEL) pixels whatever the format
+template <typename FORMAT> internal HANDMADE_TARGET_SSE2 RENDER_FILL_RECT(render_FillRect_SSE2)
+{
+    typedef typename FORMAT::PIXEL PIXEL;
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory + (MinY * Buffer->Pitch) + (MinX * (int) sizeof(PIXEL));
+    PIXEL Packed = FORMAT::Pack(Colour);
+    __m128i Wide = _mm_set1_epi32((int) FORMAT::Replicate(Packed));
+    int Width = MaxX - MinX;
+    int Step = 16 / (int) sizeof(PIXEL);
+
+    for(int Y = MinY; Y < MaxY; ++Y)
+    {
+        PIXEL *Pixel = (PIXEL *) Row;
+
+        int X = 0;
+        for(; X + Step <= Width; X += Step)
+        {
+            _mm_storeu_si128((__m128i *) (Pixel + X), Wide);
+        }
+
+        for(; X < Width; ++X)
+        {
+            Pixel[X] = Packed;
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+template <typename FORMAT> internal HANDMADE_TARGET_AVX2 RENDER_FILL_RECT(render_FillRect_AVX2)
+{
+    typedef typename FORMAT::PIXEL PIXEL;
+    uint8 *Row = (uint8 *) Buffer->BitmapMemory + (MinY * Buffer->Pitch) + (MinX * (int) sizeof(PIXEL));
+    PIXEL Packed = FORMAT::Pack(Colour);
+    __m256i Wide = _mm256_set1_epi32((int) FORMAT::Replicate(Packed));
+    int Width = MaxX - MinX;
+    int Step = 32 / (int) sizeof(PIXEL);
+
+    for(int Y = MinY; Y < MaxY; ++Y)
+    {
+        PIXEL *Pixel = (PIXEL *) Row;
+
+        int X = 0;
+        for(; X + Step <= Width; X += Step)
+        {
+            _mm256_storeu_si256((__m256i *) (Pixel + X), Wide);
+        }
+
+        for(; X < Width; ++X)
+        {
+            Pixel[X] = Packed;
+        }
+
+        Row += Buffer->Pitch;
+    }
+}
+
+//Reference for one pixel, the SIMD kernels do the same integer math per 16 bit lane so results match bit for bit
+//Filtered source is rounded to 8 bits, then Dest * (255 - SourceAlpha) / 255 rounds exactly via (T + (T >> 8)) >> 8
+internal uint32 render_BlendPixel(uint32 Dest, uint32 T00, uint32 T10, uint32 T01, uint32 T11, RENDER_BLIT_WEIGHTS *Weights)
+{
+    uint32 Source[4];
+    for(int Channel = 0; Channel < 4; ++Channel)
+    {
+        int Shift = Channel * 8;
+        uint32 Sum = (((T00 >> Shift) & 0xFF) * Weights->W00) + (((T10 >> Shift) & 0xFF) * Weights->W10) +
+                     (((T01 >> Shift) & 0xFF) * Weights->W01) + (((T11 >> Shift) & 0xFF) * Weights->W11);
+        Source[Channel] = (Sum + 128) >> 8;
+    }
+
+    uint32 InverseAlpha = 255 - Source[3];
+    uint32 Result = 0;
+
+    for(int Channel = 0; Channel < 4; ++Channel)
+    {
+        int Shift = Channel * 8;
+        uint32 Scaled = (((Dest >> Shift) & 0xFF) * InverseAlpha) + 128;
+        Scaled = (Scaled + (Scaled >> 8)) >> 8;
+
+        uint32 Blended = Source[Channel] + Scaled;
+        if(Blended > 255)
+        {
+            Blended = 255;
+        }
+
+        Result |= Blended << Shift;
+    }
+
+    return Result;
+}
+
+//Formats narrower than BGRX8888 widen the destination, blend as 8 bit channels and pack the result back
+template <typename FORMAT> internal RENDER_BLIT(render_Blit_Scalar)
+{
+    uint8 *DestRow = (uint8 *) Buffer->BitmapMemory + (MinY * Buffer->Pitch);
+
+    for(int Y = MinY; Y < MaxY; ++Y)
+    {
+        typename FORMAT::PIXEL *Dest = (typename FORMAT::PIXEL *) DestRow;
+        int T = Y - OriginY;
+        uint32 *Row0 = (uint32 *) ((uint8 *) Bitmap->Memory + ((T - 1) * Bitmap->Pitch));
+        uint32 *Row1 = (uint32 *) ((uint8 *) Bitmap->Memory + (T * Bitmap->Pitch));
+
+        for(int X = MinX; X < MaxX; ++X)
+        {
+            int S = X - OriginX;
+            Dest[X] = FORMAT::Pack(render_BlendPixel(FORMAT::Unpack(Dest[X]), Row0[S - 1], Row0[S], Row1[S - 1], Row1[S], &Weights));
+        }
+
+        DestRow += Buffer->Pitch;
+    }
+}
+
+//Two pixels' worth of 16 bit channels: filter the four texels, then premultiplied over Dest
+internal HANDMADE_TARGET_SSE2 __m128i render_BlendPixels_SSE2(__m128i Dest, __m128i T00, __m128i T10, __m128i T01, __m128i T11,
+                                                              __m128i W00, __m128i W10, __m128i W01, __m128i W11)
+{
+    __m128i Half = _mm_set1_epi16(128);
+    __m128i Max = _mm_set1_epi16(255);
+
+    __m128i Source = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(T00, W00), _mm_mullo_epi16(T10, W10)),
+                                   _mm_add_epi16(_mm_mullo_epi16(T01, W01), _mm_mullo_epi16(T11, W11)));
+    Source = _mm_srli_epi16(_mm_add_epi16(Source, Half), 8);
+
+    //Alpha is channel 3 of each pixel, copied across that pixel's four lanes
+    __m128i Alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(Source, 0xFF), 0xFF);
+
+    __m128i Scaled = _mm_add_epi16(_mm_mullo_epi16(Dest, _mm_sub_epi16(Max, Alpha)), Half);
+    Scaled = _mm_srli_epi16(_mm_add_epi16(Scaled, _mm_srli_epi16(Scaled, 8)), 8);
+
+    return _mm_add_epi16(Source, Scaled);
+}
+
+//4 pixels per iteration, unpacked to two registers of 16 bit channels and packed back with saturation
+internal HANDMADE_TARGET_SSE2 RENDER_BLIT(render_Blit_SSE2)
+{
+    uint8 *DestRow = (uint8 *) Buffer->BitmapMemory + (MinY * Buffer->Pitch);
+
+    __m128i Zero = _mm_setzero_si128();
+    __m128i W00 = _mm_set1_epi16((short) Weights.W00);
+    __m128i W10 = _mm_set1_epi16((short) Weights.W10);
+    __m128i W01 = _mm_set1_epi16((short) Weights.W01);
+    __m128i W11 = _mm_set1_epi16((short) Weights.W11);
+
+    for(int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Dest = (uint32 *) DestRow;
+        int T = Y - OriginY;
+        uint32 *Row0 = (uint32 *) ((uint8 *) Bitmap->Memory + ((T - 1) * Bitmap->Pitch));
+        uint32 *Row1 = (uint32 *) ((uint8 *) Bitmap->Memory + (T * Bitmap->Pitch));
+
+        int X = MinX;
+        for(; X + 4 <= MaxX; X += 4)
+        {
+            int S = X - OriginX;
+
+            __m128i T00 = _mm_loadu_si128((__m128i *) (Row0 + S - 1));
+            __m128i T10 = _mm_loadu_si128((__m128i *) (Row0 + S));
+            __m128i T01 = _mm_loadu_si128((__m128i *) (Row1 + S - 1));
+            __m128i T11 = _mm_loadu_si128((__m128i *) (Row1 + S));
+            __m128i D = _mm_loadu_si128((__m128i *) (Dest + X));
+
+            __m128i Low = render_BlendPixels_SSE2(_mm_unpacklo_epi8(D, Zero), _mm_unpacklo_epi8(T00, Zero), _mm_unpacklo_epi8(T10, Zero),
+                                                  _mm_unpacklo_epi8(T01, Zero), _mm_unpacklo_epi8(T11, Zero), W00, W10, W01, W11);
+            __m128i High = render_BlendPixels_SSE2(_mm_unpackhi_epi8(D, Zero), _mm_unpackhi_epi8(T00, Zero), _mm_unpackhi_epi8(T10, Zero),
+                                                   _mm_unpackhi_epi8(T01, Zero), _mm_unpackhi_epi8(T11, Zero), W00, W10, W01, W11);
+
+            _mm_storeu_si128((__m128i *) (Dest + X), _mm_packus_epi16(Low, High));
+        }
+
+        for(; X < MaxX; ++X)
+        {
+            int S = X - OriginX;
+            Dest[X] = render_BlendPixel(Dest[X], Row0[S - 1], Row0[S], Row1[S - 1], Row1[S], &Weights);
+        }
+
+        DestRow += Buffer->Pitch;
+    }
+}
+
+internal HANDMADE_TARGET_AVX2 __m256i render_BlendPixels_AVX2(__m256i Dest, __m256i T00, __m256i T10, __m256i T01, __m256i T11,
+                                                              __m256i W00, __m256i W10, __m256i W01, __m256i W11)
+{
+    __m256i Half = _mm256_set1_epi16(128);
+    __m256i Max = _mm256_set1_epi16(255);
+
+    __m256i Source = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(T00, W00), _mm256_mullo_epi16(T10, W10)),
+                                      _mm256_add_epi16(_mm256_mullo_epi16(T01, W01), _mm256_mullo_epi16(T11, W11)));
+    Source = _mm256_srli_epi16(_mm256_add_epi16(Source, Half), 8);
+
+    __m256i Alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(Source, 0xFF), 0xFF);
+
+    __m256i Scaled = _mm256_add_epi16(_mm256_mullo_epi16(Dest, _mm256_sub_epi16(Max, Alpha)), Half);
+    Scaled = _mm256_srli_epi16(_mm256_add_epi16(Scaled, _mm256_srli_epi16(Scaled, 8)), 8);
+
+    return _mm256_add_epi16(Source, Scaled);
+}
+
+//8 pixels per iteration, unpack and pack both work within 128 bit halves so pixel order survives the round trip
+internal HANDMADE_TARGET_AVX2 RENDER_BLIT(render_Blit_AVX2)
+{
+    uint8 *DestRow = (uint8 *) Buffer->BitmapMemory + (MinY * Buffer->Pitch);
+
+    __m256i Zero = _mm256_setzero_si256();
+    __m256i W00 = _mm256_set1_epi16((short) Weights.W00);
+    __m256i W10 = _mm256_set1_epi16((short) Weights.W10);
+    __m256i W01 = _mm256_set1_epi16((short) Weights.W01);
+    __m256i W11 = _mm256_set1_epi16((short) Weights.W11);
+
+    for(int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Dest = (uint32 *) DestRow;
+        int T = Y - OriginY;
+        uint32 *Row0 = (uint32 *) ((uint8 *) Bitmap->Memory + ((T - 1) * Bitmap->Pitch));
+        uint32 *Row1 = (uint32 *) ((uint8 *) Bitmap->Memory + (T * Bitmap->Pitch));
+
+        int X = MinX;
+        for(; X + 8 <= MaxX; X += 8)
+        {
+            int S = X - OriginX;
+
+            __m256i T00 = _mm256_loadu_si256((__m256i *) (Row0 + S - 1));
+            __m256i T10 = _mm256_loadu_si256((__m256i *) (Row0 + S));
+            __m256i T01 = _mm256_loadu_si256((__m256i *) (Row1 + S - 1));
+            __m256i T11 = _mm256_loadu_si256((__m256i *) (Row1 + S));
+            __m256i D = _mm256_loadu_si256((__m256i *) (Dest + X));
+
+            __m256i Low = render_BlendPixels_AVX2(_mm256_unpacklo_epi8(D, Zero), _mm256_unpacklo_epi8(T00, Zero), _mm256_unpacklo_epi8(T10, Zero),
+                                                  _mm256_unpacklo_epi8(T01, Zero), _mm256_unpacklo_epi8(T11, Zero), W00, W10, W01, W11);
+            __m256i High = render_BlendPixels_AVX2(_mm256_unpackhi_epi8(D, Zero), _mm256_unpackhi_epi8(T00, Zero), _mm256_unpackhi_epi8(T10, Zero),
+                                                   _mm256_unpackhi_epi8(T01, Zero), _mm256_unpackhi_epi8(T11, Zero), W00, W10, W01, W11);
+
+            _mm256_storeu_si256((__m256i *) (Dest + X), _mm256_packus_epi16(Low, High));
+        }
+
+        //Sprite interiors are rarely a multiple of 8 wide, one 4 pixel step keeps the scalar tail to 3
+        if(X + 4 <= MaxX)
+        {
+            int S = X - OriginX;
+            __m128i Zero4 = _mm256_castsi256_si128(Zero);
+            __m128i W004 = _mm256_castsi256_si128(W00);
+            __m128i W104 = _mm256_castsi256_si128(W10);
+            __m128i W014 = _mm256_castsi256_si128(W01);
+            __m128i W114 = _mm256_castsi256_si128(W11);
+
+            __m128i T00 = _mm_loadu_si128((__m128i *) (Row0 + S - 1));
+            __m128i T10 = _mm_loadu_si128((__m128i *) (Row0 + S));
+            __m128i T01 = _mm_loadu_si128((__m128i *) (Row1 + S - 1));
+            __m128i T11 = _mm_loadu_si128((__m128i *) (Row1 + S));
+            __m128i D = _mm_loadu_si128((__m128i *) (Dest + X));
+
+            __m128i Low = render_BlendPixels_SSE2(_mm_unpacklo_epi8(D, Zero4), _mm_unpacklo_epi8(T00, Zero4), _mm_unpacklo_epi8(T10, Zero4),
+                                                  _mm_unpacklo_epi8(T01, Zero4), _mm_unpacklo_epi8(T11, Zero4), W004, W104, W014, W114);
+            __m128i High = render_BlendPixels_SSE2(_mm_unpackhi_epi8(D, Zero4), _mm_unpackhi_epi8(T00, Zero4), _mm_unpackhi_epi8(T10, Zero4),
+                                                   _mm_unpackhi_epi8(T01, Zero4), _mm_unpackhi_epi8(T11, Zero4), W004, W104, W014, W114);
+
+            _mm_storeu_si128((__m128i *) (Dest + X), _mm_packus_epi16(Low, High));
+            X += 4;
+        }
+
+        for(; X < MaxX; ++X)
+        {
+            int S = X - OriginX;
+            Dest[X] = render_BlendPixel(Dest[X], Row0[S - 1], Row0[S], Row1[S - 1], Row1[S], &Weights);
+        }
+
+        DestRow += Buffer->Pitch;
+    }
+}
+
+//Returns the level actually used, which may be lower than requested
+//Blits into RGB565 and indexed buffers are scalar at every level, their sprites are small next to the fills
+internal SIMD_LEVEL render_SelectKernels(SIMD_LEVEL Requested)
+{
+    SIMD_LEVEL Selected = cpu_SelectSimdLevel(Requested);
+
+    render_Blit_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = render_Blit_Scalar<PIXEL_RGB565>;
+    render_Blit_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = render_Blit_Scalar<PIXEL_INDEXED8>;
+
+    switch(Selected)
+    {
+        case SIMD_LEVEL_AVX2:
+        {
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_Gradient_AVX2;
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = render_Gradient_RGB565_AVX2;
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = render_Gradient_Indexed8_AVX2;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_FillRect_AVX2<PIXEL_BGRX8888>;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = render_FillRect_AVX2<PIXEL_RGB565>;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = render_FillRect_AVX2<PIXEL_INDEXED8>;
+            render_Blit_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_Blit_AVX2;
+            break;
+        }
+
+        case SIMD_LEVEL_SSE2:
+        {
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_Gradient_SSE2;
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = render_Gradient_RGB565_SSE2;
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = render_Gradient_Indexed8_SSE2;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_FillRect_SSE2<PIXEL_BGRX8888>;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = render_FillRect_SSE2<PIXEL_RGB565>;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = render_FillRect_SSE2<PIXEL_INDEXED8>;
+            render_Blit_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_Blit_SSE2;
+            break;
+        }
+
+        default:
+        {
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_Gradient_Scalar<PIXEL_BGRX8888>;
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = render_Gradient_Scalar<PIXEL_RGB565>;
+            render_Gradient_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = render_Gradient_Scalar<PIXEL_INDEXED8>;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_FillRect_Scalar<PIXEL_BGRX8888>;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_RGB565] = render_FillRect_Scalar<PIXEL_RGB565>;
+            render_FillRect_Kernels[HANDMADE_PIXEL_FORMAT_INDEXED8] = render_FillRect_Scalar<PIXEL_INDEXED8>;
+            render_Blit_Kernels[HANDMADE_PIXEL_FORMAT_BGRX8888] = render_Blit_Scalar<PIXEL_BGRX8888>;
+            break;
+        }
+    }
+
+    return Selected;
+}
+
+internal void render_Gradient(HANDMADE_OFFSCREEN_BUFFER *Buffer, int XOffset, int YOffset)
+{
+    TIMED_FUNCTION();
+
+    if(!render_Gradient_Kernels[0])
+    {
+        render_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+
+    render_Gradient_Kernels[Buffer->Format](Buffer, XOffset, YOffset);
+}
+
+internal int render_RoundToInt(float32 Value)
+{
+    return (int) floorf(Value + 0.5f);
+}
+
+internal HANDMADE_RECT render_GetBufferRect(HANDMADE_OFFSCREEN_BUFFER *Buffer)
+{
+    HANDMADE_RECT Result = {0, 0, Buffer->BitmapWidth, Buffer->BitmapHeight};
+    return Result;
+}
+
+internal HANDMADE_RECT render_IntersectRects(HANDMADE_RECT A, HANDMADE_RECT B)
+{
+    HANDMADE_RECT Result;
+    Result.MinX = (A.MinX > B.MinX) ? A.MinX : B.MinX;
+    Result.MinY = (A.MinY > B.MinY) ? A.MinY : B.MinY;
+    Result.MaxX = (A.MaxX < B.MaxX) ? A.MaxX : B.MaxX;
+    Result.MaxY = (A.MaxY < B.MaxY) ? A.MaxY : B.MaxY;
+
+    return Result;
+}
+
+internal HANDMADE_RECT render_UnionRects(HANDMADE_RECT A, HANDMADE_RECT B)
+{
+    HANDMADE_RECT Result;
+    Result.MinX = (A.MinX < B.MinX) ? A.MinX : B.MinX;
+    Result.MinY = (A.MinY < B.MinY) ? A.MinY : B.MinY;
+    Result.MaxX = (A.MaxX > B.MaxX) ? A.MaxX : B.MaxX;
+    Result.MaxY = (A.MaxY > B.MaxY) ? A.MaxY : B.MaxY;
+
+    return Result;
+}
+
+internal bool32 render_IsRectEmpty(HANDMADE_RECT Rect)
+{
+    return (Rect.MinX >= Rect.MaxX) || (Rect.MinY >= Rect.MaxY);
+}
+
+internal bool32 render_RectsEqual(HANDMADE_RECT A, HANDMADE_RECT B)
+{
+    return (A.MinX == B.MinX) && (A.MinY == B.MinY) && (A.MaxX == B.MaxX) && (A.MaxY == B.MaxY);
+}
+
+internal uint64 render_GetRectArea(HANDMADE_RECT Rect)
+{
+    return render_IsRectEmpty(Rect) ? 0 : ((uint64) (Rect.MaxX - Rect.MinX) * (uint64) (Rect.MaxY - Rect.MinY));
+}
+
+//View of part of Buffer sharing its Pitch, like a tile
+internal HANDMADE_OFFSCREEN_BUFFER render_GetSubBuffer(HANDMADE_OFFSCREEN_BUFFER *Buffer, HANDMADE_RECT Rect)
+{
+    HANDMADE_OFFSCREEN_BUFFER Result;
+    Result.BitmapMemory = (uint8 *) Buffer->BitmapMemory + (Rect.MinY * Buffer->Pitch) + (Rect.MinX * PixelFormatBytes[Buffer->Format]);
+    Result.BitmapWidth = Rect.MaxX - Rect.MinX;
+    Result.BitmapHeight = Rect.MaxY - Rect.MinY;
+    Result.Pitch = Buffer->Pitch;
+    Result.Format = Buffer->Format;
+
+    return Result;
+}
+
+//Pixels render_DrawRectangle writes before clipping
+internal HANDMADE_RECT render_GetRectangleBounds(float32 MinX, float32 MinY, float32 MaxX, float32 MaxY)
+{
+    HANDMADE_RECT Result = {render_RoundToInt(MinX), render_RoundToInt(MinY), render_RoundToInt(MaxX), render_RoundToInt(MaxY)};
+    return Result;
+}
+
+//Solid fill, edges round to the nearest pixel boundary and the rectangle is clipped to Clip, which must lie inside the buffer
+internal void render_DrawRectangleClipped(HANDMADE_OFFSCREEN_BUFFER *Buffer, float32 MinX, float32 MinY, float32 MaxX, float32 MaxY, uint32 Colour, HANDMADE_RECT Clip)
+{
+    if(!render_FillRect_Kernels[0])
+    {
+        render_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+
+    HANDMADE_RECT Rect = render_IntersectRects(render_GetRectangleBounds(MinX, MinY, MaxX, MaxY), Clip);
+
+    if(!render_IsRectEmpty(Rect))
+    {
+        render_FillRect_Kernels[Buffer->Format](Buffer, Rect.MinX, Rect.MinY, Rect.MaxX, Rect.MaxY, Colour);
+    }
+}
+
+internal void render_DrawRectangle(HANDMADE_OFFSCREEN_BUFFER *Buffer, float32 MinX, float32 MinY, float32 MaxX, float32 MaxY, uint32 Colour)
+{
+    render_DrawRectangleClipped(Buffer, MinX, MinY, MaxX, MaxY, Colour, render_GetBufferRect(Buffer));
+}
+
+//Texels outside the bitmap are transparent, only the one pixel border of a blit needs this
+internal uint32 render_GetTexel(RENDER_BITMAP *Bitmap, int S, int T)
+{
+    uint32 Result = 0;
+
+    if((S >= 0) && (T >= 0) && (S < Bitmap->Width) && (T < Bitmap->Height))
+    {
+        Result = *(uint32 *) ((uint8 *) Bitmap->Memory + (T * Bitmap->Pitch) + (S * 4));
+    }
+
+    return Result;
+}
+
+template <typename FORMAT> internal RENDER_BLIT(render_BlitEdge)
+{
+    for(int Y = MinY; Y < MaxY; ++Y)
+    {
+        typename FORMAT::PIXEL *Dest = (typename FORMAT::PIXEL *) ((uint8 *) Buffer->BitmapMemory + (Y * Buffer->Pitch));
+        int T = Y - OriginY;
+
+        for(int X = MinX; X < MaxX; ++X)
+        {
+            int S = X - OriginX;
+            Dest[X] = FORMAT::Pack(render_BlendPixel(FORMAT::Unpack(Dest[X]), render_GetTexel(Bitmap, S - 1, T - 1), render_GetTexel(Bitmap, S, T - 1),
+                                                     render_GetTexel(Bitmap, S - 1, T), render_GetTexel(Bitmap, S, T), &Weights));
+        }
+    }
+}
+
+//Edges need no SIMD, a table per format keeps the call sites free of a switch
+global render_blit *render_BlitEdge_Kernels[HANDMADE_PIXEL_FORMAT_COUNT] =
+{
+    render_BlitEdge<PIXEL_BGRX8888>,
+    render_BlitEdge<PIXEL_RGB565>,
+    render_BlitEdge<PIXEL_INDEXED8>,
+};
+
+//Whole pixel origin and 1/256th fraction a blit at X snaps to
+internal void render_GetBlitOrigin(float32 X, int *Origin, int *Fraction)
+{
+    *Origin = (int) floorf(X);
+    *Fraction = render_RoundToInt((X - (float32) *Origin) * 256.0f);
+
+    if(*Fraction == 256)
+    {
+        ++*Origin;
+        *Fraction = 0;
+    }
+}
+
+//Pixels render_DrawBitmap writes before clipping, a fractional position spills one more row or column
+internal HANDMADE_RECT render_GetBitmapBounds(RENDER_BITMAP *Bitmap, float32 X, float32 Y)
+{
+    int OriginX, OriginY, FractionX, FractionY;
+    render_GetBlitOrigin(X, &OriginX, &FractionX);
+    render_GetBlitOrigin(Y, &OriginY, &FractionY);
+
+    HANDMADE_RECT Result = {OriginX, OriginY, OriginX + Bitmap->Width + (FractionX ? 1 : 0), OriginY + Bitmap->Height + (FractionY ? 1 : 0)};
+    return Result;
+}
+
+//Premultiplied alpha over the buffer with Bitmap's top left corner at (X, Y), only pixels inside Clip are touched
+//A fractional position is a box filtered one pixel shift, so sprites move smoothly instead of snapping
+//The kernel takes the interior where all four texels exist, the one pixel ring around it goes through render_BlitEdge
+internal void render_DrawBitmapClipped(HANDMADE_OFFSCREEN_BUFFER *Buffer, RENDER_BITMAP *Bitmap, float32 X, float32 Y, HANDMADE_RECT Clip)
+{
+    if(!render_Blit_Kernels[0])
+    {
+        render_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+
+    render_blit *Blit = render_Blit_Kernels[Buffer->Format];
+    render_blit *BlitEdge = render_BlitEdge_Kernels[Buffer->Format];
+
+    int OriginX, OriginY, FractionX, FractionY;
+    render_GetBlitOrigin(X, &OriginX, &FractionX);
+    render_GetBlitOrigin(Y, &OriginY, &FractionY);
+
+    RENDER_BLIT_WEIGHTS Weights;
+    Weights.W00 = (FractionX * FractionY) >> 8;
+    Weights.W01 = (FractionX * (256 - FractionY)) >> 8;
+    Weights.W10 = ((256 - FractionX) * FractionY) >> 8;
+    Weights.W11 = 256 - Weights.W00 - Weights.W01 - Weights.W10;
+
+    HANDMADE_RECT Bounds = render_IntersectRects(render_GetBitmapBounds(Bitmap, X, Y), Clip);
+
+    if(render_IsRectEmpty(Bounds))
+    {
+        return;
+    }
+
+    int MinX = Bounds.MinX;
+    int MinY = Bounds.MinY;
+    int MaxX = Bounds.MaxX;
+    int MaxY = Bounds.MaxY;
+
+    //Interior is where S - 1 >= 0, S < Width and the same for T
+    int InnerMinX = OriginX + 1;
+    int InnerMinY = OriginY + 1;
+    int InnerMaxX = OriginX + Bitmap->Width;
+    int InnerMaxY = OriginY + Bitmap->Height;
+
+    if(InnerMinX < MinX) InnerMinX = MinX;
+    if(InnerMinY < MinY) InnerMinY = MinY;
+    if(InnerMaxX > MaxX) InnerMaxX = MaxX;
+    if(InnerMaxY > MaxY) InnerMaxY = MaxY;
+
+    if((InnerMinX >= InnerMaxX) || (InnerMinY >= InnerMaxY))
+    {
+        BlitEdge(Buffer, Bitmap, MinX, MinY, MaxX, MaxY, OriginX, OriginY, Weights);
+        return;
+    }
+
+    Blit(Buffer, Bitmap, InnerMinX, InnerMinY, InnerMaxX, InnerMaxY, OriginX, OriginY, Weights);
+
+    //Top and bottom strips full width, left and right strips between them
+    BlitEdge(Buffer, Bitmap, MinX, MinY, MaxX, InnerMinY, OriginX, OriginY, Weights);
+    BlitEdge(Buffer, Bitmap, MinX, InnerMaxY, MaxX, MaxY, OriginX, OriginY, Weights);
+    BlitEdge(Buffer, Bitmap, MinX, InnerMinY, InnerMinX, InnerMaxY, OriginX, OriginY, Weights);
+    BlitEdge(Buffer, Bitmap, InnerMaxX, InnerMinY, MaxX, InnerMaxY, OriginX, OriginY, Weights);
+}
+
+internal void render_DrawBitmap(HANDMADE_OFFSCREEN_BUFFER *Buffer, RENDER_BITMAP *Bitmap, float32 X, float32 Y)
+{
+    render_DrawBitmapClipped(Buffer, Bitmap, X, Y, render_GetBufferRect(Buffer));
+}
+
+internal void render_ClearDirtyRects(HANDMADE_DIRTY_RECTS *Dirty)
+{
+    Dirty->RectCount = 0;
+    Dirty->DirtyPixelCount = 0;
+}
+
+//Clipped to the buffer, a full list collapses into one bounding rectangle rather than losing anything
+internal void render_AddDirtyRect(HANDMADE_DIRTY_RECTS *Dirty, HANDMADE_OFFSCREEN_BUFFER *Buffer, HANDMADE_RECT Rect)
+{
+    Rect = render_IntersectRects(Rect, render_GetBufferRect(Buffer));
+
+    if(render_IsRectEmpty(Rect))
+    {
+        return;
+    }
+
+    if(Dirty->RectCount == HANDMADE_MAX_DIRTY_RECTS)
+    {
+        for(int RectIndex = 1; RectIndex < Dirty->RectCount; ++RectIndex)
+        {
+            Dirty->Rects[0] = render_UnionRects(Dirty->Rects[0], Dirty->Rects[RectIndex]);
+        }
+
+        Dirty->Rects[0] = render_UnionRects(Dirty->Rects[0], Rect);
+        Dirty->RectCount = 1;
+        return;
+    }
+
+    Dirty->Rects[Dirty->RectCount++] = Rect;
+}
+
+//Merges any two rectangles that overlap, which leaves the list disjoint so nothing is drawn or presented twice,
+//and any two whose bounding box wastes no more than RENDER_DIRTY_MERGE_SLACK pixels, which saves a present per pair
+internal void render_CoalesceDirtyRects(HANDMADE_DIRTY_RECTS *Dirty)
+{
+    TIMED_FUNCTION();
+
+    bool32 Merged = true;
+
+    while(Merged)
+    {
+        Merged = false;
+
+        for(int First = 0; (First < Dirty->RectCount) && !Merged; ++First)
+        {
+            for(int Second = First + 1; Second < Dirty->RectCount; ++Second)
+            {
+                HANDMADE_RECT A = Dirty->Rects[First];
+                HANDMADE_RECT B = Dirty->Rects[Second];
+                HANDMADE_RECT Union = render_UnionRects(A, B);
+                HANDMADE_RECT Overlap = render_IntersectRects(A, B);
+
+                uint64 Covered = render_GetRectArea(A) + render_GetRectArea(B) - render_GetRectArea(Overlap);
+
+                if(!render_IsRectEmpty(Overlap) || (render_GetRectArea(Union) <= Covered + RENDER_DIRTY_MERGE_SLACK))
+                {
+                    Dirty->Rects[First] = Union;
+                    Dirty->Rects[Second] = Dirty->Rects[--Dirty->RectCount];
+                    Merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    Dirty->DirtyPixelCount = 0;
+    for(int RectIndex = 0; RectIndex < Dirty->RectCount; ++RectIndex)
+    {
+        Dirty->DirtyPixelCount += render_GetRectArea(Dirty->Rects[RectIndex]);
+    }
+}
+
+//Straight alpha to premultiplied in place, for bitmaps that come from files
+internal void render_PremultiplyBitmap(RENDER_BITMAP *Bitmap)
+{
+    uint8 *Row = (uint8 *) Bitmap->Memory;
+
+    for(int Y = 0; Y < Bitmap->Height; ++Y)
+    {
+        uint32 *Texel = (uint32 *) Row;
+
+        for(int X = 0; X < Bitmap->Width; ++X)
+        {
+            uint32 Alpha = *Texel >> 24;
+            uint32 Result = Alpha << 24;
+
+            for(int Shift = 0; Shift < 24; Shift += 8)
+            {
+                uint32 Scaled = (((*Texel >> Shift) & 0xFF) * Alpha) + 128;
+                Result |= ((Scaled + (Scaled >> 8)) >> 8) << Shift;
+            }
+
+            *Texel++ = Result;
+        }
+
+        Row += Bitmap->Pitch;
+    }
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(render_DoTileWork)
+{
+    (void) Queue;
+    RENDER_TILE_WORK *Work = (RENDER_TILE_WORK *) Data;
+    render_Gradient(&Work->Tile, Work->XOffset, Work->YOffset);
+}
+
+//Split the backbuffer into tiles and render one job per tile on the platform's work queue
+//Tiles are sub-buffers sharing the parent Pitch, offsets are shifted so the output matches render_Gradient exactly
+//With Dirty set only the parts of tiles inside its rectangles are rendered, tiles it doesn't touch get no job at all
+//Work entries are temporary memory on Arena, released once the barrier at the end has passed
+internal void render_GradientTiled(HANDMADE_PLATFORM *Platform, MEMORY_ARENA *Arena, HANDMADE_OFFSCREEN_BUFFER *Buffer, int XOffset, int YOffset, HANDMADE_DIRTY_RECTS *Dirty)
+{
+    TIMED_FUNCTION();
+
+    //Select on the calling thread before any worker can race on the kernel pointers
+    if(!render_Gradient_Kernels[0])
+    {
+        render_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+
+    int TileWidth = Platform->RenderTileWidth;
+    int TileHeight = Platform->RenderTileHeight;
+
+    if(TileWidth <= 0)
+    {
+        TileWidth = Buffer->BitmapWidth;
+    }
+    if(TileHeight <= 0)
+    {
+        TileHeight = Buffer->BitmapHeight;
+    }
+
+    TileWidth = ((TileWidth + RENDER_TILE_ALIGN_PIXELS - 1) / RENDER_TILE_ALIGN_PIXELS) * RENDER_TILE_ALIGN_PIXELS;
+
+    int TileCountX = (Buffer->BitmapWidth + TileWidth - 1) / TileWidth;
+    int TileCountY = (Buffer->BitmapHeight + TileHeight - 1) / TileHeight;
+
+    int RectCount = Dirty ? Dirty->RectCount : 1;
+    HANDMADE_RECT *Rects = Dirty ? Dirty->Rects : 0;
+    HANDMADE_RECT Whole = render_GetBufferRect(Buffer);
+
+    TEMPORARY_MEMORY TileMemory = memory_BeginTemporaryMemory(Arena);
+    RENDER_TILE_WORK *WorkEntries = memory_PushArray(Arena, TileCountX * TileCountY * RectCount, RENDER_TILE_WORK);
+
+    int WorkCount = 0;
+
+    for(int TileY = 0; TileY < Buffer->BitmapHeight; TileY += TileHeight)
+    {
+        for(int TileX = 0; TileX < Buffer->BitmapWidth; TileX += TileWidth)
+        {
+            HANDMADE_RECT TileRect = {TileX, TileY, TileX + TileWidth, TileY + TileHeight};
+            TileRect = render_IntersectRects(TileRect, Whole);
+
+            //Dirty rectangles are disjoint, so their pieces of one tile never overlap either
+            for(int RectIndex = 0; RectIndex < RectCount; ++RectIndex)
+            {
+                HANDMADE_RECT Rect = Rects ? render_IntersectRects(TileRect, Rects[RectIndex]) : TileRect;
+
+                if(render_IsRectEmpty(Rect))
+                {
+                    continue;
+                }
+
+                RENDER_TILE_WORK *Work = &WorkEntries[WorkCount++];
+                Work->Tile = render_GetSubBuffer(Buffer, Rect);
+                Work->XOffset = XOffset + Rect.MinX;
+                Work->YOffset = YOffset + Rect.MinY;
+
+                Platform->AddWorkEntry(Platform->JobQueue, render_DoTileWork, Work);
+            }
+        }
+    }
+
+    //Barrier, nothing can be presented until every tile is written
+    Platform->CompleteAllWork(Platform->JobQueue);
+
+    memory_EndTemporaryMemory(TileMemory);
+}
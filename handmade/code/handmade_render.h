@@ -0,0 +1,60 @@
+#if !defined(HANDMADE_RENDER_H)
+
+//Kernel prototype so every instruction set variant shares one signature
+#define RENDER_GRADIENT(name) void name(HANDMADE_OFFSCREEN_BUFFER *Buffer, int XOffset, int YOffset)
+typedef RENDER_GRADIENT(render_gradient);
+
+//Premultiplied alpha, 0xAARRGGBB in memory order BB GG RR AA like the backbuffer
+struct RENDER_BITMAP
+{
+    int Width;
+    int Height;
+    int Pitch;
+    void *Memory;
+};
+
+//Box filter coverage of one destination pixel by the 2x2 texels under it, in 1/256ths summing to 256
+//00 is texel (S - 1, T - 1), 10 is (S, T - 1), 01 is (S - 1, T), 11 is (S, T)
+struct RENDER_BLIT_WEIGHTS
+{
+    uint32 W00;
+    uint32 W10;
+    uint32 W01;
+    uint32 W11;
+};
+
+//Rectangles are in destination pixels, Min inclusive and Max exclusive, already clipped to the buffer
+#define RENDER_FILL_RECT(name) void name(HANDMADE_OFFSCREEN_BUFFER *Buffer, int MinX, int MinY, int MaxX, int MaxY, uint32 Colour)
+typedef RENDER_FILL_RECT(render_fill_rect);
+
+//Destination pixel (X, Y) samples around texel (X - OriginX, Y - OriginY), the rectangle only covers pixels whose four texels are all inside Bitmap
+#define RENDER_BLIT(name) void name(HANDMADE_OFFSCREEN_BUFFER *Buffer, RENDER_BITMAP *Bitmap, int MinX, int MinY, int MaxX, int MaxY, int OriginX, int OriginY, RENDER_BLIT_WEIGHTS Weights)
+typedef RENDER_BLIT(render_blit);
+
+//Tiles start on a 64 byte boundary so neighbouring jobs never write the same cache line
+#define RENDER_TILE_ALIGN_PIXELS 16
+
+//Two dirty rectangles merge when their bounding box covers at most this many pixels neither of them does
+#define RENDER_DIRTY_MERGE_SLACK (64 * 64)
+
+struct RENDER_TILE_WORK
+{
+    HANDMADE_OFFSCREEN_BUFFER Tile;
+    int XOffset;
+    int YOffset;
+};
+
+internal SIMD_LEVEL render_SelectKernels(SIMD_LEVEL Requested);
+internal void render_Gradient(HANDMADE_OFFSCREEN_BUFFER *Buffer, int XOffset, int YOffset);
+internal void render_DrawRectangle(HANDMADE_OFFSCREEN_BUFFER *Buffer, float32 MinX, float32 MinY, float32 MaxX, float32 MaxY, uint32 Colour);
+internal void render_DrawRectangleClipped(HANDMADE_OFFSCREEN_BUFFER *Buffer, float32 MinX, float32 MinY, float32 MaxX, float32 MaxY, uint32 Colour, HANDMADE_RECT Clip);
+internal void render_DrawBitmap(HANDMADE_OFFSCREEN_BUFFER *Buffer, RENDER_BITMAP *Bitmap, float32 X, float32 Y);
+internal void render_DrawBitmapClipped(HANDMADE_OFFSCREEN_BUFFER *Buffer, RENDER_BITMAP *Bitmap, float32 X, float32 Y, HANDMADE_RECT Clip);
+internal void render_PremultiplyBitmap(RENDER_BITMAP *Bitmap);
+internal void render_GradientTiled(HANDMADE_PLATFORM *Platform, MEMORY_ARENA *Arena, HANDMADE_OFFSCREEN_BUFFER *Buffer, int XOffset, int YOffset, HANDMADE_DIRTY_RECTS *Dirty);
+internal void render_ClearDirtyRects(HANDMADE_DIRTY_RECTS *Dirty);
+internal void render_AddDirtyRect(HANDMADE_DIRTY_RECTS *Dirty, HANDMADE_OFFSCREEN_BUFFER *Buffer, HANDMADE_RECT Rect);
+internal void render_CoalesceDirtyRects(HANDMADE_DIRTY_RECTS *Dirty);
+
+#define HANDMADE_RENDER_H
+#endif
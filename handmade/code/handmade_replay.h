@@ -0,0 +1,52 @@
+#if !defined(HANDMADE_REPLAY_H)
+
+//Input recording: a snapshot of permanent storage followed by every frame's input
+//Playing it back from the snapshot reproduces the session exactly, so a recording doubles as a benchmark workload
+//Transient storage is scratch by contract and isn't saved
+
+#define REPLAY_MAGIC 0x31494D48 //"HMI1"
+#define REPLAY_VERSION 2 //2 added the per-frame input events
+
+struct REPLAY_HEADER
+{
+    uint32 Magic;
+    uint32 Version;
+    uint32 InputSize; //sizeof(REPLAY_FRAME) when recorded, a changed input layout makes old files unplayable
+    bool32 IsInitialised; //HANDMADE_MEMORY::IsInitialised at the snapshot
+
+    //Snapshot holds pointers into itself, playback must map permanent storage at the same address
+    uint64 PermanentStorageBase;
+    uint64 PermanentStorageSize;
+
+    int32 SampleRate;
+    int32 Pad;
+};
+
+//Sound state advances by however many samples the platform asked for, so that's recorded too
+struct REPLAY_FRAME
+{
+    HANDMADE_INPUT_USER Input;
+    int32 SoundSampleCount;
+};
+
+internal void replay_InitHeader(REPLAY_HEADER *Header, HANDMADE_MEMORY *Memory, int SampleRate)
+{
+    *Header = {};
+    Header->Magic = REPLAY_MAGIC;
+    Header->Version = REPLAY_VERSION;
+    Header->InputSize = sizeof(REPLAY_FRAME);
+    Header->IsInitialised = Memory->IsInitialised;
+    Header->PermanentStorageBase = (uint64) Memory->PermanentStorage;
+    Header->PermanentStorageSize = Memory->PermanentStorageSize;
+    Header->SampleRate = SampleRate;
+}
+
+//Returns false if the file was recorded by an incompatible build or against a differently placed memory block
+internal bool32 replay_CheckHeader(REPLAY_HEADER *Header, HANDMADE_MEMORY *Memory)
+{
+    return (Header->Magic == REPLAY_MAGIC) && (Header->Version == REPLAY_VERSION) && (Header->InputSize == sizeof(REPLAY_FRAME)) &&
+           (Header->PermanentStorageBase == (uint64) Memory->PermanentStorage) && (Header->PermanentStorageSize == Memory->PermanentStorageSize);
+}
+
+#define HANDMADE_REPLAY_H
+#endif
@@ -0,0 +1,383 @@
+#include "handmade_resample.h"
+
+//Active kernel, chosen from CPUID on first use unless the platform picked a level
+global resample_filter_frames *resample_FilterFrames_Kernel;
+
+//Phase set an output at Phase / Denominator past Index reads, exact unless the positions outnumber the phases
+internal uint32 resample_GetPhaseIndex(RESAMPLE_CONTEXT *Context)
+{
+    if((uint32) Context->PhaseCount == Context->Denominator)
+    {
+        return Context->Phase;
+    }
+
+    return (uint32) (((uint64) Context->Phase * (uint64) Context->PhaseCount) / Context->Denominator);
+}
+
+internal void resample_Advance(RESAMPLE_CONTEXT *Context)
+{
+    Context->Index += Context->InputStep;
+    Context->Phase += Context->PhaseStep;
+
+    if(Context->Phase >= Context->Denominator)
+    {
+        Context->Phase -= Context->Denominator;
+        ++Context->Index;
+    }
+}
+
+//Round to nearest even after clamping, same as sound_WriteSamples_Scalar
+internal int16 resample_ToSample(float32 Value)
+{
+    if(Value > 32767.0f)
+    {
+        Value = 32767.0f;
+    }
+    if(Value < -32768.0f)
+    {
+        Value = -32768.0f;
+    }
+
+    return (int16) lrintf(Value);
+}
+
+internal RESAMPLE_FILTER_FRAMES(resample_FilterFrames_Scalar)
+{
+    int TapCount = Context->TapCount;
+    int Written = 0;
+
+    while((Written < DestFrames) && (Context->Index + TapCount <= Context->HistoryFrames))
+    {
+        float32 *Taps = Context->History + (Context->Index * 2);
+        float32 *Coefficients = Context->Coefficients + ((size_t) resample_GetPhaseIndex(Context) * TapCount * 2);
+
+        float32 Left = 0.0f;
+        float32 Right = 0.0f;
+        for(int Tap = 0; Tap < TapCount * 2; Tap += 2)
+        {
+            Left += Taps[Tap] * Coefficients[Tap];
+            Right += Taps[Tap + 1] * Coefficients[Tap + 1];
+        }
+
+        Dest[(Written * 2)] = resample_ToSample(Left);
+        Dest[(Written * 2) + 1] = resample_ToSample(Right);
+        ++Written;
+
+        resample_Advance(Context);
+    }
+
+    return Written;
+}
+
+//Clamps, converts and packs the left and right sums in the two low lanes into one int16 frame
+internal HANDMADE_TARGET_SSE2 void resample_StoreFrame_SSE2(int16 *Dest, __m128 Sum)
+{
+    Sum = _mm_min_ps(_mm_max_ps(Sum, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+    __m128i Packed = _mm_packs_epi32(_mm_cvtps_epi32(Sum), _mm_setzero_si128());
+    *(int32 *) Dest = _mm_cvtsi128_si32(Packed);
+}
+
+//2 frames of history per register, lanes L R L R against coefficients c c c' c', two accumulators to hide the add latency
+//Folding the high pair onto the low one leaves left in lane 0 and right in lane 1
+internal HANDMADE_TARGET_SSE2 RESAMPLE_FILTER_FRAMES(resample_FilterFrames_SSE2)
+{
+    int TapCount = Context->TapCount;
+    int Written = 0;
+
+    while((Written < DestFrames) && (Context->Index + TapCount <= Context->HistoryFrames))
+    {
+        float32 *Taps = Context->History + (Context->Index * 2);
+        float32 *Coefficients = Context->Coefficients + ((size_t) resample_GetPhaseIndex(Context) * TapCount * 2);
+
+        __m128 Sum0 = _mm_setzero_ps();
+        __m128 Sum1 = _mm_setzero_ps();
+        for(int Tap = 0; Tap < TapCount * 2; Tap += 8)
+        {
+            Sum0 = _mm_add_ps(Sum0, _mm_mul_ps(_mm_loadu_ps(Taps + Tap), _mm_loadu_ps(Coefficients + Tap)));
+            Sum1 = _mm_add_ps(Sum1, _mm_mul_ps(_mm_loadu_ps(Taps + Tap + 4), _mm_loadu_ps(Coefficients + Tap + 4)));
+        }
+
+        __m128 Sum = _mm_add_ps(Sum0, Sum1);
+        Sum = _mm_add_ps(Sum, _mm_movehl_ps(Sum, Sum));
+
+        resample_StoreFrame_SSE2(Dest + (Written * 2), Sum);
+        ++Written;
+
+        resample_Advance(Context);
+    }
+
+    return Written;
+}
+
+//4 frames per register, the tap count is a multiple of 4 so whole registers cover it, two at a time while they last
+internal HANDMADE_TARGET_AVX2 RESAMPLE_FILTER_FRAMES(resample_FilterFrames_AVX2)
+{
+    int TapCount = Context->TapCount;
+    int Written = 0;
+
+    while((Written < DestFrames) && (Context->Index + TapCount <= Context->HistoryFrames))
+    {
+        float32 *Taps = Context->History + (Context->Index * 2);
+        float32 *Coefficients = Context->Coefficients + ((size_t) resample_GetPhaseIndex(Context) * TapCount * 2);
+
+        __m256 Sum0 = _mm256_setzero_ps();
+        __m256 Sum1 = _mm256_setzero_ps();
+
+        int Tap = 0;
+        for(; Tap + 16 <= TapCount * 2; Tap += 16)
+        {
+            Sum0 = _mm256_add_ps(Sum0, _mm256_mul_ps(_mm256_loadu_ps(Taps + Tap), _mm256_loadu_ps(Coefficients + Tap)));
+            Sum1 = _mm256_add_ps(Sum1, _mm256_mul_ps(_mm256_loadu_ps(Taps + Tap + 8), _mm256_loadu_ps(Coefficients + Tap + 8)));
+        }
+        if(Tap < TapCount * 2)
+        {
+            Sum0 = _mm256_add_ps(Sum0, _mm256_mul_ps(_mm256_loadu_ps(Taps + Tap), _mm256_loadu_ps(Coefficients + Tap)));
+        }
+
+        __m256 Sum8 = _mm256_add_ps(Sum0, Sum1);
+        __m128 Sum = _mm_add_ps(_mm256_castps256_ps128(Sum8), _mm256_extractf128_ps(Sum8, 1));
+        Sum = _mm_add_ps(Sum, _mm_movehl_ps(Sum, Sum));
+
+        resample_StoreFrame_SSE2(Dest + (Written * 2), Sum);
+        ++Written;
+
+        resample_Advance(Context);
+    }
+
+    return Written;
+}
+
+//Returns the level actually used, which may be lower than requested
+internal SIMD_LEVEL resample_SelectKernels(SIMD_LEVEL Requested)
+{
+    SIMD_LEVEL Selected = cpu_SelectSimdLevel(Requested);
+
+    switch(Selected)
+    {
+        case SIMD_LEVEL_AVX2:
+        {
+            resample_FilterFrames_Kernel = resample_FilterFrames_AVX2;
+            break;
+        }
+
+        case SIMD_LEVEL_SSE2:
+        {
+            resample_FilterFrames_Kernel = resample_FilterFrames_SSE2;
+            break;
+        }
+
+        default:
+        {
+            resample_FilterFrames_Kernel = resample_FilterFrames_Scalar;
+            break;
+        }
+    }
+
+    return Selected;
+}
+
+internal uint32 resample_GetGCD(uint32 A, uint32 B)
+{
+    while(B)
+    {
+        uint32 Remainder = A % B;
+        A = B;
+        B = Remainder;
+    }
+
+    return A;
+}
+
+//Both rates positive and within RESAMPLE_MAX_RATIO of each other
+internal void resample_GetShape(int InputRate, int OutputRate, RESAMPLE_QUALITY Quality, int *TapCount, int *PhaseCount)
+{
+    uint32 Denominator = (uint32) OutputRate / resample_GetGCD((uint32) InputRate, (uint32) OutputRate);
+    float64 Stretch = (InputRate > OutputRate) ? ((float64) InputRate / (float64) OutputRate) : 1.0;
+
+    int Taps = (int) ceil((float64) ResampleQualitySettings[Quality].TapCount * Stretch);
+    *TapCount = (Taps + 3) & ~3;
+    *PhaseCount = (Denominator < RESAMPLE_MAX_PHASES) ? (int) Denominator : RESAMPLE_MAX_PHASES;
+}
+
+internal size_t resample_GetMemorySize(int InputRate, int OutputRate, RESAMPLE_QUALITY Quality)
+{
+    int TapCount;
+    int PhaseCount;
+    resample_GetShape(InputRate, OutputRate, Quality, &TapCount, &PhaseCount);
+
+    return (((size_t) PhaseCount * TapCount) + TapCount + RESAMPLE_BLOCK_FRAMES) * 2 * sizeof(float32);
+}
+
+//Zeroth order modified Bessel function of the first kind, the series converges long before 64 terms for any beta used here
+internal float64 resample_BesselI0(float64 X)
+{
+    float64 Sum = 1.0;
+    float64 Term = 1.0;
+
+    for(int K = 1; K < 64; ++K)
+    {
+        float64 Half = X / (2.0 * (float64) K);
+        Term *= Half * Half;
+        Sum += Term;
+
+        if(Term < (Sum * 1e-17))
+        {
+            break;
+        }
+    }
+
+    return Sum;
+}
+
+//Output history goes back to silence, as if the converter had just been set up
+internal void resample_Reset(RESAMPLE_CONTEXT *Context)
+{
+    //Taps run from TapCount / 2 - 1 frames before the output's position to TapCount / 2 after, so that many leading
+    //zeros put input frame 0 under the centre of the first output
+    Context->HistoryFrames = (Context->TapCount / 2) - 1;
+    Context->Index = 0;
+    Context->Phase = 0;
+
+    for(int Sample = 0; Sample < Context->HistoryFrames * 2; ++Sample)
+    {
+        Context->History[Sample] = 0.0f;
+    }
+}
+
+//Memory must be resample_GetMemorySize bytes for the same rates and quality
+//Builds every phase in double precision and normalises each to unity gain, so DC passes untouched at every position
+internal void resample_InitContext(RESAMPLE_CONTEXT *Context, void *Memory, int InputRate, int OutputRate, RESAMPLE_QUALITY Quality)
+{
+    uint32 GCD = resample_GetGCD((uint32) InputRate, (uint32) OutputRate);
+    uint32 Numerator = (uint32) InputRate / GCD;
+
+    Context->Quality = Quality;
+    Context->InputRate = InputRate;
+    Context->OutputRate = OutputRate;
+    Context->Denominator = (uint32) OutputRate / GCD;
+    Context->InputStep = Numerator / Context->Denominator;
+    Context->PhaseStep = Numerator % Context->Denominator;
+    resample_GetShape(InputRate, OutputRate, Quality, &Context->TapCount, &Context->PhaseCount);
+
+    Context->Coefficients = (float32 *) Memory;
+    Context->History = Context->Coefficients + ((size_t) Context->PhaseCount * Context->TapCount * 2);
+    Context->HistoryCapacity = Context->TapCount + RESAMPLE_BLOCK_FRAMES;
+
+    //Cutoff in cycles per input frame, below the lower of the two Nyquists
+    const RESAMPLE_QUALITY_SETTINGS *Settings = &ResampleQualitySettings[Quality];
+    float64 Cutoff = 0.5 * Settings->Passband * ((OutputRate < InputRate) ? ((float64) OutputRate / (float64) InputRate) : 1.0);
+    float64 HalfWidth = (float64) Context->TapCount / 2.0;
+    float64 WindowScale = 1.0 / resample_BesselI0(Settings->KaiserBeta);
+    float64 Pi = 3.14159265358979323846;
+
+    for(int PhaseIndex = 0; PhaseIndex < Context->PhaseCount; ++PhaseIndex)
+    {
+        float64 Fraction = (float64) PhaseIndex / (float64) Context->PhaseCount;
+        float64 Weights[RESAMPLE_MAX_TAPS];
+        float64 Total = 0.0;
+
+        for(int Tap = 0; Tap < Context->TapCount; ++Tap)
+        {
+            //Distance from the output's position, the window reaches zero just past the outermost taps
+            float64 X = (float64) (Tap - ((Context->TapCount / 2) - 1)) - Fraction;
+            float64 Sinc = (X == 0.0) ? 1.0 : (sin(2.0 * Pi * Cutoff * X) / (2.0 * Pi * Cutoff * X));
+            float64 Edge = X / HalfWidth;
+            float64 Window = (Edge * Edge < 1.0) ? (resample_BesselI0(Settings->KaiserBeta * sqrt(1.0 - (Edge * Edge))) * WindowScale) : 0.0;
+
+            Weights[Tap] = Sinc * Window;
+            Total += Weights[Tap];
+        }
+
+        float32 *Coefficients = Context->Coefficients + ((size_t) PhaseIndex * Context->TapCount * 2);
+        for(int Tap = 0; Tap < Context->TapCount; ++Tap)
+        {
+            Coefficients[(Tap * 2)] = (float32) (Weights[Tap] / Total);
+            Coefficients[(Tap * 2) + 1] = (float32) (Weights[Tap] / Total);
+        }
+    }
+
+    resample_Reset(Context);
+
+    if(!resample_FilterFrames_Kernel)
+    {
+        resample_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+}
+
+//Input frames resample_Process needs to produce DestFrames more, beyond what the history already holds
+internal int resample_GetInputFrames(RESAMPLE_CONTEXT *Context, int DestFrames)
+{
+    if(DestFrames <= 0)
+    {
+        return 0;
+    }
+
+    //The last output's first tap, then a whole filter from there
+    uint64 Position = (uint64) Context->Phase + ((uint64) (DestFrames - 1) * ((Context->InputStep * Context->Denominator) + Context->PhaseStep));
+    int64 LastIndex = (int64) Context->Index + (int64) (Position / Context->Denominator);
+    int64 Needed = LastIndex + Context->TapCount - Context->HistoryFrames;
+
+    return (Needed > 0) ? (int) Needed : 0;
+}
+
+//Output frames SourceFrames more input would complete, for a producer that decided its input count itself
+internal int resample_GetOutputFrames(RESAMPLE_CONTEXT *Context, int SourceFrames)
+{
+    //Output M fits while its first tap is at most Last, which is when Phase + M * Numerator < (Last - Index + 1) * Denominator
+    int64 Last = (int64) Context->HistoryFrames + SourceFrames - Context->TapCount;
+    if(Last < Context->Index)
+    {
+        return 0;
+    }
+
+    uint64 Numerator = ((uint64) Context->InputStep * Context->Denominator) + Context->PhaseStep;
+    uint64 Limit = ((uint64) (Last - Context->Index + 1) * Context->Denominator) - 1 - Context->Phase;
+
+    return (int) (Limit / Numerator) + 1;
+}
+
+//Dest gets exactly DestFrames, which Source must be enough for: resample_GetInputFrames(Context, DestFrames) frames,
+//or DestFrames is resample_GetOutputFrames(Context, SourceFrames)
+//Input is taken RESAMPLE_BLOCK_FRAMES at a time, all of it is kept in the history until outputs no longer reach it
+internal void resample_Process(RESAMPLE_CONTEXT *Context, int16 *Source, int SourceFrames, int16 *Dest, int DestFrames)
+{
+    int Written = 0;
+
+    for(;;)
+    {
+        Written += resample_FilterFrames_Kernel(Context, Dest + (Written * 2), DestFrames - Written);
+
+        //Every step is at most InputStep + 1 frames, never more than a filter, so Index never passes the end
+        int KeepFrames = Context->HistoryFrames - Context->Index;
+        float32 *Keep = Context->History + (Context->Index * 2);
+        for(int Sample = 0; Sample < KeepFrames * 2; ++Sample)
+        {
+            Context->History[Sample] = Keep[Sample];
+        }
+
+        Context->HistoryFrames = KeepFrames;
+        Context->Index = 0;
+
+        //Anything left once Dest is full is less than the next output needs, so it always fits
+        int AppendFrames = Context->HistoryCapacity - Context->HistoryFrames;
+        if(AppendFrames > SourceFrames)
+        {
+            AppendFrames = SourceFrames;
+        }
+
+        if(AppendFrames == 0)
+        {
+            break;
+        }
+
+        float32 *Append = Context->History + (Context->HistoryFrames * 2);
+        for(int Sample = 0; Sample < AppendFrames * 2; ++Sample)
+        {
+            Append[Sample] = (float32) Source[Sample];
+        }
+
+        Context->HistoryFrames += AppendFrames;
+        Source += AppendFrames * 2;
+        SourceFrames -= AppendFrames;
+    }
+}
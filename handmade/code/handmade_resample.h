@@ -0,0 +1,74 @@
+#if !defined(HANDMADE_RESAMPLE_H)
+
+//Streaming sample rate converter between the rate the game mixes at and the rate the device plays at
+//Polyphase FIR: output frame N sits at input position N * InputRate / OutputRate, its taps are a Kaiser windowed sinc
+//centred there, one precomputed set per fractional position so nothing is evaluated per sample
+//Rates are reduced by their gcd, the denominator left is the number of distinct positions. Up to RESAMPLE_MAX_PHASES
+//every position gets its own exact phase, past that positions round down to the nearest of RESAMPLE_MAX_PHASES
+//Frames are interleaved stereo int16 like HANDMADE_SOUND_BUFFER, history is kept as float so taps and channels vectorise together
+
+#define RESAMPLE_MAX_PHASES 1024
+#define RESAMPLE_MAX_RATIO 8 //Either rate may be at most this many times the other
+#define RESAMPLE_MAX_TAPS (64 * RESAMPLE_MAX_RATIO) //Best quality stretched by the largest downsampling ratio
+#define RESAMPLE_BLOCK_FRAMES 256 //Input frames converted to float per pass, history holds this plus one filter's worth
+
+enum RESAMPLE_QUALITY
+{
+    RESAMPLE_QUALITY_LOW,
+    RESAMPLE_QUALITY_MEDIUM,
+    RESAMPLE_QUALITY_HIGH,
+    RESAMPLE_QUALITY_BEST,
+
+    RESAMPLE_QUALITY_COUNT
+};
+
+global const char * const ResampleQualityNames[RESAMPLE_QUALITY_COUNT] = {"low", "medium", "high", "best"};
+
+//Taps are per output frame when upsampling, downsampling stretches the filter by the ratio so it keeps its shape
+//against the lower Nyquist. Passband is the cutoff as a fraction of that Nyquist
+struct RESAMPLE_QUALITY_SETTINGS
+{
+    int TapCount;
+    float64 Passband;
+    float64 KaiserBeta;
+};
+
+global const RESAMPLE_QUALITY_SETTINGS ResampleQualitySettings[RESAMPLE_QUALITY_COUNT] = {{8, 0.80, 5.0}, {16, 0.88, 7.0}, {32, 0.92, 9.0}, {64, 0.95, 11.0}};
+
+//Set up once per pair of rates by resample_InitContext, tables point into memory the caller owns
+struct RESAMPLE_CONTEXT
+{
+    RESAMPLE_QUALITY Quality;
+    int InputRate;
+    int OutputRate;
+    int TapCount; //Multiple of 4, so both channels of every tap fill whole 128 and 256 bit registers
+    int PhaseCount;
+
+    //Each output frame advances the input position by InputStep + PhaseStep / Denominator
+    uint32 InputStep;
+    uint32 PhaseStep;
+    uint32 Denominator;
+
+    float32 *Coefficients; //PhaseCount sets of TapCount pairs, each tap repeated for left and right
+    float32 *History; //Interleaved input frames as float, the first tap of the next output at Index
+    int HistoryCapacity;
+    int HistoryFrames;
+    int Index;
+    uint32 Phase; //Numerator over Denominator of the next output's position past Index
+};
+
+//Filters outputs from the history until DestFrames are written or the next one needs frames not yet appended
+//Returns the frames written and advances Index and Phase past them
+#define RESAMPLE_FILTER_FRAMES(name) int name(RESAMPLE_CONTEXT *Context, int16 *Dest, int DestFrames)
+typedef RESAMPLE_FILTER_FRAMES(resample_filter_frames);
+
+internal SIMD_LEVEL resample_SelectKernels(SIMD_LEVEL Requested);
+internal size_t resample_GetMemorySize(int InputRate, int OutputRate, RESAMPLE_QUALITY Quality);
+internal void resample_InitContext(RESAMPLE_CONTEXT *Context, void *Memory, int InputRate, int OutputRate, RESAMPLE_QUALITY Quality);
+internal void resample_Reset(RESAMPLE_CONTEXT *Context);
+internal int resample_GetInputFrames(RESAMPLE_CONTEXT *Context, int DestFrames);
+internal int resample_GetOutputFrames(RESAMPLE_CONTEXT *Context, int SourceFrames);
+internal void resample_Process(RESAMPLE_CONTEXT *Context, int16 *Source, int SourceFrames, int16 *Dest, int DestFrames);
+
+#define HANDMADE_RESAMPLE_H
+#endif
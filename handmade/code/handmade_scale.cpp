@@ -0,0 +1,573 @@
+#include "handmade_scale.h"
+
+//Active kernels, chosen from CPUID on first use unless the platform picked a level
+global scale_expand_row *scale_ExpandRow_Kernel;
+global scale_blend_rows *scale_BlendRows_Kernel;
+global scale_blend_columns *scale_BlendColumns_Kernel;
+
+//Reference for one pixel, the SIMD kernels do the same math in 16 bit lanes, which never overflow as 255 * 256 + 128 fits
+internal uint32 scale_BlendPixel(uint32 A, uint32 B, uint32 Weight)
+{
+    uint32 Result = 0;
+
+    for(int Shift = 0; Shift < 32; Shift += 8)
+    {
+        uint32 Channel = ((((A >> Shift) & 0xFF) * (256 - Weight)) + (((B >> Shift) & 0xFF) * Weight) + 128) >> 8;
+        Result |= Channel << Shift;
+    }
+
+    return Result;
+}
+
+internal SCALE_EXPAND_ROW(scale_ExpandRow_Scalar)
+{
+    for(int Index = 0; Index < Count; ++Index)
+    {
+        uint32 Pixel = Source[Index];
+
+        for(int Repeat = 0; Repeat < Factor; ++Repeat)
+        {
+            *Dest++ = Pixel;
+        }
+    }
+}
+
+//Factors up to 4 shuffle 4 source pixels into Factor stores, larger ones broadcast each pixel and store it 4 at a time
+internal HANDMADE_TARGET_SSE2 SCALE_EXPAND_ROW(scale_ExpandRow_SSE2)
+{
+    int Index = 0;
+
+    if(Factor == 1)
+    {
+        for(; Index + 4 <= Count; Index += 4)
+        {
+            _mm_storeu_si128((__m128i *) (Dest + Index), _mm_loadu_si128((__m128i *) (Source + Index)));
+        }
+    }
+    else if(Factor == 2)
+    {
+        for(; Index + 4 <= Count; Index += 4)
+        {
+            __m128i Pixels = _mm_loadu_si128((__m128i *) (Source + Index));
+            uint32 *Out = Dest + (Index * 2);
+
+            _mm_storeu_si128((__m128i *) (Out + 0), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(1, 1, 0, 0)));
+            _mm_storeu_si128((__m128i *) (Out + 4), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(3, 3, 2, 2)));
+        }
+    }
+    else if(Factor == 3)
+    {
+        for(; Index + 4 <= Count; Index += 4)
+        {
+            __m128i Pixels = _mm_loadu_si128((__m128i *) (Source + Index));
+            uint32 *Out = Dest + (Index * 3);
+
+            _mm_storeu_si128((__m128i *) (Out + 0), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(1, 0, 0, 0)));
+            _mm_storeu_si128((__m128i *) (Out + 4), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(2, 2, 1, 1)));
+            _mm_storeu_si128((__m128i *) (Out + 8), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(3, 3, 3, 2)));
+        }
+    }
+    else if(Factor == 4)
+    {
+        for(; Index + 4 <= Count; Index += 4)
+        {
+            __m128i Pixels = _mm_loadu_si128((__m128i *) (Source + Index));
+            uint32 *Out = Dest + (Index * 4);
+
+            _mm_storeu_si128((__m128i *) (Out + 0), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(0, 0, 0, 0)));
+            _mm_storeu_si128((__m128i *) (Out + 4), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(1, 1, 1, 1)));
+            _mm_storeu_si128((__m128i *) (Out + 8), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(2, 2, 2, 2)));
+            _mm_storeu_si128((__m128i *) (Out + 12), _mm_shuffle_epi32(Pixels, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+    }
+    else
+    {
+        for(; Index < Count; ++Index)
+        {
+            __m128i Pixel = _mm_set1_epi32((int) Source[Index]);
+            uint32 *Out = Dest + (Index * Factor);
+
+            int Repeat = 0;
+            for(; Repeat + 4 <= Factor; Repeat += 4)
+            {
+                _mm_storeu_si128((__m128i *) (Out + Repeat), Pixel);
+            }
+
+            for(; Repeat < Factor; ++Repeat)
+            {
+                Out[Repeat] = Source[Index];
+            }
+        }
+    }
+
+    scale_ExpandRow_Scalar(Dest + (Index * Factor), Source + Index, Count - Index, Factor);
+}
+
+//8 source pixels per iteration, output vector K takes source lane (8K + J) / Factor for its lane J
+//so one permute per 8 output pixels whatever the factor, past 8 the SSE2 broadcast is as good
+internal HANDMADE_TARGET_AVX2 SCALE_EXPAND_ROW(scale_ExpandRow_AVX2)
+{
+    if(Factor > 8)
+    {
+        scale_ExpandRow_SSE2(Dest, Source, Count, Factor);
+        return;
+    }
+
+    __m256i Lanes[8];
+    for(int Vector = 0; Vector < Factor; ++Vector)
+    {
+        int32 Indices[8];
+        for(int Lane = 0; Lane < 8; ++Lane)
+        {
+            Indices[Lane] = ((Vector * 8) + Lane) / Factor;
+        }
+
+        Lanes[Vector] = _mm256_loadu_si256((__m256i *) Indices);
+    }
+
+    int Index = 0;
+    for(; Index + 8 <= Count; Index += 8)
+    {
+        __m256i Pixels = _mm256_loadu_si256((__m256i *) (Source + Index));
+        uint32 *Out = Dest + (Index * Factor);
+
+        for(int Vector = 0; Vector < Factor; ++Vector)
+        {
+            _mm256_storeu_si256((__m256i *) (Out + (Vector * 8)), _mm256_permutevar8x32_epi32(Pixels, Lanes[Vector]));
+        }
+    }
+
+    scale_ExpandRow_Scalar(Dest + (Index * Factor), Source + Index, Count - Index, Factor);
+}
+
+internal SCALE_BLEND_ROWS(scale_BlendRows_Scalar)
+{
+    for(int Index = 0; Index < Count; ++Index)
+    {
+        Dest[Index] = scale_BlendPixel(Top[Index], Bottom[Index], Weight);
+    }
+}
+
+//4 pixels per iteration, widened to 16 bit channels in two halves and packed back
+internal HANDMADE_TARGET_SSE2 SCALE_BLEND_ROWS(scale_BlendRows_SSE2)
+{
+    __m128i Zero = _mm_setzero_si128();
+    __m128i Round = _mm_set1_epi16(128);
+    __m128i TopWeight = _mm_set1_epi16((int16) (256 - Weight));
+    __m128i BottomWeight = _mm_set1_epi16((int16) Weight);
+
+    int Index = 0;
+    for(; Index + 4 <= Count; Index += 4)
+    {
+        __m128i TopPixels = _mm_loadu_si128((__m128i *) (Top + Index));
+        __m128i BottomPixels = _mm_loadu_si128((__m128i *) (Bottom + Index));
+
+        __m128i Low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(TopPixels, Zero), TopWeight), _mm_mullo_epi16(_mm_unpacklo_epi8(BottomPixels, Zero), BottomWeight));
+        __m128i High = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(TopPixels, Zero), TopWeight), _mm_mullo_epi16(_mm_unpackhi_epi8(BottomPixels, Zero), BottomWeight));
+
+        Low = _mm_srli_epi16(_mm_add_epi16(Low, Round), 8);
+        High = _mm_srli_epi16(_mm_add_epi16(High, Round), 8);
+
+        _mm_storeu_si128((__m128i *) (Dest + Index), _mm_packus_epi16(Low, High));
+    }
+
+    scale_BlendRows_Scalar(Dest + Index, Top + Index, Bottom + Index, Count - Index, Weight);
+}
+
+//8 pixels per iteration, unpack and pack both stay within 128 bit halves so pixel order survives
+internal HANDMADE_TARGET_AVX2 SCALE_BLEND_ROWS(scale_BlendRows_AVX2)
+{
+    __m256i Zero = _mm256_setzero_si256();
+    __m256i Round = _mm256_set1_epi16(128);
+    __m256i TopWeight = _mm256_set1_epi16((int16) (256 - Weight));
+    __m256i BottomWeight = _mm256_set1_epi16((int16) Weight);
+
+    int Index = 0;
+    for(; Index + 8 <= Count; Index += 8)
+    {
+        __m256i TopPixels = _mm256_loadu_si256((__m256i *) (Top + Index));
+        __m256i BottomPixels = _mm256_loadu_si256((__m256i *) (Bottom + Index));
+
+        __m256i Low = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(TopPixels, Zero), TopWeight), _mm256_mullo_epi16(_mm256_unpacklo_epi8(BottomPixels, Zero), BottomWeight));
+        __m256i High = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(TopPixels, Zero), TopWeight), _mm256_mullo_epi16(_mm256_unpackhi_epi8(BottomPixels, Zero), BottomWeight));
+
+        Low = _mm256_srli_epi16(_mm256_add_epi16(Low, Round), 8);
+        High = _mm256_srli_epi16(_mm256_add_epi16(High, Round), 8);
+
+        _mm256_storeu_si256((__m256i *) (Dest + Index), _mm256_packus_epi16(Low, High));
+    }
+
+    scale_BlendRows_Scalar(Dest + Index, Top + Index, Bottom + Index, Count - Index, Weight);
+}
+
+internal SCALE_BLEND_COLUMNS(scale_BlendColumns_Scalar)
+{
+    for(int Index = 0; Index < Count; ++Index)
+    {
+        uint32 *Pair = Source + Columns[Index];
+        Dest[Index] = scale_BlendPixel(Pair[0], Pair[1], Weights[Index].Lanes[4]);
+    }
+}
+
+//Each output pixel's two neighbours are one 64 bit load, widened so the left pixel sits in the low half and the right in the high
+//Multiplying by the tap's weights and adding the halves together leaves the pixel in the low half
+internal HANDMADE_TARGET_SSE2 __m128i scale_BlendPair_SSE2(__m128i Pair, SCALE_WEIGHTS *Weights, __m128i Round)
+{
+    __m128i Product = _mm_mullo_epi16(Pair, _mm_loadu_si128((__m128i *) Weights));
+    __m128i Sum = _mm_add_epi16(Product, _mm_shuffle_epi32(Product, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    return _mm_srli_epi16(_mm_add_epi16(Sum, Round), 8);
+}
+
+internal HANDMADE_TARGET_SSE2 SCALE_BLEND_COLUMNS(scale_BlendColumns_SSE2)
+{
+    __m128i Zero = _mm_setzero_si128();
+    __m128i Round = _mm_set1_epi16(128);
+
+    int Index = 0;
+    for(; Index + 4 <= Count; Index += 4)
+    {
+        __m128i Pairs01 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *) (Source + Columns[Index + 0])), _mm_loadl_epi64((__m128i *) (Source + Columns[Index + 1])));
+        __m128i Pairs23 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *) (Source + Columns[Index + 2])), _mm_loadl_epi64((__m128i *) (Source + Columns[Index + 3])));
+
+        __m128i Pixel0 = scale_BlendPair_SSE2(_mm_unpacklo_epi8(Pairs01, Zero), &Weights[Index + 0], Round);
+        __m128i Pixel1 = scale_BlendPair_SSE2(_mm_unpackhi_epi8(Pairs01, Zero), &Weights[Index + 1], Round);
+        __m128i Pixel2 = scale_BlendPair_SSE2(_mm_unpacklo_epi8(Pairs23, Zero), &Weights[Index + 2], Round);
+        __m128i Pixel3 = scale_BlendPair_SSE2(_mm_unpackhi_epi8(Pairs23, Zero), &Weights[Index + 3], Round);
+
+        _mm_storeu_si128((__m128i *) (Dest + Index), _mm_packus_epi16(_mm_unpacklo_epi64(Pixel0, Pixel1), _mm_unpacklo_epi64(Pixel2, Pixel3)));
+    }
+
+    scale_BlendColumns_Scalar(Dest + Index, Source, Columns + Index, Weights + Index, Count - Index);
+}
+
+//Same per pixel math two pixels to a register: lane halves hold pixels (0, 2), (1, 3), (4, 6), (5, 7)
+//so the final pack comes out as 0 1 4 5 | 2 3 6 7 and one qword permute puts it in order
+internal HANDMADE_TARGET_AVX2 __m256i scale_BlendPairs_AVX2(__m256i Pairs, SCALE_WEIGHTS *WeightsLow, SCALE_WEIGHTS *WeightsHigh, __m256i Round)
+{
+    __m256i Weights = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((__m128i *) WeightsLow)), _mm_loadu_si128((__m128i *) WeightsHigh), 1);
+    __m256i Product = _mm256_mullo_epi16(Pairs, Weights);
+    __m256i Sum = _mm256_add_epi16(Product, _mm256_shuffle_epi32(Product, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    return _mm256_srli_epi16(_mm256_add_epi16(Sum, Round), 8);
+}
+
+internal HANDMADE_TARGET_AVX2 SCALE_BLEND_COLUMNS(scale_BlendColumns_AVX2)
+{
+    __m256i Zero = _mm256_setzero_si256();
+    __m256i Round = _mm256_set1_epi16(128);
+
+    int Index = 0;
+    for(; Index + 8 <= Count; Index += 8)
+    {
+        __m128i Pairs01 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *) (Source + Columns[Index + 0])), _mm_loadl_epi64((__m128i *) (Source + Columns[Index + 1])));
+        __m128i Pairs23 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *) (Source + Columns[Index + 2])), _mm_loadl_epi64((__m128i *) (Source + Columns[Index + 3])));
+        __m128i Pairs45 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *) (Source + Columns[Index + 4])), _mm_loadl_epi64((__m128i *) (Source + Columns[Index + 5])));
+        __m128i Pairs67 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i *) (Source + Columns[Index + 6])), _mm_loadl_epi64((__m128i *) (Source + Columns[Index + 7])));
+
+        __m256i Pairs0123 = _mm256_inserti128_si256(_mm256_castsi128_si256(Pairs01), Pairs23, 1);
+        __m256i Pairs4567 = _mm256_inserti128_si256(_mm256_castsi128_si256(Pairs45), Pairs67, 1);
+
+        __m256i Pixels02 = scale_BlendPairs_AVX2(_mm256_unpacklo_epi8(Pairs0123, Zero), &Weights[Index + 0], &Weights[Index + 2], Round);
+        __m256i Pixels13 = scale_BlendPairs_AVX2(_mm256_unpackhi_epi8(Pairs0123, Zero), &Weights[Index + 1], &Weights[Index + 3], Round);
+        __m256i Pixels46 = scale_BlendPairs_AVX2(_mm256_unpacklo_epi8(Pairs4567, Zero), &Weights[Index + 4], &Weights[Index + 6], Round);
+        __m256i Pixels57 = scale_BlendPairs_AVX2(_mm256_unpackhi_epi8(Pairs4567, Zero), &Weights[Index + 5], &Weights[Index + 7], Round);
+
+        __m256i Packed = _mm256_packus_epi16(_mm256_unpacklo_epi64(Pixels02, Pixels13), _mm256_unpacklo_epi64(Pixels46, Pixels57));
+        _mm256_storeu_si256((__m256i *) (Dest + Index), _mm256_permute4x64_epi64(Packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    scale_BlendColumns_Scalar(Dest + Index, Source, Columns + Index, Weights + Index, Count - Index);
+}
+
+//Returns the level actually used, which may be lower than requested
+internal SIMD_LEVEL scale_SelectKernels(SIMD_LEVEL Requested)
+{
+    SIMD_LEVEL Selected = cpu_SelectSimdLevel(Requested);
+
+    switch(Selected)
+    {
+        case SIMD_LEVEL_AVX2:
+        {
+            scale_ExpandRow_Kernel = scale_ExpandRow_AVX2;
+            scale_BlendRows_Kernel = scale_BlendRows_AVX2;
+            scale_BlendColumns_Kernel = scale_BlendColumns_AVX2;
+            break;
+        }
+
+        case SIMD_LEVEL_SSE2:
+        {
+            scale_ExpandRow_Kernel = scale_ExpandRow_SSE2;
+            scale_BlendRows_Kernel = scale_BlendRows_SSE2;
+            scale_BlendColumns_Kernel = scale_BlendColumns_SSE2;
+            break;
+        }
+
+        default:
+        {
+            scale_ExpandRow_Kernel = scale_ExpandRow_Scalar;
+            scale_BlendRows_Kernel = scale_BlendRows_Scalar;
+            scale_BlendColumns_Kernel = scale_BlendColumns_Scalar;
+            break;
+        }
+    }
+
+    return Selected;
+}
+
+//Source rows are read in place, so only the source width matters
+internal size_t scale_GetMemorySize(int SourceWidth, int DestWidth, int DestHeight)
+{
+    return ((size_t) DestWidth * (sizeof(int) + sizeof(SCALE_WEIGHTS))) + ((size_t) DestHeight * sizeof(SCALE_TAP)) + ((size_t) SourceWidth * sizeof(uint32));
+}
+
+//Output pixel centres mapped back into the source in 16.16, half a pixel lower so source centres land on whole numbers
+//The last source pixel is reached as Index = Size - 2 at full weight, so Index + 1 is always inside the source
+internal SCALE_TAP scale_GetTap(int DestIndex, int SourceSize, int DestSize)
+{
+    int64 Position = ((((int64) DestIndex * 2) + 1) * SourceSize * 65536) / (2 * (int64) DestSize) - 32768;
+
+    SCALE_TAP Tap = {0, 0};
+
+    if(Position > 0)
+    {
+        Tap.Index = (int) (Position >> 16);
+        Tap.Weight = (uint32) (((Position & 0xFFFF) + 128) >> 8);
+
+        if(Tap.Weight == 256)
+        {
+            ++Tap.Index;
+            Tap.Weight = 0;
+        }
+    }
+
+    if(Tap.Index >= (SourceSize - 1))
+    {
+        Tap.Index = SourceSize - 2;
+        Tap.Weight = 256;
+    }
+
+    return Tap;
+}
+
+//Memory must be scale_GetMemorySize bytes for the same sizes, the source at least 2x2
+//Nearest needs room for at least one whole copy of the source and falls back to bilinear when the surface is smaller
+internal void scale_InitContext(SCALE_CONTEXT *Context, void *Memory, SCALE_FILTER Filter, int SourceWidth, int SourceHeight, int DestWidth, int DestHeight)
+{
+    Assert((SourceWidth >= 2) && (SourceHeight >= 2) && (DestWidth >= 1) && (DestHeight >= 1));
+
+    if(!scale_BlendColumns_Kernel)
+    {
+        scale_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+
+    Context->SourceWidth = SourceWidth;
+    Context->SourceHeight = SourceHeight;
+    Context->DestWidth = DestWidth;
+    Context->DestHeight = DestHeight;
+
+    int FactorX = DestWidth / SourceWidth;
+    int FactorY = DestHeight / SourceHeight;
+    Context->Factor = (FactorX < FactorY) ? FactorX : FactorY;
+    Context->Filter = ((Filter == SCALE_FILTER_NEAREST) && (Context->Factor >= 1)) ? SCALE_FILTER_NEAREST : SCALE_FILTER_BILINEAR;
+
+    uint8 *Next = (uint8 *) Memory;
+    Context->ColumnWeights = (SCALE_WEIGHTS *) Next;
+    Next += (size_t) DestWidth * sizeof(SCALE_WEIGHTS);
+    Context->Columns = (int *) Next;
+    Next += (size_t) DestWidth * sizeof(int);
+    Context->Rows = (SCALE_TAP *) Next;
+    Next += (size_t) DestHeight * sizeof(SCALE_TAP);
+    Context->BlendedRow = (uint32 *) Next;
+
+    if(Context->Filter == SCALE_FILTER_NEAREST)
+    {
+        int ImageWidth = SourceWidth * Context->Factor;
+        int ImageHeight = SourceHeight * Context->Factor;
+
+        Context->Image.MinX = (DestWidth - ImageWidth) / 2;
+        Context->Image.MinY = (DestHeight - ImageHeight) / 2;
+        Context->Image.MaxX = Context->Image.MinX + ImageWidth;
+        Context->Image.MaxY = Context->Image.MinY + ImageHeight;
+    }
+    else
+    {
+        Context->Factor = 0;
+        Context->Image.MinX = 0;
+        Context->Image.MinY = 0;
+        Context->Image.MaxX = DestWidth;
+        Context->Image.MaxY = DestHeight;
+
+        for(int X = 0; X < DestWidth; ++X)
+        {
+            SCALE_TAP Tap = scale_GetTap(X, SourceWidth, DestWidth);
+            Context->Columns[X] = Tap.Index;
+
+            for(int Lane = 0; Lane < 4; ++Lane)
+            {
+                Context->ColumnWeights[X].Lanes[Lane] = (uint16) (256 - Tap.Weight);
+                Context->ColumnWeights[X].Lanes[Lane + 4] = (uint16) Tap.Weight;
+            }
+        }
+
+        for(int Y = 0; Y < DestHeight; ++Y)
+        {
+            Context->Rows[Y] = scale_GetTap(Y, SourceHeight, DestHeight);
+        }
+    }
+}
+
+//Surface pixels that read anything inside SourceRect, bilinear reaches one source pixel further left and up
+internal HANDMADE_RECT scale_GetDestRect(SCALE_CONTEXT *Context, HANDMADE_RECT SourceRect)
+{
+    HANDMADE_RECT Result;
+
+    if(Context->Filter == SCALE_FILTER_NEAREST)
+    {
+        Result.MinX = Context->Image.MinX + (SourceRect.MinX * Context->Factor);
+        Result.MinY = Context->Image.MinY + (SourceRect.MinY * Context->Factor);
+        Result.MaxX = Context->Image.MinX + (SourceRect.MaxX * Context->Factor);
+        Result.MaxY = Context->Image.MinY + (SourceRect.MaxY * Context->Factor);
+    }
+    else
+    {
+        //Taps only ever move forward, so the rect is the run between the first and last that reach in
+        Result.MinX = 0;
+        while((Result.MinX < Context->DestWidth) && (Context->Columns[Result.MinX] < (SourceRect.MinX - 1)))
+        {
+            ++Result.MinX;
+        }
+
+        Result.MaxX = Context->DestWidth;
+        while((Result.MaxX > Result.MinX) && (Context->Columns[Result.MaxX - 1] > (SourceRect.MaxX - 1)))
+        {
+            --Result.MaxX;
+        }
+
+        Result.MinY = 0;
+        while((Result.MinY < Context->DestHeight) && (Context->Rows[Result.MinY].Index < (SourceRect.MinY - 1)))
+        {
+            ++Result.MinY;
+        }
+
+        Result.MaxY = Context->DestHeight;
+        while((Result.MaxY > Result.MinY) && (Context->Rows[Result.MaxY - 1].Index > (SourceRect.MaxY - 1)))
+        {
+            --Result.MaxY;
+        }
+    }
+
+    return Result;
+}
+
+internal void scale_ClearRect(HANDMADE_OFFSCREEN_BUFFER *Dest, int MinX, int MinY, int MaxX, int MaxY)
+{
+    for(int Y = MinY; Y < MaxY; ++Y)
+    {
+        uint32 *Pixel = (uint32 *) ((uint8 *) Dest->BitmapMemory + (Y * Dest->Pitch)) + MinX;
+
+        for(int X = MinX; X < MaxX; ++X)
+        {
+            *Pixel++ = 0;
+        }
+    }
+}
+
+//Rescales the part of Dest that depends on SourceRect, or all of it with the border cleared when SourceRect is 0
+//Source and Dest must be the sizes the context was set up for, returns the part of Dest that was written
+internal HANDMADE_RECT scale_Upscale(SCALE_CONTEXT *Context, HANDMADE_OFFSCREEN_BUFFER *Source, HANDMADE_OFFSCREEN_BUFFER *Dest, HANDMADE_RECT *SourceRect)
+{
+    TIMED_FUNCTION();
+
+    Assert((Source->BitmapWidth == Context->SourceWidth) && (Source->BitmapHeight == Context->SourceHeight));
+    Assert((Dest->BitmapWidth == Context->DestWidth) && (Dest->BitmapHeight == Context->DestHeight));
+
+    HANDMADE_RECT Rect = {0, 0, Context->SourceWidth, Context->SourceHeight};
+
+    if(SourceRect)
+    {
+        if(SourceRect->MinX > Rect.MinX) Rect.MinX = SourceRect->MinX;
+        if(SourceRect->MinY > Rect.MinY) Rect.MinY = SourceRect->MinY;
+        if(SourceRect->MaxX < Rect.MaxX) Rect.MaxX = SourceRect->MaxX;
+        if(SourceRect->MaxY < Rect.MaxY) Rect.MaxY = SourceRect->MaxY;
+    }
+    else
+    {
+        HANDMADE_RECT Image = Context->Image;
+        scale_ClearRect(Dest, 0, 0, Context->DestWidth, Image.MinY);
+        scale_ClearRect(Dest, 0, Image.MaxY, Context->DestWidth, Context->DestHeight);
+        scale_ClearRect(Dest, 0, Image.MinY, Image.MinX, Image.MaxY);
+        scale_ClearRect(Dest, Image.MaxX, Image.MinY, Context->DestWidth, Image.MaxY);
+    }
+
+    HANDMADE_RECT Result = {0, 0, 0, 0};
+
+    if((Rect.MinX >= Rect.MaxX) || (Rect.MinY >= Rect.MaxY))
+    {
+        return Result;
+    }
+
+    Result = scale_GetDestRect(Context, Rect);
+
+    if(Context->Filter == SCALE_FILTER_NEAREST)
+    {
+        int Factor = Context->Factor;
+        int DestWidth = Result.MaxX - Result.MinX;
+        uint8 *DestRow = (uint8 *) Dest->BitmapMemory + (Result.MinY * Dest->Pitch) + (Result.MinX * sizeof(uint32));
+
+        for(int Y = Rect.MinY; Y < Rect.MaxY; ++Y)
+        {
+            uint32 *SourceRow = (uint32 *) ((uint8 *) Source->BitmapMemory + (Y * Source->Pitch));
+            scale_ExpandRow_Kernel((uint32 *) DestRow, SourceRow + Rect.MinX, Rect.MaxX - Rect.MinX, Factor);
+
+            //Every copy of a source row is the same, the rest are copies of the first at a factor of 1
+            for(int Repeat = 1; Repeat < Factor; ++Repeat)
+            {
+                scale_ExpandRow_Kernel((uint32 *) (DestRow + (Repeat * Dest->Pitch)), (uint32 *) DestRow, DestWidth, 1);
+            }
+
+            DestRow += Factor * Dest->Pitch;
+        }
+    }
+    else if(Result.MinX < Result.MaxX)
+    {
+        //Vertical blend only covers the source columns these output columns read
+        int FirstColumn = Context->Columns[Result.MinX];
+        int ColumnCount = Context->Columns[Result.MaxX - 1] + 2 - FirstColumn;
+
+        for(int Y = Result.MinY; Y < Result.MaxY; ++Y)
+        {
+            SCALE_TAP Tap = Context->Rows[Y];
+            uint32 *Top = (uint32 *) ((uint8 *) Source->BitmapMemory + (Tap.Index * Source->Pitch));
+            uint32 *Bottom = (uint32 *) ((uint8 *) Top + Source->Pitch);
+            uint32 *Blended = Context->BlendedRow;
+
+            //Blending at either end is exact, so those rows are read in place
+            if(Tap.Weight == 0)
+            {
+                Blended = Top;
+            }
+            else if(Tap.Weight == 256)
+            {
+                Blended = Bottom;
+            }
+            else
+            {
+                scale_BlendRows_Kernel(Blended + FirstColumn, Top + FirstColumn, Bottom + FirstColumn, ColumnCount, Tap.Weight);
+            }
+
+            uint32 *DestRow = (uint32 *) ((uint8 *) Dest->BitmapMemory + (Y * Dest->Pitch));
+            scale_BlendColumns_Kernel(DestRow + Result.MinX, Blended, Context->Columns + Result.MinX, Context->ColumnWeights + Result.MinX, Result.MaxX - Result.MinX);
+        }
+    }
+
+    if(!SourceRect)
+    {
+        Result.MinX = 0;
+        Result.MinY = 0;
+        Result.MaxX = Context->DestWidth;
+        Result.MaxY = Context->DestHeight;
+    }
+
+    return Result;
+}
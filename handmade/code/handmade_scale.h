@@ -0,0 +1,67 @@
+#if !defined(HANDMADE_SCALE_H)
+
+//Upscaler from the resolution the game renders at to the surface the platform presents, so no platform stretches
+//Nearest repeats every pixel a whole number of times and centres the picture, bilinear stretches it over the surface
+//Pixels are 0xAARRGGBB like the backbuffer and every instruction set matches the scalar kernels bit for bit
+
+enum SCALE_FILTER
+{
+    SCALE_FILTER_NEAREST,
+    SCALE_FILTER_BILINEAR,
+
+    SCALE_FILTER_COUNT
+};
+
+global const char * const ScaleFilterNames[SCALE_FILTER_COUNT] = {"nearest", "bilinear"};
+
+//Both weights of a bilinear tap per channel, laid out for the column kernels: 4 x (256 - W) then 4 x W
+struct SCALE_WEIGHTS
+{
+    uint16 Lanes[8];
+};
+
+//Where an output row samples: Index and Index + 1 blended by Weight in 1/256ths
+struct SCALE_TAP
+{
+    int Index;
+    uint32 Weight;
+};
+
+//Count source pixels, each written Factor times in a row
+#define SCALE_EXPAND_ROW(name) void name(uint32 *Dest, uint32 *Source, int Count, int Factor)
+typedef SCALE_EXPAND_ROW(scale_expand_row);
+
+//Each channel (Top * (256 - Weight) + Bottom * Weight + 128) >> 8
+#define SCALE_BLEND_ROWS(name) void name(uint32 *Dest, uint32 *Top, uint32 *Bottom, int Count, uint32 Weight)
+typedef SCALE_BLEND_ROWS(scale_blend_rows);
+
+//Dest[X] blends Source[Columns[X]] with Source[Columns[X] + 1] the same way, by Weights[X]
+#define SCALE_BLEND_COLUMNS(name) void name(uint32 *Dest, uint32 *Source, int *Columns, SCALE_WEIGHTS *Weights, int Count)
+typedef SCALE_BLEND_COLUMNS(scale_blend_columns);
+
+//Set up once per pair of sizes by scale_InitContext, tables point into memory the platform owns
+struct SCALE_CONTEXT
+{
+    SCALE_FILTER Filter;
+    int SourceWidth;
+    int SourceHeight;
+    int DestWidth;
+    int DestHeight;
+
+    int Factor; //Nearest only
+    HANDMADE_RECT Image; //Part of the surface the picture covers, nearest leaves a black border around it
+
+    int *Columns;
+    SCALE_WEIGHTS *ColumnWeights;
+    SCALE_TAP *Rows;
+    uint32 *BlendedRow; //One source row blended vertically, indexed like the source
+};
+
+internal SIMD_LEVEL scale_SelectKernels(SIMD_LEVEL Requested);
+internal size_t scale_GetMemorySize(int SourceWidth, int DestWidth, int DestHeight);
+internal void scale_InitContext(SCALE_CONTEXT *Context, void *Memory, SCALE_FILTER Filter, int SourceWidth, int SourceHeight, int DestWidth, int DestHeight);
+internal HANDMADE_RECT scale_GetDestRect(SCALE_CONTEXT *Context, HANDMADE_RECT SourceRect);
+internal HANDMADE_RECT scale_Upscale(SCALE_CONTEXT *Context, HANDMADE_OFFSCREEN_BUFFER *Source, HANDMADE_OFFSCREEN_BUFFER *Dest, HANDMADE_RECT *SourceRect);
+
+#define HANDMADE_SCALE_H
+#endif
@@ -0,0 +1,1013 @@
+#include "handmade_sound.h"
+
+//Active kernels, chosen from CPUID on first use unless the platform picked a level
+global sound_render_oscillator *sound_RenderOscillator_Kernel;
+global sound_mix_span *sound_MixSpan_Kernel;
+global sound_write_samples *sound_WriteSamples_Kernel;
+
+//Sink for stream read ahead, stops the page touches being optimised away
+global volatile uint32 sound_ReadAheadSink;
+
+//Tables are built from one double precision sine cycle, harmonic H of sample N is Sine[(H * N) % Size]
+//so building every octave costs lookups, not sin calls
+internal void sound_InitWavetables(SOUND_WAVETABLES *Wavetables)
+{
+    local float64 Sine[SOUND_TABLE_SIZE];
+    local float64 Sum[SOUND_TABLE_SIZE];
+
+    for(int SampleIndex = 0; SampleIndex < SOUND_TABLE_SIZE; ++SampleIndex)
+    {
+        Sine[SampleIndex] = sin((2.0 * (float64) Pi32 * (float64) SampleIndex) / (float64) SOUND_TABLE_SIZE);
+    }
+
+    for(int Wave = 0; Wave < SOUND_WAVE_COUNT; ++Wave)
+    {
+        for(int Octave = 0; Octave < SOUND_OCTAVE_COUNT; ++Octave)
+        {
+            int HarmonicCount = (SOUND_TABLE_SIZE / 2) >> Octave;
+
+            for(int SampleIndex = 0; SampleIndex < SOUND_TABLE_SIZE; ++SampleIndex)
+            {
+                Sum[SampleIndex] = 0.0;
+            }
+
+            for(int Harmonic = 1; Harmonic <= HarmonicCount; ++Harmonic)
+            {
+                //Fourier series amplitudes, only the sine stops at the fundamental
+                float64 Gain = 0.0;
+                switch(Wave)
+                {
+                    case SOUND_WAVE_SINE:
+                    {
+                        Gain = (Harmonic == 1) ? 1.0 : 0.0;
+                        break;
+                    }
+
+                    case SOUND_WAVE_SAW:
+                    {
+                        Gain = ((Harmonic & 1) ? 1.0 : -1.0) / (float64) Harmonic;
+                        break;
+                    }
+
+                    case SOUND_WAVE_SQUARE:
+                    {
+                        Gain = (Harmonic & 1) ? (1.0 / (float64) Harmonic) : 0.0;
+                        break;
+                    }
+
+                    case SOUND_WAVE_TRIANGLE:
+                    {
+                        Gain = (Harmonic & 1) ? ((((Harmonic / 2) & 1) ? -1.0 : 1.0) / (float64) (Harmonic * Harmonic)) : 0.0;
+                        break;
+                    }
+                }
+
+                if(Gain == 0.0)
+                {
+                    continue;
+                }
+
+                for(int SampleIndex = 0; SampleIndex < SOUND_TABLE_SIZE; ++SampleIndex)
+                {
+                    Sum[SampleIndex] += Gain * Sine[(Harmonic * SampleIndex) & (SOUND_TABLE_SIZE - 1)];
+                }
+            }
+
+            //Normalise to a peak of 1 so Amplitude means the same thing for every wave
+            float64 Peak = 0.0;
+            for(int SampleIndex = 0; SampleIndex < SOUND_TABLE_SIZE; ++SampleIndex)
+            {
+                float64 Magnitude = (Sum[SampleIndex] < 0.0) ? -Sum[SampleIndex] : Sum[SampleIndex];
+                if(Magnitude > Peak)
+                {
+                    Peak = Magnitude;
+                }
+            }
+
+            float32 *Table = Wavetables->Tables[Wave][Octave];
+            for(int SampleIndex = 0; SampleIndex < SOUND_TABLE_SIZE; ++SampleIndex)
+            {
+                Table[SampleIndex] = (float32) (Sum[SampleIndex] / Peak);
+            }
+
+            Table[SOUND_TABLE_SIZE] = Table[0];
+        }
+    }
+
+    Wavetables->IsInitialised = true;
+}
+
+internal void sound_InitOscillatorBank(SOUND_OSCILLATOR_BANK *Bank, SOUND_WAVETABLES *Wavetables, int SampleRate)
+{
+    if(!Wavetables->IsInitialised)
+    {
+        sound_InitWavetables(Wavetables);
+    }
+
+    Bank->Wavetables = Wavetables;
+    Bank->SampleRate = SampleRate;
+    Bank->OscillatorCount = 0;
+}
+
+//Phase increment is exact to 2^-32 cycles per sample, so pitch no longer snaps to whole sample periods
+//Changing frequency keeps the phase, so retuning a playing oscillator doesn't click
+internal void sound_SetOscillator(SOUND_OSCILLATOR_BANK *Bank, SOUND_OSCILLATOR *Oscillator, SOUND_WAVE Wave, float32 Hz, float32 Amplitude)
+{
+    float64 Nyquist = 0.5 * (float64) Bank->SampleRate;
+    float64 Frequency = (Hz < 0.0f) ? 0.0 : (float64) Hz;
+    if(Frequency > Nyquist)
+    {
+        Frequency = Nyquist;
+    }
+
+    uint32 PhaseIncrement = (uint32) (((Frequency / (float64) Bank->SampleRate) * 4294967296.0) + 0.5);
+
+    //First octave whose top harmonic stays below Nyquist (2^31 in phase units)
+    int Octave = 0;
+    while(Octave < (SOUND_OCTAVE_COUNT - 1))
+    {
+        uint64 TopHarmonic = (uint64) ((SOUND_TABLE_SIZE / 2) >> Octave) * (uint64) PhaseIncrement;
+        if(TopHarmonic < (1ull << 31))
+        {
+            break;
+        }
+
+        ++Octave;
+    }
+
+    Oscillator->PhaseIncrement = PhaseIncrement;
+    Oscillator->Amplitude = Amplitude;
+    Oscillator->Table = Bank->Wavetables->Tables[Wave][Octave];
+}
+
+//Linear interpolation between the two table entries either side of the phase
+internal float32 sound_SampleTable(float32 *Table, uint32 Phase)
+{
+    uint32 Index = Phase >> SOUND_PHASE_FRACTION_BITS;
+    float32 Fraction = (float32) (Phase & ((1 << SOUND_PHASE_FRACTION_BITS) - 1)) * (1.0f / (float32) (1 << SOUND_PHASE_FRACTION_BITS));
+
+    float32 A = Table[Index];
+    float32 B = Table[Index + 1];
+
+    return A + (Fraction * (B - A));
+}
+
+//Reference path with the per sample sinf the game used to call, kept for benchmarks and error checks
+internal SOUND_RENDER_OSCILLATOR(sound_RenderOscillator_Sinf)
+{
+    uint32 Phase = Oscillator->Phase;
+
+    for(int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        float32 tSine = (float32) Phase * (2.0f * Pi32 / 4294967296.0f);
+        Bus[SampleIndex] += Oscillator->Amplitude * sinf(tSine);
+
+        Phase += Oscillator->PhaseIncrement;
+    }
+
+    Oscillator->Phase = Phase;
+}
+
+internal SOUND_RENDER_OSCILLATOR(sound_RenderOscillator_Scalar)
+{
+    float32 *Table = Oscillator->Table;
+    uint32 Phase = Oscillator->Phase;
+
+    for(int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        Bus[SampleIndex] += Oscillator->Amplitude * sound_SampleTable(Table, Phase);
+        Phase += Oscillator->PhaseIncrement;
+    }
+
+    Oscillator->Phase = Phase;
+}
+
+//SSE2 has no gather, lane indices go through memory and the table reads stay scalar
+internal HANDMADE_TARGET_SSE2 SOUND_RENDER_OSCILLATOR(sound_RenderOscillator_SSE2)
+{
+    float32 *Table = Oscillator->Table;
+    uint32 Phase = Oscillator->Phase;
+    uint32 Increment = Oscillator->PhaseIncrement;
+
+    __m128i LanePhase = _mm_setr_epi32((int32) Phase, (int32) (Phase + Increment), (int32) (Phase + (Increment * 2)), (int32) (Phase + (Increment * 3)));
+    __m128i LaneStep = _mm_set1_epi32((int32) (Increment * 4));
+    __m128i FractionMask = _mm_set1_epi32((1 << SOUND_PHASE_FRACTION_BITS) - 1);
+    __m128 FractionScale = _mm_set1_ps(1.0f / (float32) (1 << SOUND_PHASE_FRACTION_BITS));
+    __m128 Amplitude = _mm_set1_ps(Oscillator->Amplitude);
+
+    int SampleIndex = 0;
+    for(; SampleIndex + 4 <= SampleCount; SampleIndex += 4)
+    {
+        uint32 Index[4];
+        _mm_storeu_si128((__m128i *) Index, _mm_srli_epi32(LanePhase, SOUND_PHASE_FRACTION_BITS));
+
+        __m128 A = _mm_setr_ps(Table[Index[0]], Table[Index[1]], Table[Index[2]], Table[Index[3]]);
+        __m128 B = _mm_setr_ps(Table[Index[0] + 1], Table[Index[1] + 1], Table[Index[2] + 1], Table[Index[3] + 1]);
+        __m128 Fraction = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(LanePhase, FractionMask)), FractionScale);
+
+        __m128 Value = _mm_add_ps(A, _mm_mul_ps(Fraction, _mm_sub_ps(B, A)));
+        __m128 Mix = _mm_add_ps(_mm_loadu_ps(Bus + SampleIndex), _mm_mul_ps(Amplitude, Value));
+        _mm_storeu_ps(Bus + SampleIndex, Mix);
+
+        LanePhase = _mm_add_epi32(LanePhase, LaneStep);
+    }
+
+    Phase += Increment * (uint32) SampleIndex;
+
+    for(; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        Bus[SampleIndex] += Oscillator->Amplitude * sound_SampleTable(Table, Phase);
+        Phase += Increment;
+    }
+
+    Oscillator->Phase = Phase;
+}
+
+//8 samples per iteration, both interpolation taps come from gathers
+internal HANDMADE_TARGET_AVX2 SOUND_RENDER_OSCILLATOR(sound_RenderOscillator_AVX2)
+{
+    float32 *Table = Oscillator->Table;
+    uint32 Phase = Oscillator->Phase;
+    uint32 Increment = Oscillator->PhaseIncrement;
+
+    __m256i LaneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i LanePhase = _mm256_add_epi32(_mm256_set1_epi32((int32) Phase), _mm256_mullo_epi32(_mm256_set1_epi32((int32) Increment), LaneIndex));
+    __m256i LaneStep = _mm256_set1_epi32((int32) (Increment * 8));
+    __m256i FractionMask = _mm256_set1_epi32((1 << SOUND_PHASE_FRACTION_BITS) - 1);
+    __m256 FractionScale = _mm256_set1_ps(1.0f / (float32) (1 << SOUND_PHASE_FRACTION_BITS));
+    __m256 Amplitude = _mm256_set1_ps(Oscillator->Amplitude);
+
+    int SampleIndex = 0;
+    for(; SampleIndex + 8 <= SampleCount; SampleIndex += 8)
+    {
+        __m256i Index = _mm256_srli_epi32(LanePhase, SOUND_PHASE_FRACTION_BITS);
+
+        __m256 A = _mm256_i32gather_ps(Table, Index, 4);
+        __m256 B = _mm256_i32gather_ps(Table + 1, Index, 4);
+        __m256 Fraction = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(LanePhase, FractionMask)), FractionScale);
+
+        __m256 Value = _mm256_add_ps(A, _mm256_mul_ps(Fraction, _mm256_sub_ps(B, A)));
+        __m256 Mix = _mm256_add_ps(_mm256_loadu_ps(Bus + SampleIndex), _mm256_mul_ps(Amplitude, Value));
+        _mm256_storeu_ps(Bus + SampleIndex, Mix);
+
+        LanePhase = _mm256_add_epi32(LanePhase, LaneStep);
+    }
+
+    Phase += Increment * (uint32) SampleIndex;
+
+    for(; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        Bus[SampleIndex] += Oscillator->Amplitude * sound_SampleTable(Table, Phase);
+        Phase += Increment;
+    }
+
+    Oscillator->Phase = Phase;
+}
+
+internal SOUND_MIX_SPAN(sound_MixSpan_Scalar)
+{
+    for(int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        float32 VolumeLeft = Volume[0] + ((float32) SampleIndex * dVolume[0]);
+        float32 VolumeRight = Volume[1] + ((float32) SampleIndex * dVolume[1]);
+
+        BusLeft[SampleIndex] += VolumeLeft * (float32) SourceLeft[SampleIndex];
+        BusRight[SampleIndex] += VolumeRight * (float32) SourceRight[SampleIndex];
+    }
+
+    Volume[0] += (float32) SampleCount * dVolume[0];
+    Volume[1] += (float32) SampleCount * dVolume[1];
+}
+
+//Sign extends 4 int16 to int32 without SSE4.1
+#define SOUND_UNPACK_INT16_SSE2(Value) _mm_srai_epi32(_mm_unpacklo_epi16((Value), (Value)), 16)
+
+internal HANDMADE_TARGET_SSE2 SOUND_MIX_SPAN(sound_MixSpan_SSE2)
+{
+    __m128 LaneIndex = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    __m128 dVolumeLeft = _mm_set1_ps(dVolume[0]);
+    __m128 dVolumeRight = _mm_set1_ps(dVolume[1]);
+    __m128 VolumeLeft = _mm_add_ps(_mm_set1_ps(Volume[0]), _mm_mul_ps(LaneIndex, dVolumeLeft));
+    __m128 VolumeRight = _mm_add_ps(_mm_set1_ps(Volume[1]), _mm_mul_ps(LaneIndex, dVolumeRight));
+    __m128 VolumeStepLeft = _mm_mul_ps(_mm_set1_ps(4.0f), dVolumeLeft);
+    __m128 VolumeStepRight = _mm_mul_ps(_mm_set1_ps(4.0f), dVolumeRight);
+
+    int SampleIndex = 0;
+    for(; SampleIndex + 4 <= SampleCount; SampleIndex += 4)
+    {
+        __m128i Left16 = _mm_loadl_epi64((__m128i *) (SourceLeft + SampleIndex));
+        __m128i Right16 = _mm_loadl_epi64((__m128i *) (SourceRight + SampleIndex));
+
+        __m128 Left = _mm_cvtepi32_ps(SOUND_UNPACK_INT16_SSE2(Left16));
+        __m128 Right = _mm_cvtepi32_ps(SOUND_UNPACK_INT16_SSE2(Right16));
+
+        _mm_storeu_ps(BusLeft + SampleIndex, _mm_add_ps(_mm_loadu_ps(BusLeft + SampleIndex), _mm_mul_ps(VolumeLeft, Left)));
+        _mm_storeu_ps(BusRight + SampleIndex, _mm_add_ps(_mm_loadu_ps(BusRight + SampleIndex), _mm_mul_ps(VolumeRight, Right)));
+
+        VolumeLeft = _mm_add_ps(VolumeLeft, VolumeStepLeft);
+        VolumeRight = _mm_add_ps(VolumeRight, VolumeStepRight);
+    }
+
+    //Tail picks up the ramp where the vector loop stopped
+    float32 TailVolume[2];
+    TailVolume[0] = Volume[0] + ((float32) SampleIndex * dVolume[0]);
+    TailVolume[1] = Volume[1] + ((float32) SampleIndex * dVolume[1]);
+    sound_MixSpan_Scalar(BusLeft + SampleIndex, BusRight + SampleIndex, SourceLeft + SampleIndex, SourceRight + SampleIndex, SampleCount - SampleIndex, TailVolume, dVolume);
+
+    Volume[0] += (float32) SampleCount * dVolume[0];
+    Volume[1] += (float32) SampleCount * dVolume[1];
+}
+
+internal HANDMADE_TARGET_AVX2 SOUND_MIX_SPAN(sound_MixSpan_AVX2)
+{
+    __m256 LaneIndex = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    __m256 dVolumeLeft = _mm256_set1_ps(dVolume[0]);
+    __m256 dVolumeRight = _mm256_set1_ps(dVolume[1]);
+    __m256 VolumeLeft = _mm256_add_ps(_mm256_set1_ps(Volume[0]), _mm256_mul_ps(LaneIndex, dVolumeLeft));
+    __m256 VolumeRight = _mm256_add_ps(_mm256_set1_ps(Volume[1]), _mm256_mul_ps(LaneIndex, dVolumeRight));
+    __m256 VolumeStepLeft = _mm256_mul_ps(_mm256_set1_ps(8.0f), dVolumeLeft);
+    __m256 VolumeStepRight = _mm256_mul_ps(_mm256_set1_ps(8.0f), dVolumeRight);
+
+    int SampleIndex = 0;
+    for(; SampleIndex + 8 <= SampleCount; SampleIndex += 8)
+    {
+        __m256 Left = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) (SourceLeft + SampleIndex))));
+        __m256 Right = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i *) (SourceRight + SampleIndex))));
+
+        _mm256_storeu_ps(BusLeft + SampleIndex, _mm256_add_ps(_mm256_loadu_ps(BusLeft + SampleIndex), _mm256_mul_ps(VolumeLeft, Left)));
+        _mm256_storeu_ps(BusRight + SampleIndex, _mm256_add_ps(_mm256_loadu_ps(BusRight + SampleIndex), _mm256_mul_ps(VolumeRight, Right)));
+
+        VolumeLeft = _mm256_add_ps(VolumeLeft, VolumeStepLeft);
+        VolumeRight = _mm256_add_ps(VolumeRight, VolumeStepRight);
+    }
+
+    //The scalar tail is legacy SSE, clear the upper halves first or every call pays the AVX to SSE transition
+    _mm256_zeroupper();
+
+    float32 TailVolume[2];
+    TailVolume[0] = Volume[0] + ((float32) SampleIndex * dVolume[0]);
+    TailVolume[1] = Volume[1] + ((float32) SampleIndex * dVolume[1]);
+    sound_MixSpan_Scalar(BusLeft + SampleIndex, BusRight + SampleIndex, SourceLeft + SampleIndex, SourceRight + SampleIndex, SampleCount - SampleIndex, TailVolume, dVolume);
+
+    Volume[0] += (float32) SampleCount * dVolume[0];
+    Volume[1] += (float32) SampleCount * dVolume[1];
+}
+
+internal SOUND_WRITE_SAMPLES(sound_WriteSamples_Scalar)
+{
+    int16 *SampleOut = Samples;
+
+    for(int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        float32 Value[2] = {BusLeft[SampleIndex], BusRight[SampleIndex]};
+
+        for(int Channel = 0; Channel < 2; ++Channel)
+        {
+            if(Value[Channel] > 32767.0f)
+            {
+                Value[Channel] = 32767.0f;
+            }
+            if(Value[Channel] < -32768.0f)
+            {
+                Value[Channel] = -32768.0f;
+            }
+
+            //Round to nearest even, same as cvtps2dq in the SIMD path
+            *SampleOut++ = (int16) lrintf(Value[Channel]);
+        }
+    }
+}
+
+//Clamp in float first, cvtps2dq turns anything out of int32 range into INT_MIN which would flip the sign
+internal HANDMADE_TARGET_SSE2 SOUND_WRITE_SAMPLES(sound_WriteSamples_SSE2)
+{
+    __m128 Max = _mm_set1_ps(32767.0f);
+    __m128 Min = _mm_set1_ps(-32768.0f);
+
+    int SampleIndex = 0;
+    for(; SampleIndex + 4 <= SampleCount; SampleIndex += 4)
+    {
+        __m128i Left = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(BusLeft + SampleIndex), Min), Max));
+        __m128i Right = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(BusRight + SampleIndex), Min), Max));
+
+        //L0 R0 L1 R1 | L2 R2 L3 R3, then one saturating pack to int16
+        __m128i Low = _mm_unpacklo_epi32(Left, Right);
+        __m128i High = _mm_unpackhi_epi32(Left, Right);
+        _mm_storeu_si128((__m128i *) (Samples + (SampleIndex * 2)), _mm_packs_epi32(Low, High));
+    }
+
+    sound_WriteSamples_Scalar(BusLeft + SampleIndex, BusRight + SampleIndex, Samples + (SampleIndex * 2), SampleCount - SampleIndex);
+}
+
+//Returns the level actually used, which may be lower than requested
+internal SIMD_LEVEL sound_SelectKernels(SIMD_LEVEL Requested)
+{
+    SIMD_LEVEL Selected = cpu_SelectSimdLevel(Requested);
+
+    switch(Selected)
+    {
+        case SIMD_LEVEL_AVX2:
+        {
+            sound_RenderOscillator_Kernel = sound_RenderOscillator_AVX2;
+            sound_MixSpan_Kernel = sound_MixSpan_AVX2;
+            sound_WriteSamples_Kernel = sound_WriteSamples_SSE2;
+            break;
+        }
+
+        case SIMD_LEVEL_SSE2:
+        {
+            sound_RenderOscillator_Kernel = sound_RenderOscillator_SSE2;
+            sound_MixSpan_Kernel = sound_MixSpan_SSE2;
+            sound_WriteSamples_Kernel = sound_WriteSamples_SSE2;
+            break;
+        }
+
+        default:
+        {
+            sound_RenderOscillator_Kernel = sound_RenderOscillator_Scalar;
+            sound_MixSpan_Kernel = sound_MixSpan_Scalar;
+            sound_WriteSamples_Kernel = sound_WriteSamples_Scalar;
+            break;
+        }
+    }
+
+    return Selected;
+}
+
+internal void sound_InitMixer(SOUND_MIXER *Mixer, SOUND_WAVETABLES *Wavetables, int SampleRate)
+{
+    Mixer->SampleRate = SampleRate;
+    sound_InitOscillatorBank(&Mixer->Oscillators, Wavetables, SampleRate);
+
+    Mixer->VoiceCount = 0;
+    Mixer->FirstVoice = 0;
+    Mixer->FirstFreeVoice = 0;
+
+    for(int VoiceIndex = SOUND_MAX_VOICES - 1; VoiceIndex >= 0; --VoiceIndex)
+    {
+        SOUND_VOICE *Voice = &Mixer->Voices[VoiceIndex];
+        Voice->Next = Mixer->FirstFreeVoice;
+        Mixer->FirstFreeVoice = Voice;
+    }
+
+    //Converters keep their tables, each checks its rates when it is next taken
+    Mixer->FirstFreeConverter = 0;
+    for(int ConverterIndex = SOUND_MAX_CONVERTERS - 1; ConverterIndex >= 0; --ConverterIndex)
+    {
+        SOUND_CONVERTER *Converter = &Mixer->Converters[ConverterIndex];
+        Converter->NextFree = Mixer->FirstFreeConverter;
+        Mixer->FirstFreeConverter = Converter;
+    }
+}
+
+//Returns 0 when every converter is busy or the rates are too far apart for the resampler
+internal SOUND_CONVERTER *sound_TakeConverter(SOUND_MIXER *Mixer, int SampleRate)
+{
+    SOUND_CONVERTER *Converter = Mixer->FirstFreeConverter;
+
+    if(!Converter || (SampleRate <= 0) ||
+       (SampleRate > (Mixer->SampleRate * RESAMPLE_MAX_RATIO)) || (Mixer->SampleRate > (SampleRate * RESAMPLE_MAX_RATIO)))
+    {
+        return 0;
+    }
+
+    int Quality = SOUND_CONVERTER_QUALITY;
+    while((Quality >= 0) && (resample_GetMemorySize(SampleRate, Mixer->SampleRate, (RESAMPLE_QUALITY) Quality) > SOUND_CONVERTER_MEMORY_SIZE))
+    {
+        --Quality;
+    }
+
+    if(Quality < 0)
+    {
+        return 0;
+    }
+
+    RESAMPLE_CONTEXT *Context = &Converter->Context;
+    if((Context->InputRate == SampleRate) && (Context->OutputRate == Mixer->SampleRate) && (Context->Quality == (RESAMPLE_QUALITY) Quality))
+    {
+        resample_Reset(Context);
+    }
+    else
+    {
+        resample_InitContext(Context, Converter->Memory, SampleRate, Mixer->SampleRate, (RESAMPLE_QUALITY) Quality);
+    }
+
+    Mixer->FirstFreeConverter = Converter->NextFree;
+
+    return Converter;
+}
+
+//Puts a voice that finished or was stopped back on the free list, along with its converter
+internal void sound_FreeVoice(SOUND_MIXER *Mixer, SOUND_VOICE *Voice)
+{
+    if(Voice->Converter)
+    {
+        Voice->Converter->NextFree = Mixer->FirstFreeConverter;
+        Mixer->FirstFreeConverter = Voice->Converter;
+        Voice->Converter = 0;
+    }
+
+    Voice->Next = Mixer->FirstFreeVoice;
+    Mixer->FirstFreeVoice = Voice;
+    --Mixer->VoiceCount;
+}
+
+internal SOUND_VOICE *sound_StartVoice(SOUND_MIXER *Mixer, SOUND_SAMPLES *Sound, SOUND_STREAM *Stream, int SampleRate, float32 VolumeLeft, float32 VolumeRight, bool32 Looping)
+{
+    SOUND_VOICE *Voice = Mixer->FirstFreeVoice;
+    SOUND_CONVERTER *Converter = 0;
+
+    if(Voice && (SampleRate != Mixer->SampleRate))
+    {
+        Converter = sound_TakeConverter(Mixer, SampleRate);
+
+        if(!Converter)
+        {
+            Voice = 0;
+        }
+    }
+
+    if(Voice)
+    {
+        Mixer->FirstFreeVoice = Voice->Next;
+
+        Voice->Sound = Sound;
+        Voice->Stream = Stream;
+        Voice->Converter = Converter;
+        Voice->SamplesPlayed = 0;
+        Voice->Looping = Looping;
+        Voice->CurrentVolume[0] = Voice->TargetVolume[0] = VolumeLeft;
+        Voice->CurrentVolume[1] = Voice->TargetVolume[1] = VolumeRight;
+        Voice->dVolume[0] = 0.0f;
+        Voice->dVolume[1] = 0.0f;
+        Voice->RampSamplesLeft = 0;
+
+        Voice->Next = Mixer->FirstVoice;
+        Mixer->FirstVoice = Voice;
+        ++Mixer->VoiceCount;
+    }
+
+    return Voice;
+}
+
+//Returns 0 when every voice is busy. The pointer stays valid until the voice finishes or is stopped
+//A sound at another rate than the mixer's is converted as it plays, and also returns 0 when every converter is busy
+internal SOUND_VOICE *sound_PlaySound(SOUND_MIXER *Mixer, SOUND_SAMPLES *Sound, float32 VolumeLeft, float32 VolumeRight, bool32 Looping)
+{
+    return sound_StartVoice(Mixer, Sound, 0, Sound->SampleRate, VolumeLeft, VolumeRight, Looping);
+}
+
+//Same for a stream, which must stay where it is while the voice plays. Nothing is read until the voice is mixed
+internal SOUND_VOICE *sound_PlayStream(SOUND_MIXER *Mixer, SOUND_STREAM *Stream, float32 VolumeLeft, float32 VolumeRight, bool32 Looping)
+{
+    return sound_StartVoice(Mixer, 0, Stream, Stream->SampleRate, VolumeLeft, VolumeRight, Looping);
+}
+
+//Ramps both channels to the new volume over FadeSeconds, 0 changes it at the next sample
+internal void sound_ChangeVolume(SOUND_MIXER *Mixer, SOUND_VOICE *Voice, float32 FadeSeconds, float32 VolumeLeft, float32 VolumeRight)
+{
+    Voice->TargetVolume[0] = VolumeLeft;
+    Voice->TargetVolume[1] = VolumeRight;
+
+    int RampSamples = (int) (FadeSeconds * (float32) Mixer->SampleRate);
+
+    if(RampSamples <= 0)
+    {
+        Voice->CurrentVolume[0] = VolumeLeft;
+        Voice->CurrentVolume[1] = VolumeRight;
+        Voice->RampSamplesLeft = 0;
+    }
+    else
+    {
+        Voice->dVolume[0] = (VolumeLeft - Voice->CurrentVolume[0]) / (float32) RampSamples;
+        Voice->dVolume[1] = (VolumeRight - Voice->CurrentVolume[1]) / (float32) RampSamples;
+        Voice->RampSamplesLeft = RampSamples;
+    }
+}
+
+internal void sound_StopSound(SOUND_MIXER *Mixer, SOUND_VOICE *Voice)
+{
+    for(SOUND_VOICE **VoicePtr = &Mixer->FirstVoice; *VoicePtr; VoicePtr = &(*VoicePtr)->Next)
+    {
+        if(*VoicePtr == Voice)
+        {
+            *VoicePtr = Voice->Next;
+            sound_FreeVoice(Mixer, Voice);
+            break;
+        }
+    }
+}
+
+//Converts SampleCount frames from Position on into planar int16, Right is left alone for a mono stream
+//Float samples are scaled and saturated the way sound_WriteSamples_Scalar does it
+internal void sound_ReadStreamFrames(SOUND_STREAM *Stream, int Position, int SampleCount, int16 *Left, int16 *Right)
+{
+    int ChannelCount = Stream->ChannelCount;
+
+    if(Stream->Format == SOUND_SAMPLE_FORMAT_INT16)
+    {
+        int16 *Source = (int16 *) Stream->Frames + ((int64) Position * ChannelCount);
+
+        if(ChannelCount == 2)
+        {
+            for(int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+            {
+                Left[SampleIndex] = Source[SampleIndex * 2];
+                Right[SampleIndex] = Source[(SampleIndex * 2) + 1];
+            }
+        }
+        else
+        {
+            for(int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+            {
+                Left[SampleIndex] = Source[SampleIndex];
+            }
+        }
+    }
+    else
+    {
+        float32 *Source = (float32 *) Stream->Frames + ((int64) Position * ChannelCount);
+
+        for(int Channel = 0; Channel < ChannelCount; ++Channel)
+        {
+            int16 *Dest = (Channel == 0) ? Left : Right;
+
+            for(int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+            {
+                float32 Value = Source[(SampleIndex * ChannelCount) + Channel] * 32767.0f;
+
+                if(Value > 32767.0f)
+                {
+                    Value = 32767.0f;
+                }
+                else if(!(Value >= -32768.0f)) //NaN goes to the floor too
+                {
+                    Value = -32768.0f;
+                }
+
+                Dest[SampleIndex] = (int16) lrintf(Value);
+            }
+        }
+    }
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(sound_ReadAheadWork)
+{
+    (void) Queue;
+    SOUND_STREAM *Stream = (SOUND_STREAM *) Data;
+    TIMED_FUNCTION();
+
+    //One read per page is enough to fault it in
+    uint32 Sum = 0;
+    for(uint64 Offset = 0; Offset < Stream->ReadAheadSize; Offset += 4096)
+    {
+        Sum += Stream->ReadAheadMemory[Offset];
+    }
+    sound_ReadAheadSink = Sum;
+
+    CompletePreviousWritesBeforeFutureWrites;
+    Stream->ReadAheadBusy = false;
+}
+
+//Call before sound_OutputSound. Keeps at least a chunk of every playing stream paged in ahead of its voice
+//so the mix never waits on the file. Without a background queue the mix faults pages in itself
+//Only one voice per stream is tracked, a second voice on the same stream just reads cold pages
+internal void sound_ReadAhead(SOUND_MIXER *Mixer, HANDMADE_PLATFORM *Platform)
+{
+    if(!Platform->BackgroundQueue)
+    {
+        return;
+    }
+
+    for(SOUND_VOICE *Voice = Mixer->FirstVoice; Voice; Voice = Voice->Next)
+    {
+        SOUND_STREAM *Stream = Voice->Stream;
+
+        if(!Stream || Stream->ReadAheadBusy || (Stream->SampleCount <= 0))
+        {
+            continue;
+        }
+
+        //Looping voices count the distance around the loop, anything else out of range means the voice moved
+        int Ahead = Stream->ReadAheadEnd - Voice->SamplesPlayed;
+        if(Voice->Looping && (Ahead < 0))
+        {
+            Ahead += Stream->SampleCount;
+        }
+
+        if((Ahead < 0) || (Ahead > Stream->SampleCount))
+        {
+            Stream->ReadAheadEnd = Voice->SamplesPlayed;
+            Ahead = 0;
+        }
+
+        if(Ahead >= SOUND_STREAM_CHUNK_FRAMES)
+        {
+            continue;
+        }
+
+        int Start = Stream->ReadAheadEnd;
+        if(Start >= Stream->SampleCount)
+        {
+            if(!Voice->Looping)
+            {
+                continue;
+            }
+
+            Start = 0;
+        }
+
+        int Count = Stream->SampleCount - Start;
+        if(Count > SOUND_STREAM_CHUNK_FRAMES)
+        {
+            Count = SOUND_STREAM_CHUNK_FRAMES;
+        }
+
+        uint64 FrameSize = (uint64) Stream->ChannelCount * ((Stream->Format == SOUND_SAMPLE_FORMAT_INT16) ? sizeof(int16) : sizeof(float32));
+        Stream->ReadAheadMemory = (uint8 *) Stream->Frames + ((uint64) Start * FrameSize);
+        Stream->ReadAheadSize = (uint64) Count * FrameSize;
+        Stream->ReadAheadEnd = Start + Count;
+        Stream->ReadAheadBusy = true;
+
+        Platform->AddWorkEntry(Platform->BackgroundQueue, sound_ReadAheadWork, Stream);
+    }
+}
+
+//Reads Count source frames of a converted voice into interleaved stereo, wrapping a looping voice and reading silence
+//past the end of anything else. Advances SamplesPlayed by Count
+internal void sound_ReadVoiceFrames(SOUND_VOICE *Voice, int Count, int16 *Frames)
+{
+    int16 StreamLeft[SOUND_BLOCK_SIZE];
+    int16 StreamRight[SOUND_BLOCK_SIZE];
+
+    SOUND_SAMPLES *Sound = Voice->Sound;
+    SOUND_STREAM *Stream = Voice->Stream;
+    int SampleCount = Stream ? Stream->SampleCount : Sound->SampleCount;
+    int ChannelCount = Stream ? Stream->ChannelCount : Sound->ChannelCount;
+
+    int Read = 0;
+    while(Read < Count)
+    {
+        if(Voice->Looping && (Voice->SamplesPlayed >= SampleCount))
+        {
+            Voice->SamplesPlayed = 0;
+        }
+
+        int RunCount = Count - Read;
+        int SamplesLeft = SampleCount - Voice->SamplesPlayed;
+        int16 *Dest = Frames + (Read * 2);
+
+        if(SamplesLeft <= 0)
+        {
+            for(int Sample = 0; Sample < RunCount * 2; ++Sample)
+            {
+                Dest[Sample] = 0;
+            }
+        }
+        else
+        {
+            if(RunCount > SamplesLeft)
+            {
+                RunCount = SamplesLeft;
+            }
+
+            int16 *Left;
+            int16 *Right;
+            if(Stream)
+            {
+                sound_ReadStreamFrames(Stream, Voice->SamplesPlayed, RunCount, StreamLeft, StreamRight);
+                Left = StreamLeft;
+                Right = (ChannelCount > 1) ? StreamRight : StreamLeft;
+            }
+            else
+            {
+                Left = Sound->Samples[0] + Voice->SamplesPlayed;
+                Right = Sound->Samples[1] + Voice->SamplesPlayed;
+            }
+
+            for(int SampleIndex = 0; SampleIndex < RunCount; ++SampleIndex)
+            {
+                Dest[(SampleIndex * 2)] = Left[SampleIndex];
+                Dest[(SampleIndex * 2) + 1] = Right[SampleIndex];
+            }
+        }
+
+        Read += RunCount;
+        Voice->SamplesPlayed += RunCount;
+    }
+}
+
+//Fills Count mixer rate frames of a converted voice into planar Left and Right, Count is at most SOUND_BLOCK_SIZE
+//Source is read a block at a time, so a voice downsampled by a large ratio may take a few passes
+internal void sound_ConvertVoiceFrames(SOUND_VOICE *Voice, int Count, int16 *Left, int16 *Right)
+{
+    int16 Source[SOUND_BLOCK_SIZE * 2];
+    int16 Converted[SOUND_BLOCK_SIZE * 2];
+
+    RESAMPLE_CONTEXT *Context = &Voice->Converter->Context;
+
+    int Written = 0;
+    while(Written < Count)
+    {
+        int OutputCount = Count - Written;
+        int InputCount = resample_GetInputFrames(Context, OutputCount);
+
+        if(InputCount > SOUND_BLOCK_SIZE)
+        {
+            InputCount = SOUND_BLOCK_SIZE;
+            OutputCount = resample_GetOutputFrames(Context, InputCount);
+        }
+
+        sound_ReadVoiceFrames(Voice, InputCount, Source);
+        resample_Process(Context, Source, InputCount, Converted, OutputCount);
+
+        for(int SampleIndex = 0; SampleIndex < OutputCount; ++SampleIndex)
+        {
+            Left[Written + SampleIndex] = Converted[(SampleIndex * 2)];
+            Right[Written + SampleIndex] = Converted[(SampleIndex * 2) + 1];
+        }
+
+        Written += OutputCount;
+    }
+}
+
+//Each voice is mixed as spans that end at a loop point, the end of the sound or the end of a volume ramp
+//so the kernels only ever see contiguous source samples and a single linear ramp
+//Streamed voices convert each span into a block on the stack first, so their cost follows the frames mixed and not the length of the stream
+//Converted voices do the same through their resampler, their spans count mixer frames and the loop point is handled while reading
+internal void sound_MixVoices(SOUND_MIXER *Mixer, float32 *BusLeft, float32 *BusRight, int BlockCount)
+{
+    local float32 NoRamp[2] = {0.0f, 0.0f};
+
+    int16 StreamLeft[SOUND_BLOCK_SIZE];
+    int16 StreamRight[SOUND_BLOCK_SIZE];
+
+    SOUND_VOICE **VoicePtr = &Mixer->FirstVoice;
+
+    while(*VoicePtr)
+    {
+        SOUND_VOICE *Voice = *VoicePtr;
+        SOUND_SAMPLES *Sound = Voice->Sound;
+        SOUND_STREAM *Stream = Voice->Stream;
+        SOUND_CONVERTER *Converter = Voice->Converter;
+        int SampleCount = Stream ? Stream->SampleCount : Sound->SampleCount;
+        bool32 Finished = (SampleCount <= 0);
+
+        //Silence past the end flushes the last source frames out through the filter
+        int EndSample = SampleCount;
+        if(Converter && !Voice->Looping)
+        {
+            EndSample += Converter->Context.TapCount;
+        }
+
+        int Mixed = 0;
+        while((Mixed < BlockCount) && !Finished)
+        {
+            int SpanCount = BlockCount - Mixed;
+
+            int SamplesLeft = SampleCount - Voice->SamplesPlayed;
+            if(!Converter && (SpanCount > SamplesLeft))
+            {
+                SpanCount = SamplesLeft;
+            }
+
+            float32 *dVolume = NoRamp;
+            if(Voice->RampSamplesLeft > 0)
+            {
+                dVolume = Voice->dVolume;
+
+                if(SpanCount > Voice->RampSamplesLeft)
+                {
+                    SpanCount = Voice->RampSamplesLeft;
+                }
+            }
+
+            if(Converter)
+            {
+                sound_ConvertVoiceFrames(Voice, SpanCount, StreamLeft, StreamRight);
+                sound_MixSpan_Kernel(BusLeft + Mixed, BusRight + Mixed, StreamLeft, StreamRight,
+                                     SpanCount, Voice->CurrentVolume, dVolume);
+            }
+            else if(Stream)
+            {
+                sound_ReadStreamFrames(Stream, Voice->SamplesPlayed, SpanCount, StreamLeft, StreamRight);
+                sound_MixSpan_Kernel(BusLeft + Mixed, BusRight + Mixed,
+                                     StreamLeft, (Stream->ChannelCount > 1) ? StreamRight : StreamLeft,
+                                     SpanCount, Voice->CurrentVolume, dVolume);
+            }
+            else
+            {
+                sound_MixSpan_Kernel(BusLeft + Mixed, BusRight + Mixed,
+                                     Sound->Samples[0] + Voice->SamplesPlayed, Sound->Samples[1] + Voice->SamplesPlayed,
+                                     SpanCount, Voice->CurrentVolume, dVolume);
+            }
+
+            Mixed += SpanCount;
+            if(!Converter)
+            {
+                Voice->SamplesPlayed += SpanCount;
+            }
+
+            if(Voice->RampSamplesLeft > 0)
+            {
+                Voice->RampSamplesLeft -= SpanCount;
+
+                //Snap so float error in the ramp never leaves the volume off target
+                if(Voice->RampSamplesLeft == 0)
+                {
+                    Voice->CurrentVolume[0] = Voice->TargetVolume[0];
+                    Voice->CurrentVolume[1] = Voice->TargetVolume[1];
+                }
+            }
+
+            if(Voice->SamplesPlayed >= EndSample)
+            {
+                if(Voice->Looping)
+                {
+                    Voice->SamplesPlayed = 0;
+                }
+                else
+                {
+                    Finished = true;
+                }
+            }
+        }
+
+        if(Finished)
+        {
+            *VoicePtr = Voice->Next;
+            sound_FreeVoice(Mixer, Voice);
+        }
+        else
+        {
+            VoicePtr = &Voice->Next;
+        }
+    }
+}
+
+//Fills a sound with a decaying tone from the wavetables, for effects the game makes itself
+internal void sound_GenerateTone(SOUND_MIXER *Mixer, SOUND_SAMPLES *Sound, int16 *Memory, int SampleCount, SOUND_WAVE Wave, float32 Hz, float32 Amplitude)
+{
+    SOUND_OSCILLATOR Oscillator = {};
+    sound_SetOscillator(&Mixer->Oscillators, &Oscillator, Wave, Hz, 1.0f);
+
+    for(int SampleIndex = 0; SampleIndex < SampleCount; ++SampleIndex)
+    {
+        float32 Envelope = 1.0f - ((float32) SampleIndex / (float32) SampleCount);
+        Memory[SampleIndex] = (int16) (Amplitude * Envelope * Envelope * sound_SampleTable(Oscillator.Table, Oscillator.Phase));
+        Oscillator.Phase += Oscillator.PhaseIncrement;
+    }
+
+    Sound->ChannelCount = 1;
+    Sound->SampleRate = Mixer->SampleRate;
+    Sound->SampleCount = SampleCount;
+    Sound->Samples[0] = Memory;
+    Sound->Samples[1] = Memory;
+}
+
+//Mixes the oscillator bank and every voice into Samples, SOUND_BLOCK_SIZE frames at a time
+internal void sound_OutputSound(SOUND_MIXER *Mixer, HANDMADE_SOUND_BUFFER *SoundBuffer)
+{
+    TIMED_FUNCTION();
+
+    if(!sound_RenderOscillator_Kernel)
+    {
+        sound_SelectKernels(SIMD_LEVEL_AUTO);
+    }
+
+    SOUND_OSCILLATOR_BANK *Bank = &Mixer->Oscillators;
+
+    float32 Mono[SOUND_BLOCK_SIZE];
+    float32 BusLeft[SOUND_BLOCK_SIZE];
+    float32 BusRight[SOUND_BLOCK_SIZE];
+
+    for(int BlockStart = 0; BlockStart < SoundBuffer->SampleCount; BlockStart += SOUND_BLOCK_SIZE)
+    {
+        int BlockCount = SoundBuffer->SampleCount - BlockStart;
+        if(BlockCount > SOUND_BLOCK_SIZE)
+        {
+            BlockCount = SOUND_BLOCK_SIZE;
+        }
+
+        for(int SampleIndex = 0; SampleIndex < BlockCount; ++SampleIndex)
+        {
+            Mono[SampleIndex] = 0.0f;
+        }
+
+        //Oscillators are centred, rendered once in mono and copied to both sides
+        for(int OscillatorIndex = 0; OscillatorIndex < Bank->OscillatorCount; ++OscillatorIndex)
+        {
+            sound_RenderOscillator_Kernel(&Bank->Oscillators[OscillatorIndex], Mono, BlockCount);
+        }
+
+        for(int SampleIndex = 0; SampleIndex < BlockCount; ++SampleIndex)
+        {
+            BusLeft[SampleIndex] = Mono[SampleIndex];
+            BusRight[SampleIndex] = Mono[SampleIndex];
+        }
+
+        sound_MixVoices(Mixer, BusLeft, BusRight, BlockCount);
+
+        sound_WriteSamples_Kernel(BusLeft, BusRight, SoundBuffer->Samples + (BlockStart * 2), BlockCount);
+    }
+}
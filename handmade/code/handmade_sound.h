@@ -0,0 +1,149 @@
+#if !defined(HANDMADE_SOUND_H)
+
+#include "handmade_resample.h"
+
+//Wavetables hold one cycle, a power of two long so the top bits of the phase index them directly
+#define SOUND_TABLE_BITS 11
+#define SOUND_TABLE_SIZE (1 << SOUND_TABLE_BITS)
+#define SOUND_PHASE_FRACTION_BITS (32 - SOUND_TABLE_BITS)
+
+//One table per octave, octave N holds (SOUND_TABLE_SIZE / 2) >> N harmonics
+//An oscillator uses the first octave whose top harmonic stays under Nyquist, so nothing aliases
+#define SOUND_OCTAVE_COUNT 11
+
+#define SOUND_MAX_OSCILLATORS 256
+#define SOUND_MAX_VOICES 1024
+
+//Frames mixed through the float bus per pass, the bus lives on the stack
+#define SOUND_BLOCK_SIZE 256
+
+//Voices baked at another rate than the mixer's play through a converter, a voice can't start once they are all taken
+//Each converter has room for high quality tables at every upsampling ratio, downsampling stretches the filter
+//so quality drops until its tables fit
+#define SOUND_MAX_CONVERTERS 8
+#define SOUND_CONVERTER_QUALITY RESAMPLE_QUALITY_HIGH
+#define SOUND_CONVERTER_MEMORY_SIZE ((((RESAMPLE_MAX_PHASES + 1) * 32) + RESAMPLE_BLOCK_FRAMES) * 2 * sizeof(float32))
+
+enum SOUND_WAVE
+{
+    SOUND_WAVE_SINE,
+    SOUND_WAVE_SAW,
+    SOUND_WAVE_SQUARE,
+    SOUND_WAVE_TRIANGLE,
+
+    SOUND_WAVE_COUNT
+};
+
+struct SOUND_WAVETABLES
+{
+    bool32 IsInitialised;
+
+    //Guard sample at the end repeats the first so interpolation never has to wrap
+    float32 Tables[SOUND_WAVE_COUNT][SOUND_OCTAVE_COUNT][SOUND_TABLE_SIZE + 1];
+};
+
+struct SOUND_OSCILLATOR
+{
+    uint32 Phase; //Fixed point position in the cycle, wraps for free at 2^32
+    uint32 PhaseIncrement;
+    float32 Amplitude;
+    float32 *Table;
+};
+
+struct SOUND_OSCILLATOR_BANK
+{
+    SOUND_WAVETABLES *Wavetables; //Owned by the caller, kept in game memory so oscillator tables survive a reload
+    int SampleRate;
+    int OscillatorCount;
+    SOUND_OSCILLATOR Oscillators[SOUND_MAX_OSCILLATORS];
+};
+
+//Adds one oscillator into a mono float bus and advances its phase
+#define SOUND_RENDER_OSCILLATOR(name) void name(SOUND_OSCILLATOR *Oscillator, float32 *Bus, int SampleCount)
+typedef SOUND_RENDER_OSCILLATOR(sound_render_oscillator);
+
+//Sound held in memory, planar int16. Mono sounds leave Samples[1] pointing at Samples[0]
+struct SOUND_SAMPLES
+{
+    int ChannelCount;
+    int SampleRate; //A rate other than the mixer's is converted as the sound plays
+    int SampleCount;
+    int16 *Samples[2];
+};
+
+enum SOUND_SAMPLE_FORMAT
+{
+    SOUND_SAMPLE_FORMAT_INT16,
+    SOUND_SAMPLE_FORMAT_FLOAT32,
+};
+
+//Frames per read ahead request, about a third of a second at 48 kHz
+#define SOUND_STREAM_CHUNK_FRAMES 16384
+
+//Long sound played straight out of mapped memory, interleaved the way the WAV stored it
+//Nothing is decoded up front, the mixer converts only the frames it is mixing
+struct SOUND_STREAM
+{
+    SOUND_SAMPLE_FORMAT Format;
+    int ChannelCount;
+    int SampleRate;
+    int SampleCount; //Frames, like SOUND_SAMPLES
+    void *Frames;
+
+    //Pages before ReadAheadEnd have been touched or queued on the background queue, one request in flight at a time
+    int ReadAheadEnd;
+    uint32 volatile ReadAheadBusy;
+    uint8 *ReadAheadMemory;
+    uint64 ReadAheadSize;
+};
+
+//Tables are kept when the converter is freed, the next voice at the same rates only clears the history
+struct SOUND_CONVERTER
+{
+    RESAMPLE_CONTEXT Context;
+    SOUND_CONVERTER *NextFree;
+    uint8 Memory[SOUND_CONVERTER_MEMORY_SIZE];
+};
+
+//One playing sound, volumes are per channel and ramp linearly towards the target
+struct SOUND_VOICE
+{
+    SOUND_SAMPLES *Sound;
+    SOUND_STREAM *Stream; //Set instead of Sound for a streamed voice
+    SOUND_CONVERTER *Converter; //Set when the source rate isn't the mixer's
+    int SamplesPlayed; //Source frames, a converted voice runs a filter's length of silence past the end
+    bool32 Looping;
+
+    float32 CurrentVolume[2];
+    float32 TargetVolume[2];
+    float32 dVolume[2]; //Change per sample while RampSamplesLeft > 0
+    int RampSamplesLeft;
+
+    SOUND_VOICE *Next;
+};
+
+//Oscillators and voices mix into a float stereo bus, which is converted to int16 once at the end
+struct SOUND_MIXER
+{
+    int SampleRate;
+    SOUND_OSCILLATOR_BANK Oscillators;
+
+    int VoiceCount;
+    SOUND_VOICE *FirstVoice;
+    SOUND_VOICE *FirstFreeVoice;
+    SOUND_VOICE Voices[SOUND_MAX_VOICES];
+
+    SOUND_CONVERTER *FirstFreeConverter;
+    SOUND_CONVERTER Converters[SOUND_MAX_CONVERTERS];
+};
+
+//Adds SampleCount frames of a voice into the stereo bus with volume Volume + Index * dVolume, advances Volume
+#define SOUND_MIX_SPAN(name) void name(float32 *BusLeft, float32 *BusRight, int16 *SourceLeft, int16 *SourceRight, int SampleCount, float32 *Volume, float32 *dVolume)
+typedef SOUND_MIX_SPAN(sound_mix_span);
+
+//Converts the float stereo bus to interleaved int16, saturating
+#define SOUND_WRITE_SAMPLES(name) void name(float32 *BusLeft, float32 *BusRight, int16 *Samples, int SampleCount)
+typedef SOUND_WRITE_SAMPLES(sound_write_samples);
+
+#define HANDMADE_SOUND_H
+#endif
@@ -0,0 +1,2621 @@
+#include "handmade.h"
+#include "handmade_memory.h"
+#include "handmade_jobs.cpp"
+#include "handmade_audio.cpp"
+#include "handmade_input.cpp"
+#include "handmade_replay.h"
+
+//The game itself runs from libhandmade.so, these copies of its modules are only for the benchmark modes
+#include "handmade_render.cpp"
+#include "handmade_pixel.cpp"
+#include "handmade_scale.cpp"
+#include "handmade_sound.cpp"
+#include "handmade_resample.cpp"
+#include "handmade_asset.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <x86intrin.h>
+
+#include "handmade_frametime.h"
+#include "handmade_debug.cpp"
+#include "handmade_capture.cpp"
+#include "linux_handmade.h"
+
+//Headless platform layer: no window, no audio device, no controllers
+//Drives the game update in a tight loop so the game side can be timed on machines without a display
+
+//Monotonic clock in nanoseconds, stands in for QueryPerformanceCounter
+internal uint64 linux_GetWallClock(void)
+{
+    timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+
+    return ((uint64) Time.tv_sec * 1000000000ull) + (uint64) Time.tv_nsec;
+}
+
+//Sleeps for the bulk of the wait and spins the tail, so scheduler wake up latency lands inside the spin instead of past the deadline
+//Absolute deadlines keep a late wake up from pushing every later frame back with it
+internal void linux_WaitUntil(uint64 Deadline, uint64 SpinNS)
+{
+    if(Deadline > SpinNS)
+    {
+        uint64 WakeClock = Deadline - SpinNS;
+
+        if(linux_GetWallClock() < WakeClock)
+        {
+            timespec WakeTime;
+            WakeTime.tv_sec = (time_t) (WakeClock / 1000000000ull);
+            WakeTime.tv_nsec = (long) (WakeClock % 1000000000ull);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &WakeTime, 0);
+        }
+    }
+
+    while(linux_GetWallClock() < Deadline)
+    {
+        _mm_pause();
+    }
+}
+
+//rdtsc against the monotonic clock, only needed to put trace timestamps in microseconds
+internal float64 linux_GetMicrosecondsPerCycle(void)
+{
+    uint64 StartCounter = linux_GetWallClock();
+    uint64 StartCycleCount = __rdtsc();
+
+    linux_WaitUntil(StartCounter + 20000000ull, 0);
+
+    uint64 EndCycleCount = __rdtsc();
+    uint64 EndCounter = linux_GetWallClock();
+
+    return ((float64) (EndCounter - StartCounter) / 1000.0) / (float64) (EndCycleCount - StartCycleCount);
+}
+
+//mmap whole pages, same role as VirtualAlloc with MEM_RESERVE | MEM_COMMIT
+internal void *linux_AllocateMemory(size_t Size)
+{
+    void *Result = mmap(0, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(Result == MAP_FAILED)
+    {
+        Result = 0;
+    }
+
+    return Result;
+}
+
+internal void linux_FreeMemory(void *Memory, size_t Size)
+{
+    if(Memory)
+    {
+        munmap(Memory, Size);
+    }
+}
+
+//Modification time in nanoseconds, 0 when the file doesn't exist
+internal uint64 linux_GetLastWriteTime(char *Path)
+{
+    struct stat FileStat;
+    uint64 Result = 0;
+
+    if(stat(Path, &FileStat) == 0)
+    {
+        Result = ((uint64) FileStat.st_mtim.tv_sec * 1000000000ull) + (uint64) FileStat.st_mtim.tv_nsec;
+    }
+
+    return Result;
+}
+
+//build.sh writes the library under a temporary name and renames it, so a changed timestamp always means a complete file
+internal LINUX_GAME_CODE linux_LoadGameCode(char *Path)
+{
+    LINUX_GAME_CODE Result = {};
+    Result.LastWriteTime = linux_GetLastWriteTime(Path);
+    Result.Library = dlopen(Path, RTLD_NOW | RTLD_LOCAL);
+
+    if(Result.Library)
+    {
+        Result.UpdateAndRender = (handmade_game_update_render *) dlsym(Result.Library, "handmade_GameUpdate_Render");
+        Result.GetSoundSamples = (handmade_game_get_sound_samples *) dlsym(Result.Library, "handmade_GetSoundSamples");
+        Result.IsValid = (Result.UpdateAndRender && Result.GetSoundSamples);
+    }
+
+    if(!Result.IsValid)
+    {
+        Result.UpdateAndRender = 0;
+        Result.GetSoundSamples = 0;
+    }
+
+    return Result;
+}
+
+internal void linux_UnloadGameCode(LINUX_GAME_CODE *GameCode)
+{
+    if(GameCode->Library)
+    {
+        dlclose(GameCode->Library);
+    }
+
+    *GameCode = {};
+}
+
+//Call between frames, the old library is closed before the new one opens so dlopen can't hand back the cached copy
+//Background work still queued points at the old library's code, so it has to finish first
+//LogWriter may be 0 when nothing is logging
+internal bool32 linux_ReloadGameCodeIfChanged(LINUX_GAME_CODE *GameCode, char *Path, HANDMADE_MEMORY *Memory, HANDMADE_WORK_QUEUE *BackgroundQueue, DEBUG_LOG_WRITER *LogWriter)
+{
+    uint64 WriteTime = linux_GetLastWriteTime(Path);
+
+    if(!WriteTime || (WriteTime == GameCode->LastWriteTime))
+    {
+        return false;
+    }
+
+    if(BackgroundQueue)
+    {
+        jobs_CompleteAllWork(BackgroundQueue);
+    }
+
+    //Records still queued point at format strings in the old library
+    if(LogWriter)
+    {
+        debug_FlushLog(LogWriter);
+    }
+
+    linux_UnloadGameCode(GameCode);
+    *GameCode = linux_LoadGameCode(Path);
+    Memory->ExecutableReloaded = true;
+
+    return true;
+}
+
+//FileName in the directory the executable was started from
+internal void linux_GetExecutableSiblingPath(char *Path, size_t PathSize, const char *SiblingName)
+{
+    ssize_t Length = readlink("/proc/self/exe", Path, PathSize - 1);
+    if(Length < 0)
+    {
+        Length = 0;
+    }
+    Path[Length] = 0;
+
+    char *LastSlash = strrchr(Path, '/');
+    char *FileName = LastSlash ? (LastSlash + 1) : Path;
+
+    snprintf(FileName, PathSize - (size_t) (FileName - Path), "%s", SiblingName);
+}
+
+//libhandmade.so sits next to the executable
+internal void linux_GetGameLibraryPath(char *Path, size_t PathSize)
+{
+    linux_GetExecutableSiblingPath(Path, PathSize, "libhandmade.so");
+}
+
+//Read only and lazily paged, only the pages something touches ever become resident
+internal void *linux_MapFile(char *Path, uint64 *Size)
+{
+    *Size = 0;
+
+    int File = open(Path, O_RDONLY);
+    if(File < 0)
+    {
+        return 0;
+    }
+
+    struct stat FileStat;
+    void *Result = 0;
+
+    if((fstat(File, &FileStat) == 0) && (FileStat.st_size > 0))
+    {
+        Result = mmap(0, (size_t) FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+
+        if(Result == MAP_FAILED)
+        {
+            Result = 0;
+        }
+        else
+        {
+            *Size = (uint64) FileStat.st_size;
+        }
+    }
+
+    close(File);
+    return Result;
+}
+
+//Same base every run so pointers stored in game memory stay valid across snapshots
+#define LINUX_GAME_MEMORY_BASE ((void *) Terabytes(2))
+#define LINUX_HUGE_PAGE_SIZE Megabytes(2)
+
+//One mapping for all game memory, explicit huge pages if the system has any reserved, else ask for transparent ones
+internal bool32 linux_AllocateGameMemory(LINUX_GAME_MEMORY *GameMemory, size_t Size)
+{
+    Size = (Size + LINUX_HUGE_PAGE_SIZE - 1) & ~((size_t) LINUX_HUGE_PAGE_SIZE - 1);
+
+    int Flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_FIXED_NOREPLACE)
+    Flags |= MAP_FIXED_NOREPLACE;
+#endif
+
+    //No MAP_NORESERVE here, the mapping must fail up front if the huge page pool can't hold it rather than fault later
+    bool32 HugePages = true;
+    void *Base = mmap(LINUX_GAME_MEMORY_BASE, Size, PROT_READ | PROT_WRITE, Flags | MAP_HUGETLB, -1, 0);
+
+    if(Base == MAP_FAILED)
+    {
+        HugePages = false;
+        Base = mmap(LINUX_GAME_MEMORY_BASE, Size, PROT_READ | PROT_WRITE, Flags | MAP_NORESERVE, -1, 0);
+    }
+
+    //Address taken, the block still works but snapshots from another run won't line up
+    if(Base == MAP_FAILED)
+    {
+        Base = mmap(0, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    }
+
+    if(Base == MAP_FAILED)
+    {
+        return false;
+    }
+
+    if(!HugePages)
+    {
+        madvise(Base, Size, MADV_HUGEPAGE);
+    }
+
+    GameMemory->Base = Base;
+    GameMemory->Size = Size;
+    GameMemory->AtFixedBase = (Base == LINUX_GAME_MEMORY_BASE);
+    GameMemory->HugePages = HugePages;
+
+    return true;
+}
+
+internal void linux_ResizeOffscreenBuffer(LINUX_OFFSCREEN_BUFFER *Buffer, int Width, int Height, HANDMADE_PIXEL_FORMAT Format)
+{
+    if(Buffer->BitmapMemory)
+    {
+        linux_FreeMemory(Buffer->BitmapMemory, Buffer->BitmapMemory_Size);
+    }
+
+    Buffer->BitmapWidth = Width;
+    Buffer->BitmapHeight = Height;
+    Buffer->Format = Format;
+    int BytesPerPixel = PixelFormatBytes[Format];
+
+    Buffer->BitmapMemory_Size = (Buffer->BitmapWidth * Buffer->BitmapHeight) * BytesPerPixel;
+    Buffer->BitmapMemory = linux_AllocateMemory(Buffer->BitmapMemory_Size);
+
+    Buffer->Pitch = Buffer->BitmapWidth * BytesPerPixel;
+}
+
+internal HANDMADE_OFFSCREEN_BUFFER linux_GetGameBuffer(LINUX_OFFSCREEN_BUFFER *Buffer)
+{
+    HANDMADE_OFFSCREEN_BUFFER Result = {};
+    Result.BitmapMemory = Buffer->BitmapMemory;
+    Result.BitmapWidth = Buffer->BitmapWidth;
+    Result.BitmapHeight = Buffer->BitmapHeight;
+    Result.Pitch = Buffer->Pitch;
+    Result.Format = Buffer->Format;
+
+    return Result;
+}
+
+//No window to blit to, so presenting copies into a front buffer standing in for the window's surface
+//Only the dirty rectangles are copied when the game reported them, and upscaled on the way when Scaler is set
+//A back buffer in another format is widened to BGRX8888 here, through Converted first when it is also upscaled
+//Returns the bytes written to the front buffer
+internal uint64 linux_DisplayBuffer(LINUX_OFFSCREEN_BUFFER *Front, LINUX_OFFSCREEN_BUFFER *Back, LINUX_OFFSCREEN_BUFFER *Converted,
+                                    HANDMADE_DIRTY_RECTS *Dirty, SCALE_CONTEXT *Scaler)
+{
+    HANDMADE_RECT Whole = {0, 0, Back->BitmapWidth, Back->BitmapHeight};
+    HANDMADE_RECT *Rects = Dirty ? Dirty->Rects : &Whole;
+    int RectCount = Dirty ? Dirty->RectCount : 1;
+    int BytesPerPixel = 4;
+    uint64 Bytes = 0;
+
+    HANDMADE_OFFSCREEN_BUFFER Source = linux_GetGameBuffer(Back);
+    HANDMADE_OFFSCREEN_BUFFER Dest = linux_GetGameBuffer(Front);
+
+    if(Scaler)
+    {
+        HANDMADE_OFFSCREEN_BUFFER Widened = (Back->Format == HANDMADE_PIXEL_FORMAT_BGRX8888) ? Source : linux_GetGameBuffer(Converted);
+
+        for(int RectIndex = 0; RectIndex < RectCount; ++RectIndex)
+        {
+            if(Back->Format != HANDMADE_PIXEL_FORMAT_BGRX8888)
+            {
+                pixel_ConvertRect(&Widened, &Source, Rects[RectIndex]);
+            }
+
+            HANDMADE_RECT Written = scale_Upscale(Scaler, &Widened, &Dest, Dirty ? &Rects[RectIndex] : 0);
+            Bytes += (uint64) (Written.MaxX - Written.MinX) * (uint64) (Written.MaxY - Written.MinY) * BytesPerPixel;
+        }
+
+        return Bytes;
+    }
+
+    if(Back->Format != HANDMADE_PIXEL_FORMAT_BGRX8888)
+    {
+        for(int RectIndex = 0; RectIndex < RectCount; ++RectIndex)
+        {
+            Bytes += pixel_ConvertRect(&Dest, &Source, Rects[RectIndex]);
+        }
+
+        return Bytes;
+    }
+
+    for(int RectIndex = 0; RectIndex < RectCount; ++RectIndex)
+    {
+        HANDMADE_RECT Rect = Rects[RectIndex];
+        size_t RowSize = (size_t) (Rect.MaxX - Rect.MinX) * BytesPerPixel;
+
+        uint8 *Source = (uint8 *) Back->BitmapMemory + (Rect.MinY * Back->Pitch) + (Rect.MinX * BytesPerPixel);
+        uint8 *Dest = (uint8 *) Front->BitmapMemory + (Rect.MinY * Front->Pitch) + (Rect.MinX * BytesPerPixel);
+
+        for(int Y = Rect.MinY; Y < Rect.MaxY; ++Y)
+        {
+            memcpy(Dest, Source, RowSize);
+            Source += Back->Pitch;
+            Dest += Front->Pitch;
+        }
+
+        Bytes += (uint64) RowSize * (uint64) (Rect.MaxY - Rect.MinY);
+    }
+
+    return Bytes;
+}
+
+//FNV-1a over the visible pixels, equal runs with and without dirty tracking must end on the same picture
+internal uint64 linux_HashBuffer(LINUX_OFFSCREEN_BUFFER *Buffer)
+{
+    uint64 Hash = 14695981039346656037ull;
+
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        uint8 *Row = (uint8 *) Buffer->BitmapMemory + (Y * Buffer->Pitch);
+
+        for(int ByteIndex = 0; ByteIndex < Buffer->BitmapWidth * 4; ++ByteIndex)
+        {
+            Hash ^= Row[ByteIndex];
+            Hash *= 1099511628211ull;
+        }
+    }
+
+    return Hash;
+}
+
+//Binary PPM, the simplest format every image viewer opens
+internal bool32 linux_DumpBuffer(LINUX_OFFSCREEN_BUFFER *Buffer, char *Path)
+{
+    FILE *File = fopen(Path, "wb");
+    if(!File)
+    {
+        return false;
+    }
+
+    fprintf(File, "P6\n%d %d\n255\n", Buffer->BitmapWidth, Buffer->BitmapHeight);
+
+    uint8 *Row = (uint8 *) linux_AllocateMemory((size_t) Buffer->BitmapWidth * 3);
+
+    for(int Y = 0; Y < Buffer->BitmapHeight; ++Y)
+    {
+        uint32 *Pixel = (uint32 *) ((uint8 *) Buffer->BitmapMemory + (Y * Buffer->Pitch));
+
+        for(int X = 0; X < Buffer->BitmapWidth; ++X)
+        {
+            Row[(X * 3) + 0] = (uint8) (Pixel[X] >> 16);
+            Row[(X * 3) + 1] = (uint8) (Pixel[X] >> 8);
+            Row[(X * 3) + 2] = (uint8) Pixel[X];
+        }
+
+        fwrite(Row, 3, (size_t) Buffer->BitmapWidth, File);
+    }
+
+    linux_FreeMemory(Row, (size_t) Buffer->BitmapWidth * 3);
+
+    return (fclose(File) == 0);
+}
+
+internal JOBS_SIGNAL_SEMAPHORE(linux_SignalSemaphore)
+{
+    for(int SignalIndex = 0; SignalIndex < Count; ++SignalIndex)
+    {
+        sem_post((sem_t *) SemaphoreHandle);
+    }
+}
+
+internal JOBS_WAIT_SEMAPHORE(linux_WaitSemaphore)
+{
+    while(sem_wait((sem_t *) SemaphoreHandle) != 0)
+    {
+        //Interrupted by a signal, go back to sleep
+    }
+}
+
+struct LINUX_WORKER_INFO
+{
+    HANDMADE_WORK_QUEUE *Queue;
+    int ThreadIndex;
+};
+
+internal void *linux_WorkerThreadProc(void *Parameter)
+{
+    LINUX_WORKER_INFO *Info = (LINUX_WORKER_INFO *) Parameter;
+    jobs_WorkerLoop(Info->Queue, Info->ThreadIndex);
+
+    return 0;
+}
+
+//Workers live for the whole process, the calling thread becomes thread 0 and helps whenever it waits on the queue
+//Each queue gets its own semaphore and worker table, so a process can run several
+internal bool32 linux_MakeQueue(HANDMADE_WORK_QUEUE *Queue, int WorkerCount)
+{
+    int ThreadCount = WorkerCount + 1;
+    if(ThreadCount > JOBS_MAX_THREADS)
+    {
+        ThreadCount = JOBS_MAX_THREADS;
+    }
+
+    JOBS_DEQUE *Deques = (JOBS_DEQUE *) linux_AllocateMemory(jobs_GetDequeMemorySize(ThreadCount));
+    sem_t *Semaphore = (sem_t *) linux_AllocateMemory(sizeof(sem_t));
+    LINUX_WORKER_INFO *WorkerInfo = (LINUX_WORKER_INFO *) linux_AllocateMemory(sizeof(LINUX_WORKER_INFO) * (size_t) ThreadCount);
+
+    if(!Deques || !Semaphore || !WorkerInfo || (sem_init(Semaphore, 0, 0) != 0))
+    {
+        return false;
+    }
+
+    jobs_InitQueue(Queue, ThreadCount, Deques, Semaphore, linux_SignalSemaphore, linux_WaitSemaphore);
+
+    for(int ThreadIndex = 1; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        LINUX_WORKER_INFO *Info = &WorkerInfo[ThreadIndex];
+        Info->Queue = Queue;
+        Info->ThreadIndex = ThreadIndex;
+
+        pthread_t Thread;
+        if(pthread_create(&Thread, 0, linux_WorkerThreadProc, Info) != 0)
+        {
+            return false;
+        }
+
+        pthread_detach(Thread);
+    }
+
+    return true;
+}
+
+//Period the simulated device pulls, similar to a small ALSA period
+#define LINUX_AUDIO_PERIOD_FRAMES 256
+
+//Uniform lateness in [0, JitterNS] from a xorshift state, for the -jitter options
+internal uint64 linux_GetJitter(uint32 *RandomState, uint64 JitterNS)
+{
+    if(!JitterNS)
+    {
+        return 0;
+    }
+
+    uint32 Random = *RandomState;
+    Random ^= Random << 13;
+    Random ^= Random >> 17;
+    Random ^= Random << 5;
+    *RandomState = Random;
+
+    return ((uint64) Random * (JitterNS + 1)) >> 32;
+}
+
+//Audio thread: sleeps to each period deadline then reads every period that is due, so a late wake catches up like real hardware would
+internal void *linux_AudioThreadProc(void *Parameter)
+{
+    LINUX_AUDIO_DEVICE *Device = (LINUX_AUDIO_DEVICE *) Parameter;
+
+    uint64 PeriodNS = ((uint64) Device->PeriodFrames * 1000000000ull) / (uint64) Device->SampleRate;
+    uint64 NextWake = Device->StartClock + PeriodNS;
+
+    while(Device->Running)
+    {
+        uint64 Wake = NextWake + linux_GetJitter(&Device->RandomState, Device->WakeJitterNS);
+
+        timespec WakeTime;
+        WakeTime.tv_sec = (time_t) (Wake / 1000000000ull);
+        WakeTime.tv_nsec = (long) (Wake % 1000000000ull);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &WakeTime, 0);
+
+        uint64 Elapsed = linux_GetWallClock() - Device->StartClock;
+        int64 DeviceFrame = (int64) ((Elapsed * (uint64) Device->SampleRate) / 1000000000ull);
+
+        while(Device->FramesPlayed + Device->PeriodFrames <= DeviceFrame)
+        {
+            audio_ReadFrames(Device->Ring, Device->PeriodSamples, Device->PeriodFrames);
+            Device->FramesPlayed += Device->PeriodFrames;
+
+            if(Device->Sink)
+            {
+                fwrite(Device->PeriodSamples, sizeof(int16) * AUDIO_CHANNEL_COUNT, Device->PeriodFrames, Device->Sink);
+            }
+        }
+
+        NextWake += PeriodNS;
+    }
+
+    return 0;
+}
+
+internal bool32 linux_StartAudioDevice(LINUX_AUDIO_DEVICE *Device, AUDIO_RING_BUFFER *Ring, int SampleRate, uint64 WakeJitterNS, char *OutputPath)
+{
+    Device->Ring = Ring;
+    Device->SampleRate = SampleRate;
+    Device->WakeJitterNS = WakeJitterNS;
+    Device->RandomState = 0x9E3779B9;
+    Device->PeriodFrames = LINUX_AUDIO_PERIOD_FRAMES;
+    Device->PeriodSamples = (int16 *) linux_AllocateMemory(LINUX_AUDIO_PERIOD_FRAMES * sizeof(int16) * AUDIO_CHANNEL_COUNT);
+    Device->Sink = 0;
+    Device->FramesPlayed = 0;
+    Device->Running = true;
+
+    if(OutputPath)
+    {
+        Device->Sink = fopen(OutputPath, "wb");
+    }
+
+    if(!Device->PeriodSamples || (OutputPath && !Device->Sink))
+    {
+        return false;
+    }
+
+    Device->StartClock = linux_GetWallClock();
+
+    return pthread_create(&Device->Thread, 0, linux_AudioThreadProc, Device) == 0;
+}
+
+internal void linux_StopAudioDevice(LINUX_AUDIO_DEVICE *Device)
+{
+    Device->Running = false;
+    pthread_join(Device->Thread, 0);
+
+    if(Device->Sink)
+    {
+        fclose(Device->Sink);
+    }
+
+    linux_FreeMemory(Device->PeriodSamples, LINUX_AUDIO_PERIOD_FRAMES * sizeof(int16) * AUDIO_CHANNEL_COUNT);
+}
+
+internal void *linux_CaptureThreadProc(void *Parameter)
+{
+    capture_WriterLoop((CAPTURE_QUEUE *) Parameter);
+
+    return 0;
+}
+
+//Errors and warnings to stderr, the rest to stdout with the other -v output
+internal DEBUG_LOG_WRITE(linux_WriteLog)
+{
+    (void) Context;
+    fwrite(Text, 1, (size_t) Length, (Level <= DEBUG_LOG_WARNING) ? stderr : stdout);
+}
+
+internal void *linux_LogThreadProc(void *Parameter)
+{
+    debug_LogWriterLoop((DEBUG_LOG_WRITER *) Parameter);
+
+    return 0;
+}
+
+//Points GlobalDebugLog at fresh rings, records are handed to Write on the new thread
+internal bool32 linux_StartLog(LINUX_LOG_THREAD *LogThread, debug_log_write *Write, void *WriteContext)
+{
+    *LogThread = {};
+    LogThread->Log = (DEBUG_LOG *) linux_AllocateMemory(sizeof(DEBUG_LOG));
+    if(!LogThread->Log)
+    {
+        return false;
+    }
+
+    if(sem_init(&LogThread->Semaphore, 0, 0) != 0)
+    {
+        linux_FreeMemory(LogThread->Log, sizeof(DEBUG_LOG));
+        return false;
+    }
+
+    debug_BeginLog(&LogThread->Writer, LogThread->Log, linux_GetMicrosecondsPerCycle(), Write, WriteContext, &LogThread->Semaphore, linux_SignalSemaphore, linux_WaitSemaphore);
+
+    if(pthread_create(&LogThread->Thread, 0, linux_LogThreadProc, &LogThread->Writer) != 0)
+    {
+        sem_destroy(&LogThread->Semaphore);
+        linux_FreeMemory(LogThread->Log, sizeof(DEBUG_LOG));
+        return false;
+    }
+
+    GlobalDebugLog = LogThread->Log;
+
+    return true;
+}
+
+//Writes out everything still queued, then logging drops records until the next start
+internal void linux_StopLog(LINUX_LOG_THREAD *LogThread)
+{
+    GlobalDebugLog = 0;
+    debug_EndLog(&LogThread->Writer);
+    pthread_join(LogThread->Thread, 0);
+    sem_destroy(&LogThread->Semaphore);
+
+    LogThread->DroppedCount = debug_GetLogDroppedCount(LogThread->Log);
+    linux_FreeMemory(LogThread->Log, sizeof(DEBUG_LOG));
+    LogThread->Log = 0;
+}
+
+//FNV-1a over 64 bit words, only has to tell two passes apart
+internal uint64 linux_HashMemory(void *Memory, uint64 Size)
+{
+    uint64 *Word = (uint64 *) Memory;
+    uint64 Hash = 0xCBF29CE484222325ull;
+
+    for(uint64 WordIndex = 0; WordIndex < Size / sizeof(uint64); ++WordIndex)
+    {
+        Hash ^= Word[WordIndex];
+        Hash *= 0x100000001B3ull;
+    }
+
+    return Hash;
+}
+
+internal bool32 linux_BeginRecording(LINUX_REPLAY *Replay, char *Path, HANDMADE_MEMORY *Memory, int SampleRate)
+{
+    Replay->RecordFile = fopen(Path, "wb");
+    Replay->RecordedFrameCount = 0;
+
+    if(!Replay->RecordFile)
+    {
+        return false;
+    }
+
+    REPLAY_HEADER Header;
+    replay_InitHeader(&Header, Memory, SampleRate);
+
+    bool32 Written = (fwrite(&Header, sizeof(Header), 1, Replay->RecordFile) == 1) &&
+                     (fwrite(Memory->PermanentStorage, (size_t) Memory->PermanentStorageSize, 1, Replay->RecordFile) == 1);
+
+    return Written;
+}
+
+internal void linux_RecordFrame(LINUX_REPLAY *Replay, HANDMADE_INPUT_USER *Input, int SoundSampleCount)
+{
+    REPLAY_FRAME Frame = {};
+    Frame.Input = *Input;
+    Frame.SoundSampleCount = SoundSampleCount;
+
+    fwrite(&Frame, sizeof(Frame), 1, Replay->RecordFile);
+    ++Replay->RecordedFrameCount;
+}
+
+internal void linux_EndRecording(LINUX_REPLAY *Replay)
+{
+    fclose(Replay->RecordFile);
+    Replay->RecordFile = 0;
+}
+
+//Puts game memory back to the snapshot and starts the next pass
+internal void linux_RestartPlayback(LINUX_REPLAY *Replay, HANDMADE_MEMORY *Memory)
+{
+    if(Replay->BackgroundQueue)
+    {
+        jobs_CompleteAllWork(Replay->BackgroundQueue);
+    }
+
+    memcpy(Memory->PermanentStorage, Replay->Snapshot, (size_t) Memory->PermanentStorageSize);
+    Memory->IsInitialised = Replay->Header->IsInitialised;
+    Replay->FrameIndex = 0;
+}
+
+internal bool32 linux_BeginPlayback(LINUX_REPLAY *Replay, char *Path, HANDMADE_MEMORY *Memory)
+{
+    int File = open(Path, O_RDONLY);
+    if(File < 0)
+    {
+        fprintf(stderr, "Can't open recording %s\n", Path);
+        return false;
+    }
+
+    struct stat FileStat;
+    fstat(File, &FileStat);
+
+    Replay->MappingSize = (size_t) FileStat.st_size;
+    Replay->Mapping = mmap(0, Replay->MappingSize, PROT_READ, MAP_PRIVATE | MAP_POPULATE, File, 0);
+    close(File);
+
+    if((Replay->Mapping == MAP_FAILED) || (Replay->MappingSize < sizeof(REPLAY_HEADER)))
+    {
+        fprintf(stderr, "Can't read recording %s\n", Path);
+        return false;
+    }
+
+    Replay->Header = (REPLAY_HEADER *) Replay->Mapping;
+
+    if(!replay_CheckHeader(Replay->Header, Memory))
+    {
+        fprintf(stderr, "%s was recorded by a different build or with game memory at another address\n", Path);
+        return false;
+    }
+
+    size_t FramesOffset = sizeof(REPLAY_HEADER) + (size_t) Memory->PermanentStorageSize;
+    Replay->Snapshot = (uint8 *) Replay->Mapping + sizeof(REPLAY_HEADER);
+    Replay->Frames = (REPLAY_FRAME *) ((uint8 *) Replay->Mapping + FramesOffset);
+    Replay->FrameCount = (Replay->MappingSize > FramesOffset) ? (int) ((Replay->MappingSize - FramesOffset) / sizeof(REPLAY_FRAME)) : 0;
+
+    if(Replay->FrameCount == 0)
+    {
+        fprintf(stderr, "%s has no frames\n", Path);
+        return false;
+    }
+
+    linux_RestartPlayback(Replay, Memory);
+
+    return true;
+}
+
+//Called before each frame, wraps to the snapshot at the end of the recording
+internal REPLAY_FRAME *linux_PlaybackFrame(LINUX_REPLAY *Replay, HANDMADE_MEMORY *Memory)
+{
+    if(Replay->FrameIndex == Replay->FrameCount)
+    {
+        uint64 Checksum = linux_HashMemory(Memory->PermanentStorage, Memory->PermanentStorageSize);
+
+        if(Replay->PassCount == 0)
+        {
+            Replay->FirstPassChecksum = Checksum;
+        }
+        else if(Checksum != Replay->FirstPassChecksum)
+        {
+            Replay->Diverged = true;
+        }
+
+        ++Replay->PassCount;
+        linux_RestartPlayback(Replay, Memory);
+    }
+
+    return &Replay->Frames[Replay->FrameIndex++];
+}
+
+//Scripted stand-in for a gamepad, the first controller after the keyboard
+#define LINUX_SCRIPTED_CONTROLLER (HANDMADE_INPUT_KEYBOARD + 1)
+
+internal void linux_ScriptButton(LINUX_SCRIPTED_INPUT *Script, HANDMADE_INPUT_CONTROLLER *OldController, uint32 ButtonIndex, bool32 IsDown, uint64 Timestamp)
+{
+    if((OldController->Buttons[ButtonIndex].EndedDown != 0) != (IsDown != 0))
+    {
+        input_PushEvent(&Script->Ring, Timestamp, LINUX_SCRIPTED_CONTROLLER, ButtonIndex, IsDown);
+    }
+}
+
+//Each button is held on its own cadence so every input path gets hit, changes land at the start of the frame
+//Every 90 frames Right is also tapped and released within one frame, which polling once a frame would never see
+internal void linux_ScriptInput(LINUX_SCRIPTED_INPUT *Script, int FrameIndex, HANDMADE_INPUT_USER *OldInput, HANDMADE_INPUT_USER *NewInput)
+{
+    HANDMADE_INPUT_CONTROLLER *OldController = &OldInput->Controllers[LINUX_SCRIPTED_CONTROLLER];
+    uint64 WindowStart = (uint64) FrameIndex * Script->FrameTicks;
+
+    linux_ScriptButton(Script, OldController, HANDMADE_INPUT_BUTTON_DOWN, ((FrameIndex / 30) % 2) == 0, WindowStart);
+    linux_ScriptButton(Script, OldController, HANDMADE_INPUT_BUTTON_RIGHT, ((FrameIndex / 45) % 2) == 0, WindowStart);
+    linux_ScriptButton(Script, OldController, HANDMADE_INPUT_BUTTON_LEFT, ((FrameIndex / 60) % 2) == 0, WindowStart);
+    linux_ScriptButton(Script, OldController, HANDMADE_INPUT_BUTTON_UP, ((FrameIndex / 90) % 2) == 0, WindowStart);
+    linux_ScriptButton(Script, OldController, HANDMADE_INPUT_BUTTON_LEFT_SHOULDER, (FrameIndex % 120) < 10, WindowStart);
+    linux_ScriptButton(Script, OldController, HANDMADE_INPUT_BUTTON_RIGHT_SHOULDER, (FrameIndex % 120) >= 110, WindowStart);
+
+    //Right is always up here
+    if((FrameIndex % 90) == 60)
+    {
+        input_PushEvent(&Script->Ring, WindowStart + (Script->FrameTicks / 4), LINUX_SCRIPTED_CONTROLLER, HANDMADE_INPUT_BUTTON_RIGHT, true);
+        input_PushEvent(&Script->Ring, WindowStart + (Script->FrameTicks / 2), LINUX_SCRIPTED_CONTROLLER, HANDMADE_INPUT_BUTTON_RIGHT, false);
+    }
+
+    INPUT_EVENT_RING *Rings[] = {&Script->Ring};
+    input_GatherFrame(Rings, ArrayCount(Rings), WindowStart, WindowStart + Script->FrameTicks, 1.0e-9, OldInput, NewInput, &Script->Stats);
+}
+
+internal void linux_PrintUsage(char *ProgramName)
+{
+    fprintf(stderr, "Usage: %s [-w width] [-h height] [-f frames] [-r samplerate] [-dr devicerate] [-rq low|medium|high|best] [-u updatehz] [-k auto|scalar|sse2|avx2]\n"
+                    "\t[-t workers] [-tw tilewidth] [-th tileheight] [-m game|tiles|jobstress|jobbench|oscbench|mixbench|audio|replay|logbench|latency] [-v]\n"
+                    "\t[-l latencyms] [-s stallms] [-adapt] [-jitter us] [-o audiofile] [-rec recording] [-i recording] [-lock] [-spin us] [-trace json]\n"
+                    "\t[-a pack] [-full] [-half] [-filter nearest|bilinear] [-format bgrx8888|rgb565|indexed8]\n"
+                    "\t[-dump frame.ppm] [-capture video.y4m] [-slots count]\n"
+                    "\t-t 0 renders on the main thread without tiling\n"
+                    "\t-m tiles compares single thread against tiled rendering, jobstress/jobbench run -f rounds of the job system\n"
+                    "\t-m oscbench renders -f seconds of audio per oscillator count and kernel\n"
+                    "\t-m mixbench mixes -f frames of audio per voice count and kernel\n"
+                    "\t-m logbench times -f rounds of worker logging through fprintf and the asynchronous log\n"
+                    "\t-m audio runs -f frames in real time against a simulated device -l ms ahead, stalling -s ms once a second\n"
+                    "\t-adapt sizes the audio mode write-ahead from measured frame times and device bursts, -l is then its ceiling\n"
+                    "\t-jitter makes every audio or latency mode game frame and device wake up to that much late\n"
+                    "\t-dr runs the audio mode device at another rate, within 8x of -r, the game's mix is resampled to it at -rq (high)\n"
+                    "\t-m latency simulates -f frames of fixed and adaptive write-ahead against the same jitter and stalls, without waiting\n"
+                    "\t-m latency then checks adaptive latency returns to its calm level after one early stall, exiting 1 if not\n"
+                    "\t-o writes what the device played as raw 16 bit stereo\n"
+                    "\t-rec records game mode input, -m replay -i plays a recording back for -f frames as fast as possible, looping\n"
+                    "\t-lock paces game and replay modes to -u Hz, sleeping until -spin us before each deadline then busy-waiting\n"
+                    "\t-trace writes every timed block of a game or replay run as a Chrome trace\n"
+                    "\t-a maps an asset pack built by handmade_packer, handmade.hha next to the executable is used if present\n"
+                    "\t-full presents and redraws the whole buffer every frame instead of only what changed\n"
+                    "\t-half renders at half of -w x -h and upscales to it with -filter, nearest by default\n"
+                    "\t-format is the back buffer the game renders into, widened to bgrx8888 when presenting\n"
+                    "\t-dump writes the last frame presented by a game or replay run\n"
+                    "\t-capture writes every frame presented by a game or replay run on a writer thread, dropping frames once -slots (4) are queued\n", ProgramName);
+}
+
+internal bool32 linux_ParseSettings(int ArgumentCount, char **Arguments, LINUX_SETTINGS *Settings)
+{
+    for(int ArgumentIndex = 1; ArgumentIndex < ArgumentCount; ++ArgumentIndex)
+    {
+        char *Argument = Arguments[ArgumentIndex];
+        char *Value = (ArgumentIndex + 1 < ArgumentCount) ? Arguments[ArgumentIndex + 1] : 0;
+
+        if(strcmp(Argument, "-v") == 0)
+        {
+            Settings->PrintFrames = true;
+            continue;
+        }
+
+        if(strcmp(Argument, "-lock") == 0)
+        {
+            Settings->LockFrameRate = true;
+            continue;
+        }
+
+        if(strcmp(Argument, "-full") == 0)
+        {
+            Settings->FullPresent = true;
+            continue;
+        }
+
+        if(strcmp(Argument, "-half") == 0)
+        {
+            Settings->HalfResolution = true;
+            continue;
+        }
+
+        if(strcmp(Argument, "-adapt") == 0)
+        {
+            Settings->AdaptiveLatency = true;
+            continue;
+        }
+
+        if(!Value)
+        {
+            return false;
+        }
+
+        if(strcmp(Argument, "-w") == 0)
+        {
+            Settings->Width = atoi(Value);
+        }
+        else if(strcmp(Argument, "-h") == 0)
+        {
+            Settings->Height = atoi(Value);
+        }
+        else if(strcmp(Argument, "-f") == 0)
+        {
+            Settings->FrameCount = atoi(Value);
+        }
+        else if(strcmp(Argument, "-r") == 0)
+        {
+            Settings->SampleRate = atoi(Value);
+        }
+        else if(strcmp(Argument, "-dr") == 0)
+        {
+            Settings->DeviceSampleRate = atoi(Value);
+        }
+        else if(strcmp(Argument, "-rq") == 0)
+        {
+            Settings->ResampleQuality = RESAMPLE_QUALITY_COUNT;
+            for(int QualityIndex = 0; QualityIndex < RESAMPLE_QUALITY_COUNT; ++QualityIndex)
+            {
+                if(strcmp(Value, ResampleQualityNames[QualityIndex]) == 0)
+                {
+                    Settings->ResampleQuality = (RESAMPLE_QUALITY) QualityIndex;
+                }
+            }
+
+            if(Settings->ResampleQuality == RESAMPLE_QUALITY_COUNT)
+            {
+                return false;
+            }
+        }
+        else if(strcmp(Argument, "-u") == 0)
+        {
+            Settings->GameUpdateHz = atoi(Value);
+        }
+        else if(strcmp(Argument, "-t") == 0)
+        {
+            Settings->WorkerCount = atoi(Value);
+        }
+        else if(strcmp(Argument, "-tw") == 0)
+        {
+            Settings->TileWidth = atoi(Value);
+        }
+        else if(strcmp(Argument, "-th") == 0)
+        {
+            Settings->TileHeight = atoi(Value);
+        }
+        else if(strcmp(Argument, "-l") == 0)
+        {
+            Settings->AudioLatencyMS = atoi(Value);
+        }
+        else if(strcmp(Argument, "-s") == 0)
+        {
+            Settings->StallMS = atoi(Value);
+        }
+        else if(strcmp(Argument, "-jitter") == 0)
+        {
+            Settings->JitterUS = atoi(Value);
+        }
+        else if(strcmp(Argument, "-o") == 0)
+        {
+            Settings->AudioOutputPath = Value;
+        }
+        else if(strcmp(Argument, "-spin") == 0)
+        {
+            Settings->SpinUS = atoi(Value);
+        }
+        else if(strcmp(Argument, "-trace") == 0)
+        {
+            Settings->TracePath = Value;
+        }
+        else if(strcmp(Argument, "-rec") == 0)
+        {
+            Settings->RecordPath = Value;
+        }
+        else if(strcmp(Argument, "-i") == 0)
+        {
+            Settings->ReplayPath = Value;
+        }
+        else if(strcmp(Argument, "-a") == 0)
+        {
+            Settings->AssetPath = Value;
+        }
+        else if(strcmp(Argument, "-dump") == 0)
+        {
+            Settings->DumpPath = Value;
+        }
+        else if(strcmp(Argument, "-capture") == 0)
+        {
+            Settings->CapturePath = Value;
+        }
+        else if(strcmp(Argument, "-slots") == 0)
+        {
+            Settings->CaptureSlotCount = atoi(Value);
+        }
+        else if(strcmp(Argument, "-filter") == 0)
+        {
+            Settings->ScaleFilter = SCALE_FILTER_COUNT;
+            for(int FilterIndex = 0; FilterIndex < SCALE_FILTER_COUNT; ++FilterIndex)
+            {
+                if(strcmp(Value, ScaleFilterNames[FilterIndex]) == 0)
+                {
+                    Settings->ScaleFilter = (SCALE_FILTER) FilterIndex;
+                }
+            }
+
+            if(Settings->ScaleFilter == SCALE_FILTER_COUNT)
+            {
+                return false;
+            }
+        }
+        else if(strcmp(Argument, "-format") == 0)
+        {
+            Settings->PixelFormat = HANDMADE_PIXEL_FORMAT_COUNT;
+            for(int FormatIndex = 0; FormatIndex < HANDMADE_PIXEL_FORMAT_COUNT; ++FormatIndex)
+            {
+                if(strcmp(Value, PixelFormatNames[FormatIndex]) == 0)
+                {
+                    Settings->PixelFormat = (HANDMADE_PIXEL_FORMAT) FormatIndex;
+                }
+            }
+
+            if(Settings->PixelFormat == HANDMADE_PIXEL_FORMAT_COUNT)
+            {
+                return false;
+            }
+        }
+        else if(strcmp(Argument, "-m") == 0)
+        {
+            Settings->Mode = LINUX_RUN_MODE_COUNT;
+            for(int ModeIndex = 0; ModeIndex < LINUX_RUN_MODE_COUNT; ++ModeIndex)
+            {
+                if(strcmp(Value, LinuxRunModeNames[ModeIndex]) == 0)
+                {
+                    Settings->Mode = (LINUX_RUN_MODE) ModeIndex;
+                }
+            }
+
+            if(Settings->Mode == LINUX_RUN_MODE_COUNT)
+            {
+                return false;
+            }
+        }
+        else if(strcmp(Argument, "-k") == 0)
+        {
+            Settings->SimdLevel = SIMD_LEVEL_COUNT;
+            for(int LevelIndex = 0; LevelIndex < SIMD_LEVEL_COUNT; ++LevelIndex)
+            {
+                if(strcmp(Value, SimdLevelNames[LevelIndex]) == 0)
+                {
+                    Settings->SimdLevel = (SIMD_LEVEL) LevelIndex;
+                }
+            }
+
+            if(Settings->SimdLevel == SIMD_LEVEL_COUNT)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        ++ArgumentIndex;
+    }
+
+    int MinSize = Settings->HalfResolution ? 4 : 1;
+
+    if(Settings->DeviceSampleRate == 0)
+    {
+        Settings->DeviceSampleRate = Settings->SampleRate;
+    }
+
+    return (Settings->Width >= MinSize) && (Settings->Height >= MinSize) && (Settings->FrameCount > 0) && (Settings->SampleRate > 0) && (Settings->GameUpdateHz > 0) &&
+           (Settings->DeviceSampleRate > 0) && ((int64) Settings->DeviceSampleRate * RESAMPLE_MAX_RATIO >= Settings->SampleRate) &&
+           ((int64) Settings->SampleRate * RESAMPLE_MAX_RATIO >= Settings->DeviceSampleRate) &&
+           (Settings->WorkerCount >= 0) && (Settings->TileWidth > 0) && (Settings->TileHeight > 0) && (Settings->AudioLatencyMS > 0) && (Settings->StallMS >= 0) && (Settings->JitterUS >= 0) && (Settings->SpinUS >= 0) &&
+           (Settings->CaptureSlotCount > 0) && (Settings->CaptureSlotCount <= CAPTURE_MAX_SLOTS) && !(Settings->CaptureSlotCount & (Settings->CaptureSlotCount - 1)) &&
+           ((Settings->Mode != LINUX_RUN_MODE_REPLAY) || Settings->ReplayPath);
+}
+
+internal void linux_PrintFrameStats(LINUX_FRAME_STATS *Stats, float64 WallSeconds)
+{
+    if(Stats->FrameCount == 0)
+    {
+        return;
+    }
+
+    float64 AverageMS = Stats->TotalMS / (float64) Stats->FrameCount;
+    float64 AverageCycles = (float64) Stats->TotalCycles / (float64) Stats->FrameCount;
+    float64 GameSeconds = Stats->TotalMS / 1000.0;
+
+    printf("Frames:\t\t%d (%0.3f s wall)\n", Stats->FrameCount, WallSeconds);
+    printf("ms/frame:\t%0.4f avg\t %0.4f min\t %0.4f max\n", AverageMS, Stats->MinMS, Stats->MaxMS);
+    printf("cycles/frame:\t%0.0f avg\t %llu min\t %llu max\n", AverageCycles, (unsigned long long) Stats->MinCycles, (unsigned long long) Stats->MaxCycles);
+    printf("frames/sec:\t%0.2f\n", (float64) Stats->FrameCount / GameSeconds);
+    printf("pixels/sec:\t%0.2f M\n", ((float64) Stats->PixelCount / GameSeconds) / (1000.0 * 1000.0));
+    printf("samples/sec:\t%0.2f M\n", ((float64) Stats->SampleCount / GameSeconds) / (1000.0 * 1000.0));
+}
+
+//Render only, same frames through render_Gradient on this thread and through the tiled path on the queue
+internal void linux_RunTileBenchmark(LINUX_SETTINGS *Settings, HANDMADE_OFFSCREEN_BUFFER *Buffer, HANDMADE_PLATFORM *Platform, HANDMADE_MEMORY *Memory)
+{
+    //Game isn't running, so the tile entries borrow its transient storage
+    MEMORY_ARENA Arena;
+    memory_InitArena(&Arena, (size_t) Memory->TransientStorageSize, Memory->TransientStorage);
+
+    int WarmUpFrames = 16;
+    float64 PathMS[2] = {};
+
+    for(int PathIndex = 0; PathIndex < 2; ++PathIndex)
+    {
+        bool32 Tiled = (PathIndex == 1);
+
+        for(int FrameIndex = -WarmUpFrames; FrameIndex < Settings->FrameCount; ++FrameIndex)
+        {
+            uint64 LastCounter = linux_GetWallClock();
+
+            if(Tiled)
+            {
+                render_GradientTiled(Platform, &Arena, Buffer, FrameIndex, FrameIndex, 0);
+            }
+            else
+            {
+                render_Gradient(Buffer, FrameIndex, FrameIndex);
+            }
+
+            uint64 EndCounter = linux_GetWallClock();
+
+            if(FrameIndex >= 0)
+            {
+                PathMS[PathIndex] += (float64) (EndCounter - LastCounter) / (1000.0 * 1000.0);
+            }
+        }
+    }
+
+    float64 SingleMS = PathMS[0] / (float64) Settings->FrameCount;
+    float64 TiledMS = PathMS[1] / (float64) Settings->FrameCount;
+
+    printf("Tile benchmark:\t%dx%d, %d frames, %d workers + main, %dx%d tiles\n", Buffer->BitmapWidth, Buffer->BitmapHeight, Settings->FrameCount, Settings->WorkerCount, Platform->RenderTileWidth, Platform->RenderTileHeight);
+    printf("single thread:\t%0.4f ms/frame\n", SingleMS);
+    printf("tiled:\t\t%0.4f ms/frame\n", TiledMS);
+    printf("speedup:\t%0.2fx\n", SingleMS / TiledMS);
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(linux_JobTestNode)
+{
+    LINUX_JOB_TEST_NODE *Node = (LINUX_JOB_TEST_NODE *) Data;
+    LINUX_JOB_TEST *Test = Node->Test;
+
+    atomic_IncrementUInt32(&Test->Hits[Node->Index]);
+
+    //Uneven work per node so some deques drain early and have to steal
+    uint32 Spin = ((Node->Index * 2654435761u) >> 26) * Test->SpinScale;
+    for(uint32 SpinIndex = 0; SpinIndex < Spin; ++SpinIndex)
+    {
+        _mm_pause();
+    }
+
+    if(Test->FanOut > 0)
+    {
+        for(uint32 ChildIndex = 1; ChildIndex <= Test->FanOut; ++ChildIndex)
+        {
+            uint32 Child = (Node->Index * Test->FanOut) + ChildIndex;
+            if(Child < Test->NodeCount)
+            {
+                Test->Platform->AddWorkEntry(Queue, linux_JobTestNode, Node - Node->Index + Child);
+            }
+        }
+    }
+}
+
+//One pass over every node, nested from the root or flat from this thread, then check each ran exactly once
+internal bool32 linux_RunJobTestPass(LINUX_JOB_TEST *Test, LINUX_JOB_TEST_NODE *Nodes)
+{
+    HANDMADE_PLATFORM *Platform = Test->Platform;
+
+    for(uint32 NodeIndex = 0; NodeIndex < Test->NodeCount; ++NodeIndex)
+    {
+        Test->Hits[NodeIndex] = 0;
+    }
+
+    if(Test->FanOut > 0)
+    {
+        Platform->AddWorkEntry(Platform->JobQueue, linux_JobTestNode, &Nodes[0]);
+    }
+    else
+    {
+        for(uint32 NodeIndex = 0; NodeIndex < Test->NodeCount; ++NodeIndex)
+        {
+            Platform->AddWorkEntry(Platform->JobQueue, linux_JobTestNode, &Nodes[NodeIndex]);
+        }
+    }
+
+    Platform->CompleteAllWork(Platform->JobQueue);
+
+    bool32 Passed = (Platform->JobQueue->PendingCount == 0);
+
+    for(uint32 NodeIndex = 0; NodeIndex < Test->NodeCount; ++NodeIndex)
+    {
+        if(Test->Hits[NodeIndex] != 1)
+        {
+            Passed = false;
+        }
+    }
+
+    return Passed;
+}
+
+internal LINUX_JOB_TEST_NODE *linux_MakeJobTestNodes(LINUX_JOB_TEST *Test, uint32 NodeCount)
+{
+    Test->NodeCount = NodeCount;
+    Test->Hits = (uint32 volatile *) linux_AllocateMemory(NodeCount * sizeof(uint32));
+
+    LINUX_JOB_TEST_NODE *Nodes = (LINUX_JOB_TEST_NODE *) linux_AllocateMemory(NodeCount * sizeof(LINUX_JOB_TEST_NODE));
+
+    if(Nodes && Test->Hits)
+    {
+        for(uint32 NodeIndex = 0; NodeIndex < NodeCount; ++NodeIndex)
+        {
+            Nodes[NodeIndex].Test = Test;
+            Nodes[NodeIndex].Index = NodeIndex;
+        }
+    }
+
+    return Nodes;
+}
+
+//Every round mixes tree shapes and flat pushes past the deque size, so pop/steal races, the inline
+//full-deque path and sleeping workers all get hit. Exit code is non-zero on any lost or repeated job
+internal int linux_RunJobStress(LINUX_SETTINGS *Settings, HANDMADE_PLATFORM *Platform)
+{
+    LINUX_JOB_TEST Test = {};
+    Test.Platform = Platform;
+
+    LINUX_JOB_TEST_NODE *Nodes = linux_MakeJobTestNodes(&Test, (JOBS_DEQUE_SIZE * 3) + 17);
+    if(!Nodes || !Test.Hits)
+    {
+        fprintf(stderr, "Failed to allocate job stress nodes\n");
+        return 1;
+    }
+
+    uint32 FanOuts[] = {0, 1, 2, 3, 8, 64};
+    uint32 MaxNodeCount = Test.NodeCount;
+    int FailedPasses = 0;
+    int PassCount = 0;
+
+    jobs_ResetStats(Platform->JobQueue);
+
+    for(int RoundIndex = 0; RoundIndex < Settings->FrameCount; ++RoundIndex)
+    {
+        for(int FanOutIndex = 0; FanOutIndex < (int) ArrayCount(FanOuts); ++FanOutIndex)
+        {
+            Test.FanOut = FanOuts[FanOutIndex];
+            Test.NodeCount = MaxNodeCount - (uint32) ((RoundIndex * 131) % 4096);
+            Test.SpinScale = (uint32) (RoundIndex % 3);
+
+            if(!linux_RunJobTestPass(&Test, Nodes))
+            {
+                ++FailedPasses;
+                fprintf(stderr, "Round %d fan out %u: lost or repeated jobs\n", RoundIndex, Test.FanOut);
+            }
+
+            ++PassCount;
+        }
+    }
+
+    JOBS_THREAD_STATS Stats = jobs_GetStats(Platform->JobQueue);
+
+    printf("Job stress:\t%d threads, %d passes, %d failed\n", Platform->JobQueue->ThreadCount, PassCount, FailedPasses);
+    printf("jobs:\t\t%llu pushed\t %llu executed\t %llu inline\t %llu stolen\n", (unsigned long long) Stats.Pushed, (unsigned long long) Stats.Executed, (unsigned long long) Stats.RanInline, (unsigned long long) Stats.Steals);
+    printf("%s\n", (FailedPasses == 0) ? "PASSED" : "FAILED");
+
+    return (FailedPasses == 0) ? 0 : 1;
+}
+
+internal void linux_PrintJobBenchmark(const char *Name, LINUX_JOB_TEST *Test, int RoundCount, float64 Seconds)
+{
+    JOBS_THREAD_STATS Stats = jobs_GetStats(Test->Platform->JobQueue);
+
+    float64 JobsPerSecond = (float64) Stats.Executed / Seconds;
+    float64 StealRate = (Stats.Executed > 0) ? ((float64) Stats.Steals / (float64) Stats.Executed) : 0.0;
+    float64 StealSuccess = (Stats.StealAttempts > 0) ? ((float64) Stats.Steals / (float64) Stats.StealAttempts) : 0.0;
+
+    printf("%s:\t%d rounds of %u jobs, %0.2f M jobs/sec, %0.1f ns/job\n", Name, RoundCount, Test->NodeCount, JobsPerSecond / (1000.0 * 1000.0), (Seconds * 1.0e9) / (float64) Stats.Executed);
+    printf("\t\t%0.2f%% of jobs stolen, %0.2f%% of steal attempts succeeded, %llu ran inline\n", StealRate * 100.0, StealSuccess * 100.0, (unsigned long long) Stats.RanInline);
+}
+
+//Empty jobs so the cost measured is the queue itself: flat pushes from this thread, then trees spawned by the workers
+internal void linux_RunJobBenchmark(LINUX_SETTINGS *Settings, HANDMADE_PLATFORM *Platform)
+{
+    LINUX_JOB_TEST Test = {};
+    Test.Platform = Platform;
+
+    LINUX_JOB_TEST_NODE *Nodes = linux_MakeJobTestNodes(&Test, JOBS_DEQUE_SIZE);
+    if(!Nodes || !Test.Hits)
+    {
+        fprintf(stderr, "Failed to allocate job benchmark nodes\n");
+        return;
+    }
+
+    printf("Job benchmark:\t%d threads\n", Platform->JobQueue->ThreadCount);
+
+    uint32 FanOuts[] = {0, 2, 8};
+    const char *Names[] = {"flat", "tree x2", "tree x8"};
+
+    for(int FanOutIndex = 0; FanOutIndex < (int) ArrayCount(FanOuts); ++FanOutIndex)
+    {
+        Test.FanOut = FanOuts[FanOutIndex];
+        Test.SpinScale = 0;
+
+        linux_RunJobTestPass(&Test, Nodes);
+        jobs_ResetStats(Platform->JobQueue);
+
+        uint64 StartCounter = linux_GetWallClock();
+
+        for(int RoundIndex = 0; RoundIndex < Settings->FrameCount; ++RoundIndex)
+        {
+            linux_RunJobTestPass(&Test, Nodes);
+        }
+
+        float64 Seconds = (float64) (linux_GetWallClock() - StartCounter) / (1000.0 * 1000.0 * 1000.0);
+        linux_PrintJobBenchmark(Names[FanOutIndex], &Test, Settings->FrameCount, Seconds);
+    }
+}
+
+internal DEBUG_LOG_WRITE(linux_WriteLogToFile)
+{
+    (void) Level;
+    fwrite(Text, 1, (size_t) Length, (FILE *) Context);
+}
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(linux_LogBenchJob)
+{
+    (void) Queue;
+    LINUX_LOG_BENCH *Bench = (LINUX_LOG_BENCH *) Data;
+
+    for(int RecordIndex = 0; RecordIndex < Bench->RecordsPerJob; ++RecordIndex)
+    {
+        if(Bench->Async)
+        {
+            debug_LogInfo("Job record %d of %d at %p, %0.3f done", RecordIndex, Bench->RecordsPerJob, Data, (float64) RecordIndex / (float64) Bench->RecordsPerJob);
+        }
+        else
+        {
+            fprintf(Bench->Sink, "Job record %d of %d at %p, %0.3f done\n", RecordIndex, Bench->RecordsPerJob, Data, (float64) RecordIndex / (float64) Bench->RecordsPerJob);
+        }
+    }
+}
+
+//Time the workers spend logging, fprintf to /dev/null from every thread against records queued for the writer thread
+//The log is flushed between rounds, untimed, like the writer catching up while a frame waits for vblank, and a round
+//never logs more than a ring holds so drops only show up if the writer falls behind anyway
+internal int linux_RunLogBenchmark(LINUX_SETTINGS *Settings, HANDMADE_PLATFORM *Platform)
+{
+    FILE *Sink = fopen("/dev/null", "wb");
+    if(!Sink)
+    {
+        fprintf(stderr, "Failed to open /dev/null\n");
+        return 1;
+    }
+
+    int JobsPerRound = 16;
+    int RecordCounts[] = {1, 4, 16};
+    const char *Names[] = {"fprintf", "async"};
+
+    printf("Log benchmark:\t%d threads, %d rounds of %d jobs, %d record rings\n", Platform->JobQueue->ThreadCount, Settings->FrameCount, JobsPerRound, DEBUG_LOG_RECORD_COUNT);
+
+    for(int CountIndex = 0; CountIndex < (int) ArrayCount(RecordCounts); ++CountIndex)
+    {
+        for(int PathIndex = 0; PathIndex < (int) ArrayCount(Names); ++PathIndex)
+        {
+            LINUX_LOG_BENCH Bench = {};
+            Bench.Sink = Sink;
+            Bench.RecordsPerJob = RecordCounts[CountIndex];
+            Bench.Async = (PathIndex == 1);
+
+            local LINUX_LOG_THREAD LogThread;
+            if(Bench.Async && !linux_StartLog(&LogThread, linux_WriteLogToFile, Sink))
+            {
+                fprintf(stderr, "Failed to start the log writer\n");
+                fclose(Sink);
+                return 1;
+            }
+
+            uint64 LoggingNS = 0;
+            uint64 WriterNS = 0;
+
+            for(int RoundIndex = 0; RoundIndex < Settings->FrameCount; ++RoundIndex)
+            {
+                uint64 StartCounter = linux_GetWallClock();
+
+                for(int JobIndex = 0; JobIndex < JobsPerRound; ++JobIndex)
+                {
+                    Platform->AddWorkEntry(Platform->JobQueue, linux_LogBenchJob, &Bench);
+                }
+
+                Platform->CompleteAllWork(Platform->JobQueue);
+
+                LoggingNS += linux_GetWallClock() - StartCounter;
+
+                if(Bench.Async)
+                {
+                    uint64 FlushCounter = linux_GetWallClock();
+                    debug_FlushLog(&LogThread.Writer);
+                    WriterNS += linux_GetWallClock() - FlushCounter;
+                }
+            }
+
+            int64 WrittenCount = (int64) Settings->FrameCount * JobsPerRound * Bench.RecordsPerJob;
+            int64 DroppedCount = 0;
+
+            if(Bench.Async)
+            {
+                linux_StopLog(&LogThread);
+                WrittenCount = LogThread.Writer.WrittenCount;
+                DroppedCount = LogThread.DroppedCount;
+            }
+
+            float64 RecordCount = (float64) Settings->FrameCount * (float64) JobsPerRound * (float64) Bench.RecordsPerJob;
+
+            printf("%2d records/job %-8s\t%8.1f ns/record logging\t %8.1f ns/record writing\t %lld written\t %lld dropped\n", Bench.RecordsPerJob, Names[PathIndex],
+                   (float64) LoggingNS / RecordCount, (float64) WriterNS / RecordCount, (long long) WrittenCount, (long long) DroppedCount);
+        }
+    }
+
+    fclose(Sink);
+
+    return 0;
+}
+
+//Cost per oscillator sample of the sinf reference and each wavetable kernel at several bank sizes
+//Error is the largest difference from sinf over one bank of sines, in int16 units at the game's amplitude
+internal void linux_RunOscillatorBenchmark(LINUX_SETTINGS *Settings)
+{
+    local SOUND_WAVETABLES Wavetables;
+    local SOUND_OSCILLATOR_BANK Bank;
+    local float32 Reference[SOUND_BLOCK_SIZE];
+    local float32 Bus[SOUND_BLOCK_SIZE];
+
+    sound_InitOscillatorBank(&Bank, &Wavetables, Settings->SampleRate);
+
+    int OscillatorCounts[] = {1, 16, 256};
+    const char *KernelNames[] = {"sinf", "scalar", "sse2", "avx2"};
+    sound_render_oscillator *Kernels[] = {sound_RenderOscillator_Sinf, sound_RenderOscillator_Scalar, sound_RenderOscillator_SSE2, sound_RenderOscillator_AVX2};
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+
+    printf("Oscillator benchmark:\t%d Hz, %d s of audio per run, %d frame blocks\n", Settings->SampleRate, Settings->FrameCount, SOUND_BLOCK_SIZE);
+
+    for(int CountIndex = 0; CountIndex < (int) ArrayCount(OscillatorCounts); ++CountIndex)
+    {
+        int OscillatorCount = OscillatorCounts[CountIndex];
+        float64 SinfNS = 0.0;
+
+        for(int KernelIndex = 0; KernelIndex < (int) ArrayCount(Kernels); ++KernelIndex)
+        {
+            //Kernel index lines up with SIMD_LEVEL from scalar up
+            if((KernelIndex > 0) && (KernelIndex > (Best - SIMD_LEVEL_SCALAR + 1)))
+            {
+                continue;
+            }
+
+            //Same spread of pitches every run, 55 Hz upwards in small steps
+            Bank.OscillatorCount = OscillatorCount;
+            for(int OscillatorIndex = 0; OscillatorIndex < OscillatorCount; ++OscillatorIndex)
+            {
+                SOUND_OSCILLATOR *Oscillator = &Bank.Oscillators[OscillatorIndex];
+                Oscillator->Phase = 0;
+                sound_SetOscillator(&Bank, Oscillator, SOUND_WAVE_SINE, 55.0f + (7.3f * (float32) OscillatorIndex), 3000.0f / (float32) OscillatorCount);
+            }
+
+            int BlockCount = (Settings->SampleRate * Settings->FrameCount) / SOUND_BLOCK_SIZE;
+
+            uint64 StartCounter = linux_GetWallClock();
+            uint64 StartCycleCount = __rdtsc();
+
+            for(int BlockIndex = 0; BlockIndex < BlockCount; ++BlockIndex)
+            {
+                for(int SampleIndex = 0; SampleIndex < SOUND_BLOCK_SIZE; ++SampleIndex)
+                {
+                    Bus[SampleIndex] = 0.0f;
+                }
+
+                for(int OscillatorIndex = 0; OscillatorIndex < OscillatorCount; ++OscillatorIndex)
+                {
+                    Kernels[KernelIndex](&Bank.Oscillators[OscillatorIndex], Bus, SOUND_BLOCK_SIZE);
+                }
+            }
+
+            uint64 CyclesElapsed = __rdtsc() - StartCycleCount;
+            float64 NS = (float64) (linux_GetWallClock() - StartCounter);
+
+            float64 OscillatorSamples = (float64) BlockCount * (float64) SOUND_BLOCK_SIZE * (float64) OscillatorCount;
+            float64 NSPerSample = NS / OscillatorSamples;
+
+            if(KernelIndex == 0)
+            {
+                SinfNS = NSPerSample;
+            }
+
+            //Accuracy, one block from where the timed run left off against sinf
+            float32 MaxError = 0.0f;
+            for(int OscillatorIndex = 0; OscillatorIndex < OscillatorCount; ++OscillatorIndex)
+            {
+                SOUND_OSCILLATOR ReferenceOscillator = Bank.Oscillators[OscillatorIndex];
+                SOUND_OSCILLATOR TestOscillator = ReferenceOscillator;
+                ReferenceOscillator.Amplitude = 3000.0f;
+                TestOscillator.Amplitude = 3000.0f;
+
+                for(int SampleIndex = 0; SampleIndex < SOUND_BLOCK_SIZE; ++SampleIndex)
+                {
+                    Reference[SampleIndex] = 0.0f;
+                    Bus[SampleIndex] = 0.0f;
+                }
+
+                sound_RenderOscillator_Sinf(&ReferenceOscillator, Reference, SOUND_BLOCK_SIZE);
+                Kernels[KernelIndex](&TestOscillator, Bus, SOUND_BLOCK_SIZE);
+
+                for(int SampleIndex = 0; SampleIndex < SOUND_BLOCK_SIZE; ++SampleIndex)
+                {
+                    float32 Error = fabsf(Reference[SampleIndex] - Bus[SampleIndex]);
+                    if(Error > MaxError)
+                    {
+                        MaxError = Error;
+                    }
+                }
+            }
+
+            printf("%3d oscillators %-6s\t%7.3f ns/sample\t %7.2f cycles/sample\t %6.2fx vs sinf\t max error %0.4f\n",
+                   OscillatorCount, KernelNames[KernelIndex], NSPerSample, (float64) CyclesElapsed / OscillatorSamples, SinfNS / NSPerSample, MaxError);
+        }
+    }
+}
+
+//Game loop paced to GameUpdateHz with the audio thread pulling from the ring, the way the Windows build runs
+//Each frame tops the ring up to the latency target, a stall longer than the latency must show up as underruns
+internal int linux_RunAudioTest(LINUX_SETTINGS *Settings, HANDMADE_PLATFORM *Platform, HANDMADE_MEMORY *Memory, LINUX_GAME_CODE *GameCode, char *GameLibraryPath, LINUX_OFFSCREEN_BUFFER *BackBuffer, int16 *Samples)
+{
+    local AUDIO_RING_BUFFER Ring;
+    local LINUX_AUDIO_DEVICE Device;
+
+    //Ring, latency and device all count frames at the device rate, only the game's mix is at -r
+    int DeviceRate = Settings->DeviceSampleRate;
+    int64 LatencyFrames = ((int64) Settings->AudioLatencyMS * DeviceRate) / 1000;
+    int64 RingCapacity = audio_GetRingCapacity(LatencyFrames + LINUX_AUDIO_PERIOD_FRAMES);
+
+    void *RingMemory = linux_AllocateMemory(audio_GetRingMemorySize(RingCapacity));
+    if(!RingMemory)
+    {
+        fprintf(stderr, "Failed to allocate audio ring\n");
+        return 1;
+    }
+
+    audio_InitRingBuffer(&Ring, RingMemory, RingCapacity);
+
+    //Game mixes into Samples at its own rate, converted into DeviceSamples on the way to the ring
+    RESAMPLE_CONTEXT Resampler = {};
+    bool32 Resampling = (DeviceRate != Settings->SampleRate);
+    size_t ResampleMemorySize = 0;
+    void *ResampleMemory = 0;
+    int16 *DeviceSamples = Samples;
+
+    if(Resampling)
+    {
+        ResampleMemorySize = resample_GetMemorySize(Settings->SampleRate, DeviceRate, Settings->ResampleQuality) + ((size_t) LatencyFrames * sizeof(int16) * AUDIO_CHANNEL_COUNT);
+        ResampleMemory = linux_AllocateMemory(ResampleMemorySize);
+        if(!ResampleMemory)
+        {
+            fprintf(stderr, "Failed to allocate resampler\n");
+            return 1;
+        }
+
+        resample_InitContext(&Resampler, ResampleMemory, Settings->SampleRate, DeviceRate, Settings->ResampleQuality);
+        DeviceSamples = (int16 *) ((uint8 *) ResampleMemory + resample_GetMemorySize(Settings->SampleRate, DeviceRate, Settings->ResampleQuality));
+    }
+
+    //Game writes into Samples before it is copied to the ring, one second of frames like the secondary buffer
+    //The first write asks for the most, a whole latency plus the filter's lookahead
+    if((LatencyFrames > DeviceRate) || (Resampling && (resample_GetInputFrames(&Resampler, (int) LatencyFrames) > Settings->SampleRate)))
+    {
+        fprintf(stderr, "Audio latency can be at most one second\n");
+        return 1;
+    }
+
+    uint64 FrameNS = 1000000000ull / (uint64) Settings->GameUpdateHz;
+    uint64 StallNS = (uint64) Settings->StallMS * 1000000ull;
+    uint64 JitterNS = (uint64) Settings->JitterUS * 1000ull;
+    uint32 RandomState = 0x12345678;
+
+    //-l is both where the adaptive write-ahead starts and the most it may ask for, a few ms is the least
+    AUDIO_LATENCY_CONTROLLER Controller;
+    audio_InitLatencyController(&Controller, DeviceRate, LatencyFrames, DeviceRate / 500, LatencyFrames);
+
+    int64 TargetFrames = LatencyFrames;
+    int64 MinTargetFrames = LatencyFrames;
+    int64 MaxTargetFrames = 0;
+    float64 TotalTargetFrames = 0.0;
+
+    HANDMADE_INPUT_USER Input[2] = {};
+    HANDMADE_INPUT_USER *NewInput = &Input[0];
+    HANDMADE_INPUT_USER *OldInput = &Input[1];
+
+    local LINUX_SCRIPTED_INPUT Script;
+    input_InitRing(&Script.Ring);
+    Script.FrameTicks = FrameNS;
+    Script.Stats = {};
+
+    int64 FramesWritten = 0;
+    int64 MinQueuedBeforeWrite = RingCapacity;
+
+    //Prime the ring before the device starts so the first period isn't an underrun
+    int64 PrimeFrames = audio_GetFramesToWrite(&Ring, LatencyFrames);
+    audio_ClearFrames(DeviceSamples, PrimeFrames);
+    audio_WriteFrames(&Ring, DeviceSamples, PrimeFrames);
+
+    if(!linux_StartAudioDevice(&Device, &Ring, DeviceRate, JitterNS, Settings->AudioOutputPath))
+    {
+        fprintf(stderr, "Failed to start audio device\n");
+        return 1;
+    }
+
+    uint64 NextFrame = linux_GetWallClock();
+    uint64 LastWriteClock = NextFrame;
+
+    for(int FrameIndex = 0; FrameIndex < Settings->FrameCount; ++FrameIndex)
+    {
+        linux_ScriptInput(&Script, FrameIndex, OldInput, NewInput);
+
+        uint64 WriteClock = linux_GetWallClock();
+        int64 QueuedFrames = audio_GetQueuedFrames(&Ring);
+        if(QueuedFrames < MinQueuedBeforeWrite)
+        {
+            MinQueuedBeforeWrite = QueuedFrames;
+        }
+
+        if(Settings->AdaptiveLatency)
+        {
+            TargetFrames = audio_UpdateLatency(&Controller, &Ring, (float64) (WriteClock - LastWriteClock) / 1000000000.0);
+        }
+        LastWriteClock = WriteClock;
+
+        TotalTargetFrames += (float64) TargetFrames;
+        if(TargetFrames < MinTargetFrames)
+        {
+            MinTargetFrames = TargetFrames;
+        }
+        if(TargetFrames > MaxTargetFrames)
+        {
+            MaxTargetFrames = TargetFrames;
+        }
+
+        int DeviceFrames = (int) audio_GetFramesToWrite(&Ring, TargetFrames);
+
+        HANDMADE_SOUND_BUFFER SoundBuffer = {};
+        SoundBuffer.SampleRate = Settings->SampleRate;
+        SoundBuffer.SampleCount = Resampling ? resample_GetInputFrames(&Resampler, DeviceFrames) : DeviceFrames;
+        SoundBuffer.Samples = Samples;
+
+        HANDMADE_OFFSCREEN_BUFFER Buffer = {};
+        Buffer.BitmapMemory = BackBuffer->BitmapMemory;
+        Buffer.BitmapWidth = BackBuffer->BitmapWidth;
+        Buffer.BitmapHeight = BackBuffer->BitmapHeight;
+        Buffer.Pitch = BackBuffer->Pitch;
+        Buffer.Format = BackBuffer->Format;
+
+        if(linux_ReloadGameCodeIfChanged(GameCode, GameLibraryPath, Memory, Platform->BackgroundQueue, 0))
+        {
+            printf("%d\t reloaded %s\n", FrameIndex, GameCode->IsValid ? "game code" : "game code, load failed");
+        }
+
+        if(GameCode->IsValid)
+        {
+            GameCode->UpdateAndRender(Platform, Memory, NewInput, &Buffer);
+            GameCode->GetSoundSamples(Platform, Memory, &SoundBuffer);
+        }
+        else
+        {
+            SoundBuffer.SampleCount = 0;
+            DeviceFrames = 0;
+        }
+
+        if(Resampling)
+        {
+            resample_Process(&Resampler, Samples, SoundBuffer.SampleCount, DeviceSamples, DeviceFrames);
+        }
+
+        FramesWritten += audio_WriteFrames(&Ring, DeviceSamples, DeviceFrames);
+
+        if(Settings->PrintFrames)
+        {
+            printf("%d\t %lld queued\t %lld target\t %d mixed\t %d written\t %lld underruns\n",
+                   FrameIndex, (long long) QueuedFrames, (long long) TargetFrames, SoundBuffer.SampleCount, DeviceFrames, (long long) Ring.UnderrunCount);
+        }
+
+        //Simulated hitch, the device keeps pulling while the game is away
+        if(StallNS && ((FrameIndex % Settings->GameUpdateHz) == (Settings->GameUpdateHz - 1)))
+        {
+            NextFrame += StallNS;
+        }
+
+        //Jitter makes this frame late without moving the schedule, like a slow frame the next one catches up on
+        NextFrame += FrameNS;
+        linux_WaitUntil(NextFrame + linux_GetJitter(&RandomState, JitterNS), (uint64) Settings->SpinUS * 1000ull);
+
+        HANDMADE_INPUT_USER *Temp = NewInput;
+        NewInput = OldInput;
+        OldInput = Temp;
+    }
+
+    linux_StopAudioDevice(&Device);
+
+    float64 MSPerFrame = 1000.0 / (float64) DeviceRate;
+
+    printf("Audio:\t\t%d Hz, %d ms latency (%lld frames), %d frame device period, %lld frame ring\n",
+           DeviceRate, Settings->AudioLatencyMS, (long long) LatencyFrames, LINUX_AUDIO_PERIOD_FRAMES, (long long) RingCapacity);
+    printf("Frames:\t\t%lld written\t %lld played\n", (long long) (FramesWritten + PrimeFrames), (long long) Device.FramesPlayed);
+    printf("Queued:\t\t%0.2f ms min before a device read\t %0.2f ms min before a game write\n",
+           (float64) Ring.MinQueuedFrames * MSPerFrame, (float64) MinQueuedBeforeWrite * MSPerFrame);
+    printf("Underruns:\t%lld (%0.2f ms of silence)\n", (long long) Ring.UnderrunCount, (float64) Ring.UnderrunFrames * MSPerFrame);
+
+    if(Settings->AdaptiveLatency)
+    {
+        printf("Latency:\t%0.2f ms avg\t %0.2f min\t %0.2f max\t %0.2f final\t %lld widenings, %d us jitter\n",
+               (TotalTargetFrames / (float64) Settings->FrameCount) * MSPerFrame, (float64) MinTargetFrames * MSPerFrame,
+               (float64) MaxTargetFrames * MSPerFrame, audio_GetLatencyMS(&Controller), (long long) Controller.WidenCount, Settings->JitterUS);
+    }
+
+    if(Resampling)
+    {
+        printf("Resample:\t%d to %d Hz, %s, %d taps, %d phases%s\n", Settings->SampleRate, DeviceRate, ResampleQualityNames[Settings->ResampleQuality],
+               Resampler.TapCount, Resampler.PhaseCount, ((uint32) Resampler.PhaseCount < Resampler.Denominator) ? " (rounded)" : "");
+        linux_FreeMemory(ResampleMemory, ResampleMemorySize);
+    }
+
+    linux_FreeMemory(RingMemory, audio_GetRingMemorySize(RingCapacity));
+
+    return 0;
+}
+
+//Recovery check: one long stall early on, then enough calm for the floor it raised to sink back
+#define LINUX_LATENCY_RECOVERY_SECONDS 120
+#define LINUX_LATENCY_RECOVERY_STALL_SECONDS 10
+#define LINUX_LATENCY_RECOVERY_STALL_MS 100
+
+//One pass of the latency simulation, game and device on one virtual nanosecond clock so nothing waits and every run repeats exactly
+//The device wakes once a period, late by up to the jitter, and catches up like linux_AudioThreadProc
+//The game frame is late by up to the jitter too and stalls StallMS once a second, or only at StallOnceFrame when that isn't -1
+//The write-ahead is -l or the controller's pick
+internal bool32 linux_SimulateLatency(LINUX_SETTINGS *Settings, bool32 Adaptive, int FrameCount, int StallMS, int StallOnceFrame, LINUX_LATENCY_RUN *Run)
+{
+    AUDIO_RING_BUFFER Ring;
+
+    int64 LatencyFrames = ((int64) Settings->AudioLatencyMS * Settings->SampleRate) / 1000;
+    int64 RingCapacity = audio_GetRingCapacity(LatencyFrames + LINUX_AUDIO_PERIOD_FRAMES);
+    size_t RingMemorySize = audio_GetRingMemorySize(RingCapacity);
+    size_t SamplesSize = (size_t) RingCapacity * sizeof(int16) * AUDIO_CHANNEL_COUNT;
+
+    uint8 *Memory = (uint8 *) linux_AllocateMemory(RingMemorySize + SamplesSize);
+    if(!Memory)
+    {
+        return false;
+    }
+
+    int16 *Samples = (int16 *) (Memory + RingMemorySize);
+    audio_InitRingBuffer(&Ring, Memory, RingCapacity);
+
+    AUDIO_LATENCY_CONTROLLER Controller;
+    audio_InitLatencyController(&Controller, Settings->SampleRate, LatencyFrames, Settings->SampleRate / 500, LatencyFrames);
+
+    uint64 SampleRate = (uint64) Settings->SampleRate;
+    uint64 PeriodNS = ((uint64) LINUX_AUDIO_PERIOD_FRAMES * 1000000000ull) / SampleRate;
+    uint64 FrameNS = 1000000000ull / (uint64) Settings->GameUpdateHz;
+    uint64 StallNS = (uint64) StallMS * 1000000ull;
+    uint64 JitterNS = (uint64) Settings->JitterUS * 1000ull;
+
+    //Both passes see the same lateness
+    uint32 GameRandom = 0x12345678;
+    uint32 DeviceRandom = 0x9E3779B9;
+
+    *Run = {};
+    Run->FrameCount = FrameCount;
+    Run->MinLatencyMS = 1000.0 * (float64) LatencyFrames / (float64) SampleRate;
+
+    audio_ClearFrames(Samples, RingCapacity);
+    audio_WriteFrames(&Ring, Samples, audio_GetFramesToWrite(&Ring, LatencyFrames));
+
+    uint64 NextPeriod = PeriodNS;
+    uint64 DeviceWake = NextPeriod + linux_GetJitter(&DeviceRandom, JitterNS);
+    int64 FramesPlayed = 0;
+
+    uint64 GameClock = 0;
+    uint64 LastGameClock = 0;
+
+    for(int FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+    {
+        //Every device wake due before this write, each reading all whole periods played by then
+        while(DeviceWake <= GameClock)
+        {
+            int64 DeviceFrame = (int64) ((DeviceWake * SampleRate) / 1000000000ull);
+            while(FramesPlayed + LINUX_AUDIO_PERIOD_FRAMES <= DeviceFrame)
+            {
+                audio_ReadFrames(&Ring, Samples, LINUX_AUDIO_PERIOD_FRAMES);
+                FramesPlayed += LINUX_AUDIO_PERIOD_FRAMES;
+            }
+
+            NextPeriod += PeriodNS;
+            DeviceWake = NextPeriod + linux_GetJitter(&DeviceRandom, JitterNS);
+        }
+
+        int64 TargetFrames = LatencyFrames;
+        if(Adaptive)
+        {
+            float64 FrameSeconds = (float64) (FrameIndex ? (GameClock - LastGameClock) : FrameNS) / 1000000000.0;
+            TargetFrames = audio_UpdateLatency(&Controller, &Ring, FrameSeconds);
+        }
+
+        audio_WriteFrames(&Ring, Samples, audio_GetFramesToWrite(&Ring, TargetFrames));
+
+        float64 LatencyMS = 1000.0 * (float64) TargetFrames / (float64) SampleRate;
+        Run->TotalLatencyMS += LatencyMS;
+        Run->FinalLatencyMS = LatencyMS;
+        if(LatencyMS < Run->MinLatencyMS)
+        {
+            Run->MinLatencyMS = LatencyMS;
+        }
+        if(LatencyMS > Run->MaxLatencyMS)
+        {
+            Run->MaxLatencyMS = LatencyMS;
+        }
+
+        if(Settings->PrintFrames && ((FrameIndex % Settings->GameUpdateHz) == 0))
+        {
+            printf("%s %d\t %0.2f ms latency\t %lld underruns\n", Adaptive ? "adaptive" : "fixed", FrameIndex, LatencyMS, (long long) Ring.UnderrunCount);
+        }
+
+        LastGameClock = GameClock;
+        bool32 Stalls = (StallOnceFrame >= 0) ? (FrameIndex == StallOnceFrame) : ((FrameIndex % Settings->GameUpdateHz) == (Settings->GameUpdateHz - 1));
+        if(StallNS && Stalls)
+        {
+            GameClock += StallNS;
+        }
+        GameClock += FrameNS + linux_GetJitter(&GameRandom, JitterNS);
+    }
+
+    Run->UnderrunCount = Ring.UnderrunCount;
+    Run->UnderrunFrames = Ring.UnderrunFrames;
+    Run->WidenCount = Controller.WidenCount;
+
+    linux_FreeMemory(Memory, RingMemorySize + SamplesSize);
+
+    return true;
+}
+
+internal void linux_PrintLatencyRun(LINUX_SETTINGS *Settings, const char *Name, LINUX_LATENCY_RUN *Run)
+{
+    printf("%-10s %10.2f %10.2f %10.2f %10.2f %10lld %12.2f %10lld\n", Name,
+           Run->TotalLatencyMS / (float64) Run->FrameCount, Run->MinLatencyMS, Run->MaxLatencyMS, Run->FinalLatencyMS,
+           (long long) Run->UnderrunCount, (1000.0 * (float64) Run->UnderrunFrames) / (float64) Settings->SampleRate, (long long) Run->WidenCount);
+}
+
+//Fixed against adaptive write-ahead under the same frame and device timing, then whether adaptive latency comes back down after one stall
+internal int linux_RunLatencySimulation(LINUX_SETTINGS *Settings)
+{
+    int64 LatencyFrames = ((int64) Settings->AudioLatencyMS * Settings->SampleRate) / 1000;
+    if(LatencyFrames > Settings->SampleRate)
+    {
+        fprintf(stderr, "Audio latency can be at most one second\n");
+        return 1;
+    }
+
+    printf("Latency:\t%d Hz, %d frame device period, %d Hz game, %d us jitter, %d ms stall once a second, %0.1f simulated seconds\n",
+           Settings->SampleRate, LINUX_AUDIO_PERIOD_FRAMES, Settings->GameUpdateHz, Settings->JitterUS, Settings->StallMS,
+           (float64) Settings->FrameCount / (float64) Settings->GameUpdateHz);
+    printf("%-10s %10s %10s %10s %10s %10s %12s %10s\n", "Pass", "avg ms", "min ms", "max ms", "final ms", "underruns", "silence ms", "widenings");
+
+    for(int Pass = 0; Pass < 2; ++Pass)
+    {
+        bool32 Adaptive = (Pass == 1);
+
+        LINUX_LATENCY_RUN Run;
+        if(!linux_SimulateLatency(Settings, Adaptive, Settings->FrameCount, Settings->StallMS, -1, &Run))
+        {
+            fprintf(stderr, "Failed to allocate audio ring\n");
+            return 1;
+        }
+
+        linux_PrintLatencyRun(Settings, Adaptive ? "adaptive" : "fixed", &Run);
+    }
+
+    //No stalls at all against a single early one, the stalled run must end within a step of the calm one
+    //Without jitter, so the stall's are the only underruns either run sees
+    LINUX_SETTINGS Quiet = *Settings;
+    Quiet.JitterUS = 0;
+
+    int RecoveryFrameCount = LINUX_LATENCY_RECOVERY_SECONDS * Settings->GameUpdateHz;
+    int StallFrame = (LINUX_LATENCY_RECOVERY_STALL_SECONDS * Settings->GameUpdateHz) - 1;
+
+    LINUX_LATENCY_RUN Calm;
+    LINUX_LATENCY_RUN Recovery;
+    if(!linux_SimulateLatency(&Quiet, true, RecoveryFrameCount, 0, -1, &Calm) ||
+       !linux_SimulateLatency(&Quiet, true, RecoveryFrameCount, LINUX_LATENCY_RECOVERY_STALL_MS, StallFrame, &Recovery))
+    {
+        fprintf(stderr, "Failed to allocate audio ring\n");
+        return 1;
+    }
+
+    printf("\nRecovery:\t%d ms stall after %d s, no jitter, %d simulated seconds\n", LINUX_LATENCY_RECOVERY_STALL_MS, LINUX_LATENCY_RECOVERY_STALL_SECONDS, LINUX_LATENCY_RECOVERY_SECONDS);
+    linux_PrintLatencyRun(Settings, "calm", &Calm);
+    linux_PrintLatencyRun(Settings, "stalled", &Recovery);
+
+    float64 StepMS = 1.0;
+    bool32 Recovered = (Recovery.UnderrunCount > 0) && (Recovery.FinalLatencyMS <= (Calm.FinalLatencyMS + StepMS));
+    printf("%s\n", Recovered ? "PASSED" : "FAILED");
+
+    return Recovered ? 0 : 1;
+}
+
+//Cost of mixing one game frame of audio against the number of playing voices, half of them mid volume ramp
+//Oscillators are left out so only the voice mix and the int16 conversion are timed
+internal void linux_RunMixerBenchmark(LINUX_SETTINGS *Settings)
+{
+    local SOUND_WAVETABLES Wavetables;
+    local SOUND_MIXER Mixer;
+    local SOUND_SAMPLES Sound;
+    local int16 SoundSamples[2][48000];
+
+    int SamplesPerFrame = Settings->SampleRate / Settings->GameUpdateHz;
+    int16 *Samples = (int16 *) linux_AllocateMemory(SamplesPerFrame * sizeof(int16) * 2);
+
+    if(!Samples)
+    {
+        fprintf(stderr, "Failed to allocate mixer output\n");
+        return;
+    }
+
+    //Stereo noise so the conversion sees a spread of values, long enough that voices loop mid block
+    uint32 Random = 0x12345678;
+    for(int SampleIndex = 0; SampleIndex < (int) ArrayCount(SoundSamples[0]); ++SampleIndex)
+    {
+        for(int Channel = 0; Channel < 2; ++Channel)
+        {
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+            SoundSamples[Channel][SampleIndex] = (int16) (Random >> 16);
+        }
+    }
+
+    Sound.ChannelCount = 2;
+    Sound.SampleRate = Settings->SampleRate;
+    Sound.SampleCount = ArrayCount(SoundSamples[0]);
+    Sound.Samples[0] = SoundSamples[0];
+    Sound.Samples[1] = SoundSamples[1];
+
+    int VoiceCounts[] = {1, 8, 32, 128, 256, 512};
+    SIMD_LEVEL Best = cpu_SelectSimdLevel(SIMD_LEVEL_AUTO);
+
+    printf("Mixer benchmark:\t%d Hz, %d samples per frame, %d frames per run\n", Settings->SampleRate, SamplesPerFrame, Settings->FrameCount);
+
+    for(int CountIndex = 0; CountIndex < (int) ArrayCount(VoiceCounts); ++CountIndex)
+    {
+        int VoiceCount = VoiceCounts[CountIndex];
+
+        for(int Level = SIMD_LEVEL_SCALAR; Level <= Best; ++Level)
+        {
+            sound_SelectKernels((SIMD_LEVEL) Level);
+
+            sound_InitMixer(&Mixer, &Wavetables, Settings->SampleRate);
+            Mixer.Oscillators.OscillatorCount = 0;
+
+            for(int VoiceIndex = 0; VoiceIndex < VoiceCount; ++VoiceIndex)
+            {
+                SOUND_VOICE *Voice = sound_PlaySound(&Mixer, &Sound, 0.5f / (float32) VoiceCount, 0.5f / (float32) VoiceCount, true);
+                Voice->SamplesPlayed = (VoiceIndex * 997) % Sound.SampleCount;
+            }
+
+            uint64 TotalNS = 0;
+            uint64 TotalCycles = 0;
+
+            for(int FrameIndex = 0; FrameIndex < Settings->FrameCount; ++FrameIndex)
+            {
+                //Every frame restarts a ramp on half the voices so they never settle
+                int VoiceIndex = 0;
+                for(SOUND_VOICE *Voice = Mixer.FirstVoice; Voice; Voice = Voice->Next, ++VoiceIndex)
+                {
+                    if(VoiceIndex & 1)
+                    {
+                        float32 Pan = (float32) (FrameIndex & 7) / 7.0f;
+                        sound_ChangeVolume(&Mixer, Voice, 1.0f / (float32) Settings->GameUpdateHz, Pan / (float32) VoiceCount, (1.0f - Pan) / (float32) VoiceCount);
+                    }
+                }
+
+                HANDMADE_SOUND_BUFFER SoundBuffer = {};
+                SoundBuffer.SampleRate = Settings->SampleRate;
+                SoundBuffer.SampleCount = SamplesPerFrame;
+                SoundBuffer.Samples = Samples;
+
+                uint64 StartCounter = linux_GetWallClock();
+                uint64 StartCycleCount = __rdtsc();
+
+                sound_OutputSound(&Mixer, &SoundBuffer);
+
+                TotalCycles += __rdtsc() - StartCycleCount;
+                TotalNS += linux_GetWallClock() - StartCounter;
+            }
+
+            float64 VoiceSamples = (float64) Settings->FrameCount * (float64) SamplesPerFrame * (float64) VoiceCount;
+
+            printf("%3d voices %-6s\t%9.2f us/frame\t %7.3f ns/voice sample\t %7.2f cycles/voice sample\n",
+                   VoiceCount, SimdLevelNames[Level], ((float64) TotalNS / 1000.0) / (float64) Settings->FrameCount,
+                   (float64) TotalNS / VoiceSamples, (float64) TotalCycles / VoiceSamples);
+        }
+    }
+
+    sound_SelectKernels(Settings->SimdLevel);
+    linux_FreeMemory(Samples, SamplesPerFrame * sizeof(int16) * 2);
+}
+
+int main(int ArgumentCount, char **Arguments)
+{
+    LINUX_SETTINGS Settings = {};
+    Settings.Width = 1280;
+    Settings.Height = 720;
+    Settings.FrameCount = 600;
+    Settings.SampleRate = 48000;
+    Settings.GameUpdateHz = 60;
+    Settings.WorkerCount = (int) sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    Settings.TileWidth = 64;
+    Settings.TileHeight = 64;
+    Settings.AudioLatencyMS = 50;
+    Settings.ResampleQuality = RESAMPLE_QUALITY_HIGH;
+    Settings.SpinUS = 500;
+    Settings.CaptureSlotCount = 4;
+
+    if(Settings.WorkerCount < 0)
+    {
+        Settings.WorkerCount = 0;
+    }
+
+    if(!linux_ParseSettings(ArgumentCount, Arguments, &Settings))
+    {
+        linux_PrintUsage(Arguments[0]);
+        return 1;
+    }
+
+    SIMD_LEVEL SimdLevel = render_SelectKernels(Settings.SimdLevel);
+    scale_SelectKernels(Settings.SimdLevel);
+    pixel_SelectKernels(Settings.SimdLevel);
+    capture_SelectKernels(Settings.SimdLevel);
+    sound_SelectKernels(Settings.SimdLevel);
+    resample_SelectKernels(Settings.SimdLevel);
+
+    if(Settings.Mode == LINUX_RUN_MODE_OSCBENCH)
+    {
+        linux_RunOscillatorBenchmark(&Settings);
+        return 0;
+    }
+
+    if(Settings.Mode == LINUX_RUN_MODE_MIXBENCH)
+    {
+        linux_RunMixerBenchmark(&Settings);
+        return 0;
+    }
+
+    if(Settings.Mode == LINUX_RUN_MODE_LATENCY)
+    {
+        return linux_RunLatencySimulation(&Settings);
+    }
+
+    //Game renders into the back buffer, the front buffer is the -w x -h surface it is presented to
+    LINUX_OFFSCREEN_BUFFER BackBuffer = {};
+    linux_ResizeOffscreenBuffer(&BackBuffer, Settings.HalfResolution ? (Settings.Width / 2) : Settings.Width, Settings.HalfResolution ? (Settings.Height / 2) : Settings.Height,
+                                Settings.PixelFormat);
+
+    LINUX_OFFSCREEN_BUFFER FrontBuffer = {};
+    linux_ResizeOffscreenBuffer(&FrontBuffer, Settings.Width, Settings.Height, HANDMADE_PIXEL_FORMAT_BGRX8888);
+
+    //Upscaling reads BGRX8888, so another format is widened into this first
+    LINUX_OFFSCREEN_BUFFER ConvertedBuffer = {};
+    if(Settings.HalfResolution && (Settings.PixelFormat != HANDMADE_PIXEL_FORMAT_BGRX8888))
+    {
+        linux_ResizeOffscreenBuffer(&ConvertedBuffer, BackBuffer.BitmapWidth, BackBuffer.BitmapHeight, HANDMADE_PIXEL_FORMAT_BGRX8888);
+    }
+
+    SCALE_CONTEXT ScaleContext;
+    SCALE_CONTEXT *Scaler = 0;
+    size_t ScaleMemorySize = scale_GetMemorySize(BackBuffer.BitmapWidth, FrontBuffer.BitmapWidth, FrontBuffer.BitmapHeight);
+    void *ScaleMemory = 0;
+
+    if(Settings.HalfResolution)
+    {
+        ScaleMemory = linux_AllocateMemory(ScaleMemorySize);
+        scale_InitContext(&ScaleContext, ScaleMemory, Settings.ScaleFilter, BackBuffer.BitmapWidth, BackBuffer.BitmapHeight, FrontBuffer.BitmapWidth, FrontBuffer.BitmapHeight);
+        Scaler = &ScaleContext;
+    }
+
+    //Initialise audio buffer, one second like the DirectSound secondary buffer
+    LINUX_SOUND_OUTPUT SoundOutput = {};
+
+    SoundOutput.SampleRate = Settings.SampleRate;
+    SoundOutput.RunningSampleIndex = 0;
+    SoundOutput.BytesPerSample = sizeof(int16) * 2;
+    SoundOutput.SecondaryBufferSize = SoundOutput.SampleRate * SoundOutput.BytesPerSample;
+    SoundOutput.SamplesPerFrame = SoundOutput.SampleRate / Settings.GameUpdateHz;
+
+    int16 *Samples = (int16 *) linux_AllocateMemory(SoundOutput.SecondaryBufferSize);
+
+    if(!BackBuffer.BitmapMemory || !FrontBuffer.BitmapMemory || !Samples || (Settings.HalfResolution && (Settings.PixelFormat != HANDMADE_PIXEL_FORMAT_BGRX8888) && !ConvertedBuffer.BitmapMemory))
+    {
+        fprintf(stderr, "Failed to allocate platform buffers\n");
+        return 1;
+    }
+
+    //All game state lives in one block, permanent first then transient
+    HANDMADE_MEMORY Memory = {};
+    Memory.PermanentStorageSize = Megabytes(64);
+    Memory.TransientStorageSize = Megabytes(512);
+
+    LINUX_GAME_MEMORY GameMemory = {};
+
+    if(!linux_AllocateGameMemory(&GameMemory, (size_t) (Memory.PermanentStorageSize + Memory.TransientStorageSize)))
+    {
+        fprintf(stderr, "Failed to allocate game memory\n");
+        return 1;
+    }
+
+    Memory.PermanentStorage = GameMemory.Base;
+    Memory.TransientStorage = (uint8 *) Memory.PermanentStorage + Memory.PermanentStorageSize;
+
+    //Job system shared by rendering and anything else the game pushes, no workers means the original single thread path
+    local HANDMADE_WORK_QUEUE JobQueue;
+
+    HANDMADE_PLATFORM Platform = {};
+    Platform.AddWorkEntry = jobs_AddWorkEntry;
+    Platform.CompleteAllWork = jobs_CompleteAllWork;
+    Platform.RenderTileWidth = Settings.TileWidth;
+    Platform.RenderTileHeight = Settings.TileHeight;
+    Platform.SimdLevel = Settings.SimdLevel;
+
+    bool32 NeedsQueue = (Settings.WorkerCount > 0) || ((Settings.Mode != LINUX_RUN_MODE_GAME) && (Settings.Mode != LINUX_RUN_MODE_AUDIO) && (Settings.Mode != LINUX_RUN_MODE_REPLAY));
+
+    if(NeedsQueue)
+    {
+        if(!linux_MakeQueue(&JobQueue, Settings.WorkerCount))
+        {
+            fprintf(stderr, "Failed to start worker threads\n");
+            return 1;
+        }
+
+        Platform.JobQueue = &JobQueue;
+    }
+
+    if(Settings.Mode == LINUX_RUN_MODE_JOBSTRESS)
+    {
+        return linux_RunJobStress(&Settings, &Platform);
+    }
+
+    if(Settings.Mode == LINUX_RUN_MODE_JOBBENCH)
+    {
+        linux_RunJobBenchmark(&Settings, &Platform);
+        return 0;
+    }
+
+    if(Settings.Mode == LINUX_RUN_MODE_LOGBENCH)
+    {
+        return linux_RunLogBenchmark(&Settings, &Platform);
+    }
+
+    if(Settings.Mode == LINUX_RUN_MODE_TILES)
+    {
+        HANDMADE_OFFSCREEN_BUFFER Buffer = {};
+        Buffer.BitmapMemory = BackBuffer.BitmapMemory;
+        Buffer.BitmapWidth = BackBuffer.BitmapWidth;
+        Buffer.BitmapHeight = BackBuffer.BitmapHeight;
+        Buffer.Pitch = BackBuffer.Pitch;
+        Buffer.Format = BackBuffer.Format;
+
+        printf("Render kernel:\t%s\n", SimdLevelNames[SimdLevel]);
+        linux_RunTileBenchmark(&Settings, &Buffer, &Platform, &Memory);
+        return 0;
+    }
+
+    //Pack stays mapped until exit, the game reads assets straight out of it
+    char AssetPath[4096];
+    if(Settings.AssetPath)
+    {
+        snprintf(AssetPath, sizeof(AssetPath), "%s", Settings.AssetPath);
+    }
+    else
+    {
+        linux_GetExecutableSiblingPath(AssetPath, sizeof(AssetPath), "handmade.hha");
+    }
+
+    Platform.AssetPackMemory = linux_MapFile(AssetPath, &Platform.AssetPackSize);
+
+    if(Settings.AssetPath && !Platform.AssetPackMemory)
+    {
+        fprintf(stderr, "Can't map asset pack %s\n", Settings.AssetPath);
+        return 1;
+    }
+
+    //Asset loads stream in on their own worker so a page fault storm never holds up the render workers
+    local HANDMADE_WORK_QUEUE BackgroundQueue;
+    HANDMADE_ASSET_STATS AssetStats = {};
+    Platform.AssetStats = &AssetStats;
+
+    if(Settings.WorkerCount > 0)
+    {
+        if(!linux_MakeQueue(&BackgroundQueue, 1))
+        {
+            fprintf(stderr, "Failed to start the background worker\n");
+            return 1;
+        }
+
+        Platform.BackgroundQueue = &BackgroundQueue;
+    }
+
+    //Game modes run the library, rebuilding it with build.sh while they run swaps it in between frames
+    char GameLibraryPath[4096];
+    linux_GetGameLibraryPath(GameLibraryPath, sizeof(GameLibraryPath));
+
+    LINUX_GAME_CODE GameCode = linux_LoadGameCode(GameLibraryPath);
+    Memory.ExecutableReloaded = true;
+
+    if(!GameCode.IsValid)
+    {
+        fprintf(stderr, "Failed to load game code from %s: %s\n", GameLibraryPath, dlerror());
+        return 1;
+    }
+
+    if(Settings.Mode == LINUX_RUN_MODE_AUDIO)
+    {
+        return linux_RunAudioTest(&Settings, &Platform, &Memory, &GameCode, GameLibraryPath, &BackBuffer, Samples);
+    }
+
+    //Index controllers
+    HANDMADE_INPUT_USER Input[2] = {};
+    HANDMADE_INPUT_USER *NewInput = &Input[0];
+    HANDMADE_INPUT_USER *OldInput = &Input[1];
+
+    local LINUX_SCRIPTED_INPUT Script;
+    input_InitRing(&Script.Ring);
+    Script.FrameTicks = 1000000000ull / (uint64) Settings.GameUpdateHz;
+    Script.Stats = {};
+
+    LINUX_FRAME_STATS Stats = {};
+    Stats.MinMS = 1.0e30;
+    Stats.MinCycles = ~0ull;
+
+    //Replay mode takes input and sample counts from the recording instead of the script
+    LINUX_REPLAY Replay = {};
+    Replay.BackgroundQueue = Platform.BackgroundQueue;
+
+    if(Settings.Mode == LINUX_RUN_MODE_REPLAY)
+    {
+        if(!linux_BeginPlayback(&Replay, Settings.ReplayPath, &Memory))
+        {
+            return 1;
+        }
+
+        if(Replay.Header->SampleRate != SoundOutput.SampleRate)
+        {
+            fprintf(stderr, "Recording is at %d Hz, run with -r %d\n", Replay.Header->SampleRate, Replay.Header->SampleRate);
+            return 1;
+        }
+    }
+    else if(Settings.RecordPath)
+    {
+        if(!linux_BeginRecording(&Replay, Settings.RecordPath, &Memory, SoundOutput.SampleRate))
+        {
+            fprintf(stderr, "Can't record to %s\n", Settings.RecordPath);
+            return 1;
+        }
+    }
+
+    //Game reports what it changed each frame so only that is redrawn and presented
+    HANDMADE_DIRTY_RECTS DirtyRects = {};
+    Platform.DirtyRects = Settings.FullPresent ? 0 : &DirtyRects;
+
+    //Profiler is always on for the game, collation and the trace write happen outside the timed update
+    DEBUG_TABLE *DebugTable = (DEBUG_TABLE *) linux_AllocateMemory(sizeof(DEBUG_TABLE));
+    Platform.DebugTable = DebugTable;
+
+    local DEBUG_COLLATION DebugCollation;
+    debug_ResetCollation(&DebugCollation);
+
+    DEBUG_TRACE DebugTrace = {};
+
+    if(Settings.TracePath && !debug_BeginTrace(&DebugTrace, Settings.TracePath, linux_GetMicrosecondsPerCycle()))
+    {
+        fprintf(stderr, "Can't write trace to %s\n", Settings.TracePath);
+        return 1;
+    }
+
+    //Logging from the frame, the game and the workers is written on its own thread from here until the summary
+    local LINUX_LOG_THREAD LogThread;
+    if(!linux_StartLog(&LogThread, linux_WriteLog, 0))
+    {
+        fprintf(stderr, "Failed to start the log writer\n");
+        return 1;
+    }
+
+    Platform.DebugLog = LogThread.Log;
+
+    //Capture takes what was presented, so it records the upscaled frame a window would have shown
+    local CAPTURE_QUEUE Capture;
+    size_t CaptureMemorySize = 0;
+    void *CaptureMemory = 0;
+    sem_t CaptureSemaphore;
+    pthread_t CaptureThread;
+
+    if(Settings.CapturePath)
+    {
+        CaptureMemorySize = capture_GetMemorySize(FrontBuffer.BitmapWidth, FrontBuffer.BitmapHeight, Settings.CaptureSlotCount);
+        CaptureMemory = linux_AllocateMemory(CaptureMemorySize);
+
+        if(!CaptureMemory || (sem_init(&CaptureSemaphore, 0, 0) != 0) ||
+           !capture_Begin(&Capture, CaptureMemory, Settings.CapturePath, FrontBuffer.BitmapWidth, FrontBuffer.BitmapHeight, Settings.CaptureSlotCount,
+                          Settings.GameUpdateHz, &CaptureSemaphore, linux_SignalSemaphore, linux_WaitSemaphore) ||
+           (pthread_create(&CaptureThread, 0, linux_CaptureThreadProc, &Capture) != 0))
+        {
+            fprintf(stderr, "Can't capture to %s\n", Settings.CapturePath);
+            return 1;
+        }
+    }
+
+    //Histogram covers whole frames, start to start, locked or not
+    local FRAME_HISTOGRAM FrameHistogram;
+    uint64 FrameNS = Settings.LockFrameRate ? (1000000000ull / (uint64) Settings.GameUpdateHz) : 0;
+    uint64 SpinNS = (uint64) Settings.SpinUS * 1000ull;
+    frame_InitHistogram(&FrameHistogram, (float32) FrameNS / (1000.0f * 1000.0f));
+
+    uint64 StartWallClock = linux_GetWallClock();
+    uint64 FrameStart = StartWallClock;
+    uint64 FrameDeadline = StartWallClock + FrameNS;
+
+    for(int FrameIndex = 0; FrameIndex < Settings.FrameCount; ++FrameIndex)
+    {
+        if(linux_ReloadGameCodeIfChanged(&GameCode, GameLibraryPath, &Memory, Platform.BackgroundQueue, &LogThread.Writer))
+        {
+            debug_LogInfo("Frame %d reloaded %s", FrameIndex, GameCode.IsValid ? "game code" : "game code, load failed");
+        }
+
+        HANDMADE_SOUND_BUFFER SoundBuffer = {};
+        SoundBuffer.SampleRate = SoundOutput.SampleRate;
+        SoundBuffer.SampleCount = SoundOutput.SamplesPerFrame;
+        SoundBuffer.Samples = Samples;
+
+        if(Replay.Frames)
+        {
+            REPLAY_FRAME *Frame = linux_PlaybackFrame(&Replay, &Memory);
+            *NewInput = Frame->Input;
+            SoundBuffer.SampleCount = Frame->SoundSampleCount;
+        }
+        else
+        {
+            linux_ScriptInput(&Script, FrameIndex, OldInput, NewInput);
+        }
+
+        if(Replay.RecordFile)
+        {
+            linux_RecordFrame(&Replay, NewInput, SoundBuffer.SampleCount);
+        }
+
+        HANDMADE_OFFSCREEN_BUFFER Buffer = {};
+        Buffer.BitmapMemory = BackBuffer.BitmapMemory;
+        Buffer.BitmapWidth = BackBuffer.BitmapWidth;
+        Buffer.BitmapHeight = BackBuffer.BitmapHeight;
+        Buffer.Pitch = BackBuffer.Pitch;
+        Buffer.Format = BackBuffer.Format;
+
+        //Performance counters
+        uint64 LastCounter = linux_GetWallClock();
+        uint64 LastCycleCount = __rdtsc();
+
+        if(GameCode.IsValid)
+        {
+            GameCode.UpdateAndRender(&Platform, &Memory, NewInput, &Buffer);
+            GameCode.GetSoundSamples(&Platform, &Memory, &SoundBuffer);
+        }
+        else
+        {
+            DirtyRects.RectCount = 0;
+            DirtyRects.DirtyPixelCount = 0;
+        }
+
+        uint64 EndCycleCount = __rdtsc();
+        uint64 EndCounter = linux_GetWallClock();
+
+        uint64 PresentBytes = linux_DisplayBuffer(&FrontBuffer, &BackBuffer, &ConvertedBuffer, Platform.DirtyRects, Scaler);
+        uint64 PresentEnd = linux_GetWallClock();
+
+        if(CaptureMemory)
+        {
+            HANDMADE_OFFSCREEN_BUFFER Presented = linux_GetGameBuffer(&FrontBuffer);
+            capture_SubmitFrame(&Capture, &Presented);
+            Stats.CaptureMS += (float64) (linux_GetWallClock() - PresentEnd) / (1000.0 * 1000.0);
+        }
+
+        uint64 FramePixelCount = (uint64) Buffer.BitmapWidth * (uint64) Buffer.BitmapHeight;
+        uint64 DirtyPixelCount = Platform.DirtyRects ? DirtyRects.DirtyPixelCount : FramePixelCount;
+        float64 DirtyFraction = (float64) DirtyPixelCount / (float64) FramePixelCount;
+
+        //Null sound device consumes everything that was written
+        SoundOutput.RunningSampleIndex += SoundBuffer.SampleCount;
+
+        uint64 CyclesElapsed = EndCycleCount - LastCycleCount;
+        float64 MSPerFrame = (float64) (EndCounter - LastCounter) / (1000.0 * 1000.0);
+
+        Stats.FrameCount++;
+        Stats.TotalMS += MSPerFrame;
+        Stats.TotalCycles += CyclesElapsed;
+        Stats.PixelCount += (uint64) Buffer.BitmapWidth * (uint64) Buffer.BitmapHeight;
+        Stats.SampleCount += (uint64) SoundBuffer.SampleCount;
+        Stats.DirtyPixelCount += DirtyPixelCount;
+        Stats.PresentedBytes += PresentBytes;
+        Stats.PresentMS += (float64) (PresentEnd - EndCounter) / (1000.0 * 1000.0);
+
+        if(DirtyFraction > Stats.MaxDirtyFraction) Stats.MaxDirtyFraction = DirtyFraction;
+        if(DirtyPixelCount == 0) Stats.CleanFrameCount++;
+
+        if(MSPerFrame < Stats.MinMS) Stats.MinMS = MSPerFrame;
+        if(MSPerFrame > Stats.MaxMS) Stats.MaxMS = MSPerFrame;
+        if(CyclesElapsed < Stats.MinCycles) Stats.MinCycles = CyclesElapsed;
+        if(CyclesElapsed > Stats.MaxCycles) Stats.MaxCycles = CyclesElapsed;
+
+        if(Settings.PrintFrames)
+        {
+            float64 MegaHzCyclesPerFrame = (float64) CyclesElapsed / (1000.0 * 1000.0);
+            //Asked for with -v, so written as a bare message whether or not DEBUG is defined
+            debug_Log(DEBUG_LOG_MESSAGE, 0, "%d\t %0.4f ms/frame\t %0.4f cycles(MHz)/frame\t %0.2f%% dirty in %d rects", FrameIndex, MSPerFrame, MegaHzCyclesPerFrame,
+                                            DirtyFraction * 100.0, Platform.DirtyRects ? DirtyRects.RectCount : 1);
+        }
+
+        if(DebugTable)
+        {
+            debug_EndFrame(DebugTable, &DebugCollation, &DebugTrace);
+        }
+
+        debug_SignalLog(&LogThread.Writer);
+
+        //A frame whose work overran the deadline is missed, the schedule restarts from now rather than rushing to catch up
+        bool32 Missed = false;
+
+        if(FrameNS)
+        {
+            uint64 Now = linux_GetWallClock();
+
+            if(Now > FrameDeadline)
+            {
+                Missed = true;
+                FrameDeadline = Now;
+            }
+            else
+            {
+                linux_WaitUntil(FrameDeadline, SpinNS);
+            }
+
+            FrameDeadline += FrameNS;
+        }
+
+        uint64 FrameEnd = linux_GetWallClock();
+        frame_AddFrame(&FrameHistogram, (float32) (FrameEnd - FrameStart) / (1000.0f * 1000.0f), Missed);
+        FrameStart = FrameEnd;
+
+        if(Settings.PrintFrames && ((FrameIndex % FRAME_HISTOGRAM_WINDOW) == (FRAME_HISTOGRAM_WINDOW - 1)))
+        {
+            char HistogramText[256];
+            frame_FormatHistogram(&FrameHistogram, HistogramText, sizeof(HistogramText));
+            printf("%d\t %s", FrameIndex, HistogramText);
+        }
+
+        HANDMADE_INPUT_USER *Temp = NewInput;
+        NewInput = OldInput;
+        OldInput = Temp;
+    }
+
+    float64 WallSeconds = (float64) (linux_GetWallClock() - StartWallClock) / (1000.0 * 1000.0 * 1000.0);
+
+    //Everything logged during the run comes out before the summary
+    linux_StopLog(&LogThread);
+    Platform.DebugLog = 0;
+
+    printf("Resolution:\t%dx%d %s @ %d Hz audio, %d samples/frame\n", BackBuffer.BitmapWidth, BackBuffer.BitmapHeight, PixelFormatNames[BackBuffer.Format],
+           SoundOutput.SampleRate, SoundOutput.SamplesPerFrame);
+    printf("Render kernel:\t%s, %d workers, %dx%d tiles\n", SimdLevelNames[SimdLevel], Platform.JobQueue ? Settings.WorkerCount : 0, Settings.TileWidth, Settings.TileHeight);
+    printf("Game memory:\t%llu MB permanent, %llu MB transient at %p (%s, %s)\n", (unsigned long long) (Memory.PermanentStorageSize / Megabytes(1)), (unsigned long long) (Memory.TransientStorageSize / Megabytes(1)),
+           GameMemory.Base, GameMemory.AtFixedBase ? "fixed base" : "moved", GameMemory.HugePages ? "huge pages" : "transparent huge pages requested");
+    if(Platform.AssetPackMemory)
+    {
+        ASSET_PACK AssetPack;
+        bool32 Valid = asset_OpenPack(&AssetPack, Platform.AssetPackMemory, Platform.AssetPackSize);
+        printf("Assets:\t\t%s, %u assets in %llu KB%s\n", AssetPath, AssetPack.AssetCount, (unsigned long long) (Platform.AssetPackSize / Kilobytes(1)), Valid ? "" : " (not a valid pack)");
+        printf("Asset cache:\t%llu hits, %llu misses, %llu loads, %llu evictions, %llu over budget, %0.2f of %llu MB resident, %llu KB in flight (%s)\n",
+               (unsigned long long) AssetStats.Hits, (unsigned long long) AssetStats.Misses, (unsigned long long) AssetStats.Loads,
+               (unsigned long long) AssetStats.Evictions, (unsigned long long) AssetStats.BudgetFailures,
+               (float64) AssetStats.BytesResident / (float64) Megabytes(1), (unsigned long long) (AssetStats.BudgetSize / Megabytes(1)),
+               (unsigned long long) (AssetStats.BytesInFlight / Kilobytes(1)), Platform.BackgroundQueue ? "background worker" : "loaded inline");
+    }
+    linux_PrintFrameStats(&Stats, WallSeconds);
+    if(!Replay.Frames)
+    {
+        printf("Input:\t\t%lld scripted transitions, %lld buttons moved more than once in a frame, %lld unlisted, %lld dropped\n",
+               (long long) Script.Stats.EventCount, (long long) Script.Stats.MultiTransitionCount, (long long) Script.Stats.UnlistedCount, (long long) Script.Ring.DroppedCount);
+    }
+    if(Stats.FrameCount)
+    {
+        float64 FramePixelCount = (float64) BackBuffer.BitmapWidth * (float64) BackBuffer.BitmapHeight;
+        printf("Present:\t%s, %0.2f%% dirty avg\t %0.2f%% max\t %d frames with nothing to present\n",
+               Platform.DirtyRects ? "dirty rects" : "full buffer", 100.0 * (float64) Stats.DirtyPixelCount / (FramePixelCount * (float64) Stats.FrameCount),
+               100.0 * Stats.MaxDirtyFraction, Stats.CleanFrameCount);
+        printf("\t\t%0.2f MB %s, %0.4f ms/frame, front buffer %016llx\n", (float64) Stats.PresentedBytes / (float64) Megabytes(1), Scaler ? "upscaled" : "copied",
+               Stats.PresentMS / (float64) Stats.FrameCount, (unsigned long long) linux_HashBuffer(&FrontBuffer));
+        if(Scaler)
+        {
+            printf("Upscale:\t%dx%d to %dx%d, %s", BackBuffer.BitmapWidth, BackBuffer.BitmapHeight, FrontBuffer.BitmapWidth, FrontBuffer.BitmapHeight, ScaleFilterNames[Scaler->Filter]);
+            if(Scaler->Filter == SCALE_FILTER_NEAREST)
+            {
+                printf(" x%d", Scaler->Factor);
+            }
+            printf("\n");
+        }
+    }
+
+    if(Settings.DumpPath)
+    {
+        if(linux_DumpBuffer(&FrontBuffer, Settings.DumpPath))
+        {
+            printf("Dump:\t\t%s\n", Settings.DumpPath);
+        }
+        else
+        {
+            fprintf(stderr, "Can't write %s\n", Settings.DumpPath);
+        }
+    }
+
+    if(CaptureMemory)
+    {
+        capture_End(&Capture);
+        pthread_join(CaptureThread, 0);
+        sem_destroy(&CaptureSemaphore);
+
+        printf("Capture:\t%lld frames to %s, %lld dropped with %d slots, %0.4f ms/frame to submit%s\n", (long long) Capture.WrittenCount, Settings.CapturePath,
+               (long long) Capture.DroppedCount, Capture.SlotCount, Stats.FrameCount ? (Stats.CaptureMS / (float64) Stats.FrameCount) : 0.0,
+               Capture.WriteFailed ? ", WRITE FAILED" : "");
+        linux_FreeMemory(CaptureMemory, CaptureMemorySize);
+    }
+
+    char HistogramText[256];
+    frame_FormatHistogram(&FrameHistogram, HistogramText, sizeof(HistogramText));
+    if(FrameNS)
+    {
+        printf("Frame lock:\t%d Hz, sleeping to %d us before each deadline\n", Settings.GameUpdateHz, Settings.SpinUS);
+    }
+    printf("Frame time:\t%s", HistogramText);
+
+    if(DebugTable)
+    {
+        local char ProfileText[Kilobytes(64)];
+        debug_FormatCollation(&DebugCollation, ProfileText, sizeof(ProfileText));
+        printf("Profile:\n%s", ProfileText);
+        linux_FreeMemory(DebugTable, sizeof(DEBUG_TABLE));
+    }
+
+    if(LogThread.Writer.WrittenCount || LogThread.DroppedCount)
+    {
+        printf("Log:\t\t%lld records written, %lld dropped\n", (long long) LogThread.Writer.WrittenCount, (long long) LogThread.DroppedCount);
+    }
+
+    if(DebugTrace.File)
+    {
+        printf("Trace:\t\t%llu blocks to %s\n", (unsigned long long) DebugTrace.EventCount, Settings.TracePath);
+        debug_EndTrace(&DebugTrace);
+    }
+
+    int Result = 0;
+
+    if(Replay.RecordFile)
+    {
+        printf("Recorded:\t%d frames to %s\n", Replay.RecordedFrameCount, Settings.RecordPath);
+        linux_EndRecording(&Replay);
+    }
+
+    if(Replay.Frames)
+    {
+        printf("Replay:\t\t%d frame recording, %d full passes, %s\n", Replay.FrameCount, Replay.PassCount,
+               (Replay.PassCount < 2) ? "run more frames to compare passes" : (Replay.Diverged ? "DIVERGED" : "deterministic"));
+
+        munmap(Replay.Mapping, Replay.MappingSize);
+        Result = Replay.Diverged ? 1 : 0;
+    }
+
+    //No load may still be reading the mapping
+    if(Platform.BackgroundQueue)
+    {
+        jobs_CompleteAllWork(Platform.BackgroundQueue);
+    }
+
+    if(Platform.AssetPackMemory)
+    {
+        munmap(Platform.AssetPackMemory, (size_t) Platform.AssetPackSize);
+    }
+
+    linux_FreeMemory(Samples, SoundOutput.SecondaryBufferSize);
+    linux_FreeMemory(BackBuffer.BitmapMemory, BackBuffer.BitmapMemory_Size);
+    linux_FreeMemory(FrontBuffer.BitmapMemory, FrontBuffer.BitmapMemory_Size);
+    if(ConvertedBuffer.BitmapMemory)
+    {
+        linux_FreeMemory(ConvertedBuffer.BitmapMemory, ConvertedBuffer.BitmapMemory_Size);
+    }
+    if(ScaleMemory)
+    {
+        linux_FreeMemory(ScaleMemory, ScaleMemorySize);
+    }
+
+    return Result;
+}
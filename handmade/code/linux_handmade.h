@@ -0,0 +1,206 @@
+struct LINUX_OFFSCREEN_BUFFER
+{
+    void *BitmapMemory;
+    int BitmapWidth;
+    int BitmapHeight;
+    int Pitch;
+    int BitmapMemory_Size;
+    HANDMADE_PIXEL_FORMAT Format;
+};
+
+//Entry points from the currently loaded libhandmade.so
+struct LINUX_GAME_CODE
+{
+    void *Library;
+    uint64 LastWriteTime;
+    handmade_game_update_render *UpdateAndRender;
+    handmade_game_get_sound_samples *GetSoundSamples;
+    bool32 IsValid;
+};
+
+//Game memory block and how the kernel ended up backing it
+struct LINUX_GAME_MEMORY
+{
+    void *Base;
+    size_t Size;
+    bool32 AtFixedBase;
+    bool32 HugePages; //Explicit MAP_HUGETLB pages, otherwise transparent huge pages were only requested
+};
+
+//Null audio device, samples are counted but never played
+struct LINUX_SOUND_OUTPUT
+{
+    int SampleRate;
+    uint32 RunningSampleIndex;
+    int BytesPerSample;
+    int SecondaryBufferSize;
+    int SamplesPerFrame;
+};
+
+enum LINUX_RUN_MODE
+{
+    LINUX_RUN_MODE_GAME, //Game update loop
+    LINUX_RUN_MODE_TILES, //Single thread against tiled rendering
+    LINUX_RUN_MODE_JOBSTRESS, //Job system correctness under nested pushes and stealing
+    LINUX_RUN_MODE_JOBBENCH, //Job system throughput and steal rate
+    LINUX_RUN_MODE_OSCBENCH, //Wavetable oscillators against per sample sinf
+    LINUX_RUN_MODE_MIXBENCH, //Voice mixer cost against voice count
+    LINUX_RUN_MODE_AUDIO, //Real time game loop feeding the audio thread, reports latency and underruns
+    LINUX_RUN_MODE_REPLAY, //Game loop driven by a recording, looped from its snapshot
+    LINUX_RUN_MODE_LOGBENCH, //Cost to the logging thread of fprintf against the asynchronous log
+    LINUX_RUN_MODE_LATENCY, //Fixed against adaptive audio write-ahead on a simulated clock with synthetic jitter
+
+    LINUX_RUN_MODE_COUNT
+};
+
+global const char *LinuxRunModeNames[LINUX_RUN_MODE_COUNT] = {"game", "tiles", "jobstress", "jobbench", "oscbench", "mixbench", "audio", "replay", "logbench", "latency"};
+
+//Command line options for a headless run
+struct LINUX_SETTINGS
+{
+    int Width;
+    int Height;
+    int FrameCount;
+    int SampleRate;
+    int DeviceSampleRate; //Audio mode device, resampled to from SampleRate when they differ, 0 until parsed means the same
+    RESAMPLE_QUALITY ResampleQuality;
+    int GameUpdateHz;
+    SIMD_LEVEL SimdLevel;
+    int WorkerCount;
+    int TileWidth;
+    int TileHeight;
+    LINUX_RUN_MODE Mode;
+    bool32 PrintFrames;
+    int AudioLatencyMS; //How far the game writes ahead of the device
+    int StallMS; //Audio mode sleeps this long once a second to force underruns
+    bool32 AdaptiveLatency; //Audio mode lets AUDIO_LATENCY_CONTROLLER pick the write-ahead, -l becomes its ceiling
+    int JitterUS; //Audio and latency modes make every game frame and device wake up to this much late, at random
+    char *AudioOutputPath; //Audio mode sink, raw 16 bit stereo, 0 discards
+    char *RecordPath; //Game mode records its input here
+    char *ReplayPath; //Replay mode input
+    bool32 LockFrameRate; //Game mode waits out each frame to GameUpdateHz instead of running flat out
+    int SpinUS; //Tail of each wait that is busy-waited rather than slept
+    char *TracePath; //Game and replay modes write every timed block here as a Chrome trace
+    char *AssetPath; //Pack mapped for the game, 0 tries handmade.hha next to the executable
+    bool32 FullPresent; //Game and replay modes present, and so redraw, the whole buffer every frame
+    bool32 HalfResolution; //Game renders at half of Width x Height and is upscaled to it when presenting
+    SCALE_FILTER ScaleFilter;
+    HANDMADE_PIXEL_FORMAT PixelFormat; //What the game renders into, widened to BGRX8888 when presenting
+    char *DumpPath; //Game and replay modes write the last presented frame here as a binary PPM
+    char *CapturePath; //Game and replay modes write every presented frame here as Y4M
+    int CaptureSlotCount; //Frames the writer thread may fall behind before new ones are dropped
+};
+
+//Simulated device: drains the ring one period at a time on a wall clock schedule, like a sound card pulling from its buffer
+struct LINUX_AUDIO_DEVICE
+{
+    AUDIO_RING_BUFFER *Ring;
+    int SampleRate;
+    int PeriodFrames;
+    FILE *Sink;
+    int16 *PeriodSamples;
+    uint64 StartClock;
+    uint64 WakeJitterNS;
+    uint32 RandomState;
+    int64 FramesPlayed;
+    bool32 volatile Running;
+    pthread_t Thread;
+};
+
+//Input recording, a snapshot of permanent storage followed by one REPLAY_FRAME per frame
+struct LINUX_REPLAY
+{
+    //Recording
+    FILE *RecordFile;
+    int RecordedFrameCount;
+
+    //Playback, the whole file is mapped up front so no file IO lands inside a timed frame
+    void *Mapping;
+    size_t MappingSize;
+    REPLAY_HEADER *Header;
+    void *Snapshot;
+    REPLAY_FRAME *Frames;
+    int FrameCount;
+    int FrameIndex;
+    HANDMADE_WORK_QUEUE *BackgroundQueue; //Drained before the snapshot goes back, read-ahead may still be filling the old pass's stream, 0 if none
+
+    //Permanent storage is hashed at the end of every pass, any difference means playback isn't deterministic
+    int PassCount;
+    uint64 FirstPassChecksum;
+    bool32 Diverged;
+};
+
+//Running totals for the frame loop, only the game update is measured
+struct LINUX_FRAME_STATS
+{
+    int FrameCount;
+    float64 TotalMS;
+    float64 MinMS;
+    float64 MaxMS;
+    uint64 TotalCycles;
+    uint64 MinCycles;
+    uint64 MaxCycles;
+    uint64 PixelCount;
+    uint64 SampleCount;
+    uint64 DirtyPixelCount;
+    float64 MaxDirtyFraction;
+    int CleanFrameCount; //Nothing to present
+    uint64 PresentedBytes;
+    float64 PresentMS;
+    float64 CaptureMS; //Copying frames into the capture pool
+};
+
+//Shared by every job of a stress or benchmark run, nodes form an implicit tree (children of N are N * FanOut + 1...)
+struct LINUX_JOB_TEST
+{
+    HANDMADE_PLATFORM *Platform;
+    uint32 NodeCount;
+    uint32 FanOut; //0 for flat runs where the main thread pushes every node
+    uint32 SpinScale;
+    uint32 volatile *Hits;
+};
+
+struct LINUX_JOB_TEST_NODE
+{
+    LINUX_JOB_TEST *Test;
+    uint32 Index;
+};
+
+//Scripted input runs on a clock of its own, one -u Hz frame per frame in nanoseconds, so every run sees the same event times
+struct LINUX_SCRIPTED_INPUT
+{
+    INPUT_EVENT_RING Ring;
+    uint64 FrameTicks;
+    INPUT_STATS Stats;
+};
+
+//Totals of one latency simulation run
+struct LINUX_LATENCY_RUN
+{
+    int FrameCount;
+    int64 UnderrunCount;
+    int64 UnderrunFrames;
+    int64 WidenCount;
+    float64 TotalLatencyMS;
+    float64 MinLatencyMS;
+    float64 MaxLatencyMS;
+    float64 FinalLatencyMS;
+};
+
+//Shared by every job of a log benchmark run
+struct LINUX_LOG_BENCH
+{
+    FILE *Sink; //Synchronous runs print here directly
+    int RecordsPerJob;
+    bool32 Async;
+};
+
+//Log rings and the thread writing them out, Writer must not move while the thread runs
+struct LINUX_LOG_THREAD
+{
+    DEBUG_LOG *Log;
+    DEBUG_LOG_WRITER Writer;
+    sem_t Semaphore;
+    pthread_t Thread;
+    int64 DroppedCount; //Filled in when the thread stops
+};
@@ -1,34 +1,23 @@
-#include <stdint.h>
-#include <math.h>
-
-//Static can have three different meanings:
-#define global static //Global access to variable
-#define internal static //Variable local to source file only
-#define local static //Variable persists after stepping out of scope (this should be avoided when possible)
-
-#define Pi32 3.14159265359f
-
-typedef uint8_t uint8;
-typedef uint16_t uint16;
-typedef uint32_t uint32;
-typedef uint64_t uint64;
-
-typedef int8_t int8;
-typedef int16_t int16;
-typedef int32_t int32;
-typedef int64_t int64;
-
-typedef int32 bool32;
-
-typedef float float32;
-typedef double float64;
-
-#include "handmade.cpp"
+#include "handmade.h"
+#include "handmade_jobs.cpp"
+#include "handmade_audio.cpp"
+#include "handmade_input.cpp"
+#include "handmade_replay.h"
 
 #include <windows.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
 #include <xinput.h>
 #include <dsound.h>
+#include <mmdeviceapi.h>
+#include <audioclient.h>
+
+#include "handmade_frametime.h"
+#include "handmade_debug.cpp"
+#include "handmade_scale.cpp"
+#include "handmade_pixel.cpp"
+#include "handmade_resample.cpp"
  
 #include "win32_handmade.h"
 
@@ -62,6 +51,16 @@ global win32_xinput_SetState *XInputSetState_ = XInputSetStateStub;
 global LPDIRECTSOUNDBUFFER GlobalSecondaryBuffer;
 global bool32 GlobalRunning; 
 global WIN32_OFFSCREEN_BUFFER GlobalBackBuffer;
+global WIN32_OFFSCREEN_BUFFER GlobalOutputBuffer;
+global WIN32_OFFSCREEN_BUFFER GlobalConvertedBuffer; //Backbuffer widened to BGRX8888 when the game renders another format
+global SCALE_CONTEXT GlobalScaler;
+global void *GlobalScalerMemory;
+global SCALE_FILTER GlobalScaleFilter = SCALE_FILTER_BILINEAR;
+global bool32 GlobalReplayTogglePressed;
+global bool32 GlobalFrameHistogramDumpPressed;
+global bool32 GlobalTraceTogglePressed;
+global int64 GlobalPerfCountFrequency;
+global INPUT_EVENT_RING GlobalKeyboardRing; //Filled by the window procedure, which runs on the frame thread
 
 //Rename to prevent conflicts with headers
 #define XInputGetState XInputGetState_
@@ -90,6 +89,45 @@ internal void win32_LoadXInput(void)
 }
 
 //Load and initialise DirectSound (OOP API)
+//Rate the shared mode engine mixes the default output at, DirectSound converts anything else to it. 0 if it can't be read
+internal int32 win32_GetNativeSampleRate(void)
+{
+    int32 Result = 0;
+    bool32 Initialised = SUCCEEDED(CoInitializeEx(0, COINIT_APARTMENTTHREADED));
+
+    IMMDeviceEnumerator *Enumerator;
+    if(SUCCEEDED(CoCreateInstance(__uuidof(MMDeviceEnumerator), 0, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), (void **) &Enumerator)))
+    {
+        IMMDevice *Device;
+        if(SUCCEEDED(Enumerator->GetDefaultAudioEndpoint(eRender, eConsole, &Device)))
+        {
+            IAudioClient *Client;
+            if(SUCCEEDED(Device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, 0, (void **) &Client)))
+            {
+                WAVEFORMATEX *MixFormat;
+                if(SUCCEEDED(Client->GetMixFormat(&MixFormat)))
+                {
+                    Result = (int32) MixFormat->nSamplesPerSec;
+                    CoTaskMemFree(MixFormat);
+                }
+
+                Client->Release();
+            }
+
+            Device->Release();
+        }
+
+        Enumerator->Release();
+    }
+
+    if(Initialised)
+    {
+        CoUninitialize();
+    }
+
+    return Result;
+}
+
 internal void win32_InitDSound(HWND Window, int32 SampleRate, int32 BufferSize)
 {
     //Load library
@@ -174,8 +212,11 @@ internal void win32_ClearBuffer(WIN32_SOUND_OUTPUT *SoundOutput)
 
 }
 
-internal void win32_FillSoundBuffer(WIN32_SOUND_OUTPUT *SoundOutput, DWORD ByteToLock, DWORD BytesToWrite, HANDMADE_SOUND_BUFFER *SourceBuffer)
+//Copies from the ring straight into the locked regions, whatever the ring is short is written as silence
+internal void win32_FillSoundBuffer(WIN32_SOUND_OUTPUT *SoundOutput, DWORD ByteToLock, DWORD BytesToWrite)
 {
+    TIMED_FUNCTION();
+
     VOID *Region1;
     DWORD Region1Size;
     VOID *Region2;
@@ -183,32 +224,74 @@ internal void win32_FillSoundBuffer(WIN32_SOUND_OUTPUT *SoundOutput, DWORD ByteT
     if(SUCCEEDED(GlobalSecondaryBuffer->Lock(ByteToLock, BytesToWrite, &Region1, &Region1Size, &Region2, &Region2Size, 0)))
     {
         DWORD Region1SampleCount = Region1Size / SoundOutput->BytesPerSample;
-        int16 *DestSample = (int16 *) Region1;
-        int16 *SourceSample = SourceBuffer->Samples;
+        audio_ReadFrames(SoundOutput->Ring, (int16 *) Region1, Region1SampleCount);
+        SoundOutput->RunningSampleIndex += Region1SampleCount;
 
-        for(DWORD SampleIndex = 0; SampleIndex < Region1SampleCount; ++SampleIndex)
-        {   
-            *DestSample++ = *SourceSample++;
-            *DestSample++ = *SourceSample++;
-
-            ++SoundOutput->RunningSampleIndex;
-        }
-    
         DWORD Region2SampleCount = Region2Size / SoundOutput->BytesPerSample;
-        DestSample = (int16 *) Region2;
-       
-        for(DWORD SampleIndex = 0; SampleIndex < Region2SampleCount; ++SampleIndex)
-        {    
-            *DestSample++ = *SourceSample++;
-            *DestSample++ = *SourceSample++;
-
-            ++SoundOutput->RunningSampleIndex;
-        }
-    
+        audio_ReadFrames(SoundOutput->Ring, (int16 *) Region2, Region2SampleCount);
+        SoundOutput->RunningSampleIndex += Region2SampleCount;
+
         GlobalSecondaryBuffer->Unlock(Region1, Region1Size, Region2, Region2Size);
     }
 }
 
+//Audio thread, owns all DirectSound cursor math so a slow game frame only drains the ring instead of glitching
+internal DWORD WINAPI win32_AudioThreadProc(LPVOID Parameter)
+{
+    WIN32_SOUND_OUTPUT *SoundOutput = (WIN32_SOUND_OUTPUT *) Parameter;
+
+    DWORD SafetyBytes = SoundOutput->SafetySampleCount * SoundOutput->BytesPerSample;
+    DWORD SleepMS = (1000 * SoundOutput->SafetySampleCount) / (2 * SoundOutput->SampleRate);
+
+    if(SleepMS < 1)
+    {
+        SleepMS = 1;
+    }
+
+    bool32 FirstPass = true;
+
+    while(GlobalRunning)
+    {
+        DWORD PlayCursor;
+        DWORD WriteCursor;
+
+        if(SUCCEEDED(GlobalSecondaryBuffer->GetCurrentPosition(&PlayCursor, &WriteCursor)))
+        {
+            DWORD BufferSize = SoundOutput->SecondaryBufferSize;
+            DWORD ByteToLock = ((SoundOutput->RunningSampleIndex * SoundOutput->BytesPerSample) % BufferSize);
+
+            //Distances measured forward from the play cursor so wrap around never confuses ahead with behind
+            DWORD WriteAhead = (WriteCursor - PlayCursor + BufferSize) % BufferSize;
+            DWORD OurAhead = (ByteToLock - PlayCursor + BufferSize) % BufferSize;
+
+            //Start at the write cursor, or jump back to it if the play cursor overtook us
+            if(FirstPass || (OurAhead < WriteAhead) || (OurAhead > WriteAhead + SafetyBytes))
+            {
+                if(!FirstPass)
+                {
+                    ++SoundOutput->DeviceResyncCount;
+                }
+
+                SoundOutput->RunningSampleIndex = WriteCursor / SoundOutput->BytesPerSample;
+                ByteToLock = WriteCursor;
+                OurAhead = WriteAhead;
+                FirstPass = false;
+            }
+
+            DWORD TargetAhead = WriteAhead + SafetyBytes;
+
+            if(TargetAhead > OurAhead)
+            {
+                win32_FillSoundBuffer(SoundOutput, ByteToLock, TargetAhead - OurAhead);
+            }
+        }
+
+        Sleep(SleepMS);
+    }
+
+    return 0;
+}
+
 //Replaces GetClientRect calls
 internal WIN32_WINDOW_DIMENSIONS win32_GetWindowDimensions(HWND Window)
 {
@@ -224,7 +307,7 @@ internal WIN32_WINDOW_DIMENSIONS win32_GetWindowDimensions(HWND Window)
 }
 
 //Device Independant Bitmap, function for writing into bitmaps for Windows to display through it's graphic library GDI
-internal void win32_ResizeDIBSection(WIN32_OFFSCREEN_BUFFER *Buffer, int Width, int Height)
+internal void win32_ResizeDIBSection(WIN32_OFFSCREEN_BUFFER *Buffer, int Width, int Height, HANDMADE_PIXEL_FORMAT Format)
 {
     //If there's anything in the bitmap memory, then free first so it can be written again
     if(Buffer->BitmapMemory)
@@ -235,7 +318,8 @@ internal void win32_ResizeDIBSection(WIN32_OFFSCREEN_BUFFER *Buffer, int Width,
     //Pass function inputs to buffer dimensions
     Buffer->BitmapWidth = Width;
     Buffer->BitmapHeight = Height;
-    int BytesPerPixel = 4;
+    Buffer->Format = Format;
+    int BytesPerPixel = PixelFormatBytes[Format];
 
     Buffer->BitmapInfo.bmiHeader.biSize = sizeof(Buffer->BitmapInfo.bmiHeader);
     Buffer->BitmapInfo.bmiHeader.biWidth = Buffer->BitmapWidth;
@@ -252,14 +336,230 @@ internal void win32_ResizeDIBSection(WIN32_OFFSCREEN_BUFFER *Buffer, int Width,
     Buffer->Pitch = Buffer->BitmapWidth * BytesPerPixel;
 }
 
+//Window surface sized copy of the backbuffer, upscaled here so GDI only ever copies pixels one to one
+//Rebuilt whenever the window changes size, returns true when it was so nothing of the old one can be reused
+internal bool32 win32_ResizeOutputBuffer(WIN32_OFFSCREEN_BUFFER *Buffer, int WindowWidth, int WindowHeight)
+{
+    if(GlobalScalerMemory && (GlobalOutputBuffer.BitmapWidth == WindowWidth) && (GlobalOutputBuffer.BitmapHeight == WindowHeight) &&
+       (GlobalScaler.SourceWidth == Buffer->BitmapWidth) && (GlobalScaler.SourceHeight == Buffer->BitmapHeight))
+    {
+        return false;
+    }
+
+    win32_ResizeDIBSection(&GlobalOutputBuffer, WindowWidth, WindowHeight, HANDMADE_PIXEL_FORMAT_BGRX8888);
+
+    if(GlobalScalerMemory)
+    {
+        VirtualFree(GlobalScalerMemory, 0, MEM_RELEASE);
+    }
+
+    GlobalScalerMemory = VirtualAlloc(0, scale_GetMemorySize(Buffer->BitmapWidth, WindowWidth, WindowHeight), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    scale_InitContext(&GlobalScaler, GlobalScalerMemory, GlobalScaleFilter, Buffer->BitmapWidth, Buffer->BitmapHeight, WindowWidth, WindowHeight);
+
+    return true;
+}
+
 //Primary function for passing infomation to the game's window
-internal void win32_DisplayBuffer_Window(WIN32_OFFSCREEN_BUFFER *Buffer, HDC DeviceContext, int WindowWidth, int WindowHeight)
+//A window the size of the backbuffer takes it as is, any other size gets it through the upscaler first
+//With Dirty set only the window pixels its rectangles reach are redrawn, the rest of the window is clipped out
+//A backbuffer in another format is widened to BGRX8888 before either, only where it is dirty
+internal void win32_DisplayBuffer_Window(WIN32_OFFSCREEN_BUFFER *Buffer, HDC DeviceContext, int WindowWidth, int WindowHeight, HANDMADE_DIRTY_RECTS *Dirty)
 {
-    //Copy rectangle from one buffer to another
-    StretchDIBits(DeviceContext, 0, 0, WindowWidth, WindowHeight, 0, 0, Buffer->BitmapWidth, Buffer->BitmapHeight, Buffer->BitmapMemory, &Buffer->BitmapInfo, DIB_RGB_COLORS, SRCCOPY);
+    //Minimised
+    if((WindowWidth <= 0) || (WindowHeight <= 0))
+    {
+        return;
+    }
+
+    if(Buffer->Format != HANDMADE_PIXEL_FORMAT_BGRX8888)
+    {
+        HANDMADE_OFFSCREEN_BUFFER Source = {};
+        Source.BitmapMemory = Buffer->BitmapMemory;
+        Source.BitmapWidth = Buffer->BitmapWidth;
+        Source.BitmapHeight = Buffer->BitmapHeight;
+        Source.Pitch = Buffer->Pitch;
+        Source.Format = Buffer->Format;
+
+        HANDMADE_OFFSCREEN_BUFFER Dest = {};
+        Dest.BitmapMemory = GlobalConvertedBuffer.BitmapMemory;
+        Dest.BitmapWidth = GlobalConvertedBuffer.BitmapWidth;
+        Dest.BitmapHeight = GlobalConvertedBuffer.BitmapHeight;
+        Dest.Pitch = GlobalConvertedBuffer.Pitch;
+
+        HANDMADE_RECT Whole = {0, 0, Buffer->BitmapWidth, Buffer->BitmapHeight};
+        HANDMADE_RECT *ConvertRects = Dirty ? Dirty->Rects : &Whole;
+        int ConvertRectCount = Dirty ? Dirty->RectCount : 1;
+
+        for(int RectIndex = 0; RectIndex < ConvertRectCount; ++RectIndex)
+        {
+            pixel_ConvertRect(&Dest, &Source, ConvertRects[RectIndex]);
+        }
+
+        Buffer = &GlobalConvertedBuffer;
+    }
+
+    WIN32_OFFSCREEN_BUFFER *Present = Buffer;
+    HANDMADE_RECT Rects[HANDMADE_MAX_DIRTY_RECTS];
+    int RectCount = 0;
+
+    if((WindowWidth != Buffer->BitmapWidth) || (WindowHeight != Buffer->BitmapHeight))
+    {
+        if(win32_ResizeOutputBuffer(Buffer, WindowWidth, WindowHeight))
+        {
+            Dirty = 0;
+        }
+
+        HANDMADE_OFFSCREEN_BUFFER Source = {};
+        Source.BitmapMemory = Buffer->BitmapMemory;
+        Source.BitmapWidth = Buffer->BitmapWidth;
+        Source.BitmapHeight = Buffer->BitmapHeight;
+        Source.Pitch = Buffer->Pitch;
+
+        HANDMADE_OFFSCREEN_BUFFER Dest = {};
+        Dest.BitmapMemory = GlobalOutputBuffer.BitmapMemory;
+        Dest.BitmapWidth = GlobalOutputBuffer.BitmapWidth;
+        Dest.BitmapHeight = GlobalOutputBuffer.BitmapHeight;
+        Dest.Pitch = GlobalOutputBuffer.Pitch;
+
+        if(Dirty)
+        {
+            for(int RectIndex = 0; RectIndex < Dirty->RectCount; ++RectIndex)
+            {
+                Rects[RectCount++] = scale_Upscale(&GlobalScaler, &Source, &Dest, &Dirty->Rects[RectIndex]);
+            }
+        }
+        else
+        {
+            scale_Upscale(&GlobalScaler, &Source, &Dest, 0);
+        }
+
+        Present = &GlobalOutputBuffer;
+    }
+    else if(Dirty)
+    {
+        for(int RectIndex = 0; RectIndex < Dirty->RectCount; ++RectIndex)
+        {
+            Rects[RectCount++] = Dirty->Rects[RectIndex];
+        }
+    }
+
+    HRGN Clip = 0;
+
+    if(Dirty)
+    {
+        if(RectCount == 0)
+        {
+            return;
+        }
+
+        for(int RectIndex = 0; RectIndex < RectCount; ++RectIndex)
+        {
+            HRGN RectRegion = CreateRectRgn(Rects[RectIndex].MinX, Rects[RectIndex].MinY, Rects[RectIndex].MaxX, Rects[RectIndex].MaxY);
+
+            if(Clip)
+            {
+                CombineRgn(Clip, Clip, RectRegion, RGN_OR);
+                DeleteObject(RectRegion);
+            }
+            else
+            {
+                Clip = RectRegion;
+            }
+        }
+
+        SelectClipRgn(DeviceContext, Clip);
+    }
+
+    //Copy rectangle from one buffer to another, the same size so GDI never stretches
+    StretchDIBits(DeviceContext, 0, 0, Present->BitmapWidth, Present->BitmapHeight, 0, 0, Present->BitmapWidth, Present->BitmapHeight, Present->BitmapMemory, &Present->BitmapInfo, DIB_RGB_COLORS, SRCCOPY);
+
+    if(Clip)
+    {
+        SelectClipRgn(DeviceContext, 0);
+        DeleteObject(Clip);
+    }
 }
 
 //Callback function as Windows is free to pass this function when it pleases                                      
+//GetMessageTime is milliseconds on the GetTickCount clock, moved onto the performance counter by how long ago it was
+internal uint64 win32_GetMessageCounter(void)
+{
+    LARGE_INTEGER Now;
+    QueryPerformanceCounter(&Now);
+
+    DWORD AgeMS = GetTickCount() - (DWORD) GetMessageTime();
+    int64 AgeCounts = ((int64) AgeMS * GlobalPerfCountFrequency) / 1000;
+
+    return (uint64) ((AgeCounts < Now.QuadPart) ? (Now.QuadPart - AgeCounts) : 0);
+}
+
+//Pad buttons by HANDMADE_INPUT_BUTTON
+global WORD Win32PadButtonBits[HANDMADE_INPUT_BUTTON_COUNT] =
+{
+    XINPUT_GAMEPAD_Y, XINPUT_GAMEPAD_A, XINPUT_GAMEPAD_X, XINPUT_GAMEPAD_B, XINPUT_GAMEPAD_LEFT_SHOULDER, XINPUT_GAMEPAD_RIGHT_SHOULDER,
+};
+
+//About 1 kHz with the 1 ms scheduler period, every change in between is pushed with the time it was seen
+internal DWORD WINAPI win32_PadPollThreadProc(LPVOID Parameter)
+{
+    WIN32_PAD_POLL *Poll = (WIN32_PAD_POLL *) Parameter;
+
+    int PadCount = HANDMADE_INPUT_MAX_CONTROLLERS - (HANDMADE_INPUT_KEYBOARD + 1);
+    if(PadCount > XUSER_MAX_COUNT)
+    {
+        PadCount = XUSER_MAX_COUNT;
+    }
+
+    while(Poll->Running)
+    {
+        for(int PadIndex = 0; PadIndex < PadCount; ++PadIndex)
+        {
+            if(Poll->SkipPolls[PadIndex] > 0)
+            {
+                --Poll->SkipPolls[PadIndex];
+                continue;
+            }
+
+            //An unplugged pad lets go of everything it was holding
+            XINPUT_STATE ControllerState;
+            WORD Buttons = 0;
+
+            if(XInputGetState(PadIndex, &ControllerState) == ERROR_SUCCESS)
+            {
+                Buttons = ControllerState.Gamepad.wButtons;
+            }
+            else
+            {
+                Poll->SkipPolls[PadIndex] = 1000;
+            }
+
+            WORD Changed = Buttons ^ Poll->Buttons[PadIndex];
+
+            if(Changed)
+            {
+                LARGE_INTEGER Now;
+                QueryPerformanceCounter(&Now);
+
+                for(int ButtonIndex = 0; ButtonIndex < HANDMADE_INPUT_BUTTON_COUNT; ++ButtonIndex)
+                {
+                    WORD Bit = Win32PadButtonBits[ButtonIndex];
+
+                    if(Changed & Bit)
+                    {
+                        input_PushEvent(&Poll->Ring, (uint64) Now.QuadPart, HANDMADE_INPUT_KEYBOARD + 1 + PadIndex, ButtonIndex, (Buttons & Bit) != 0);
+                    }
+                }
+
+                Poll->Buttons[PadIndex] = Buttons;
+            }
+        }
+
+        Sleep(1);
+    }
+
+    return 0;
+}
+
 LRESULT CALLBACK win32_MainWindow_Callback(HWND Window, UINT UserMessage, WPARAM WParam, LPARAM LParam)
 {
     LRESULT Result = 0;
@@ -268,27 +568,27 @@ LRESULT CALLBACK win32_MainWindow_Callback(HWND Window, UINT UserMessage, WPARAM
     {
         case WM_SIZE:
         {   
-            OutputDebugStringA("WM_SIZE\n");
+            debug_Message("WM_SIZE");
             break;
         }
 
         case WM_DESTROY:
         {
             GlobalRunning = false;
-            OutputDebugStringA("WM_DESTROY\n");
+            debug_Message("WM_DESTROY");
             break;
         }
 
         case WM_CLOSE:
         {
             GlobalRunning = false;
-            OutputDebugStringA("WM_CLOSE\n");
+            debug_Message("WM_CLOSE");
             break;
         }
 
         case WM_ACTIVATEAPP:
         {
-            OutputDebugStringA("WM_ACTIVATEAPP\n");
+            debug_Message("WM_ACTIVATEAPP");
             break;
         }
 
@@ -307,53 +607,49 @@ LRESULT CALLBACK win32_MainWindow_Callback(HWND Window, UINT UserMessage, WPARAM
 
             if(WasDown != IsDown)
             {
-                if(VKCode == 'W')
+                int ButtonIndex = -1;
+
+                if((VKCode == 'W') || (VKCode == VK_UP))
                 {
-                    OutputDebugStringA("W\n");
+                    ButtonIndex = HANDMADE_INPUT_BUTTON_UP;
                 }
-                else if(VKCode == 'A')
+                else if((VKCode == 'S') || (VKCode == VK_DOWN))
                 {
-                    OutputDebugStringA("A\n");
+                    ButtonIndex = HANDMADE_INPUT_BUTTON_DOWN;
                 }
-                else if(VKCode == 'S')
+                else if((VKCode == 'A') || (VKCode == VK_LEFT))
                 {
-                    OutputDebugStringA("S\n");
+                    ButtonIndex = HANDMADE_INPUT_BUTTON_LEFT;
                 }
-                else if(VKCode == 'D')
+                else if((VKCode == 'D') || (VKCode == VK_RIGHT))
                 {
-                    OutputDebugStringA("D\n");
+                    ButtonIndex = HANDMADE_INPUT_BUTTON_RIGHT;
                 }
                 else if(VKCode == 'Q')
                 {
-                    OutputDebugStringA("Q\n");
+                    ButtonIndex = HANDMADE_INPUT_BUTTON_LEFT_SHOULDER;
                 }
                 else if(VKCode == 'E')
                 {
-                    OutputDebugStringA("E\n");
-                }
-                else if(VKCode == VK_UP)
-                {
-                    OutputDebugStringA("Up\n");
-                }
-                else if(VKCode == VK_DOWN)
-                {
-                    OutputDebugStringA("Down\n");
+                    ButtonIndex = HANDMADE_INPUT_BUTTON_RIGHT_SHOULDER;
                 }
-                else if(VKCode == VK_LEFT)
+                else if((VKCode == 'L') && IsDown)
                 {
-                    OutputDebugStringA("Left\n");
+                    GlobalReplayTogglePressed = true;
                 }
-                else if(VKCode == VK_RIGHT)
+                else if((VKCode == 'H') && IsDown)
                 {
-                    OutputDebugStringA("Right\n");
+                    GlobalFrameHistogramDumpPressed = true;
                 }
-                else if(VKCode == VK_SPACE)
+                else if((VKCode == 'T') && IsDown)
                 {
-                    OutputDebugStringA("Space\n");
+                    GlobalTraceTogglePressed = true;
                 }
-                else if(VKCode == VK_ESCAPE)
+
+                //Stamped with when the key went down, not when the frame got round to dispatching it
+                if(ButtonIndex >= 0)
                 {
-                    OutputDebugStringA("Escape\n");
+                    input_PushEvent(&GlobalKeyboardRing, win32_GetMessageCounter(), HANDMADE_INPUT_KEYBOARD, ButtonIndex, IsDown);
                 }
             }
 
@@ -381,7 +677,7 @@ LRESULT CALLBACK win32_MainWindow_Callback(HWND Window, UINT UserMessage, WPARAM
             WIN32_WINDOW_DIMENSIONS WindowDimensions = win32_GetWindowDimensions(Window);
 
             //Call function to update window
-            win32_DisplayBuffer_Window(&GlobalBackBuffer, DeviceContext, WindowDimensions.Width, WindowDimensions.Height);
+            win32_DisplayBuffer_Window(&GlobalBackBuffer, DeviceContext, WindowDimensions.Width, WindowDimensions.Height, 0);
 
             EndPaint(Window, &Paint);
         }
@@ -397,201 +693,933 @@ LRESULT CALLBACK win32_MainWindow_Callback(HWND Window, UINT UserMessage, WPARAM
     return Result;
 }  
 
-internal void win32_xinput_ProcessDigitalButton(DWORD XInputButtonState, HANDMADE_INPUT_CONTROLLER_BUTTON_STATE *OldState, DWORD ButtonBit, HANDMADE_INPUT_CONTROLLER_BUTTON_STATE *NewState)
+//Called on the log thread, records arrive already formatted and terminated
+internal DEBUG_LOG_WRITE(win32_WriteLog)
 {
-    NewState->EndedDown = ((XInputButtonState & ButtonBit) == ButtonBit);
-    NewState->HalfTransitionCount = (OldState->EndedDown != NewState->EndedDown) ? 1 : 0;
+    (void) Context;
+    (void) Level;
+    (void) Length;
+    OutputDebugStringA(Text);
 }
 
-//Starting point
-//Entry point for any Windows application
-int CALLBACK WinMain(HINSTANCE Instance, HINSTANCE PrevInstance, LPSTR CommandLine, int CommandShow)
+internal DWORD WINAPI win32_LogThreadProc(LPVOID Parameter)
 {
-    LARGE_INTEGER PerfomanceCounterFrequency_Result;
-    QueryPerformanceFrequency(&PerfomanceCounterFrequency_Result);
-    int64 PerfomanceCounterFrequency = PerfomanceCounterFrequency_Result.QuadPart;
+    debug_LogWriterLoop((DEBUG_LOG_WRITER *) Parameter);
 
-    win32_LoadXInput(); //Load XInput dll
-    WNDCLASS WindowClass = {}; //Initialise everything in struct to 0
+    return 0;
+}
 
-    win32_ResizeDIBSection(&GlobalBackBuffer, 1280, 720);
+internal JOBS_SIGNAL_SEMAPHORE(win32_SignalSemaphore)
+{
+    ReleaseSemaphore((HANDLE) SemaphoreHandle, Count, 0);
+}
 
-    WindowClass.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC; //Create unique device context for this window
-    WindowClass.lpfnWndProc = win32_MainWindow_Callback; //Call the window process
-    WindowClass.hInstance = Instance; //Handle instance passed from win32_WinMain
-    WindowClass.lpszClassName = "HandmadeHeroWindowClass"; //Name of Window class
-    //WindowClass.hIcon;
+internal JOBS_WAIT_SEMAPHORE(win32_WaitSemaphore)
+{
+    WaitForSingleObjectEx((HANDLE) SemaphoreHandle, INFINITE, FALSE);
+}
 
-    if(RegisterClass(&WindowClass))
-    {
-        HWND Window = CreateWindowEx(0, WindowClass.lpszClassName, "Handmade Hero", WS_OVERLAPPEDWINDOW | WS_VISIBLE, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, 0, 0, Instance, 0); 
+struct WIN32_WORKER_INFO
+{
+    HANDMADE_WORK_QUEUE *Queue;
+    int ThreadIndex;
+};
 
-        if(Window) //Process message queue
-        {
-            //Specified CS_OWNDC so get one device context and use it forever
-            HDC DeviceContext = GetDC(Window);
-            
-            //Initialise audio buffer
-            WIN32_SOUND_OUTPUT SoundOutput = {};
+DWORD WINAPI win32_WorkerThreadProc(LPVOID Parameter)
+{
+    WIN32_WORKER_INFO *Info = (WIN32_WORKER_INFO *) Parameter;
+    jobs_WorkerLoop(Info->Queue, Info->ThreadIndex);
 
-            SoundOutput.SampleRate = 48000;
-            SoundOutput.RunningSampleIndex = 0;
-            SoundOutput.BytesPerSample = sizeof(int16) * 2;
-            SoundOutput.SecondaryBufferSize = SoundOutput.SampleRate * SoundOutput.BytesPerSample;
+    return 0;
+}
 
-            win32_InitDSound(Window, SoundOutput.SampleRate, SoundOutput.SecondaryBufferSize);
-            win32_ClearBuffer(&SoundOutput);
-            GlobalSecondaryBuffer->Play(0, 0, DSBPLAY_LOOPING);
-            
-            //Allocate memory for audio samples
-            int16 *Samples = (int16 * ) VirtualAlloc(0, SoundOutput.SecondaryBufferSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+//Workers live for the whole process, the calling thread becomes thread 0 and helps whenever it waits on the queue
+//Each queue gets its own semaphore and worker table, so a process can run several
+internal bool32 win32_MakeQueue(HANDMADE_WORK_QUEUE *Queue, int WorkerCount)
+{
+    int ThreadCount = WorkerCount + 1;
+    if(ThreadCount > JOBS_MAX_THREADS)
+    {
+        ThreadCount = JOBS_MAX_THREADS;
+    }
 
-            //Bools
-            bool32 SoundIsPlaying = false;
-            GlobalRunning = true;
+    JOBS_DEQUE *Deques = (JOBS_DEQUE *) VirtualAlloc(0, jobs_GetDequeMemorySize(ThreadCount), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    WIN32_WORKER_INFO *WorkerInfo = (WIN32_WORKER_INFO *) VirtualAlloc(0, sizeof(WIN32_WORKER_INFO) * ThreadCount, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    HANDLE SemaphoreHandle = CreateSemaphoreEx(0, 0, JOBS_MAX_THREADS * JOBS_DEQUE_SIZE, 0, 0, SEMAPHORE_ALL_ACCESS);
 
-            //Index controllers
-            HANDMADE_INPUT_USER Input[2] = {};
-            HANDMADE_INPUT_USER *NewInput = &Input[0];
-            HANDMADE_INPUT_USER *OldInput = &Input[1];
+    if(!Deques || !WorkerInfo || !SemaphoreHandle)
+    {
+        return false;
+    }
 
-            //Performance counters
-            LARGE_INTEGER LastCounter;
-            QueryPerformanceCounter(&LastCounter);
-            uint64 LastCycleCount = __rdtsc();
+    jobs_InitQueue(Queue, ThreadCount, Deques, SemaphoreHandle, win32_SignalSemaphore, win32_WaitSemaphore);
 
-            //Loop while program is running / until negative result from GetMessage
-            while(GlobalRunning)
-            {
-                MSG Messages;
+    for(int ThreadIndex = 1; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        WIN32_WORKER_INFO *Info = &WorkerInfo[ThreadIndex];
+        Info->Queue = Queue;
+        Info->ThreadIndex = ThreadIndex;
 
-                //PeekMessage keeps processing message queue without blocking when there are no messages available
-                while(PeekMessage(&Messages, 0, 0, 0, PM_REMOVE))
-                {
-                    if(Messages.message == WM_QUIT)
-                    {
-                        GlobalRunning = false;
-                    }
+        DWORD ThreadID;
+        HANDLE ThreadHandle = CreateThread(0, 0, win32_WorkerThreadProc, Info, 0, &ThreadID);
 
-                    TranslateMessage(&Messages);
-                    DispatchMessage(&Messages);
-                }
+        if(!ThreadHandle)
+        {
+            return false;
+        }
 
-                //Loop through all connected controllers
-                int MaxControllerCount = XUSER_MAX_COUNT;
-                if(MaxControllerCount > ArrayCount(NewInput->Controllers))
-                {
-                    MaxControllerCount = ArrayCount(NewInput->Controllers);
-                }
+        CloseHandle(ThreadHandle);
+    }
 
-                for(DWORD ControllerIndex = 0; ControllerIndex < MaxControllerCount; ++ControllerIndex)
-                {
-                    HANDMADE_INPUT_CONTROLLER *OldController = &OldInput->Controllers[ControllerIndex];
-                    HANDMADE_INPUT_CONTROLLER *NewController = &NewInput->Controllers[ControllerIndex];
-                    XINPUT_STATE ControllerState;
+    return true;
+}
 
-                    if(XInputGetState(ControllerIndex, &ControllerState) == ERROR_SUCCESS)
-                    {
-                        //Controller is plugged in
-                        //Button layouts
-                        XINPUT_GAMEPAD *Pad = &ControllerState.Gamepad;
-
-                        bool32 PadUp = (Pad->wButtons & XINPUT_GAMEPAD_DPAD_UP);
-                        bool32 PadDown = (Pad->wButtons & XINPUT_GAMEPAD_DPAD_DOWN);
-                        bool32 PadLeft = (Pad->wButtons & XINPUT_GAMEPAD_DPAD_LEFT);
-                        bool32 PadRight = (Pad->wButtons & XINPUT_GAMEPAD_DPAD_RIGHT);
-                        int16 PadStickX = Pad->sThumbLX;
-                        int16 PadStickY = Pad->sThumbLY;
-                        
-                        win32_xinput_ProcessDigitalButton(Pad->wButtons, &OldController->Down, XINPUT_GAMEPAD_A, &NewController->Down);
-                        win32_xinput_ProcessDigitalButton(Pad->wButtons, &OldController->Right, XINPUT_GAMEPAD_B, &NewController->Right);
-                        win32_xinput_ProcessDigitalButton(Pad->wButtons, &OldController->Left, XINPUT_GAMEPAD_X, &NewController->Left);
-                        win32_xinput_ProcessDigitalButton(Pad->wButtons, &OldController->Up, XINPUT_GAMEPAD_Y, &NewController->Up);
-                        win32_xinput_ProcessDigitalButton(Pad->wButtons, &OldController->LeftShoulder, XINPUT_GAMEPAD_LEFT_SHOULDER, &NewController->LeftShoulder);
-                        win32_xinput_ProcessDigitalButton(Pad->wButtons, &OldController->RightShoulder, XINPUT_GAMEPAD_RIGHT_SHOULDER, &NewController->RightShoulder);
-
-                        //bool32 PadStart = (Pad->wButtons & XINPUT_GAMEPAD_START);
-                        //bool32 PadBack = (Pad->wButtons & XINPUT_GAMEPAD_BACK);
-                    }
-                    else
-                    {
-                        //Controller unavailable
-                    }
-                }
+internal FILETIME win32_GetLastWriteTime(char *FileName)
+{
+    FILETIME LastWriteTime = {};
+    WIN32_FILE_ATTRIBUTE_DATA Data;
 
-                DWORD ByteToLock;
-                DWORD TargetCursor;
-                DWORD BytesToWrite;
-                DWORD PlayCursor;
-                DWORD WriteCursor;
+    if(GetFileAttributesEx(FileName, GetFileExInfoStandard, &Data))
+    {
+        LastWriteTime = Data.ftLastWriteTime;
+    }
 
-                bool32 SoundIsValid = false;
+    return LastWriteTime;
+}
 
-                if(SUCCEEDED(GlobalSecondaryBuffer->GetCurrentPosition(&PlayCursor, &WriteCursor)))
-                {
-                    ByteToLock = ((SoundOutput.RunningSampleIndex * SoundOutput.BytesPerSample) % SoundOutput.SecondaryBufferSize);
-                    TargetCursor = ((PlayCursor + SoundOutput.LatencySampleCount * SoundOutput.BytesPerSample) % SoundOutput.SecondaryBufferSize);
-                
-                    if(ByteToLock > TargetCursor)
-                    {
-                        BytesToWrite = (SoundOutput.SecondaryBufferSize - ByteToLock);
-                    }
-                    else
+//Loads a copy so the compiler can overwrite handmade.dll while the game is running
+internal WIN32_GAME_CODE win32_LoadGameCode(char *SourceDLLName, char *TempDLLName)
+{
+    WIN32_GAME_CODE Result = {};
+    Result.LastWriteTime = win32_GetLastWriteTime(SourceDLLName);
+
+    CopyFile(SourceDLLName, TempDLLName, FALSE);
+    Result.GameCodeDLL = LoadLibraryA(TempDLLName);
+
+    if(Result.GameCodeDLL)
+    {
+        Result.UpdateAndRender = (handmade_game_update_render *) GetProcAddress(Result.GameCodeDLL, "handmade_GameUpdate_Render");
+        Result.GetSoundSamples = (handmade_game_get_sound_samples *) GetProcAddress(Result.GameCodeDLL, "handmade_GetSoundSamples");
+        Result.IsValid = (Result.UpdateAndRender && Result.GetSoundSamples);
+    }
+
+    if(!Result.IsValid)
+    {
+        Result.UpdateAndRender = 0;
+        Result.GetSoundSamples = 0;
+    }
+
+    return Result;
+}
+
+internal void win32_UnloadGameCode(WIN32_GAME_CODE *GameCode)
+{
+    if(GameCode->GameCodeDLL)
+    {
+        FreeLibrary(GameCode->GameCodeDLL);
+    }
+
+    *GameCode = {};
+}
+
+//build.bat holds lock.tmp while the compiler writes the DLL and PDB, don't reload until it's gone
+//Background work still queued points at the old DLL's code, so it has to finish first, and so do log records pointing at its strings
+internal bool32 win32_ReloadGameCodeIfChanged(WIN32_GAME_CODE *GameCode, char *SourceDLLName, char *TempDLLName, char *LockFileName, HANDMADE_MEMORY *Memory, HANDMADE_WORK_QUEUE *BackgroundQueue,
+                                              DEBUG_LOG_WRITER *LogWriter)
+{
+    WIN32_FILE_ATTRIBUTE_DATA Ignored;
+    if(GetFileAttributesEx(LockFileName, GetFileExInfoStandard, &Ignored))
+    {
+        return false;
+    }
+
+    FILETIME WriteTime = win32_GetLastWriteTime(SourceDLLName);
+
+    if(CompareFileTime(&WriteTime, &GameCode->LastWriteTime) == 0)
+    {
+        return false;
+    }
+
+    if(BackgroundQueue)
+    {
+        jobs_CompleteAllWork(BackgroundQueue);
+    }
+
+    if(LogWriter)
+    {
+        debug_FlushLog(LogWriter);
+    }
+
+    win32_UnloadGameCode(GameCode);
+    *GameCode = win32_LoadGameCode(SourceDLLName, TempDLLName);
+    Memory->ExecutableReloaded = true;
+
+    return true;
+}
+
+//Header then a snapshot of permanent storage, frames are appended by win32_RecordFrame
+internal void win32_BeginRecording(WIN32_REPLAY_STATE *Replay, HANDMADE_MEMORY *Memory)
+{
+    if(Replay->BackgroundQueue)
+    {
+        jobs_CompleteAllWork(Replay->BackgroundQueue);
+    }
+
+    Replay->File = CreateFileA(Replay->FileName, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, 0, 0);
+
+    if(Replay->File == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    REPLAY_HEADER Header;
+    replay_InitHeader(&Header, Memory, Replay->SampleRate);
+
+    DWORD BytesWritten;
+    WriteFile(Replay->File, &Header, sizeof(Header), &BytesWritten, 0);
+    WriteFile(Replay->File, Memory->PermanentStorage, (DWORD) Memory->PermanentStorageSize, &BytesWritten, 0);
+
+    Replay->Mode = WIN32_REPLAY_MODE_RECORDING;
+}
+
+internal void win32_RecordFrame(WIN32_REPLAY_STATE *Replay, HANDMADE_INPUT_USER *Input, int SoundSampleCount)
+{
+    REPLAY_FRAME Frame = {};
+    Frame.Input = *Input;
+    Frame.SoundSampleCount = SoundSampleCount;
+
+    DWORD BytesWritten;
+    WriteFile(Replay->File, &Frame, sizeof(Frame), &BytesWritten, 0);
+}
+
+//Restores the snapshot, the next ReadFile lands on the first frame
+internal void win32_BeginPlayback(WIN32_REPLAY_STATE *Replay, HANDMADE_MEMORY *Memory)
+{
+    if(Replay->BackgroundQueue)
+    {
+        jobs_CompleteAllWork(Replay->BackgroundQueue);
+    }
+
+    Replay->File = CreateFileA(Replay->FileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+
+    if(Replay->File == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    REPLAY_HEADER Header;
+    DWORD BytesRead;
+
+    if(ReadFile(Replay->File, &Header, sizeof(Header), &BytesRead, 0) && (BytesRead == sizeof(Header)) && replay_CheckHeader(&Header, Memory))
+    {
+        ReadFile(Replay->File, Memory->PermanentStorage, (DWORD) Memory->PermanentStorageSize, &BytesRead, 0);
+        Memory->IsInitialised = Header.IsInitialised;
+        Replay->Mode = WIN32_REPLAY_MODE_PLAYBACK;
+    }
+    else
+    {
+        debug_LogWarning("Replay file doesn't match this build");
+        CloseHandle(Replay->File);
+    }
+}
+
+internal void win32_EndReplay(WIN32_REPLAY_STATE *Replay)
+{
+    if(Replay->Mode != WIN32_REPLAY_MODE_OFF)
+    {
+        CloseHandle(Replay->File);
+        Replay->Mode = WIN32_REPLAY_MODE_OFF;
+    }
+}
+
+//Overwrites this frame's input and sample count, wrapping to the snapshot at the end of the file
+internal void win32_PlaybackFrame(WIN32_REPLAY_STATE *Replay, HANDMADE_MEMORY *Memory, HANDMADE_INPUT_USER *Input, int *SoundSampleCount)
+{
+    REPLAY_FRAME Frame;
+    DWORD BytesRead;
+
+    if(!ReadFile(Replay->File, &Frame, sizeof(Frame), &BytesRead, 0) || (BytesRead != sizeof(Frame)))
+    {
+        win32_EndReplay(Replay);
+        win32_BeginPlayback(Replay, Memory);
+
+        if((Replay->Mode != WIN32_REPLAY_MODE_PLAYBACK) || !ReadFile(Replay->File, &Frame, sizeof(Frame), &BytesRead, 0) || (BytesRead != sizeof(Frame)))
+        {
+            //Empty recording
+            win32_EndReplay(Replay);
+            return;
+        }
+    }
+
+    *Input = Frame.Input;
+    *SoundSampleCount = Frame.SoundSampleCount;
+}
+
+internal void win32_ToggleReplay(WIN32_REPLAY_STATE *Replay, HANDMADE_MEMORY *Memory)
+{
+    WIN32_REPLAY_MODE OldMode = Replay->Mode;
+    win32_EndReplay(Replay);
+
+    if(OldMode == WIN32_REPLAY_MODE_OFF)
+    {
+        win32_BeginRecording(Replay, Memory);
+    }
+    else if(OldMode == WIN32_REPLAY_MODE_RECORDING)
+    {
+        win32_BeginPlayback(Replay, Memory);
+    }
+}
+
+//Path of a file sitting next to the executable
+internal void win32_BuildExePathFileName(const char *FileName, char *Dest, int DestSize)
+{
+    DWORD PathLength = GetModuleFileNameA(0, Dest, DestSize);
+    char *OnePastLastSlash = Dest;
+
+    for(DWORD Index = 0; Index < PathLength; ++Index)
+    {
+        if(Dest[Index] == '\\')
+        {
+            OnePastLastSlash = Dest + Index + 1;
+        }
+    }
+
+    int Remaining = DestSize - (int) (OnePastLastSlash - Dest);
+    for(int Index = 0; (Index < Remaining - 1) && FileName[Index]; ++Index)
+    {
+        *OnePastLastSlash++ = FileName[Index];
+    }
+
+    *OnePastLastSlash = 0;
+}
+
+//Read only view of the whole file, pages are read in as they're touched. Size is 0 on failure
+internal void *win32_MapFile(char *FileName, uint64 *Size)
+{
+    void *Result = 0;
+    *Size = 0;
+
+    HANDLE File = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+    if(File == INVALID_HANDLE_VALUE)
+    {
+        return 0;
+    }
+
+    LARGE_INTEGER FileSize;
+    if(GetFileSizeEx(File, &FileSize) && (FileSize.QuadPart > 0))
+    {
+        //View keeps the mapping alive, both handles can go straight away
+        HANDLE Mapping = CreateFileMappingA(File, 0, PAGE_READONLY, 0, 0, 0);
+        if(Mapping)
+        {
+            Result = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+            if(Result)
+            {
+                *Size = (uint64) FileSize.QuadPart;
+            }
+
+            CloseHandle(Mapping);
+        }
+    }
+
+    CloseHandle(File);
+    return Result;
+}
+
+//Same base every run so pointers stored in game memory stay valid across snapshots
+#define WIN32_GAME_MEMORY_BASE ((LPVOID) Terabytes(2))
+
+//Large pages need SeLockMemoryPrivilege on the account, returns the large page size or 0 when they can't be used
+internal SIZE_T win32_EnableLargePages(void)
+{
+    SIZE_T LargePageSize = GetLargePageMinimum();
+    HANDLE Token;
+
+    if(!LargePageSize || !OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &Token))
+    {
+        return 0;
+    }
+
+    TOKEN_PRIVILEGES Privileges = {};
+    Privileges.PrivilegeCount = 1;
+    Privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+    bool32 Enabled = false;
+    if(LookupPrivilegeValue(0, SE_LOCK_MEMORY_NAME, &Privileges.Privileges[0].Luid))
+    {
+        //Succeeds even when the privilege wasn't granted, only the last error tells
+        AdjustTokenPrivileges(Token, FALSE, &Privileges, 0, 0, 0);
+        Enabled = (GetLastError() == ERROR_SUCCESS);
+    }
+
+    CloseHandle(Token);
+
+    return Enabled ? LargePageSize : 0;
+}
+
+//One allocation for all game memory, large pages when the account allows it, the fixed base when it's free
+internal bool32 win32_AllocateGameMemory(WIN32_GAME_MEMORY *GameMemory, SIZE_T Size)
+{
+    LPVOID Base = 0;
+    SIZE_T LargePageSize = win32_EnableLargePages();
+
+    if(LargePageSize)
+    {
+        SIZE_T LargeSize = (Size + LargePageSize - 1) & ~(LargePageSize - 1);
+        Base = VirtualAlloc(WIN32_GAME_MEMORY_BASE, LargeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+        if(Base)
+        {
+            Size = LargeSize;
+        }
+    }
+
+    bool32 LargePages = (Base != 0);
+
+    if(!Base)
+    {
+        Base = VirtualAlloc(WIN32_GAME_MEMORY_BASE, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+
+    //Address taken, the block still works but snapshots from another run won't line up
+    if(!Base)
+    {
+        Base = VirtualAlloc(0, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+
+    GameMemory->Base = Base;
+    GameMemory->Size = Size;
+    GameMemory->AtFixedBase = (Base == WIN32_GAME_MEMORY_BASE);
+    GameMemory->LargePages = LargePages;
+
+    return (Base != 0);
+}
+
+internal LARGE_INTEGER win32_GetWallClock(void)
+{
+    LARGE_INTEGER Result;
+    QueryPerformanceCounter(&Result);
+    return Result;
+}
+
+internal float32 win32_GetSecondsElapsed(LARGE_INTEGER Start, LARGE_INTEGER End)
+{
+    return (float32) (End.QuadPart - Start.QuadPart) / (float32) GlobalPerfCountFrequency;
+}
+
+//rdtsc against the performance counter, only needed to put trace timestamps in microseconds
+internal float64 win32_GetMicrosecondsPerCycle(void)
+{
+    LARGE_INTEGER StartCounter = win32_GetWallClock();
+    uint64 StartCycleCount = __rdtsc();
+
+    Sleep(20);
+
+    uint64 EndCycleCount = __rdtsc();
+    LARGE_INTEGER EndCounter = win32_GetWallClock();
+
+    return (1000.0 * 1000.0 * (float64) win32_GetSecondsElapsed(StartCounter, EndCounter)) / (float64) (EndCycleCount - StartCycleCount);
+}
+
+//Sleeps for the bulk of the frame and spins the tail, Sleep can overshoot by a scheduler tick so the last SpinSeconds never sleep
+//Returns false if the work alone already ran past the target
+internal bool32 win32_WaitForFrameEnd(LARGE_INTEGER FrameStart, float32 TargetSeconds, float32 SpinSeconds, bool32 SleepIsGranular)
+{
+    float32 SecondsElapsed = win32_GetSecondsElapsed(FrameStart, win32_GetWallClock());
+
+    if(SecondsElapsed > TargetSeconds)
+    {
+        return false;
+    }
+
+    if(SleepIsGranular)
+    {
+        float32 SleepSeconds = TargetSeconds - SecondsElapsed - SpinSeconds;
+        if(SleepSeconds > 0.0f)
+        {
+            Sleep((DWORD) (1000.0f * SleepSeconds));
+        }
+    }
+
+    while(win32_GetSecondsElapsed(FrameStart, win32_GetWallClock()) < TargetSeconds)
+    {
+        _mm_pause();
+    }
+
+    return true;
+}
+
+//Starting point
+//Entry point for any Windows application
+int CALLBACK WinMain(HINSTANCE Instance, HINSTANCE PrevInstance, LPSTR CommandLine, int CommandShow)
+{
+    LARGE_INTEGER PerfomanceCounterFrequency_Result;
+    QueryPerformanceFrequency(&PerfomanceCounterFrequency_Result);
+    GlobalPerfCountFrequency = PerfomanceCounterFrequency_Result.QuadPart;
+
+    //1 ms scheduler granularity so Sleep in the frame lock wakes close to when it was asked to
+    UINT DesiredSchedulerMS = 1;
+    bool32 SleepIsGranular = (timeBeginPeriod(DesiredSchedulerMS) == TIMERR_NOERROR);
+
+    win32_LoadXInput(); //Load XInput dll
+    WNDCLASS WindowClass = {}; //Initialise everything in struct to 0
+
+    //-half renders at 640x360 for slow machines, -nearest upscales by whole pixels instead of filtering
+    //-rgb565 and -indexed8 render into a narrower backbuffer, widened when presenting
+    bool32 HalfResolution = (strstr(CommandLine, "-half") != 0);
+    if(strstr(CommandLine, "-nearest"))
+    {
+        GlobalScaleFilter = SCALE_FILTER_NEAREST;
+    }
+
+    //-devicerate opens the sound device at that rate instead of the one Windows mixes at
+    int32 DeviceSampleRate = 0;
+    char *DeviceRateArgument = strstr(CommandLine, "-devicerate ");
+    if(DeviceRateArgument)
+    {
+        DeviceSampleRate = atoi(DeviceRateArgument + 12);
+    }
+
+    HANDMADE_PIXEL_FORMAT PixelFormat = HANDMADE_PIXEL_FORMAT_BGRX8888;
+    if(strstr(CommandLine, "-rgb565"))
+    {
+        PixelFormat = HANDMADE_PIXEL_FORMAT_RGB565;
+    }
+    else if(strstr(CommandLine, "-indexed8"))
+    {
+        PixelFormat = HANDMADE_PIXEL_FORMAT_INDEXED8;
+    }
+
+    scale_SelectKernels(SIMD_LEVEL_AUTO);
+    pixel_SelectKernels(SIMD_LEVEL_AUTO);
+    win32_ResizeDIBSection(&GlobalBackBuffer, HalfResolution ? 640 : 1280, HalfResolution ? 360 : 720, PixelFormat);
+    if(PixelFormat != HANDMADE_PIXEL_FORMAT_BGRX8888)
+    {
+        win32_ResizeDIBSection(&GlobalConvertedBuffer, GlobalBackBuffer.BitmapWidth, GlobalBackBuffer.BitmapHeight, HANDMADE_PIXEL_FORMAT_BGRX8888);
+    }
+
+    WindowClass.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC; //Create unique device context for this window
+    WindowClass.lpfnWndProc = win32_MainWindow_Callback; //Call the window process
+    WindowClass.hInstance = Instance; //Handle instance passed from win32_WinMain
+    WindowClass.lpszClassName = "HandmadeHeroWindowClass"; //Name of Window class
+    //WindowClass.hIcon;
+
+    if(RegisterClass(&WindowClass))
+    {
+        HWND Window = CreateWindowEx(0, WindowClass.lpszClassName, "Handmade Hero", WS_OVERLAPPEDWINDOW | WS_VISIBLE, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, 0, 0, Instance, 0); 
+
+        if(Window) //Process message queue
+        {
+            //Specified CS_OWNDC so get one device context and use it forever
+            HDC DeviceContext = GetDC(Window);
+
+            //Lock the game to the monitor, VREFRESH reports 0 or 1 when the driver doesn't know
+            int MonitorRefreshHz = 60;
+            int RefreshHz = GetDeviceCaps(DeviceContext, VREFRESH);
+            if(RefreshHz > 1)
+            {
+                MonitorRefreshHz = RefreshHz;
+            }
+
+            int GameUpdateHz = MonitorRefreshHz;
+            float32 TargetSecondsPerFrame = 1.0f / (float32) GameUpdateHz;
+            float32 SpinSeconds = SleepIsGranular ? 0.002f : TargetSecondsPerFrame;
+
+            local FRAME_HISTOGRAM FrameHistogram;
+            frame_InitHistogram(&FrameHistogram, 1000.0f * TargetSecondsPerFrame);
+            
+            //Initialise audio buffer
+            WIN32_SOUND_OUTPUT SoundOutput = {};
+
+            //The game always mixes at 48 kHz, the device runs at the rate Windows mixes at so nothing downstream converts again
+            //Any rate the resampler can't reach from 48 kHz falls back to 48 kHz
+            SoundOutput.GameSampleRate = 48000;
+            SoundOutput.SampleRate = DeviceSampleRate ? DeviceSampleRate : win32_GetNativeSampleRate();
+            if((SoundOutput.SampleRate * RESAMPLE_MAX_RATIO < SoundOutput.GameSampleRate) || (SoundOutput.SampleRate > SoundOutput.GameSampleRate * RESAMPLE_MAX_RATIO))
+            {
+                SoundOutput.SampleRate = SoundOutput.GameSampleRate;
+            }
+
+            SoundOutput.RunningSampleIndex = 0;
+            SoundOutput.BytesPerSample = sizeof(int16) * 2;
+            SoundOutput.SecondaryBufferSize = SoundOutput.SampleRate * SoundOutput.BytesPerSample;
+
+            win32_InitDSound(Window, SoundOutput.SampleRate, SoundOutput.SecondaryBufferSize);
+            win32_ClearBuffer(&SoundOutput);
+            GlobalSecondaryBuffer->Play(0, 0, DSBPLAY_LOOPING);
+            
+            //Allocate memory for audio samples, one second at the game's rate
+            int16 *Samples = (int16 * ) VirtualAlloc(0, SoundOutput.GameSampleRate * SoundOutput.BytesPerSample, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+            //Resampled frames can run a filter's length past the second the game mixed
+            if(SoundOutput.GameSampleRate != SoundOutput.SampleRate)
+            {
+                SIZE_T ResampleMemorySize = resample_GetMemorySize(SoundOutput.GameSampleRate, SoundOutput.SampleRate, RESAMPLE_QUALITY_HIGH);
+                uint8 *ResampleMemory = (uint8 *) VirtualAlloc(0, ResampleMemorySize + ((SoundOutput.SampleRate + RESAMPLE_MAX_TAPS) * SoundOutput.BytesPerSample), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+                resample_SelectKernels(SIMD_LEVEL_AUTO);
+                resample_InitContext(&SoundOutput.Resampler, ResampleMemory, SoundOutput.GameSampleRate, SoundOutput.SampleRate, RESAMPLE_QUALITY_HIGH);
+                SoundOutput.DeviceSamples = (int16 *) (ResampleMemory + ResampleMemorySize);
+            }
+
+            //Game starts about four 60Hz frames ahead and adapts from there, between 2ms and a quarter second
+            //The audio thread keeps 10ms queued on the device
+            local AUDIO_RING_BUFFER SoundRing;
+            SoundOutput.LatencySampleCount = SoundOutput.SampleRate / 15;
+            SoundOutput.SafetySampleCount = SoundOutput.SampleRate / 100;
+            audio_InitLatencyController(&SoundOutput.Latency, SoundOutput.SampleRate, SoundOutput.LatencySampleCount, SoundOutput.SampleRate / 500, SoundOutput.SampleRate / 4);
+
+            int64 RingCapacity = audio_GetRingCapacity(SoundOutput.Latency.MaxFrames + SoundOutput.SafetySampleCount);
+            void *RingMemory = VirtualAlloc(0, audio_GetRingMemorySize(RingCapacity), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            audio_InitRingBuffer(&SoundRing, RingMemory, RingCapacity);
+            SoundOutput.Ring = &SoundRing;
+
+            //All game state lives in one block, permanent first then transient
+            HANDMADE_MEMORY Memory = {};
+            Memory.PermanentStorageSize = Megabytes(64);
+            Memory.TransientStorageSize = Megabytes(512);
+
+            WIN32_GAME_MEMORY GameMemory = {};
+
+            if(!win32_AllocateGameMemory(&GameMemory, (SIZE_T) (Memory.PermanentStorageSize + Memory.TransientStorageSize)))
+            {
+                return 1;
+            }
+
+            Memory.PermanentStorage = GameMemory.Base;
+            Memory.TransientStorage = (uint8 *) Memory.PermanentStorage + Memory.PermanentStorageSize;
+
+            //One worker per logical core besides this one, the main thread helps while it waits on the queue
+            SYSTEM_INFO SystemInfo;
+            GetSystemInfo(&SystemInfo);
+            int WorkerCount = (int) SystemInfo.dwNumberOfProcessors - 1;
+
+            local HANDMADE_WORK_QUEUE JobQueue;
+            local HANDMADE_WORK_QUEUE BackgroundQueue;
+            HANDMADE_ASSET_STATS AssetStats = {};
+
+            HANDMADE_PLATFORM Platform = {};
+            Platform.AddWorkEntry = jobs_AddWorkEntry;
+            Platform.CompleteAllWork = jobs_CompleteAllWork;
+            Platform.RenderTileWidth = 64;
+            Platform.RenderTileHeight = 64;
+            Platform.SimdLevel = SIMD_LEVEL_AUTO;
+
+            //Profiler stays on, H dumps the call tree with the frame times and T starts or stops a Chrome trace
+            DEBUG_TABLE *DebugTable = (DEBUG_TABLE *) VirtualAlloc(0, sizeof(DEBUG_TABLE), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            GlobalDebugTable = DebugTable;
+            Platform.DebugTable = DebugTable;
+
+            //Log lines go to the debugger from their own thread, without one every record is dropped
+            DEBUG_LOG *DebugLog = (DEBUG_LOG *) VirtualAlloc(0, sizeof(DEBUG_LOG), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            HANDLE LogSemaphore = CreateSemaphoreEx(0, 0, 0x7FFFFFFF, 0, 0, SEMAPHORE_ALL_ACCESS);
+            local DEBUG_LOG_WRITER LogWriter;
+            HANDLE LogThread = 0;
+
+            if(DebugLog && LogSemaphore)
+            {
+                debug_BeginLog(&LogWriter, DebugLog, win32_GetMicrosecondsPerCycle(), win32_WriteLog, 0, LogSemaphore, win32_SignalSemaphore, win32_WaitSemaphore);
+                LogThread = CreateThread(0, 0, win32_LogThreadProc, &LogWriter, 0, 0);
+            }
+
+            if(LogThread)
+            {
+                GlobalDebugLog = DebugLog;
+                Platform.DebugLog = DebugLog;
+            }
+
+            local DEBUG_COLLATION DebugCollation;
+            debug_ResetCollation(&DebugCollation);
+
+            DEBUG_TRACE DebugTrace = {};
+            char TraceFileName[MAX_PATH];
+            win32_BuildExePathFileName("handmade_trace.json", TraceFileName, sizeof(TraceFileName));
+
+            if((WorkerCount > 0) && win32_MakeQueue(&JobQueue, WorkerCount))
+            {
+                Platform.JobQueue = &JobQueue;
+            }
+
+            //Asset loads stream in on their own worker so a page fault storm never holds up the render workers
+            if((WorkerCount > 0) && win32_MakeQueue(&BackgroundQueue, 1))
+            {
+                Platform.BackgroundQueue = &BackgroundQueue;
+            }
+            Platform.AssetStats = &AssetStats;
+
+            //Game reports what it changed each frame so only that is redrawn and presented
+            HANDMADE_DIRTY_RECTS DirtyRects = {};
+            Platform.DirtyRects = &DirtyRects;
+            uint64 DirtyPixelCount = 0;
+            int DirtyFrameCount = 0;
+            WIN32_WINDOW_DIMENSIONS LastWindowDimensions = {};
+
+            //Optional asset pack, mapped for the life of the process
+            char AssetPackFileName[MAX_PATH];
+            win32_BuildExePathFileName("handmade.hha", AssetPackFileName, sizeof(AssetPackFileName));
+            Platform.AssetPackMemory = win32_MapFile(AssetPackFileName, &Platform.AssetPackSize);
+
+            //Game code lives in handmade.dll, rebuilding it while the game runs swaps it in between frames
+            char SourceDLLName[MAX_PATH];
+            char TempDLLName[MAX_PATH];
+            char LockFileName[MAX_PATH];
+            win32_BuildExePathFileName("handmade.dll", SourceDLLName, sizeof(SourceDLLName));
+            win32_BuildExePathFileName("handmade_temp.dll", TempDLLName, sizeof(TempDLLName));
+            win32_BuildExePathFileName("lock.tmp", LockFileName, sizeof(LockFileName));
+
+            WIN32_GAME_CODE GameCode = win32_LoadGameCode(SourceDLLName, TempDLLName);
+            Memory.ExecutableReloaded = true;
+
+            WIN32_REPLAY_STATE Replay = {};
+            Replay.SampleRate = SoundOutput.GameSampleRate;
+            Replay.BackgroundQueue = Platform.BackgroundQueue;
+            win32_BuildExePathFileName("handmade_replay.hmi", Replay.FileName, sizeof(Replay.FileName));
+
+            //Bools
+            GlobalRunning = true;
+
+            DWORD AudioThreadID;
+            HANDLE AudioThread = CreateThread(0, 0, win32_AudioThreadProc, &SoundOutput, 0, &AudioThreadID);
+            if(AudioThread)
+            {
+                SetThreadPriority(AudioThread, THREAD_PRIORITY_TIME_CRITICAL);
+                CloseHandle(AudioThread);
+            }
+
+            //Index controllers
+            HANDMADE_INPUT_USER Input[2] = {};
+            HANDMADE_INPUT_USER *NewInput = &Input[0];
+            HANDMADE_INPUT_USER *OldInput = &Input[1];
+
+            input_InitRing(&GlobalKeyboardRing);
+            INPUT_STATS InputStats = {};
+            LARGE_INTEGER LastInputCounter = win32_GetWallClock();
+
+            local WIN32_PAD_POLL PadPoll;
+            input_InitRing(&PadPoll.Ring);
+            PadPoll.Running = true;
+
+            HANDLE PadPollThread = CreateThread(0, 0, win32_PadPollThreadProc, &PadPoll, 0, 0);
+            if(PadPollThread)
+            {
+                SetThreadPriority(PadPollThread, THREAD_PRIORITY_ABOVE_NORMAL);
+            }
+
+            //Performance counters
+            LARGE_INTEGER LastCounter;
+            QueryPerformanceCounter(&LastCounter);
+            uint64 LastCycleCount = __rdtsc();
+
+            //Loop while program is running / until negative result from GetMessage
+            while(GlobalRunning)
+            {
+                MSG Messages;
+
+                //PeekMessage keeps processing message queue without blocking when there are no messages available
+                while(PeekMessage(&Messages, 0, 0, 0, PM_REMOVE))
+                {
+                    if(Messages.message == WM_QUIT)
                     {
-                        BytesToWrite = TargetCursor - ByteToLock;
+                        GlobalRunning = false;
                     }
 
-                    SoundIsValid = true;
+                    TranslateMessage(&Messages);
+                    DispatchMessage(&Messages);
                 }
-            
+
+                //Everything the keyboard and pads did since the last frame, in the order it happened
+                LARGE_INTEGER InputCounter = win32_GetWallClock();
+                INPUT_EVENT_RING *InputRings[] = {&GlobalKeyboardRing, &PadPoll.Ring};
+                input_GatherFrame(InputRings, ArrayCount(InputRings), (uint64) LastInputCounter.QuadPart, (uint64) InputCounter.QuadPart,
+                                  1.0 / (float64) GlobalPerfCountFrequency, OldInput, NewInput, &InputStats);
+
+                //Top the ring up to the latency target, the audio thread drains it at the device's pace
+                //Writes are as far apart as input windows, so the same gap tells the controller how long frames really take
+                SoundOutput.LatencySampleCount = (int) audio_UpdateLatency(&SoundOutput.Latency, SoundOutput.Ring, win32_GetSecondsElapsed(LastInputCounter, InputCounter));
+                LastInputCounter = InputCounter;
+
                 HANDMADE_SOUND_BUFFER SoundBuffer = {};
-                SoundBuffer.SampleRate = SoundOutput.SampleRate;
-                SoundBuffer.SampleCount = BytesToWrite / SoundOutput.BytesPerSample;
+                //Counts are in game frames from here until the mix has been resampled
+                int DeviceFrames = (int) audio_GetFramesToWrite(SoundOutput.Ring, SoundOutput.LatencySampleCount);
+
+                SoundBuffer.SampleRate = SoundOutput.GameSampleRate;
+                SoundBuffer.SampleCount = SoundOutput.DeviceSamples ? resample_GetInputFrames(&SoundOutput.Resampler, DeviceFrames) : DeviceFrames;
                 SoundBuffer.Samples = Samples;
 
+                if(GlobalReplayTogglePressed)
+                {
+                    win32_ToggleReplay(&Replay, &Memory);
+                    GlobalReplayTogglePressed = false;
+                }
+
+                //Playback replaces live input, the ring takes whatever part of the recorded sample count fits
+                if(Replay.Mode == WIN32_REPLAY_MODE_RECORDING)
+                {
+                    win32_RecordFrame(&Replay, NewInput, SoundBuffer.SampleCount);
+                }
+                else if(Replay.Mode == WIN32_REPLAY_MODE_PLAYBACK)
+                {
+                    win32_PlaybackFrame(&Replay, &Memory, NewInput, &SoundBuffer.SampleCount);
+                }
+
                 //Rendering
                 HANDMADE_OFFSCREEN_BUFFER Buffer = {};
                 Buffer.BitmapMemory = GlobalBackBuffer.BitmapMemory;
                 Buffer.BitmapWidth = GlobalBackBuffer.BitmapWidth;
                 Buffer.BitmapHeight = GlobalBackBuffer.BitmapHeight;
                 Buffer.Pitch = GlobalBackBuffer.Pitch;
-                handmade_GameUpdate_Render(NewInput, &Buffer, &SoundBuffer);
+                Buffer.Format = GlobalBackBuffer.Format;
+                win32_ReloadGameCodeIfChanged(&GameCode, SourceDLLName, TempDLLName, LockFileName, &Memory, Platform.BackgroundQueue, LogThread ? &LogWriter : 0);
 
-                //DirectSound square wave test tone
+                if(GameCode.IsValid)
+                {
+                    GameCode.UpdateAndRender(&Platform, &Memory, NewInput, &Buffer);
+                    GameCode.GetSoundSamples(&Platform, &Memory, &SoundBuffer);
+                }
+                else
+                {
+                    SoundBuffer.SampleCount = 0;
+                }
 
-                if(SoundIsValid)
+                //Playback may have changed the count, so the device frames follow from what was actually mixed
+                if(SoundOutput.DeviceSamples)
+                {
+                    DeviceFrames = resample_GetOutputFrames(&SoundOutput.Resampler, SoundBuffer.SampleCount);
+                    resample_Process(&SoundOutput.Resampler, SoundBuffer.Samples, SoundBuffer.SampleCount, SoundOutput.DeviceSamples, DeviceFrames);
+                    audio_WriteFrames(SoundOutput.Ring, SoundOutput.DeviceSamples, DeviceFrames);
+                }
+                else
                 {
-                    win32_FillSoundBuffer(&SoundOutput, ByteToLock, BytesToWrite, &SoundBuffer);
+                    audio_WriteFrames(SoundOutput.Ring, SoundBuffer.Samples, SoundBuffer.SampleCount);
                 }
 
+                uint64 EndCycleCount = __rdtsc();
+
+                if(GlobalTraceTogglePressed)
+                {
+                    if(DebugTrace.File)
+                    {
+                        debug_EndTrace(&DebugTrace);
+                    }
+                    else
+                    {
+                        debug_BeginTrace(&DebugTrace, TraceFileName, win32_GetMicrosecondsPerCycle());
+                    }
+
+                    GlobalTraceTogglePressed = false;
+                }
+
+                if(DebugTable)
+                {
+                    debug_EndFrame(DebugTable, &DebugCollation, &DebugTrace);
+                }
+
+                if(LogThread)
+                {
+                    debug_SignalLog(&LogWriter);
+                }
+
+                bool32 Missed = !win32_WaitForFrameEnd(LastCounter, TargetSecondsPerFrame, SpinSeconds, SleepIsGranular);
+
+                //End performance counters, the frame is start to start including the wait
+                LARGE_INTEGER EndCounter = win32_GetWallClock();
+                float32 MSPerFrame = 1000.0f * win32_GetSecondsElapsed(LastCounter, EndCounter);
+                frame_AddFrame(&FrameHistogram, MSPerFrame, Missed);
+
+                //A resized window takes the whole buffer once, the output buffer is rebuilt for it anyway
                 WIN32_WINDOW_DIMENSIONS WindowDimensions = win32_GetWindowDimensions(Window);
-                win32_DisplayBuffer_Window(&GlobalBackBuffer, DeviceContext, WindowDimensions.Width, WindowDimensions.Height);
+                bool32 SameWindow = (WindowDimensions.Width == LastWindowDimensions.Width) && (WindowDimensions.Height == LastWindowDimensions.Height);
+                win32_DisplayBuffer_Window(&GlobalBackBuffer, DeviceContext, WindowDimensions.Width, WindowDimensions.Height, (SameWindow && GameCode.IsValid) ? &DirtyRects : 0);
+                LastWindowDimensions = WindowDimensions;
+
+                DirtyPixelCount += GameCode.IsValid ? DirtyRects.DirtyPixelCount : 0;
+                DirtyFrameCount++;
                 
                 ReleaseDC(Window, DeviceContext);
 
-                //End performance counters
-                LARGE_INTEGER EndCounter;
-                QueryPerformanceCounter(&EndCounter);
-                
-                uint64 EndCycleCount = __rdtsc();
+                if(GlobalFrameHistogramDumpPressed)
+                {
+                    float32 MegaHzCyclesPerFrame = (float32) ((EndCycleCount - LastCycleCount) / (1000.0f * 1000.0f));
+
+                    char MSPerFrame_Buffer[256];
+                    frame_FormatHistogram(&FrameHistogram, MSPerFrame_Buffer, sizeof(MSPerFrame_Buffer));
+                    OutputDebugString(MSPerFrame_Buffer);
+                    sprintf(MSPerFrame_Buffer, "%0.2f ms/frame\t %0.2f cycles(MHz) of work\n", MSPerFrame, MegaHzCyclesPerFrame);
+                    OutputDebugString(MSPerFrame_Buffer);
+
+                    if(Platform.AssetPackMemory)
+                    {
+                        sprintf(MSPerFrame_Buffer, "Assets: %llu hits, %llu misses, %llu evictions, %llu over budget, %0.2f of %llu MB resident, %llu KB in flight\n",
+                                (unsigned long long) AssetStats.Hits, (unsigned long long) AssetStats.Misses, (unsigned long long) AssetStats.Evictions,
+                                (unsigned long long) AssetStats.BudgetFailures, (float64) AssetStats.BytesResident / (float64) Megabytes(1),
+                                (unsigned long long) (AssetStats.BudgetSize / Megabytes(1)), (unsigned long long) (AssetStats.BytesInFlight / Kilobytes(1)));
+                        OutputDebugString(MSPerFrame_Buffer);
+                    }
+
+                    float64 BufferPixelCount = (float64) GlobalBackBuffer.BitmapWidth * (float64) GlobalBackBuffer.BitmapHeight;
+                    sprintf(MSPerFrame_Buffer, "Present: %0.2f%% dirty avg, %0.2f%% last frame in %d rects\n",
+                            100.0 * (float64) DirtyPixelCount / (BufferPixelCount * (float64) DirtyFrameCount),
+                            100.0 * (float64) DirtyRects.DirtyPixelCount / BufferPixelCount, DirtyRects.RectCount);
+                    OutputDebugString(MSPerFrame_Buffer);
+                    if(GlobalScalerMemory && ((LastWindowDimensions.Width != GlobalBackBuffer.BitmapWidth) || (LastWindowDimensions.Height != GlobalBackBuffer.BitmapHeight)))
+                    {
+                        sprintf(MSPerFrame_Buffer, "Upscale: %dx%d to %dx%d, %s\n", GlobalBackBuffer.BitmapWidth, GlobalBackBuffer.BitmapHeight,
+                                GlobalScaler.DestWidth, GlobalScaler.DestHeight, ScaleFilterNames[GlobalScaler.Filter]);
+                        OutputDebugString(MSPerFrame_Buffer);
+                    }
+                    sprintf(MSPerFrame_Buffer, "Audio: %0.2f ms latency, %lld underruns, %lld widenings, %lld device resyncs\n",
+                            audio_GetLatencyMS(&SoundOutput.Latency), (long long) SoundOutput.Ring->UnderrunCount,
+                            (long long) SoundOutput.Latency.WidenCount, (long long) SoundOutput.DeviceResyncCount);
+                    OutputDebugString(MSPerFrame_Buffer);
+
+                    if(SoundOutput.DeviceSamples)
+                    {
+                        sprintf(MSPerFrame_Buffer, "Resample: %d to %d Hz, %s, %d taps, %d phases\n", SoundOutput.GameSampleRate, SoundOutput.SampleRate,
+                                ResampleQualityNames[SoundOutput.Resampler.Quality], SoundOutput.Resampler.TapCount, SoundOutput.Resampler.PhaseCount);
+                        OutputDebugString(MSPerFrame_Buffer);
+                    }
+
+                    DirtyPixelCount = 0;
+                    DirtyFrameCount = 0;
+
+                    //Averaged since the last dump
+                    local char ProfileText[Kilobytes(64)];
+                    debug_FormatCollation(&DebugCollation, ProfileText, sizeof(ProfileText));
+                    OutputDebugString(ProfileText);
+                    debug_ResetCollation(&DebugCollation);
+
+                    GlobalFrameHistogramDumpPressed = false;
+                }
 
-                int64 CounterElapsed = EndCounter.QuadPart - LastCounter.QuadPart;
-                uint64 CyclesElapsed = EndCycleCount - LastCycleCount;
-                float32 MSPerFrame = (float32) (((1000.0f * (float32) CounterElapsed) / (float32) PerfomanceCounterFrequency));
-                float32 FramesPerSecond = (float32) PerfomanceCounterFrequency / (float32) CounterElapsed;
-                float32 MegaHzCyclesPerFrame = (float32) (CyclesElapsed / (1000.0f * 1000.0f));
-#if 0
-                char MSPerFrame_Buffer[256];
-                sprintf(MSPerFrame_Buffer, "%0.2f ms/frame\t %0.2f FPS\t %0.2f cycles(MHz)/frame\n", MSPerFrame, FramesPerSecond, MegaHzCyclesPerFrame);
-                OutputDebugString(MSPerFrame_Buffer);
-#endif
                 LastCounter = EndCounter;
-                LastCycleCount = EndCycleCount;
+                LastCycleCount = __rdtsc();
 
                 HANDMADE_INPUT_USER *Temp = NewInput;
                 NewInput = OldInput;
                 OldInput = Temp;
             }
+
+            debug_EndTrace(&DebugTrace);
+
+            if(PadPollThread)
+            {
+                PadPoll.Running = false;
+                WaitForSingleObject(PadPollThread, INFINITE);
+                CloseHandle(PadPollThread);
+            }
+
+            if(LogThread)
+            {
+                GlobalDebugLog = 0;
+                debug_EndLog(&LogWriter);
+                WaitForSingleObject(LogThread, INFINITE);
+                CloseHandle(LogThread);
+            }
+
+            if(SleepIsGranular)
+            {
+                timeEndPeriod(DesiredSchedulerMS);
+            }
         }
 
         else
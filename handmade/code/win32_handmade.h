@@ -5,6 +5,7 @@ struct WIN32_OFFSCREEN_BUFFER
     int BitmapWidth;
     int BitmapHeight;
     int Pitch;
+    HANDMADE_PIXEL_FORMAT Format; //Only BGRX8888 goes to GDI, the others are widened first
 };
 
 //Instead of calling GetClientRect all the time, create struct for window dimensions and store them
@@ -17,10 +18,62 @@ struct WIN32_WINDOW_DIMENSIONS
 //Sound test buffer values
 struct WIN32_SOUND_OUTPUT
 {
-    int SampleRate;
+    int SampleRate; //Device, everything below counts frames at this rate
+    int GameSampleRate; //What the game mixes at, resampled to SampleRate when they differ
     uint32 RunningSampleIndex;
     int BytesPerSample;
     int SecondaryBufferSize;
     float32 tSine;
-    int LatencySampleCount;
-};
\ No newline at end of file
+    int LatencySampleCount; //How far the game writes ahead into the ring, picked each frame by Latency
+    int SafetySampleCount; //How far the audio thread keeps the secondary buffer ahead of the write cursor
+    AUDIO_RING_BUFFER *Ring;
+    AUDIO_LATENCY_CONTROLLER Latency;
+    RESAMPLE_CONTEXT Resampler;
+    int16 *DeviceSamples; //Resampler output on its way to the ring, 0 while the rates match
+    int64 DeviceResyncCount; //Audio thread fell behind the write cursor and had to jump forward
+};
+
+//Game memory block and how Windows ended up backing it
+struct WIN32_GAME_MEMORY
+{
+    void *Base;
+    size_t Size;
+    bool32 AtFixedBase;
+    bool32 LargePages;
+};
+
+//Entry points from the currently loaded handmade.dll
+struct WIN32_GAME_CODE
+{
+    HMODULE GameCodeDLL;
+    FILETIME LastWriteTime;
+    handmade_game_update_render *UpdateAndRender;
+    handmade_game_get_sound_samples *GetSoundSamples;
+    bool32 IsValid;
+};
+
+enum WIN32_REPLAY_MODE
+{
+    WIN32_REPLAY_MODE_OFF,
+    WIN32_REPLAY_MODE_RECORDING,
+    WIN32_REPLAY_MODE_PLAYBACK, //Loops back to the snapshot at the end of the file
+};
+
+//Input recording toggled with L: record, then loop playback, then off
+struct WIN32_REPLAY_STATE
+{
+    WIN32_REPLAY_MODE Mode;
+    HANDLE File;
+    char FileName[MAX_PATH];
+    int SampleRate;
+    HANDMADE_WORK_QUEUE *BackgroundQueue; //Drained before memory is snapshotted or restored, read-ahead may still be writing to it, 0 if none
+};
+
+//XInput polled on its own thread well above the frame rate, so a press and release between two frames both reach the ring
+struct WIN32_PAD_POLL
+{
+    INPUT_EVENT_RING Ring;
+    WORD Buttons[XUSER_MAX_COUNT]; //Last state seen per pad
+    int SkipPolls[XUSER_MAX_COUNT]; //Disconnected pads are slow to query, so they are only retried now and then
+    bool32 volatile Running;
+};